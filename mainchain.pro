@@ -26,6 +26,7 @@ HEADERS += src/addrdb.h \
            src/base58.h \
            src/bech32.h \
            src/blockencodings.h \
+           src/blockimport.h \
            src/bloom.h \
            src/chain.h \
            src/chainparams.h \
@@ -45,6 +46,8 @@ HEADERS += src/addrdb.h \
            src/hash.h \
            src/httprpc.h \
            src/httpserver.h \
+           src/index/base.h \
+           src/index/txindex.h \
            src/indirectmap.h \
            src/init.h \
            src/key.h \
@@ -64,12 +67,15 @@ HEADERS += src/addrdb.h \
            src/protocol.h \
            src/pubkey.h \
            src/random.h \
+           src/replaycheck.h \
            src/reverse_iterator.h \
            src/reverselock.h \
            src/scheduler.h \
            src/serialize.h \
            src/sidechain.h \
            src/sidechaindb.h \
+           src/sidechainsim.h \
+           src/socketevents.h \
            src/streams.h \
            src/sync.h \
            src/threadinterrupt.h \
@@ -124,6 +130,7 @@ HEADERS += src/addrdb.h \
            src/qt/blockexplorertablemodel.h \
            src/qt/blockindexdetailsdialog.h \
            src/qt/callback.h \
+           src/qt/chainnotifier.h \
            src/qt/clientmodel.h \
            src/qt/coincontroldialog.h \
            src/qt/coincontroltreewidget.h \
@@ -218,11 +225,14 @@ HEADERS += src/addrdb.h \
            src/test/scriptnum10.h \
            src/test/test_drivechain.h \
            src/wallet/coincontrol.h \
+           src/wallet/coinsplit.h \
            src/wallet/crypter.h \
            src/wallet/db.h \
+           src/wallet/depositqueue.h \
            src/wallet/feebumper.h \
            src/wallet/fees.h \
            src/wallet/init.h \
+           src/wallet/logdb.h \
            src/wallet/rpcwallet.h \
            src/wallet/wallet.h \
            src/wallet/walletdb.h \
@@ -320,6 +330,7 @@ HEADERS += src/addrdb.h \
            src/secp256k1/src/testrand.h \
            src/secp256k1/src/testrand_impl.h \
            src/secp256k1/src/util.h \
+           src/support/allocators/pool.h \
            src/support/allocators/secure.h \
            src/support/allocators/zeroafterfree.h \
            src/univalue/include/univalue.h \
@@ -390,6 +401,7 @@ SOURCES += src/addrdb.cpp \
            src/base58.cpp \
            src/bech32.cpp \
            src/blockencodings.cpp \
+           src/blockimport.cpp \
            src/bloom.cpp \
            src/chain.cpp \
            src/chainparams.cpp \
@@ -408,6 +420,8 @@ SOURCES += src/addrdb.cpp \
            src/hash.cpp \
            src/httprpc.cpp \
            src/httpserver.cpp \
+           src/index/base.cpp \
+           src/index/txindex.cpp \
            src/init.cpp \
            src/key.cpp \
            src/keystore.cpp \
@@ -422,10 +436,13 @@ SOURCES += src/addrdb.cpp \
            src/protocol.cpp \
            src/pubkey.cpp \
            src/random.cpp \
+           src/replaycheck.cpp \
            src/rest.cpp \
            src/scheduler.cpp \
            src/sidechain.cpp \
            src/sidechaindb.cpp \
+           src/sidechainsim.cpp \
+           src/socketevents.cpp \
            src/sync.cpp \
            src/threadinterrupt.cpp \
            src/timedata.cpp \
@@ -442,9 +459,11 @@ SOURCES += src/addrdb.cpp \
            src/validationinterface.cpp \
            src/versionbits.cpp \
            src/warnings.cpp \
+           src/bench/available_coins.cpp \
            src/bench/base58.cpp \
            src/bench/bench.cpp \
            src/bench/bench_bitcoin.cpp \
+           src/bench/block_index.cpp \
            src/bench/ccoins_caching.cpp \
            src/bench/checkblock.cpp \
            src/bench/checkqueue.cpp \
@@ -455,8 +474,12 @@ SOURCES += src/addrdb.cpp \
            src/bench/mempool_eviction.cpp \
            src/bench/perf.cpp \
            src/bench/prevector_destructor.cpp \
+           src/bench/reindex.cpp \
+           src/bench/rescan.cpp \
            src/bench/rollingbloom.cpp \
+           src/bench/sign_transaction.cpp \
            src/bench/verify_script.cpp \
+           src/bench/wallet_db.cpp \
            src/compat/glibc_compat.cpp \
            src/compat/glibc_sanity.cpp \
            src/compat/glibcxx_sanity.cpp \
@@ -471,6 +494,9 @@ SOURCES += src/addrdb.cpp \
            src/crypto/sha1.cpp \
            src/crypto/sha256.cpp \
            src/crypto/sha256_sse4.cpp \
+           src/crypto/sha256_sse41.cpp \
+           src/crypto/sha256_avx2.cpp \
+           src/crypto/sha256_shani.cpp \
            src/crypto/sha512.cpp \
            src/policy/feerate.cpp \
            src/policy/fees.cpp \
@@ -485,6 +511,7 @@ SOURCES += src/addrdb.cpp \
            src/qt/blockexplorer.cpp \
            src/qt/blockexplorertablemodel.cpp \
            src/qt/blockindexdetailsdialog.cpp \
+           src/qt/chainnotifier.cpp \
            src/qt/clientmodel.cpp \
            src/qt/coincontroldialog.cpp \
            src/qt/coincontroltreewidget.cpp \
@@ -587,6 +614,8 @@ SOURCES += src/addrdb.cpp \
            src/test/bip32_tests.cpp \
            src/test/blockchain_tests.cpp \
            src/test/blockencodings_tests.cpp \
+           src/test/blockimport_tests.cpp \
+           src/test/blockindex_tests.cpp \
            src/test/bloom_tests.cpp \
            src/test/bmm_tests.cpp \
            src/test/bswap_tests.cpp \
@@ -615,6 +644,7 @@ SOURCES += src/addrdb.cpp \
            src/test/prevector_tests.cpp \
            src/test/raii_event_tests.cpp \
            src/test/random_tests.cpp \
+           src/test/replaycheck_tests.cpp \
            src/test/reverselock_tests.cpp \
            src/test/rpc_tests.cpp \
            src/test/sanity_tests.cpp \
@@ -638,16 +668,20 @@ SOURCES += src/addrdb.cpp \
            src/test/torcontrol_tests.cpp \
            src/test/transaction_criticaldata_tests.cpp \
            src/test/transaction_tests.cpp \
+           src/test/txoutset_tests.cpp \
            src/test/txvalidation_tests.cpp \
            src/test/txvalidationcache_tests.cpp \
            src/test/uint256_tests.cpp \
            src/test/util_tests.cpp \
            src/test/versionbits_tests.cpp \
+           src/wallet/coinsplit.cpp \
            src/wallet/crypter.cpp \
            src/wallet/db.cpp \
+           src/wallet/depositqueue.cpp \
            src/wallet/feebumper.cpp \
            src/wallet/fees.cpp \
            src/wallet/init.cpp \
+           src/wallet/logdb.cpp \
            src/wallet/rpcdump.cpp \
            src/wallet/rpcwallet.cpp \
            src/wallet/wallet.cpp \
@@ -756,7 +790,10 @@ SOURCES += src/addrdb.cpp \
            src/univalue/test/test_json.cpp \
            src/univalue/test/unitester.cpp \
            src/wallet/test/accounting_tests.cpp \
+           src/wallet/test/coinsplit_tests.cpp \
            src/wallet/test/crypto_tests.cpp \
+           src/wallet/test/depositqueue_tests.cpp \
+           src/wallet/test/logdb_tests.cpp \
            src/wallet/test/wallet_test_fixture.cpp \
            src/wallet/test/wallet_tests.cpp \
            src/leveldb/doc/bench/db_bench_sqlite3.cc \
@@ -4,7 +4,9 @@
 
 #include <apiclient.h>
 
+#include <univalue.h>
 #include <util.h>
+#include <utilstrencodings.h>
 
 #include <iostream>
 #include <sstream>
@@ -18,6 +20,57 @@
 
 using boost::asio::ip::tcp;
 
+bool ParseAPIEndpoint(const std::string& strURL, APIEndpoint& endpoint)
+{
+    std::string strRest;
+    if (strURL.compare(0, 7, "http://") == 0) {
+        endpoint.fTLS = false;
+        endpoint.nPort = 80;
+        strRest = strURL.substr(7);
+    } else if (strURL.compare(0, 8, "https://") == 0) {
+        endpoint.fTLS = true;
+        endpoint.nPort = 443;
+        strRest = strURL.substr(8);
+    } else {
+        return false;
+    }
+
+    size_t nSlash = strRest.find('/');
+    endpoint.strPath = nSlash == std::string::npos ? "/" : strRest.substr(nSlash);
+    std::string strHostPort = strRest.substr(0, nSlash);
+    SplitHostPort(strHostPort, endpoint.nPort, endpoint.strHost);
+    // A port that doesn't parse is left in the host, only IPv6 hosts in brackets have a colon
+    if (endpoint.strHost.empty() || (strHostPort[0] != '[' && endpoint.strHost.find(':') != std::string::npos))
+        return false;
+    return endpoint.nPort > 0;
+}
+
+// Send the request and read the response until the server closes the
+// connection
+template <typename Stream>
+static void Exchange(Stream& stream, const std::string& strRequest, std::string& strResponse)
+{
+    boost::asio::write(stream, boost::asio::buffer(strRequest));
+
+    for (;;)
+    {
+        boost::array<char, 4096> buf;
+
+        boost::system::error_code e;
+        size_t sz = stream.read_some(boost::asio::buffer(buf), e);
+
+        if (!sz && e)
+            break;
+
+        strResponse.insert(strResponse.size(), buf.data(), sz);
+
+        if (e == boost::asio::error::eof)
+            break; // socket closed
+        else if (e)
+            throw boost::system::system_error(e);
+    }
+}
+
 APIClient::APIClient()
 {
 
@@ -136,6 +189,89 @@ bool APIClient::IsTxReplayed(const uint256& txid)
     return false;
 }
 
+bool APIClient::GetReplayStatus(const APIEndpoint& endpoint, const std::vector<uint256>& vTxid, std::map<uint256, bool>& mapReplayed)
+{
+    UniValue txids(UniValue::VARR);
+    for (const uint256& txid : vTxid)
+        txids.push_back(txid.GetHex());
+    UniValue request(UniValue::VOBJ);
+    request.pushKV("txids", txids);
+
+    std::string strReply;
+    if (!Post(endpoint, request.write(), strReply))
+        return false;
+
+    UniValue reply;
+    if (!reply.read(strReply) || !reply.isObject()) {
+        LogPrintf("ERROR API client (GetReplayStatus): Invalid reply from %s\n", endpoint.strHost);
+        return false;
+    }
+
+    for (const uint256& txid : vTxid) {
+        const UniValue& status = find_value(reply, txid.GetHex());
+        if (status.isBool())
+            mapReplayed[txid] = status.get_bool();
+    }
+    return true;
+}
+
+bool APIClient::Post(const APIEndpoint& endpoint, const std::string& strBody, std::string& strReply)
+{
+    // HTTP/1.0 keeps the server from chunking the reply
+    std::string strRequest = strprintf("POST %s HTTP/1.0\r\n", endpoint.strPath);
+    strRequest += strprintf("Host: %s\r\n", endpoint.strHost);
+    strRequest += "Content-Type: application/json\r\n";
+    strRequest += "Accept: application/json\r\n";
+    strRequest += strprintf("Content-Length: %u\r\n", strBody.size());
+    strRequest += "Connection: close\r\n\r\n";
+    strRequest += strBody;
+
+    std::string strResponse;
+    try {
+        boost::asio::io_service io_service;
+        tcp::resolver resolver(io_service);
+        tcp::resolver::query query(endpoint.strHost, std::to_string(endpoint.nPort));
+        auto endpoint_iterator = resolver.resolve(query);
+
+        if (endpoint.fTLS) {
+            // The replay status is trusted, so the server has to prove it
+            // is the endpoint
+            boost::asio::ssl::context sslContext(boost::asio::ssl::context::method::sslv23_client);
+            sslContext.set_default_verify_paths();
+            sslContext.set_verify_mode(boost::asio::ssl::verify_peer);
+            boost::asio::ssl::stream<tcp::socket> sslSocket(io_service, sslContext);
+            sslSocket.set_verify_callback(boost::asio::ssl::rfc2818_verification(endpoint.strHost));
+            boost::asio::connect(sslSocket.lowest_layer(), endpoint_iterator);
+            SSL_set_tlsext_host_name(sslSocket.native_handle(), endpoint.strHost.c_str());
+            sslSocket.handshake(boost::asio::ssl::stream_base::handshake_type::client);
+            Exchange(sslSocket, strRequest, strResponse);
+        } else {
+            tcp::socket socket(io_service);
+            boost::asio::connect(socket, endpoint_iterator);
+            Exchange(socket, strRequest, strResponse);
+        }
+    } catch (std::exception &exception) {
+        LogPrintf("ERROR API client (Post): %s\n", exception.what());
+        return false;
+    }
+
+    // Check response code
+    int code = 0;
+    size_t nSpace = strResponse.find(' ');
+    if (nSpace != std::string::npos)
+        code = atoi(strResponse.substr(nSpace + 1, 3));
+    if (code != 200) {
+        LogPrintf("ERROR API client (Post): %s replied with status %d\n", endpoint.strHost, code);
+        return false;
+    }
+
+    size_t nBody = strResponse.find("\r\n\r\n");
+    if (nBody == std::string::npos)
+        return false;
+    strReply = strResponse.substr(nBody + 4);
+    return true;
+}
+
 bool APIClient::SendRequest(const std::string& json, boost::property_tree::ptree &ptree)
 {
     // Mainnet RPC = 8332
@@ -8,11 +8,24 @@
 #include <amount.h>
 #include <uint256.h>
 
+#include <map>
 #include <string>
 #include <vector>
 
 #include <boost/property_tree/json_parser.hpp>
 
+/** An HTTP(S) endpoint of an API */
+struct APIEndpoint
+{
+    std::string strHost;
+    int nPort;
+    bool fTLS;
+    std::string strPath;
+};
+
+/** Parse an http:// or https:// URL into an endpoint */
+bool ParseAPIEndpoint(const std::string& strURL, APIEndpoint& endpoint);
+
 class APIClient
 {
 public:
@@ -20,7 +33,20 @@ public:
 
     bool IsTxReplayed(const uint256& txid);
 
+    /**
+     * Ask the replay status endpoint whether the transactions were replayed,
+     * all of them in one request. The endpoint is sent {"txids": [...]} and
+     * replies with an object of txid: true/false, transactions it leaves out
+     * are left out of mapReplayed. Returns false if the request failed.
+     */
+    bool GetReplayStatus(const APIEndpoint& endpoint, const std::vector<uint256>& vTxid, std::map<uint256, bool>& mapReplayed);
+
 private:
+    /*
+     * POST a request body to the endpoint and read the body of the reply
+     */
+    bool Post(const APIEndpoint& endpoint, const std::string& strBody, std::string& strReply);
+
     /*
      * Send json request
      */
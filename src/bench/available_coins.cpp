@@ -0,0 +1,47 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <key.h>
+#include <validation.h>
+#include <wallet/wallet.h>
+
+// Wallet with a long chain of unconfirmed transactions, each spending the one
+// before it. Only every tenth transaction has a second output paying to the
+// wallet, so most of the wallet's outputs are spent.
+static void AvailableCoins(benchmark::State& state)
+{
+    CWallet wallet;
+    CKey key;
+    key.MakeNewKey(true);
+    {
+        LOCK(wallet.cs_wallet);
+        wallet.AddKeyPubKey(key, key.GetPubKey());
+    }
+    const CScript scriptMine = GetScriptForDestination(key.GetPubKey().GetID());
+    const CScript scriptOther = CScript() << OP_TRUE;
+
+    uint256 hashPrev;
+    for (int i = 0; i < 10000; i++) {
+        CMutableTransaction tx;
+        if (i > 0)
+            tx.vin.emplace_back(hashPrev, 0);
+        tx.vout.emplace_back(COIN, scriptMine);
+        tx.vout.emplace_back(COIN, i % 10 == 0 ? scriptMine : scriptOther);
+
+        CWalletTx wtx(&wallet, MakeTransactionRef(std::move(tx)));
+        wtx.fInMempool = true;
+        wallet.AddToWallet(wtx);
+        hashPrev = wtx.GetHash();
+    }
+
+    LOCK2(cs_main, wallet.cs_wallet);
+    std::vector<COutput> vCoins;
+    while (state.KeepRunning()) {
+        wallet.AvailableCoins(vCoins);
+        assert(vCoins.size() == 1000);
+    }
+}
+
+BENCHMARK(AvailableCoins, 100);
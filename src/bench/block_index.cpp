@@ -0,0 +1,133 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <fs.h>
+#include <pow.h>
+#include <txdb.h>
+#include <util.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <assert.h>
+
+static const int BLOCK_INDEX_BENCH_ENTRIES = 100000;
+
+/**
+ * A regtest block index of BLOCK_INDEX_BENCH_ENTRIES entries written both to
+ * the block tree database and to the flat file of a temporary data directory.
+ */
+struct BenchBlockIndex
+{
+    fs::path pathDataDir;
+    std::unique_ptr<CBlockTreeDB> blocktree;
+    BlockMap mapIndex;
+
+    BenchBlockIndex()
+    {
+        SelectParams(CBaseChainParams::REGTEST);
+        const Consensus::Params& consensusParams = Params().GetConsensus();
+
+        pathDataDir = fs::temp_directory_path() / fs::unique_path("bench_blockindex_%%%%%%%%");
+        fs::create_directories(pathDataDir / "regtest" / "blocks");
+        gArgs.ForceSetArg("-datadir", pathDataDir.string());
+        ClearDatadirCache();
+        blocktree.reset(new CBlockTreeDB(8 << 20));
+
+        std::vector<const CBlockIndex*> vIndex;
+        CBlockIndex* pindexPrev = nullptr;
+        CBlockHeader header = Params().GenesisBlock().GetBlockHeader();
+        for (int nHeight = 0; nHeight < BLOCK_INDEX_BENCH_ENTRIES; nHeight++) {
+            if (pindexPrev) {
+                header.hashPrevBlock = pindexPrev->GetBlockHash();
+                header.nTime = pindexPrev->nTime + 600;
+                header.nNonce = 0;
+                while (!CheckProofOfWork(header.GetHash(), header.nBits, consensusParams))
+                    header.nNonce++;
+            }
+            CBlockIndex* pindex = Insert(header.GetHash());
+            *pindex = CBlockIndex(header);
+            pindex->phashBlock = &mapIndex.find(header.GetHash())->first;
+            pindex->pprev = pindexPrev;
+            pindex->nHeight = nHeight;
+            pindex->nTx = 1;
+            pindex->nStatus = BLOCK_VALID_SCRIPTS | BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO;
+            pindex->nDataPos = 8 + nHeight * 300;
+            pindex->nUndoPos = 8 + nHeight * 100;
+            vIndex.push_back(pindex);
+            pindexPrev = pindex;
+        }
+
+        // The database write makes any flat file stale, write it last
+        assert(blocktree->WriteBatchSync({}, 0, vIndex));
+        assert(blocktree->WriteFlatBlockIndex(vIndex));
+        Clear();
+    }
+
+    ~BenchBlockIndex()
+    {
+        Clear();
+        blocktree.reset();
+        gArgs.ForceSetArg("-datadir", "");
+        ClearDatadirCache();
+        fs::remove_all(pathDataDir);
+    }
+
+    CBlockIndex* Insert(const uint256& hash)
+    {
+        if (hash.IsNull())
+            return nullptr;
+        BlockMap::iterator it = mapIndex.find(hash);
+        if (it != mapIndex.end())
+            return it->second;
+        CBlockIndex* pindexNew = new CBlockIndex();
+        it = mapIndex.insert(std::make_pair(hash, pindexNew)).first;
+        pindexNew->phashBlock = &it->first;
+        return pindexNew;
+    }
+
+    void Clear()
+    {
+        for (const std::pair<const uint256, CBlockIndex*>& item : mapIndex)
+            delete item.second;
+        mapIndex.clear();
+    }
+};
+
+// Load the block index from the database, and sort it by height the way
+// CChainState::LoadBlockIndex does
+static void BlockIndexLoadDatabase(benchmark::State& state)
+{
+    BenchBlockIndex index;
+    while (state.KeepRunning()) {
+        bool fLoaded = index.blocktree->LoadBlockIndexGuts(Params().GetConsensus(), [&index](const uint256& hash) { return index.Insert(hash); });
+        assert(fLoaded);
+        std::vector<std::pair<int, CBlockIndex*>> vSortedByHeight;
+        vSortedByHeight.reserve(index.mapIndex.size());
+        for (const std::pair<const uint256, CBlockIndex*>& item : index.mapIndex)
+            vSortedByHeight.push_back(std::make_pair(item.second->nHeight, item.second));
+        std::sort(vSortedByHeight.begin(), vSortedByHeight.end());
+        assert(vSortedByHeight.size() == BLOCK_INDEX_BENCH_ENTRIES);
+        index.Clear();
+    }
+}
+
+// Load the block index from the flat file, already sorted by height
+static void BlockIndexLoadFlatFile(benchmark::State& state)
+{
+    BenchBlockIndex index;
+    while (state.KeepRunning()) {
+        std::vector<CBlockIndex*> vIndex;
+        bool fLoaded = index.blocktree->LoadFlatBlockIndex(Params().GetConsensus(), [&index](const uint256& hash) { return index.Insert(hash); }, vIndex);
+        assert(fLoaded);
+        assert(vIndex.size() == BLOCK_INDEX_BENCH_ENTRIES);
+        index.Clear();
+    }
+}
+
+BENCHMARK(BlockIndexLoadDatabase, 1);
+BENCHMARK(BlockIndexLoadFlatFile, 1);
@@ -7,6 +7,7 @@
 #include <policy/policy.h>
 #include <wallet/crypter.h>
 
+#include <unordered_map>
 #include <vector>
 
 // FIXME: Dedup with SetupDummyInputs in test/transaction_tests.cpp.
@@ -84,4 +85,54 @@ static void CCoinsCaching(benchmark::State& state)
     }
 }
 
+// Fill a coins cache with P2PKH outputs, the way pcoinsTip grows during
+// initial block download until it reaches -dbcache, and drop it again.
+// CCoinsMapFillMalloc does the same with a map that makes a malloc() call
+// per entry instead of using the pool of the cache.
+static const int CACHE_FILL_COINS = 20000;
+
+static std::vector<COutPoint> CacheFillOutPoints()
+{
+    std::vector<COutPoint> vOutPoints;
+    for (int i = 0; i < CACHE_FILL_COINS; i++) {
+        uint256 hash;
+        hash.begin()[0] = i & 0xff;
+        hash.begin()[1] = (i >> 8) & 0xff;
+        hash.begin()[2] = (i >> 16) & 0xff;
+        vOutPoints.emplace_back(hash, i % 3);
+    }
+    return vOutPoints;
+}
+
+static void CCoinsCacheFill(benchmark::State& state)
+{
+    const std::vector<COutPoint> vOutPoints = CacheFillOutPoints();
+    const CTxOut txout(CENT, GetScriptForDestination(CKeyID(uint160())));
+    CCoinsView coinsDummy;
+
+    while (state.KeepRunning()) {
+        CCoinsViewCache coins(&coinsDummy);
+        for (const COutPoint& outpoint : vOutPoints) {
+            coins.AddCoin(outpoint, Coin(txout, 1, false), false);
+        }
+        assert(coins.GetCacheSize() == vOutPoints.size());
+    }
+}
+
+static void CCoinsMapFillMalloc(benchmark::State& state)
+{
+    const std::vector<COutPoint> vOutPoints = CacheFillOutPoints();
+    const CTxOut txout(CENT, GetScriptForDestination(CKeyID(uint160())));
+
+    while (state.KeepRunning()) {
+        std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> map;
+        for (const COutPoint& outpoint : vOutPoints) {
+            map.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(Coin(txout, 1, false)));
+        }
+        assert(map.size() == vOutPoints.size());
+    }
+}
+
 BENCHMARK(CCoinsCaching, 170 * 1000);
+BENCHMARK(CCoinsCacheFill, 50);
+BENCHMARK(CCoinsMapFillMalloc, 50);
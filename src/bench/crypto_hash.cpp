@@ -52,6 +52,38 @@ static void SHA256_32b(benchmark::State& state)
     }
 }
 
+static void SHA256D64_1024(benchmark::State& state, sha256_implementation::UseImplementation use)
+{
+    // Only measure the backends this CPU supports, SHA256AutoDetect falls
+    // back to the generic code for the rest.
+    SHA256AutoDetect(use);
+    std::vector<uint8_t> in(64 * 1024, 0);
+    while (state.KeepRunning()) {
+        SHA256D64(in.data(), in.data(), 1024);
+    }
+    SHA256AutoDetect();
+}
+
+static void SHA256D64_1024_Standard(benchmark::State& state)
+{
+    SHA256D64_1024(state, sha256_implementation::STANDARD);
+}
+
+static void SHA256D64_1024_SSE4(benchmark::State& state)
+{
+    SHA256D64_1024(state, sha256_implementation::USE_SSE4);
+}
+
+static void SHA256D64_1024_AVX2(benchmark::State& state)
+{
+    SHA256D64_1024(state, static_cast<sha256_implementation::UseImplementation>(sha256_implementation::USE_SSE4 | sha256_implementation::USE_AVX2));
+}
+
+static void SHA256D64_1024_SHANI(benchmark::State& state)
+{
+    SHA256D64_1024(state, sha256_implementation::USE_SHANI);
+}
+
 static void SHA512(benchmark::State& state)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -93,6 +125,10 @@ BENCHMARK(SHA256, 340);
 BENCHMARK(SHA512, 330);
 
 BENCHMARK(SHA256_32b, 4700 * 1000);
+BENCHMARK(SHA256D64_1024_Standard, 7400);
+BENCHMARK(SHA256D64_1024_SSE4, 7400);
+BENCHMARK(SHA256D64_1024_AVX2, 7400);
+BENCHMARK(SHA256D64_1024_SHANI, 7400);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
@@ -0,0 +1,99 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <blockimport.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <consensus/merkle.h>
+#include <fs.h>
+#include <key.h>
+#include <script/standard.h>
+#include <streams.h>
+
+#include <assert.h>
+
+static const int REINDEX_BENCH_BLOCKS = 50;
+static const int REINDEX_BENCH_TXS_PER_BLOCK = 400;
+
+/**
+ * Write a regtest chain of blocks that spend the outputs of their
+ * predecessor to a blk file. The header signature can only be made with the
+ * signing key of the network, so the reader runs without CheckBlock.
+ */
+static fs::path WriteBenchChain(const CChainParams& chainparams)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CScript scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+
+    fs::path path = fs::temp_directory_path() / fs::unique_path("bench_reindex_%%%%%%%%.dat");
+    CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+    assert(!file.IsNull());
+
+    uint256 hashPrev = chainparams.GenesisBlock().GetHash();
+    std::vector<COutPoint> vPrevOuts;
+    for (int nHeight = 1; nHeight <= REINDEX_BENCH_BLOCKS; nHeight++) {
+        CBlock block;
+        block.nVersion = 0x20000000;
+        block.hashPrevBlock = hashPrev;
+        block.nTime = chainparams.GenesisBlock().nTime + nHeight * 600;
+        block.nBits = chainparams.GenesisBlock().nBits;
+
+        CMutableTransaction coinbase;
+        coinbase.vin.resize(1);
+        coinbase.vin[0].scriptSig = CScript() << nHeight << OP_0;
+        coinbase.vout.resize(REINDEX_BENCH_TXS_PER_BLOCK, CTxOut(COIN, scriptPubKey));
+        block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+
+        for (const COutPoint& prevout : vPrevOuts) {
+            CMutableTransaction tx;
+            tx.vin.emplace_back(prevout);
+            // Unsigned inputs of the size of a signature and public key
+            tx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(72, 1) << ToByteVector(key.GetPubKey());
+            tx.vout.resize(2, CTxOut(COIN / 2 - 1000, scriptPubKey));
+            block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+        }
+        block.hashMerkleRoot = BlockMerkleRoot(block);
+
+        vPrevOuts.clear();
+        for (uint32_t n = 0; n < REINDEX_BENCH_TXS_PER_BLOCK; n++) {
+            vPrevOuts.emplace_back(block.vtx[0]->GetHash(), n);
+        }
+        hashPrev = block.GetHash();
+
+        file << FLATDATA(chainparams.MessageStart());
+        file << (unsigned int)::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+        file << block;
+    }
+    return path;
+}
+
+// Read, deserialize and hash every block of a blk file the way
+// LoadExternalBlockFile does during -reindex
+static void Reindex(benchmark::State& state, int nThreads)
+{
+    const std::unique_ptr<CChainParams> chainparams = CreateChainParams(CBaseChainParams::REGTEST);
+    fs::path path = WriteBenchChain(*chainparams);
+
+    while (state.KeepRunning()) {
+        CBlockFileReader reader(fsbridge::fopen(path, "rb"), *chainparams, nThreads, false);
+        CBlockFileReader::Record record;
+        int nBlocks = 0;
+        while (reader.Next(record)) {
+            assert(record.pblock);
+            nBlocks++;
+        }
+        assert(nBlocks == REINDEX_BENCH_BLOCKS);
+    }
+
+    fs::remove(path);
+}
+
+static void Reindex1Thread(benchmark::State& state) { Reindex(state, 1); }
+static void Reindex4Threads(benchmark::State& state) { Reindex(state, 4); }
+
+BENCHMARK(Reindex1Thread, 10);
+BENCHMARK(Reindex4Threads, 10);
@@ -0,0 +1,164 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <blockimport.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <consensus/merkle.h>
+#include <fs.h>
+#include <key.h>
+#include <keystore.h>
+#include <pow.h>
+#include <random.h>
+#include <script/ismine.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <util.h>
+#include <validation.h>
+
+#include <assert.h>
+
+static const int RESCAN_BENCH_BLOCKS = 100;
+static const int RESCAN_BENCH_TXS_PER_BLOCK = 200;
+//! One in this many transactions pays to the keys of the bench wallet
+static const int RESCAN_BENCH_MATCH_INTERVAL = 50;
+
+/**
+ * A regtest chain written to the block files of a temporary data directory
+ * and set as the active chain, removed again when it goes out of scope.
+ */
+struct BenchChain
+{
+    fs::path pathDataDir;
+    std::map<uint256, std::unique_ptr<CBlockIndex>> mapIndex;
+    CBasicKeyStore keystore;
+
+    BenchChain()
+    {
+        SelectParams(CBaseChainParams::REGTEST);
+        const Consensus::Params& consensusParams = Params().GetConsensus();
+
+        pathDataDir = fs::temp_directory_path() / fs::unique_path("bench_rescan_%%%%%%%%");
+        fs::create_directories(pathDataDir);
+        gArgs.ForceSetArg("-datadir", pathDataDir.string());
+        ClearDatadirCache();
+
+        std::vector<CScript> vScriptMine;
+        for (int i = 0; i < 10; i++) {
+            CKey key;
+            key.MakeNewKey(true);
+            keystore.AddKey(key);
+            vScriptMine.push_back(GetScriptForDestination(key.GetPubKey().GetID()));
+        }
+        CKey keyOther;
+        keyOther.MakeNewKey(true);
+        CScript scriptOther = GetScriptForDestination(keyOther.GetPubKey().GetID());
+
+        CAutoFile file(OpenBlockFile(CDiskBlockPos(0, 0)), SER_DISK, CLIENT_VERSION);
+        assert(!file.IsNull());
+
+        CBlockIndex* pindexPrev = AddIndex(Params().GenesisBlock(), nullptr);
+        for (int nHeight = 1; nHeight <= RESCAN_BENCH_BLOCKS; nHeight++) {
+            CBlock block;
+            block.nVersion = 0x20000000;
+            block.hashPrevBlock = pindexPrev->GetBlockHash();
+            block.nTime = Params().GenesisBlock().nTime + nHeight * 600;
+            block.nBits = Params().GenesisBlock().nBits;
+
+            CMutableTransaction coinbase;
+            coinbase.vin.resize(1);
+            coinbase.vin[0].scriptSig = CScript() << nHeight << OP_0;
+            coinbase.vout.emplace_back(50 * COIN, scriptOther);
+            block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+
+            for (int i = 1; i < RESCAN_BENCH_TXS_PER_BLOCK; i++) {
+                CMutableTransaction tx;
+                tx.vin.emplace_back(COutPoint(GetRandHash(), 0));
+                tx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(72, 1) << std::vector<unsigned char>(33, 2);
+                tx.vout.emplace_back(COIN, scriptOther);
+                if (i % RESCAN_BENCH_MATCH_INTERVAL == 0)
+                    tx.vout.emplace_back(COIN, vScriptMine[i % vScriptMine.size()]);
+                else
+                    tx.vout.emplace_back(COIN, scriptOther);
+                block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+            }
+            block.hashMerkleRoot = BlockMerkleRoot(block);
+            while (!CheckProofOfWork(block.GetHash(), block.nBits, consensusParams))
+                block.nNonce++;
+
+            file << FLATDATA(Params().MessageStart());
+            file << (unsigned int)::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+            CBlockIndex* pindex = AddIndex(block, pindexPrev);
+            pindex->nFile = 0;
+            pindex->nDataPos = ftell(file.Get());
+            pindex->nStatus |= BLOCK_HAVE_DATA;
+            file << block;
+            pindexPrev = pindex;
+        }
+
+        LOCK(cs_main);
+        chainActive.SetTip(pindexPrev);
+    }
+
+    ~BenchChain()
+    {
+        {
+            LOCK(cs_main);
+            chainActive.SetTip(nullptr);
+        }
+        mapIndex.clear();
+        gArgs.ForceSetArg("-datadir", "");
+        ClearDatadirCache();
+        fs::remove_all(pathDataDir);
+    }
+
+    CBlockIndex* AddIndex(const CBlockHeader& header, CBlockIndex* pindexPrev)
+    {
+        auto it = mapIndex.emplace(header.GetHash(), std::unique_ptr<CBlockIndex>(new CBlockIndex(header))).first;
+        CBlockIndex* pindex = it->second.get();
+        pindex->phashBlock = &it->first;
+        pindex->pprev = pindexPrev;
+        pindex->nHeight = pindexPrev ? pindexPrev->nHeight + 1 : 0;
+        return pindex;
+    }
+};
+
+// Read the blocks of the active chain and match their outputs against the
+// keys of a wallet the way a wallet rescan does
+static void Rescan(benchmark::State& state, int nThreads)
+{
+    BenchChain chain;
+    auto filter = [&chain](const CBlock& block, std::vector<bool>& vMatch) {
+        for (size_t i = 0; i < block.vtx.size(); i++) {
+            for (const CTxOut& txout : block.vtx[i]->vout) {
+                if (IsMine(chain.keystore, txout.scriptPubKey) != ISMINE_NO) {
+                    vMatch[i] = true;
+                    break;
+                }
+            }
+        }
+    };
+
+    while (state.KeepRunning()) {
+        CChainBlockReader reader(1, Params().GetConsensus(), nThreads, filter);
+        CChainBlockReader::Record record;
+        int nMatches = 0;
+        for (int nHeight = 1; nHeight <= RESCAN_BENCH_BLOCKS; nHeight++) {
+            reader.Next(record);
+            assert(record.pblock);
+            for (bool fMatch : record.vMatch)
+                nMatches += fMatch;
+        }
+        assert(nMatches == RESCAN_BENCH_BLOCKS * ((RESCAN_BENCH_TXS_PER_BLOCK - 1) / RESCAN_BENCH_MATCH_INTERVAL));
+    }
+}
+
+static void Rescan1Thread(benchmark::State& state) { Rescan(state, 1); }
+static void Rescan4Threads(benchmark::State& state) { Rescan(state, 4); }
+
+BENCHMARK(Rescan1Thread, 5);
+BENCHMARK(Rescan4Threads, 5);
@@ -0,0 +1,42 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <sidechainsim.h>
+
+// Simulate a full verification period for 8 sidechains with 3 withdrawals
+// each, upvoting one withdrawal per sidechain with a varying share of blocks.
+static void WithdrawalSimulation(benchmark::State& state)
+{
+    std::vector<std::vector<SidechainWithdrawalState>> vState(8);
+    for (size_t x = 0; x < vState.size(); x++) {
+        for (size_t y = 0; y < 3; y++) {
+            SidechainWithdrawalState withdrawal;
+            withdrawal.nSidechain = x;
+            withdrawal.nBlocksLeft = SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD - 1 - 100 * y;
+            withdrawal.nWorkScore = 100 * y;
+            withdrawal.hash = uint256S(std::to_string(x * 3 + y + 1));
+            vState[x].push_back(withdrawal);
+        }
+    }
+
+    SidechainWithdrawalSim sim(vState, 0);
+
+    unsigned int nPercent = 50;
+    while (state.KeepRunning()) {
+        std::map<uint8_t, SidechainVoteStrategy> mapStrategy;
+        for (const std::vector<SidechainWithdrawalState>& v : vState) {
+            SidechainVoteStrategy strategy;
+            strategy.vote = SidechainVoteStrategy::UPVOTE;
+            strategy.hash = v.back().hash;
+            strategy.nPercent = nPercent;
+            mapStrategy[v.back().nSidechain] = strategy;
+        }
+        sim.Run(mapStrategy, SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD);
+
+        nPercent = nPercent == 100 ? 50 : nPercent + 1;
+    }
+}
+
+BENCHMARK(WithdrawalSimulation, 500);
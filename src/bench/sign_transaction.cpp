@@ -0,0 +1,74 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <key.h>
+#include <keystore.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/sign.h>
+#include <script/standard.h>
+
+#include <assert.h>
+
+static const int SIGN_BENCH_INPUTS = 1000;
+static const int SIGN_BENCH_THREADS = 8;
+
+/** An unsigned transaction spending SIGN_BENCH_INPUTS outputs to keys of the keystore */
+static void BuildSpendingTransaction(CBasicKeyStore& keystore, bool fWitness, CMutableTransaction& mtx, std::vector<CTxOut>& vSpent)
+{
+    for (int i = 0; i < SIGN_BENCH_INPUTS; i++) {
+        CKey key;
+        key.MakeNewKey(true);
+        keystore.AddKey(key);
+        CScript scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+        if (fWitness)
+            scriptPubKey = GetScriptForWitness(scriptPubKey);
+        vSpent.emplace_back(COIN, scriptPubKey);
+        mtx.vin.emplace_back(COutPoint(GetRandHash(), i));
+    }
+    mtx.vout.emplace_back(SIGN_BENCH_INPUTS * COIN - COIN, CScript() << OP_TRUE);
+}
+
+static void SignTransactionInputs(benchmark::State& state, bool fWitness, int nMaxThreads)
+{
+    CBasicKeyStore keystore;
+    CMutableTransaction mtxUnsigned;
+    std::vector<CTxOut> vSpent;
+    BuildSpendingTransaction(keystore, fWitness, mtxUnsigned, vSpent);
+
+    while (state.KeepRunning()) {
+        CMutableTransaction mtx = mtxUnsigned;
+        bool fSigned = SignTransactionInputs(keystore, mtx, vSpent, nMaxThreads);
+        assert(fSigned);
+    }
+}
+
+// The inputs of segwit transactions share one signature hash cache
+static void SignTransactionInputsWitness(benchmark::State& state)
+{
+    SignTransactionInputs(state, true, 1);
+}
+
+static void SignTransactionInputsWitnessParallel(benchmark::State& state)
+{
+    SignTransactionInputs(state, true, SIGN_BENCH_THREADS);
+}
+
+// Legacy signature hashes cover the whole transaction, for every input
+static void SignTransactionInputsLegacy(benchmark::State& state)
+{
+    SignTransactionInputs(state, false, 1);
+}
+
+static void SignTransactionInputsLegacyParallel(benchmark::State& state)
+{
+    SignTransactionInputs(state, false, SIGN_BENCH_THREADS);
+}
+
+BENCHMARK(SignTransactionInputsWitness, 8);
+BENCHMARK(SignTransactionInputsWitnessParallel, 8);
+BENCHMARK(SignTransactionInputsLegacy, 2);
+BENCHMARK(SignTransactionInputsLegacyParallel, 2);
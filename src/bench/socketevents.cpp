@@ -0,0 +1,114 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <netbase.h>
+#include <socketevents.h>
+#include <util.h>
+
+#include <assert.h>
+
+#ifndef WIN32
+#include <sys/socket.h>
+
+// One wakeup of the socket handler loop with nPairs connections of which one
+// has received data: wait for the readiness event and read the data. The
+// level triggered backends pass every socket again on each wakeup like
+// CConnman::GenerateSelectSet does.
+static void SocketEventsLoop(benchmark::State& state, SocketEventsMode mode, size_t nPairs)
+{
+    if (RaiseFileDescriptorLimit(nPairs * 2 + 64) < (int)(nPairs * 2 + 64)) {
+        return;
+    }
+
+    CSocketEvents events(mode);
+    if (!events.Init()) {
+        return;
+    }
+
+    // vLocal must not reallocate after the pointers were registered
+    std::vector<SOCKET> vLocal, vRemote;
+    vLocal.reserve(nPairs);
+    for (size_t i = 0; i < nPairs; i++) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+            break;
+        }
+        SetSocketNonBlocking(sv[0], true);
+        vLocal.push_back(sv[0]);
+        vRemote.push_back(sv[1]);
+        if (!events.IsLevelTriggered()) {
+            events.Add(sv[0], &vLocal[i], true);
+        }
+    }
+
+    size_t nNext = 0;
+    std::set<SOCKET> recv_set, send_set, error_set;
+    std::vector<CSocketEvents::Event> vEvents;
+    char ch = 0;
+    while (vLocal.size() == nPairs && state.KeepRunning()) {
+        // Spread the active connection over the whole range
+        nNext = (nNext + 7919) % nPairs;
+        if (send(vRemote[nNext], &ch, 1, 0) != 1) {
+            break;
+        }
+
+        SOCKET hReady = INVALID_SOCKET;
+        while (hReady == INVALID_SOCKET) {
+            if (events.IsLevelTriggered()) {
+                recv_set.clear();
+                send_set.clear();
+                error_set.clear();
+                for (SOCKET hSocket : vLocal) {
+                    recv_set.insert(hSocket);
+                    error_set.insert(hSocket);
+                }
+                events.Wait(recv_set, send_set, error_set, 50);
+                if (!recv_set.empty())
+                    hReady = *recv_set.begin();
+            } else {
+                events.WaitEvents(vEvents, 50);
+                for (const CSocketEvents::Event& event : vEvents) {
+                    if (event.fRecv)
+                        hReady = *static_cast<SOCKET*>(event.data);
+                }
+            }
+        }
+        assert(hReady == vLocal[nNext]);
+        if (recv(hReady, &ch, 1, 0) != 1) {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < vLocal.size(); i++) {
+        CloseSocket(vLocal[i]);
+        CloseSocket(vRemote[i]);
+    }
+}
+
+#ifdef USE_POLL
+static void SocketEventsPoll100(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_POLL, 100); }
+static void SocketEventsPoll1000(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_POLL, 1000); }
+static void SocketEventsPoll5000(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_POLL, 5000); }
+
+BENCHMARK(SocketEventsPoll100, 40 * 1000);
+BENCHMARK(SocketEventsPoll1000, 4 * 1000);
+BENCHMARK(SocketEventsPoll5000, 400);
+#else
+// select() can not handle more than FD_SETSIZE sockets
+static void SocketEventsSelect100(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_SELECT, 100); }
+
+BENCHMARK(SocketEventsSelect100, 100 * 1000);
+#endif
+
+#ifdef USE_EPOLL
+static void SocketEventsEpoll100(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_EPOLL, 100); }
+static void SocketEventsEpoll1000(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_EPOLL, 1000); }
+static void SocketEventsEpoll5000(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_EPOLL, 5000); }
+
+BENCHMARK(SocketEventsEpoll100, 500 * 1000);
+BENCHMARK(SocketEventsEpoll1000, 500 * 1000);
+BENCHMARK(SocketEventsEpoll5000, 300 * 1000);
+#endif
+#endif // WIN32
@@ -0,0 +1,68 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <fs.h>
+#include <util.h>
+#include <wallet/db.h>
+#include <wallet/wallet.h>
+#include <wallet/walletdb.h>
+
+static const int WALLET_DB_BENCH_WRITES = 1000;
+
+// Write wallet transactions to a wallet in a temporary wallet directory,
+// each in its own database transaction or all of them in one
+static void WalletDBWrite(benchmark::State& state, WalletDBFormat format, bool fBatch)
+{
+    fs::path pathWalletDir = fs::temp_directory_path() / fs::unique_path("bench_walletdb_%%%%%%%%");
+    fs::create_directories(pathWalletDir);
+    gArgs.ForceSetArg("-walletdir", pathWalletDir.string());
+    if (format == WALLETDB_BDB)
+        assert(bitdb.Open(pathWalletDir));
+
+    {
+        CWalletDBWrapper dbw(&bitdb, "wallet.dat", format);
+        CWalletDB walletdb(dbw, "cr+");
+
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(72, 1) << std::vector<unsigned char>(33, 2);
+        tx.vout.emplace_back(COIN, CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 3) << OP_EQUALVERIFY << OP_CHECKSIG);
+        tx.vout.emplace_back(COIN, CScript() << OP_TRUE);
+
+        while (state.KeepRunning()) {
+            if (fBatch)
+                assert(walletdb.TxnBegin());
+            for (int i = 0; i < WALLET_DB_BENCH_WRITES; i++) {
+                tx.nLockTime++;
+                CWalletTx wtx(nullptr, MakeTransactionRef(tx));
+                if (!fBatch)
+                    assert(walletdb.TxnBegin());
+                assert(walletdb.WriteTx(wtx));
+                if (!fBatch)
+                    assert(walletdb.TxnCommit());
+            }
+            if (fBatch)
+                assert(walletdb.TxnCommit());
+        }
+    }
+
+    if (format == WALLETDB_BDB) {
+        bitdb.Flush(true);
+        bitdb.Reset();
+    }
+    gArgs.ForceSetArg("-walletdir", "");
+    fs::remove_all(pathWalletDir);
+}
+
+static void WalletDBWriteBDB(benchmark::State& state) { WalletDBWrite(state, WALLETDB_BDB, false); }
+static void WalletDBWriteBatchBDB(benchmark::State& state) { WalletDBWrite(state, WALLETDB_BDB, true); }
+static void WalletDBWriteLog(benchmark::State& state) { WalletDBWrite(state, WALLETDB_LOG, false); }
+static void WalletDBWriteBatchLog(benchmark::State& state) { WalletDBWrite(state, WALLETDB_LOG, true); }
+
+BENCHMARK(WalletDBWriteBDB, 5);
+BENCHMARK(WalletDBWriteBatchBDB, 5);
+BENCHMARK(WalletDBWriteLog, 5);
+BENCHMARK(WalletDBWriteBatchLog, 5);
@@ -0,0 +1,362 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockimport.h>
+
+#include <chainparams.h>
+#include <clientversion.h>
+#include <consensus/consensus.h>
+#include <consensus/validation.h>
+#include <util.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <iterator>
+
+/** Largest chunk the reader copies out of the file buffer at once, reading
+ *  a whole block in one go could exceed the buffer of CBufferedFile */
+static const unsigned int BLOCK_READ_CHUNK_SIZE = 1024 * 1024;
+
+CBlockFileReader::CBlockFileReader(FILE* fileIn, const CChainParams& chainparams, int nThreads, bool fCheckBlock) :
+    nStreamVersion(CLIENT_VERSION),
+    pconsensusParams(fCheckBlock ? &chainparams.GetConsensus() : nullptr),
+    blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION),
+    nReadSeq(0),
+    nNextSeq(0),
+    nGeneration(0),
+    nReadAheadSize(0),
+    fRewind(false),
+    nRewindPos(0),
+    fEof(false),
+    fShutdown(false)
+{
+    memcpy(messageStart, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE);
+    Start(nThreads);
+}
+
+CBlockFileReader::CBlockFileReader(FILE* fileIn, const CMessageHeader::MessageStartChars& messageStartIn, int nStreamVersionIn, int nThreads) :
+    nStreamVersion(nStreamVersionIn),
+    pconsensusParams(nullptr),
+    blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION),
+    nReadSeq(0),
+    nNextSeq(0),
+    nGeneration(0),
+    nReadAheadSize(0),
+    fRewind(false),
+    nRewindPos(0),
+    fEof(false),
+    fShutdown(false)
+{
+    memcpy(messageStart, messageStartIn, CMessageHeader::MESSAGE_START_SIZE);
+    Start(nThreads);
+}
+
+void CBlockFileReader::Start(int nThreads)
+{
+    threadRead = std::thread(&TraceThread<std::function<void()>>, "blkread", std::function<void()>(std::bind(&CBlockFileReader::ThreadRead, this)));
+    for (int i = 0; i < std::max(nThreads, 1); i++) {
+        vThreadWork.emplace_back(&TraceThread<std::function<void()>>, "blkwork", std::function<void()>(std::bind(&CBlockFileReader::ThreadWork, this)));
+    }
+}
+
+CBlockFileReader::~CBlockFileReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fShutdown = true;
+    }
+    condReader.notify_all();
+    condWorker.notify_all();
+    threadRead.join();
+    for (std::thread& thread : vThreadWork) {
+        thread.join();
+    }
+}
+
+void CBlockFileReader::ThreadRead()
+{
+    uint64_t nRewind = blkdat.GetPos();
+    while (true) {
+        uint64_t nTaskGeneration;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condReader.wait(lock, [this] { return fShutdown || fRewind || (!fEof && nReadAheadSize < MAX_BLOCK_READAHEAD_SIZE); });
+            if (fShutdown)
+                return;
+            if (fRewind) {
+                fRewind = false;
+                nRewind = nRewindPos;
+                // The position may be further back than the buffer allows
+                if (!blkdat.SetPos(nRewind))
+                    blkdat.Seek(nRewind);
+            }
+            nTaskGeneration = nGeneration;
+        }
+
+        Task task;
+        unsigned int nSize = 0;
+        bool fFound = false;
+        if (!blkdat.eof()) {
+            blkdat.SetPos(nRewind);
+            nRewind++; // start one byte further next time, in case of failure
+            blkdat.SetLimit(); // remove former limit
+            try {
+                // locate a header
+                unsigned char buf[CMessageHeader::MESSAGE_START_SIZE];
+                blkdat.FindByte(messageStart[0]);
+                task.nMagicPos = blkdat.GetPos();
+                nRewind = task.nMagicPos + 1;
+                blkdat >> FLATDATA(buf);
+                if (memcmp(buf, messageStart, CMessageHeader::MESSAGE_START_SIZE))
+                    continue;
+                // read size
+                blkdat >> nSize;
+                if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
+                    continue;
+                fFound = true;
+            } catch (const std::exception&) {
+                // no valid block header found; don't complain
+            }
+        }
+        if (!fFound) {
+            std::lock_guard<std::mutex> lock(mutex);
+            fEof = true;
+            condResult.notify_one();
+            continue;
+        }
+
+        try {
+            // read block
+            task.nBlockPos = blkdat.GetPos();
+            blkdat.SetLimit(task.nBlockPos + nSize);
+            task.stream.reset(new CDataStream(SER_DISK, nStreamVersion));
+            task.stream->resize(nSize);
+            for (unsigned int nRead = 0; nRead < nSize; ) {
+                unsigned int nChunk = std::min(nSize - nRead, BLOCK_READ_CHUNK_SIZE);
+                blkdat.read(task.stream->data() + nRead, nChunk);
+                nRead += nChunk;
+            }
+            nRewind = blkdat.GetPos();
+        } catch (const std::exception& e) {
+            LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, e.what());
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (nTaskGeneration != nGeneration) {
+            // Next() rewound the file while this block was read
+            continue;
+        }
+        task.nSeq = nReadSeq++;
+        task.nGeneration = nTaskGeneration;
+        nReadAheadSize += nSize;
+        queue.push_back(std::move(task));
+        condWorker.notify_one();
+    }
+}
+
+void CBlockFileReader::ThreadWork()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condWorker.wait(lock, [this] { return fShutdown || !queue.empty(); });
+            if (fShutdown)
+                return;
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        Result result;
+        result.nMagicPos = task.nMagicPos;
+        result.record.nBlockPos = task.nBlockPos;
+        result.record.nSize = task.stream->size();
+        result.nNextPos = task.nBlockPos + result.record.nSize;
+        try {
+            std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+            *task.stream >> *pblock;
+            result.nNextPos -= task.stream->size();
+            result.record.hash = pblock->GetHash();
+            if (pconsensusParams) {
+                // Sets fChecked, the result is checked again by AcceptBlock
+                CValidationState state;
+                CheckBlock(*pblock, state, *pconsensusParams);
+            }
+            result.record.pblock = pblock;
+        } catch (const std::exception& e) {
+            result.record.strError = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (task.nGeneration != nGeneration) {
+            nReadAheadSize -= result.record.nSize;
+            condReader.notify_one();
+            continue;
+        }
+        mapResults.emplace(task.nSeq, std::move(result));
+        if (task.nSeq == nNextSeq)
+            condResult.notify_one();
+    }
+}
+
+bool CBlockFileReader::Next(Record& record)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    condResult.wait(lock, [this] { return mapResults.count(nNextSeq) || (fEof && nReadSeq == nNextSeq); });
+    std::map<uint64_t, Result>::iterator it = mapResults.find(nNextSeq);
+    if (it == mapResults.end())
+        return false;
+
+    Result result = std::move(it->second);
+    mapResults.erase(it);
+    nNextSeq++;
+    nReadAheadSize -= result.record.nSize;
+    condReader.notify_one();
+
+    if (!result.record.pblock) {
+        Rewind(result.nMagicPos + 1);
+    } else if (result.nNextPos != result.record.nBlockPos + result.record.nSize) {
+        // The block is shorter than its size field, continue scanning right after it
+        Rewind(result.nNextPos);
+    }
+    record = std::move(result.record);
+    return true;
+}
+
+void CBlockFileReader::Rewind(uint64_t nPos)
+{
+    for (const Task& task : queue) {
+        nReadAheadSize -= task.stream->size();
+    }
+    queue.clear();
+    for (const std::pair<const uint64_t, Result>& item : mapResults) {
+        nReadAheadSize -= item.second.record.nSize;
+    }
+    mapResults.clear();
+    nGeneration++;
+    nReadSeq = nNextSeq;
+    fRewind = true;
+    nRewindPos = nPos;
+    fEof = false;
+    condReader.notify_one();
+}
+
+CChainBlockReader::CChainBlockReader(int nStartHeight, const Consensus::Params& consensusParamsIn, int nThreads, Filter filterIn, int nReadAheadIn) :
+    consensusParams(consensusParamsIn),
+    filter(filterIn),
+    nReadAhead(std::max(nReadAheadIn, 1)),
+    nReadPos(0),
+    nNextPos(0),
+    fShutdown(false)
+{
+    {
+        LOCK(cs_main);
+        for (int nHeight = std::max(nStartHeight, 0); nHeight <= chainActive.Height(); nHeight++)
+            vIndex.emplace_back(chainActive[nHeight], chainActive[nHeight]->GetBlockPos());
+    }
+    for (int i = 0; i < std::max(nThreads, 1); i++) {
+        vThreadWork.emplace_back(&TraceThread<std::function<void()>>, "chainread", std::function<void()>(std::bind(&CChainBlockReader::ThreadWork, this)));
+    }
+}
+
+CChainBlockReader::~CChainBlockReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fShutdown = true;
+    }
+    condWorker.notify_all();
+    for (std::thread& thread : vThreadWork) {
+        thread.join();
+    }
+}
+
+void CChainBlockReader::ThreadWork()
+{
+    while (true) {
+        size_t nPos;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condWorker.wait(lock, [this] { return fShutdown || nReadPos < nNextPos + nReadAhead; });
+            if (fShutdown)
+                return;
+            nPos = nReadPos++;
+        }
+
+        Record record;
+        if (nPos < vIndex.size()) {
+            record.pindex = vIndex[nPos].first;
+            std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+            if (ReadBlockFromDisk(*pblock, vIndex[nPos].second, consensusParams) && pblock->GetHash() == record.pindex->GetBlockHash()) {
+                record.vMatch.assign(pblock->vtx.size(), !filter);
+                if (filter)
+                    filter(*pblock, record.vMatch);
+                record.pblock = pblock;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        mapResults.emplace(nPos, std::move(record));
+        if (nPos == nNextPos)
+            condResult.notify_one();
+    }
+}
+
+void CChainBlockReader::Next(Record& record)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    condResult.wait(lock, [this] { return mapResults.count(nNextPos); });
+    std::map<size_t, Record>::iterator it = mapResults.find(nNextPos);
+    record = std::move(it->second);
+    mapResults.erase(it);
+    nNextPos++;
+    condWorker.notify_all();
+}
+
+CImportedBlockCache::CImportedBlockCache(uint64_t nMaxSizeIn) : nMaxSize(nMaxSizeIn), nSize(0)
+{
+}
+
+void CImportedBlockCache::Add(const uint256& hash, const std::shared_ptr<const CBlock>& pblock, unsigned int nBlockSize)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (mapBlocks.count(hash))
+        return;
+    Entry& entry = mapBlocks[hash];
+    entry.pblock = pblock;
+    entry.nSize = nBlockSize;
+    nSize += nBlockSize;
+}
+
+std::shared_ptr<const CBlock> CImportedBlockCache::Take(const uint256& hash)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<uint256, Entry>::iterator it = mapBlocks.find(hash);
+    if (it == mapBlocks.end())
+        return nullptr;
+    std::shared_ptr<const CBlock> pblock = it->second.pblock;
+    nSize -= it->second.nSize;
+    mapBlocks.erase(it);
+    return pblock;
+}
+
+void CImportedBlockCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    mapBlocks.clear();
+    nSize = 0;
+}
+
+bool CImportedBlockCache::IsFull() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return nSize >= nMaxSize;
+}
+
+uint64_t CImportedBlockCache::GetSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return nSize;
+}
@@ -0,0 +1,223 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKIMPORT_H
+#define BITCOIN_BLOCKIMPORT_H
+
+#include <chain.h>
+#include <primitives/block.h>
+#include <protocol.h>
+#include <streams.h>
+#include <uint256.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CChainParams;
+
+namespace Consensus { struct Params; }
+
+/** Bytes of block data CBlockFileReader reads ahead of the caller */
+static const uint64_t MAX_BLOCK_READAHEAD_SIZE = 16 * 1024 * 1024;
+/** Serialized bytes of imported blocks kept in memory until they are connected */
+static const uint64_t MAX_IMPORTED_BLOCK_CACHE_SIZE = 64 * 1024 * 1024;
+/** Blocks CChainBlockReader reads ahead of the caller */
+static const int DEFAULT_CHAIN_READAHEAD_BLOCKS = 64;
+
+/**
+ * Reads the blocks of a block file (blk?????.dat, bootstrap.dat or a
+ * -loadblock file) in file order, using a pipeline of threads:
+ *
+ * - a reader thread scans the file for the network magic and reads the
+ *   serialized blocks,
+ * - worker threads deserialize them, which also computes the transaction
+ *   hashes, and optionally run the context-free CheckBlock (merkle root,
+ *   proof of work, header signature), which marks the block as checked,
+ * - the caller takes the blocks in file order with Next().
+ *
+ * Block data that fails to deserialize is returned as a record without a
+ * block, after which scanning resumes one byte after its magic, the same
+ * way LoadExternalBlockFile always handled corrupted files.
+ */
+class CBlockFileReader
+{
+public:
+    struct Record {
+        //! The block, or nullptr if its data could not be deserialized
+        std::shared_ptr<CBlock> pblock;
+        uint256 hash;
+        //! Position of the block data in the file
+        uint64_t nBlockPos;
+        //! Serialized size of the block
+        unsigned int nSize;
+        std::string strError;
+    };
+
+    /** Takes over fileIn and closes it when it is destroyed */
+    CBlockFileReader(FILE* fileIn, const CChainParams& chainparams, int nThreads, bool fCheckBlock = true);
+    /** Read the block files of another chain, with its network magic and the stream version to deserialize its blocks with */
+    CBlockFileReader(FILE* fileIn, const CMessageHeader::MessageStartChars& messageStart, int nStreamVersion, int nThreads);
+    ~CBlockFileReader();
+
+    CBlockFileReader(const CBlockFileReader&) = delete;
+    CBlockFileReader& operator=(const CBlockFileReader&) = delete;
+
+    /** Get the next block in file order, false at the end of the file */
+    bool Next(Record& record);
+
+private:
+    struct Task {
+        uint64_t nSeq;
+        uint64_t nGeneration;
+        //! Position of the network magic, scanning resumes after it on failure
+        uint64_t nMagicPos;
+        uint64_t nBlockPos;
+        std::unique_ptr<CDataStream> stream;
+    };
+
+    struct Result {
+        Record record;
+        uint64_t nMagicPos;
+        //! Position after the deserialized block data
+        uint64_t nNextPos;
+    };
+
+    void ThreadRead();
+    void ThreadWork();
+    /** Restart scanning at nPos and drop everything read after the current record */
+    void Rewind(uint64_t nPos);
+
+    void Start(int nThreads);
+
+    CMessageHeader::MessageStartChars messageStart;
+    const int nStreamVersion;
+    //! Consensus rules to check the blocks with, nullptr to not check them
+    const Consensus::Params* const pconsensusParams;
+    CBufferedFile blkdat;
+
+    std::mutex mutex;
+    std::condition_variable condReader;
+    std::condition_variable condWorker;
+    std::condition_variable condResult;
+
+    std::deque<Task> queue;
+    std::map<uint64_t, Result> mapResults;
+    //! Sequence number of the next block read from the file
+    uint64_t nReadSeq;
+    //! Sequence number of the next block returned by Next()
+    uint64_t nNextSeq;
+    //! Incremented on every rewind, blocks of earlier generations are dropped
+    uint64_t nGeneration;
+    //! Serialized bytes read but not returned yet
+    uint64_t nReadAheadSize;
+    bool fRewind;
+    uint64_t nRewindPos;
+    bool fEof;
+    bool fShutdown;
+
+    std::thread threadRead;
+    std::vector<std::thread> vThreadWork;
+};
+
+/**
+ * Reads the blocks of the active chain in height order from nStartHeight on,
+ * for scans of the chain like a wallet rescan. Worker threads read and
+ * deserialize the blocks up to nReadAhead blocks ahead of the caller and run
+ * the filter on them, so that the caller only has to look at the
+ * transactions the filter matched.
+ *
+ * The block indexes from nStartHeight to the tip and their block positions
+ * are looked up when the reader is created, so the workers never take cs_main
+ * and callers may hold it. Callers have to check that a block is still in
+ * the active chain. Heights past the tip at creation are returned as records
+ * without a block index.
+ */
+class CChainBlockReader
+{
+public:
+    /** Sets the entries of vMatch for the transactions of a block to keep, called on the worker threads */
+    typedef std::function<void(const CBlock& block, std::vector<bool>& vMatch)> Filter;
+
+    struct Record {
+        //! Block index at the height, nullptr past the tip when the reader was created
+        CBlockIndex* pindex = nullptr;
+        //! The block, or nullptr if it could not be read from disk
+        std::shared_ptr<const CBlock> pblock;
+        //! Transactions matched by the filter, every transaction without a filter
+        std::vector<bool> vMatch;
+    };
+
+    CChainBlockReader(int nStartHeight, const Consensus::Params& consensusParams, int nThreads, Filter filter = Filter(), int nReadAhead = DEFAULT_CHAIN_READAHEAD_BLOCKS);
+    ~CChainBlockReader();
+
+    CChainBlockReader(const CChainBlockReader&) = delete;
+    CChainBlockReader& operator=(const CChainBlockReader&) = delete;
+
+    /** Get the block at the next height */
+    void Next(Record& record);
+
+private:
+    void ThreadWork();
+
+    const Consensus::Params& consensusParams;
+    const Filter filter;
+    const int nReadAhead;
+    //! The active chain from the start height on when the reader was created,
+    //! with the position of each block on disk
+    std::vector<std::pair<CBlockIndex*, CDiskBlockPos>> vIndex;
+
+    std::mutex mutex;
+    std::condition_variable condWorker;
+    std::condition_variable condResult;
+
+    std::map<size_t, Record> mapResults;
+    //! Position in vIndex of the next block read by a worker
+    size_t nReadPos;
+    //! Position in vIndex of the next block returned by Next()
+    size_t nNextPos;
+    bool fShutdown;
+
+    std::vector<std::thread> vThreadWork;
+};
+
+/**
+ * Blocks that were imported from a block file but not connected yet, so
+ * that ConnectTip doesn't need to read them back from disk. It is filled
+ * up to nMaxSize serialized bytes and emptied by ConnectTip or Clear().
+ */
+class CImportedBlockCache
+{
+public:
+    explicit CImportedBlockCache(uint64_t nMaxSizeIn);
+
+    void Add(const uint256& hash, const std::shared_ptr<const CBlock>& pblock, unsigned int nSize);
+    /** Remove the block from the cache and return it, or nullptr if it isn't there */
+    std::shared_ptr<const CBlock> Take(const uint256& hash);
+    void Clear();
+
+    bool IsFull() const;
+    uint64_t GetSize() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const CBlock> pblock;
+        unsigned int nSize;
+    };
+
+    mutable std::mutex mutex;
+    const uint64_t nMaxSize;
+    uint64_t nSize;
+    std::map<uint256, Entry> mapBlocks;
+};
+
+#endif // BITCOIN_BLOCKIMPORT_H
@@ -34,7 +34,10 @@ size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
 
 SaltedOutpointHasher::SaltedOutpointHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
 
-CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn), cachedCoinsUsage(0) {}
+CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn),
+    cacheCoinsResource(new PoolResource()),
+    cacheCoins(0, SaltedOutpointHasher(), std::equal_to<COutPoint>(), CCoinsMap::allocator_type(cacheCoinsResource.get())),
+    cachedCoinsUsage(0), nCacheHits(0), nCacheMisses(0), nPrefetched(0) {}
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
     return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
@@ -42,8 +45,11 @@ size_t CCoinsViewCache::DynamicMemoryUsage() const {
 
 CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const {
     CCoinsMap::iterator it = cacheCoins.find(outpoint);
-    if (it != cacheCoins.end())
+    if (it != cacheCoins.end()) {
+        nCacheHits++;
         return it;
+    }
+    nCacheMisses++;
     Coin tmp;
     if (!base->GetCoin(outpoint, tmp))
         return cacheCoins.end();
@@ -136,6 +142,15 @@ bool CCoinsViewCache::HaveCoinInCache(const COutPoint &outpoint) const {
     return (it != cacheCoins.end() && !it->second.coin.IsSpent());
 }
 
+void CCoinsViewCache::AddPrefetchedCoin(const COutPoint& outpoint, Coin&& coin) {
+    assert(!coin.IsSpent());
+    std::pair<CCoinsMap::iterator, bool> inserted = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(std::move(coin)));
+    if (inserted.second) {
+        cachedCoinsUsage += inserted.first->second.coin.DynamicMemoryUsage();
+        nPrefetched++;
+    }
+}
+
 uint256 CCoinsViewCache::GetBestBlock() const {
     if (hashBlock.IsNull())
         hashBlock = base->GetBestBlock();
@@ -204,13 +219,29 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlockIn
     return true;
 }
 
+void CCoinsViewCache::ResetCacheCoins() {
+    // The map can't be assigned as its hasher is const, so it is recreated
+    // in place on a new resource.
+    cacheCoins.~CCoinsMap();
+    cacheCoinsResource.reset(new PoolResource());
+    ::new (&cacheCoins) CCoinsMap(0, SaltedOutpointHasher(), std::equal_to<COutPoint>(), CCoinsMap::allocator_type(cacheCoinsResource.get()));
+    cachedCoinsUsage = 0;
+}
+
 bool CCoinsViewCache::Flush() {
     bool fOk = base->BatchWrite(cacheCoins, hashBlock);
-    cacheCoins.clear();
-    cachedCoinsUsage = 0;
+    // Hand the memory of the pool back instead of keeping it for new entries.
+    ResetCacheCoins();
     return fOk;
 }
 
+std::unique_ptr<CCoinsCacheSnapshot> CCoinsViewCache::Detach() {
+    const size_t nUsage = DynamicMemoryUsage();
+    std::unique_ptr<CCoinsCacheSnapshot> snapshot(new CCoinsCacheSnapshot(std::move(cacheCoinsResource), std::move(cacheCoins), GetBestBlock(), nUsage));
+    ResetCacheCoins();
+    return snapshot;
+}
+
 void CCoinsViewCache::Uncache(const COutPoint& hash)
 {
     CCoinsMap::iterator it = cacheCoins.find(hash);
@@ -12,11 +12,13 @@
 #include <hash.h>
 #include <memusage.h>
 #include <serialize.h>
+#include <support/allocators/pool.h>
 #include <uint256.h>
 
 #include <assert.h>
 #include <stdint.h>
 
+#include <memory>
 #include <unordered_map>
 
 /**
@@ -38,23 +40,45 @@ public:
     //! whether containing transaction was a coinbase
     unsigned int fCoinBase : 1;
 
+    //! whether this output is held in escrow by a sidechain (pays to the
+    //! drivechain script) and the sidechain number. Derived from out when the
+    //! coin is created or read, and not serialized.
+    bool fEscrow;
+    uint8_t nEscrowSidechain;
+
     //! construct a Coin from a CTxOut and height/coinbase information.
-    Coin(CTxOut&& outIn, int nHeightIn, bool fCoinBaseIn) : out(std::move(outIn)), nHeight(nHeightIn), fCoinBase(fCoinBaseIn) {}
-    Coin(const CTxOut& outIn, int nHeightIn, bool fCoinBaseIn) : out(outIn), nHeight(nHeightIn), fCoinBase(fCoinBaseIn) {}
+    Coin(CTxOut&& outIn, int nHeightIn, bool fCoinBaseIn) : out(std::move(outIn)), nHeight(nHeightIn), fCoinBase(fCoinBaseIn) { UpdateEscrow(); }
+    Coin(const CTxOut& outIn, int nHeightIn, bool fCoinBaseIn) : out(outIn), nHeight(nHeightIn), fCoinBase(fCoinBaseIn) { UpdateEscrow(); }
 
     void Clear() {
         out.SetNull();
         fCoinBase = false;
         nHeight = 0;
+        fEscrow = false;
+        nEscrowSidechain = 0;
     }
 
     //! empty constructor
-    Coin() : nHeight(0), fCoinBase(false) { }
+    Coin() : nHeight(0), fCoinBase(false), fEscrow(false), nEscrowSidechain(0) { }
 
     bool IsCoinBase() const {
         return fCoinBase;
     }
 
+    //! Return whether this is a sidechain escrow output and set nSidechain
+    bool IsEscrow(uint8_t& nSidechain) const {
+        if (fEscrow)
+            nSidechain = nEscrowSidechain;
+        return fEscrow;
+    }
+
+    //! Recompute fEscrow & nEscrowSidechain, must be called if out is modified
+    void UpdateEscrow() {
+        fEscrow = out.scriptPubKey.IsDrivechain(nEscrowSidechain);
+        if (!fEscrow)
+            nEscrowSidechain = 0;
+    }
+
     template<typename Stream>
     void Serialize(Stream &s) const {
         assert(!IsSpent());
@@ -70,6 +94,7 @@ public:
         nHeight = code >> 1;
         fCoinBase = code & 1;
         ::Unserialize(s, REF(CTxOutCompressor(out)));
+        UpdateEscrow();
     }
 
     bool IsSpent() const {
@@ -127,7 +152,25 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+/** The nodes of the map come from the PoolResource of the owning cache, if any */
+typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher, std::equal_to<COutPoint>,
+                           PoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>>> CCoinsMap;
+
+/**
+ * Entries taken out of a CCoinsViewCache by Detach(), together with the
+ * pool their nodes were allocated from and the block they are consistent with.
+ */
+struct CCoinsCacheSnapshot
+{
+    std::unique_ptr<PoolResource> resource;
+    CCoinsMap map;
+    uint256 hashBlock;
+    //! Memory usage of the cache when it was detached
+    size_t nUsage;
+
+    CCoinsCacheSnapshot(std::unique_ptr<PoolResource>&& resourceIn, CCoinsMap&& mapIn, const uint256& hashBlockIn, size_t nUsageIn) :
+        resource(std::move(resourceIn)), map(std::move(mapIn)), hashBlock(hashBlockIn), nUsage(nUsageIn) {}
+};
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -214,11 +257,18 @@ protected:
      * declared as "const".
      */
     mutable uint256 hashBlock;
+    /* Arena for the nodes of cacheCoins, replaced together with it on Flush(). */
+    std::unique_ptr<PoolResource> cacheCoinsResource;
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
     mutable size_t cachedCoinsUsage;
 
+    /* Lookups answered by the cache, lookups passed to the backing view and coins prefetched into the cache. */
+    mutable uint64_t nCacheHits;
+    mutable uint64_t nCacheMisses;
+    uint64_t nPrefetched;
+
 public:
     CCoinsViewCache(CCoinsView *baseIn);
 
@@ -244,6 +294,14 @@ public:
      */
     bool HaveCoinInCache(const COutPoint &outpoint) const;
 
+    /**
+     * Add a coin that was read from the backing view ahead of its use, e.g.
+     * by the block input prefetcher. It is added unmodified, as if it had been
+     * fetched on demand, and only if the cache has no entry for the outpoint:
+     * a spent entry that wasn't flushed yet must not be replaced.
+     */
+    void AddPrefetchedCoin(const COutPoint& outpoint, Coin&& coin);
+
     /**
      * Return a reference to Coin in the cache, or a pruned one if not found. This is
      * more efficient than GetCoin.
@@ -276,6 +334,14 @@ public:
      */
     bool Flush();
 
+    /**
+     * Take all entries out of the cache without writing them to the base,
+     * leaving the cache empty as after Flush(). The caller is responsible for
+     * writing them to the base, and for the base to return them to reads
+     * until it has.
+     */
+    std::unique_ptr<CCoinsCacheSnapshot> Detach();
+
     /**
      * Removes the UTXO with the given outpoint from the cache, if it is
      * not modified.
@@ -288,6 +354,10 @@ public:
     //! Calculate the size of the cache (in bytes)
     size_t DynamicMemoryUsage() const;
 
+    uint64_t GetCacheHits() const { return nCacheHits; }
+    uint64_t GetCacheMisses() const { return nCacheMisses; }
+    uint64_t GetPrefetched() const { return nPrefetched; }
+
     /**
      * Amount of bitcoins coming in to a transaction
      * Note that lightweight clients may not know anything besides the hash of previous transactions,
@@ -303,6 +373,8 @@ public:
 
 private:
     CCoinsMap::iterator FetchCoin(const COutPoint &outpoint) const;
+    //! Replace cacheCoins by an empty map on a new resource
+    void ResetCacheCoins();
 };
 
 //! Utility function to add all of a transaction's outputs to a cache.
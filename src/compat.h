@@ -86,8 +86,17 @@ typedef int32_t ssize_t;
 size_t strnlen( const char *start, size_t max_len);
 #endif // HAVE_DECL_STRNLEN
 
+// poll() is not limited to FD_SETSIZE. WSAPoll on Windows is broken, so only
+// use it where it is known to work.
+#if defined(__linux__)
+#define USE_POLL
+#define USE_EPOLL
+#include <poll.h>
+#include <sys/epoll.h>
+#endif
+
 bool static inline IsSelectableSocket(const SOCKET& s) {
-#ifdef WIN32
+#if defined(USE_POLL) || defined(WIN32)
     return true;
 #else
     return (s < FD_SETSIZE);
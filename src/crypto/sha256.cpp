@@ -9,9 +9,12 @@
 #include <string.h>
 #include <atomic>
 
+#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
 #if defined(__x86_64__) || defined(__amd64__)
 #if defined(USE_ASM)
-#include <cpuid.h>
 namespace sha256_sse4
 {
 void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
@@ -19,6 +22,26 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 #endif
 #endif
 
+namespace sha256d64_sse41
+{
+void Transform_4way(unsigned char* out, const unsigned char* in);
+}
+
+namespace sha256d64_avx2
+{
+void Transform_8way(unsigned char* out, const unsigned char* in);
+}
+
+namespace sha256_shani
+{
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
+}
+
+namespace sha256d64_shani
+{
+void Transform_2way(unsigned char* out, const unsigned char* in);
+}
+
 // Internal implementation code.
 namespace
 {
@@ -144,8 +167,55 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
 } // namespace sha256
 
 typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
+typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
+
+/** Double-SHA256 a single 64-byte input using a regular transform. */
+template<TransformType tr>
+void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
+{
+    uint32_t s[8];
+    static const unsigned char padding1[64] = {
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0
+    };
+    unsigned char buffer2[64] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0
+    };
+    sha256::Initialize(s);
+    tr(s, in, 1);
+    tr(s, padding1, 1);
+    WriteBE32(buffer2 + 0, s[0]);
+    WriteBE32(buffer2 + 4, s[1]);
+    WriteBE32(buffer2 + 8, s[2]);
+    WriteBE32(buffer2 + 12, s[3]);
+    WriteBE32(buffer2 + 16, s[4]);
+    WriteBE32(buffer2 + 20, s[5]);
+    WriteBE32(buffer2 + 24, s[6]);
+    WriteBE32(buffer2 + 28, s[7]);
+    sha256::Initialize(s);
+    tr(s, buffer2, 1);
+    WriteBE32(out + 0, s[0]);
+    WriteBE32(out + 4, s[1]);
+    WriteBE32(out + 8, s[2]);
+    WriteBE32(out + 12, s[3]);
+    WriteBE32(out + 16, s[4]);
+    WriteBE32(out + 20, s[5]);
+    WriteBE32(out + 24, s[6]);
+    WriteBE32(out + 28, s[7]);
+}
 
-bool SelfTest(TransformType tr) {
+TransformType Transform = sha256::Transform;
+TransformD64Type TransformD64 = TransformD64Wrapper<sha256::Transform>;
+TransformD64Type TransformD64_2way = nullptr;
+TransformD64Type TransformD64_4way = nullptr;
+TransformD64Type TransformD64_8way = nullptr;
+
+bool SelfTest() {
     static const unsigned char in1[65] = {0, 0x80};
     static const unsigned char in2[129] = {
         0,
@@ -157,38 +227,161 @@ bool SelfTest(TransformType tr) {
     static const uint32_t init[8] = {0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul};
     static const uint32_t out1[8] = {0xe3b0c442ul, 0x98fc1c14ul, 0x9afbf4c8ul, 0x996fb924ul, 0x27ae41e4ul, 0x649b934cul, 0xa495991bul, 0x7852b855ul};
     static const uint32_t out2[8] = {0xce4153b0ul, 0x147c2a86ul, 0x3ed4298eul, 0xe0676bc8ul, 0x79fc77a1ul, 0x2abe1f49ul, 0xb2b055dful, 0x1069523eul};
+    // 8 messages of 64 bytes for the double-SHA256 transforms
+    static const unsigned char in3[514] = "-" // Intentionally not aligned
+        "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Et m"
+        " malesuada fames ac turpis egestas integer eget aliquet nibh praesent tristique magna sit amet purus gravida quis blandit turpis"
+        ". Drivechain lets sidechains spend bitcoin escrowed by the mainchain once a withdrawal bundle has collected enough work score fr"
+        "om miners. Scelerisque felis imperdiet proin fermentum leo vel orci porta non pulvinar neque laoreet suspendisse interdum consec";
+    // Double-SHA256 of each of the 64 byte messages in in3
+    static const unsigned char out3[256] = {
+        0x09, 0x3a, 0xc4, 0xd0, 0x0f, 0xf7, 0x57, 0xe1, 0x72, 0x85, 0x79, 0x42, 0xfe, 0xe7, 0xe0, 0xa0,
+        0xfc, 0x52, 0xd7, 0xdb, 0x07, 0x63, 0x45, 0xfb, 0x53, 0x14, 0x7d, 0x17, 0x22, 0x86, 0xf0, 0x52,
+        0x48, 0xb6, 0x11, 0x9e, 0x6e, 0x48, 0x81, 0x6d, 0xcc, 0x57, 0x1f, 0xb2, 0x97, 0xa8, 0xd5, 0x25,
+        0x9b, 0x82, 0xaa, 0x89, 0xe2, 0xfd, 0x2d, 0x56, 0xe8, 0x28, 0x83, 0x0b, 0xe2, 0xfa, 0x53, 0xb7,
+        0x7a, 0xcf, 0xb4, 0x78, 0x46, 0x94, 0xfe, 0xd0, 0x64, 0x8c, 0xdf, 0x0c, 0x99, 0x4f, 0xc3, 0x8c,
+        0x8e, 0xd5, 0x69, 0x10, 0xb1, 0x82, 0xab, 0x62, 0xd8, 0x05, 0x52, 0x94, 0x4a, 0xff, 0xc9, 0x71,
+        0xe9, 0xf2, 0x4a, 0xe0, 0xbe, 0x09, 0x99, 0x19, 0x0c, 0x87, 0xb5, 0x1a, 0xdd, 0xbf, 0x74, 0xcf,
+        0x5f, 0x13, 0x8d, 0xb2, 0x98, 0x95, 0x04, 0x5a, 0x54, 0x3f, 0x15, 0x75, 0x53, 0x48, 0x53, 0x05,
+        0x2e, 0xeb, 0x5e, 0x7f, 0xce, 0xde, 0xbe, 0xdb, 0x2b, 0x6e, 0x81, 0xac, 0xdd, 0xd9, 0x51, 0x6a,
+        0x2f, 0x31, 0xd1, 0xe3, 0xf6, 0x21, 0xce, 0x8f, 0x32, 0xc1, 0xca, 0x87, 0xd9, 0xd0, 0x48, 0x98,
+        0x95, 0x1e, 0x96, 0xc2, 0xe1, 0xc2, 0x6d, 0xe4, 0x7e, 0xd9, 0xd3, 0x8f, 0xc0, 0xa7, 0x43, 0x31,
+        0xea, 0x51, 0xbd, 0xf7, 0x7b, 0xef, 0x28, 0x9a, 0xca, 0x56, 0x56, 0x1a, 0x67, 0x98, 0x39, 0x5d,
+        0xd2, 0x80, 0x49, 0x9b, 0xaf, 0x76, 0x04, 0x14, 0xe5, 0xa8, 0xe9, 0x33, 0xb2, 0x7a, 0xf7, 0x6c,
+        0x8e, 0x00, 0x2f, 0x6f, 0x7c, 0x09, 0x54, 0x3d, 0xd1, 0x34, 0xf4, 0x68, 0x91, 0x23, 0xfd, 0x2e,
+        0x15, 0x0f, 0x0a, 0x1a, 0x39, 0xc0, 0x28, 0x66, 0xdb, 0x15, 0x43, 0x26, 0xa5, 0x59, 0xdb, 0x2d,
+        0x75, 0x76, 0x57, 0x7c, 0xa1, 0x4e, 0x10, 0xa4, 0x2b, 0x4a, 0xa8, 0x72, 0x8c, 0x2b, 0x13, 0x4f
+    };
     uint32_t buf[8];
     memcpy(buf, init, sizeof(buf));
     // Process nothing, and check we remain in the initial state.
-    tr(buf, nullptr, 0);
+    Transform(buf, nullptr, 0);
     if (memcmp(buf, init, sizeof(buf))) return false;
     // Process the padded empty string (unaligned)
-    tr(buf, in1 + 1, 1);
+    Transform(buf, in1 + 1, 1);
     if (memcmp(buf, out1, sizeof(buf))) return false;
     // Process 64 spaces (unaligned)
     memcpy(buf, init, sizeof(buf));
-    tr(buf, in2 + 1, 2);
+    Transform(buf, in2 + 1, 2);
     if (memcmp(buf, out2, sizeof(buf))) return false;
+
+    // Test TransformD64
+    unsigned char out[256];
+    for (int i = 0; i < 8; i++) {
+        TransformD64(out, in3 + 1 + 64 * i);
+        if (memcmp(out, out3 + 32 * i, 32)) return false;
+    }
+
+    // Test TransformD64_2way, if available.
+    if (TransformD64_2way) {
+        for (int i = 0; i < 8; i += 2) {
+            TransformD64_2way(out, in3 + 1 + 64 * i);
+            if (memcmp(out, out3 + 32 * i, 64)) return false;
+        }
+    }
+
+    // Test TransformD64_4way, if available.
+    if (TransformD64_4way) {
+        for (int i = 0; i < 8; i += 4) {
+            TransformD64_4way(out, in3 + 1 + 64 * i);
+            if (memcmp(out, out3 + 32 * i, 128)) return false;
+        }
+    }
+
+    // Test TransformD64_8way, if available.
+    if (TransformD64_8way) {
+        TransformD64_8way(out, in3 + 1);
+        if (memcmp(out, out3, 256)) return false;
+    }
+
     return true;
 }
 
-TransformType Transform = sha256::Transform;
+#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
 
 } // namespace
 
-std::string SHA256AutoDetect()
+std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implementation)
 {
-#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__))
+    std::string ret = "standard";
+    Transform = sha256::Transform;
+    TransformD64 = TransformD64Wrapper<sha256::Transform>;
+    TransformD64_2way = nullptr;
+    TransformD64_4way = nullptr;
+    TransformD64_8way = nullptr;
+
+#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+    bool have_sse4 = false;
+    bool have_xsave = false;
+    bool have_avx = false;
+    bool have_avx2 = false;
+    bool have_shani = false;
+    bool enabled_avx = false;
+
+    (void)AVXEnabled;
+    (void)have_sse4;
+    (void)have_avx;
+    (void)have_xsave;
+    (void)have_avx2;
+    (void)have_shani;
+    (void)enabled_avx;
+
     uint32_t eax, ebx, ecx, edx;
-    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx >> 19) & 1) {
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        have_sse4 = (use_implementation & sha256_implementation::USE_SSE4) && ((ecx >> 19) & 1);
+        have_xsave = (ecx >> 27) & 1;
+        have_avx = (ecx >> 28) & 1;
+        if (have_xsave && have_avx) {
+            enabled_avx = AVXEnabled();
+        }
+        if (__get_cpuid_max(0, nullptr) >= 7) {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            have_avx2 = (use_implementation & sha256_implementation::USE_AVX2) && ((ebx >> 5) & 1);
+            have_shani = (use_implementation & sha256_implementation::USE_SHANI) && ((ebx >> 29) & 1);
+        }
+    }
+
+#if defined(ENABLE_SHANI) && !defined(BUILD_DRIVECHAIN_INTERNAL)
+    if (have_shani) {
+        Transform = sha256_shani::Transform;
+        TransformD64 = TransformD64Wrapper<sha256_shani::Transform>;
+        TransformD64_2way = sha256d64_shani::Transform_2way;
+        ret = "shani(1way,2way)";
+        have_sse4 = false; // Disable SSE4/AVX2, SHA-NI is faster
+        have_avx2 = false;
+    }
+#endif
+
+    if (have_sse4) {
+#if defined(__x86_64__) || defined(__amd64__)
         Transform = sha256_sse4::Transform;
-        assert(SelfTest(Transform));
-        return "sse4";
+        TransformD64 = TransformD64Wrapper<sha256_sse4::Transform>;
+        ret = "sse4(1way)";
+#endif
+#if defined(ENABLE_SSE41) && !defined(BUILD_DRIVECHAIN_INTERNAL)
+        TransformD64_4way = sha256d64_sse41::Transform_4way;
+        ret += ",sse41(4way)";
+#endif
+    }
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_DRIVECHAIN_INTERNAL)
+    if (have_avx2 && have_avx && enabled_avx) {
+        TransformD64_8way = sha256d64_avx2::Transform_8way;
+        ret += ",avx2(8way)";
     }
+#endif
 #endif
 
-    assert(SelfTest(Transform));
-    return "standard";
+    assert(SelfTest());
+    return ret;
 }
 
 ////// SHA-256
@@ -247,3 +440,37 @@ CSHA256& CSHA256::Reset()
     sha256::Initialize(s);
     return *this;
 }
+
+void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
+{
+    if (TransformD64_8way) {
+        while (blocks >= 8) {
+            TransformD64_8way(out, in);
+            out += 256;
+            in += 512;
+            blocks -= 8;
+        }
+    }
+    if (TransformD64_4way) {
+        while (blocks >= 4) {
+            TransformD64_4way(out, in);
+            out += 128;
+            in += 256;
+            blocks -= 4;
+        }
+    }
+    if (TransformD64_2way) {
+        while (blocks >= 2) {
+            TransformD64_2way(out, in);
+            out += 64;
+            in += 128;
+            blocks -= 2;
+        }
+    }
+    while (blocks) {
+        TransformD64(out, in);
+        out += 32;
+        in += 64;
+        --blocks;
+    }
+}
@@ -26,9 +26,30 @@ public:
     CSHA256& Reset();
 };
 
+namespace sha256_implementation {
+/** Bit flags restricting which SHA256 backends SHA256AutoDetect may select */
+enum UseImplementation : uint8_t {
+    STANDARD = 0,
+    USE_SSE4 = 1 << 0,
+    USE_AVX2 = 1 << 1,
+    USE_SHANI = 1 << 2,
+    USE_ALL = USE_SSE4 | USE_AVX2 | USE_SHANI,
+};
+}
+
 /** Autodetect the best available SHA256 implementation.
  *  Returns the name of the implementation.
+ *
+ *  use_implementation can be used to disable backends, e.g. to compare them
+ *  in benchmarks. Backends which are not supported by the CPU are never used.
+ */
+std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implementation = sha256_implementation::USE_ALL);
+
+/** Compute multiple double-SHA256's of 64-byte blobs.
+ *  output:  pointer to a blocks*32 byte output buffer
+ *  input:   pointer to a blocks*64 byte input buffer
+ *  blocks:  the number of hashes to compute.
  */
-std::string SHA256AutoDetect();
+void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
 #endif // BITCOIN_CRYPTO_SHA256_H
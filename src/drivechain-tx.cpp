@@ -615,6 +615,7 @@ static void MutateTxSign(CMutableTransaction& tx, const std::string& flagStr)
                     newcoin.out.nValue = AmountFromValue(prevOut["amount"]);
                 }
                 newcoin.nHeight = 1;
+                newcoin.UpdateEscrow();
                 view.AddCoin(out, std::move(newcoin), true);
             }
 
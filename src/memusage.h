@@ -6,6 +6,7 @@
 #define BITCOIN_MEMUSAGE_H
 
 #include <indirectmap.h>
+#include <support/allocators/pool.h>
 
 #include <stdlib.h>
 
@@ -164,6 +165,19 @@ static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z>& m)
     return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
+template<typename X, typename Y, typename Z, typename E>
+static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z, E, PoolAllocator<std::pair<const X, Y> > >& m)
+{
+    PoolResource* resource = m.get_allocator().GetResource();
+    if (!resource) {
+        return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
+    }
+    // The chunks are counted whole, a node that was erased leaves a free
+    // block behind. Only the bucket array is large enough to be allocated
+    // outside of the pool.
+    return resource->ChunkBytes() + MallocUsage(resource->LargeBytes());
+}
+
 }
 
 #endif // BITCOIN_MEMUSAGE_H
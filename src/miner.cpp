@@ -549,35 +549,31 @@ bool BlockAssembler::CreateWithdrawalPayout(uint8_t nSidechain, CMutableTransact
         return false;
 
     // Copy outputs from withdrawal tx
-    std::vector<std::pair<uint8_t, CMutableTransaction>> vTx = scdb.GetWithdrawalTxCache();
-    for (const std::pair<uint8_t, CMutableTransaction>& pair : vTx) {
-        if (pair.second.GetHash() == hashBest) {
-            for (const CTxOut& out : pair.second.vout)
-                mtx.vout.push_back(out);
-            break;
-        }
-    }
+    CMutableTransaction mtxBest;
+    if (!scdb.GetCachedWithdrawalTx(hashBest, mtxBest))
+        return false;
+    mtx.vout = mtxBest.vout;
+
     // Withdrawal should have at least the encoded dest output, encoded fee output,
     // and change return output.
     if (mtx.vout.size() < 3)
         return false;
 
+    // The withdrawal outputs were parsed when SCDB cached the withdrawal tx
+    SidechainBundleInfo info;
+    if (!scdb.GetBundleInfo(hashBest, info))
+        return false;
+
     // Get the mainchain fee amount from the second Withdrawal output which encodes the
     // sum of withdrawal fees.
-    CAmount amountRead = 0;
-    if (!DecodeWithdrawalFees(mtx.vout[1].scriptPubKey, amountRead)) {
+    if (!info.fFeesValid) {
         LogPrintf("%s: Failed to decode withdrawal fees!\n", __func__);
         return false;
     }
-    nFees = amountRead;
+    nFees = info.amountFees;
 
     // Calculate the amount to be withdrawn by Withdrawal
-    CAmount amountWithdrawn = CAmount(0);
-    for (const CTxOut& out : mtx.vout) {
-        uint8_t nSidechain;
-        if (!out.scriptPubKey.IsDrivechain(nSidechain))
-            amountWithdrawn += out.nValue;
-    }
+    CAmount amountWithdrawn = info.amountOut - info.amountSidechainOut;
 
     // Add mainchain fees from withdrawal
     amountWithdrawn += nFees;
@@ -896,11 +892,13 @@ void static BitcoinMiner(const CChainParams& chainparams)
 
     unsigned int nExtraNonce = 0;
 
+    std::shared_ptr<CReserveScript> coinbaseScript;
+#ifdef ENABLE_WALLET
     if (vpwallets.empty())
         return; // TODO error message
 
-    std::shared_ptr<CReserveScript> coinbaseScript;
     vpwallets[0]->GetScriptForMining(coinbaseScript);
+#endif
 
     bool fBreakForBMM = gArgs.GetBoolArg("-minerbreakforbmm", false);
     int nBMMBreakAttempts = 0;
@@ -24,6 +24,7 @@
 #include <string.h>
 #else
 #include <fcntl.h>
+#include <sys/uio.h>
 #endif
 
 #ifdef USE_UPNP
@@ -74,6 +75,9 @@ const static std::string NET_MESSAGE_COMMAND_OTHER = "*other*";
 
 static const uint64_t RANDOMIZER_ID_NETGROUP = 0x6c0edd8036ef4036ULL; // SHA256("netgroup")[0:8]
 static const uint64_t RANDOMIZER_ID_LOCALHOSTNONCE = 0xd93e69e2bbfa5735ULL; // SHA256("localhostnonce")[0:8]
+
+/** Maximum number of queued buffers passed to one sendmsg() call */
+static const int MAX_SEND_IOVECS = 64;
 //
 // Global state variables
 //
@@ -886,26 +890,50 @@ size_t CConnman::SocketSendData(CNode *pnode) const
     size_t nSentSize = 0;
 
     while (it != pnode->vSendMsg.end()) {
-        const auto &data = *it;
-        assert(data.size() > pnode->nSendOffset);
+        assert(it->size() > pnode->nSendOffset);
+        size_t nToSend = 0;
         int nBytes = 0;
         {
             LOCK(pnode->cs_hSocket);
             if (pnode->hSocket == INVALID_SOCKET)
                 break;
-            nBytes = send(pnode->hSocket, reinterpret_cast<const char*>(data.data()) + pnode->nSendOffset, data.size() - pnode->nSendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+#ifndef WIN32
+            // Hand as many queued buffers as possible to the kernel at once
+            struct iovec iov[MAX_SEND_IOVECS];
+            int nIov = 0;
+            for (auto itv = it; itv != pnode->vSendMsg.end() && nIov < MAX_SEND_IOVECS; ++itv, ++nIov) {
+                size_t nOffset = nIov == 0 ? pnode->nSendOffset : 0;
+                iov[nIov].iov_base = const_cast<unsigned char*>(itv->begin()) + nOffset;
+                iov[nIov].iov_len = itv->size() - nOffset;
+                nToSend += iov[nIov].iov_len;
+            }
+            struct msghdr msg = {};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = nIov;
+            nBytes = sendmsg(pnode->hSocket, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+#else
+            nToSend = it->size() - pnode->nSendOffset;
+            nBytes = send(pnode->hSocket, reinterpret_cast<const char*>(it->begin()) + pnode->nSendOffset, nToSend, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
         }
         if (nBytes > 0) {
             pnode->nLastSend = GetSystemTimeInSeconds();
             pnode->nSendBytes += nBytes;
-            pnode->nSendOffset += nBytes;
             nSentSize += nBytes;
-            if (pnode->nSendOffset == data.size()) {
+            size_t nRemaining = nBytes;
+            while (nRemaining > 0) {
+                size_t nLeft = it->size() - pnode->nSendOffset;
+                if (nRemaining < nLeft) {
+                    pnode->nSendOffset += nRemaining;
+                    break;
+                }
+                nRemaining -= nLeft;
                 pnode->nSendOffset = 0;
-                pnode->nSendSize -= data.size();
+                pnode->nSendSize -= it->size();
                 pnode->fPauseSend = pnode->nSendSize > nSendBufferMaxSize;
                 it++;
-            } else {
+            }
+            if ((size_t)nBytes != nToSend) {
                 // could not send full message; stop sending more
                 break;
             }
@@ -1144,9 +1172,136 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
 
     LogPrint(BCLog::NET, "connection from %s accepted\n", addr.ToString());
 
+    AddNode(pnode);
+}
+
+void CConnman::AddNode(CNode* pnode)
+{
+    if (socketEvents && !socketEvents->IsLevelTriggered()) {
+        // The socket is removed from the interest list when it is closed.
+        // Nodes are only deleted by the socket handler thread after their
+        // socket was closed, so the pointer stays valid for every event.
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket != INVALID_SOCKET && !socketEvents->Add(pnode->hSocket, pnode, true)) {
+            pnode->CloseSocketDisconnect();
+        }
+    }
+
+    LOCK(cs_vNodes);
+    vNodes.push_back(pnode);
+}
+
+bool CConnman::GenerateSelectSet(std::set<SOCKET>& recv_set, std::set<SOCKET>& send_set, std::set<SOCKET>& error_set)
+{
+    for (const ListenSocket& hListenSocket : vhListenSocket) {
+        recv_set.insert(hListenSocket.socket);
+    }
+
+    {
+        LOCK(cs_vNodes);
+        for (CNode* pnode : vNodes)
+        {
+            // Implement the following logic:
+            // * If there is data to send, select() for sending data. As this only
+            //   happens when optimistic write failed, we choose to first drain the
+            //   write buffer in this case before receiving more. This avoids
+            //   needlessly queueing received data, if the remote peer is not themselves
+            //   receiving data. This means properly utilizing TCP flow control signalling.
+            // * Otherwise, if there is space left in the receive buffer, select() for
+            //   receiving data.
+            // * Hand off all complete messages to the processor, to be handled without
+            //   blocking here.
+
+            bool select_recv = !pnode->fPauseRecv;
+            bool select_send;
+            {
+                LOCK(pnode->cs_vSend);
+                select_send = !pnode->vSendMsg.empty();
+            }
+
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket == INVALID_SOCKET)
+                continue;
+
+            error_set.insert(pnode->hSocket);
+            if (select_send) {
+                send_set.insert(pnode->hSocket);
+                continue;
+            }
+            if (select_recv) {
+                recv_set.insert(pnode->hSocket);
+            }
+        }
+    }
+
+    return !recv_set.empty() || !send_set.empty() || !error_set.empty();
+}
+
+void CConnman::SocketEvents(std::set<SOCKET>& recv_set, std::set<SOCKET>& send_set, std::set<SOCKET>& error_set)
+{
+    const int64_t nTimeoutMillis = 50; // frequency to poll pnode->vSend
+
+    if (socketEvents->IsLevelTriggered()) {
+        bool have_fds = GenerateSelectSet(recv_set, send_set, error_set);
+        if (!socketEvents->Wait(recv_set, send_set, error_set, nTimeoutMillis)) {
+            if (have_fds) {
+                int nErr = WSAGetLastError();
+                LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
+            }
+            // Treat every socket as readable, recv() sorts them out
+            GenerateSelectSet(recv_set, send_set, error_set);
+            send_set.clear();
+            error_set.clear();
+            interruptNet.sleep_for(std::chrono::milliseconds(nTimeoutMillis));
+        }
+        return;
+    }
+
+    // Readiness is remembered per node, so only block if no node can make
+    // progress without a new event
+    bool fMoreWork = false;
     {
         LOCK(cs_vNodes);
-        vNodes.push_back(pnode);
+        for (CNode* pnode : vNodes) {
+            bool fHasSendData;
+            {
+                LOCK(pnode->cs_vSend);
+                fHasSendData = !pnode->vSendMsg.empty();
+            }
+            if (fHasSendData ? pnode->fCanSendData.load() : (pnode->fHasRecvData && !pnode->fPauseRecv)) {
+                fMoreWork = true;
+                break;
+            }
+        }
+    }
+
+    std::vector<CSocketEvents::Event> vEvents;
+    if (!socketEvents->WaitEvents(vEvents, fMoreWork ? 0 : nTimeoutMillis)) {
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEINTR) {
+            LogPrintf("socket epoll error %s\n", NetworkErrorString(nErr));
+            interruptNet.sleep_for(std::chrono::milliseconds(nTimeoutMillis));
+        }
+        return;
+    }
+
+    for (const CSocketEvents::Event& event : vEvents) {
+        bool fListenSocket = false;
+        for (const ListenSocket& hListenSocket : vhListenSocket) {
+            if (event.data == &hListenSocket) {
+                recv_set.insert(hListenSocket.socket);
+                fListenSocket = true;
+                break;
+            }
+        }
+        if (fListenSocket)
+            continue;
+
+        CNode* pnode = static_cast<CNode*>(event.data);
+        if (event.fRecv || event.fError)
+            pnode->fHasRecvData = true;
+        if (event.fSend)
+            pnode->fCanSendData = true;
     }
 }
 
@@ -1216,94 +1371,18 @@ void CConnman::ThreadSocketHandler()
                 clientInterface->NotifyNumConnectionsChanged(nPrevNodeCount);
         }
 
-        //
-        // Find which sockets have data to receive
-        //
-        struct timeval timeout;
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000; // frequency to poll pnode->vSend
-
-        fd_set fdsetRecv;
-        fd_set fdsetSend;
-        fd_set fdsetError;
-        FD_ZERO(&fdsetRecv);
-        FD_ZERO(&fdsetSend);
-        FD_ZERO(&fdsetError);
-        SOCKET hSocketMax = 0;
-        bool have_fds = false;
-
-        for (const ListenSocket& hListenSocket : vhListenSocket) {
-            FD_SET(hListenSocket.socket, &fdsetRecv);
-            hSocketMax = std::max(hSocketMax, hListenSocket.socket);
-            have_fds = true;
-        }
+        std::set<SOCKET> recv_set, send_set, error_set;
+        SocketEvents(recv_set, send_set, error_set);
 
-        {
-            LOCK(cs_vNodes);
-            for (CNode* pnode : vNodes)
-            {
-                // Implement the following logic:
-                // * If there is data to send, select() for sending data. As this only
-                //   happens when optimistic write failed, we choose to first drain the
-                //   write buffer in this case before receiving more. This avoids
-                //   needlessly queueing received data, if the remote peer is not themselves
-                //   receiving data. This means properly utilizing TCP flow control signalling.
-                // * Otherwise, if there is space left in the receive buffer, select() for
-                //   receiving data.
-                // * Hand off all complete messages to the processor, to be handled without
-                //   blocking here.
-
-                bool select_recv = !pnode->fPauseRecv;
-                bool select_send;
-                {
-                    LOCK(pnode->cs_vSend);
-                    select_send = !pnode->vSendMsg.empty();
-                }
-
-                LOCK(pnode->cs_hSocket);
-                if (pnode->hSocket == INVALID_SOCKET)
-                    continue;
-
-                FD_SET(pnode->hSocket, &fdsetError);
-                hSocketMax = std::max(hSocketMax, pnode->hSocket);
-                have_fds = true;
-
-                if (select_send) {
-                    FD_SET(pnode->hSocket, &fdsetSend);
-                    continue;
-                }
-                if (select_recv) {
-                    FD_SET(pnode->hSocket, &fdsetRecv);
-                }
-            }
-        }
-
-        int nSelect = select(have_fds ? hSocketMax + 1 : 0,
-                             &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
         if (interruptNet)
             return;
 
-        if (nSelect == SOCKET_ERROR)
-        {
-            if (have_fds)
-            {
-                int nErr = WSAGetLastError();
-                LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
-                for (unsigned int i = 0; i <= hSocketMax; i++)
-                    FD_SET(i, &fdsetRecv);
-            }
-            FD_ZERO(&fdsetSend);
-            FD_ZERO(&fdsetError);
-            if (!interruptNet.sleep_for(std::chrono::milliseconds(timeout.tv_usec/1000)))
-                return;
-        }
-
         //
         // Accept new connections
         //
         for (const ListenSocket& hListenSocket : vhListenSocket)
         {
-            if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv))
+            if (hListenSocket.socket != INVALID_SOCKET && recv_set.count(hListenSocket.socket) > 0)
             {
                 AcceptConnection(hListenSocket);
             }
@@ -1330,13 +1409,23 @@ void CConnman::ThreadSocketHandler()
             bool recvSet = false;
             bool sendSet = false;
             bool errorSet = false;
-            {
+            if (socketEvents->IsLevelTriggered()) {
                 LOCK(pnode->cs_hSocket);
                 if (pnode->hSocket == INVALID_SOCKET)
                     continue;
-                recvSet = FD_ISSET(pnode->hSocket, &fdsetRecv);
-                sendSet = FD_ISSET(pnode->hSocket, &fdsetSend);
-                errorSet = FD_ISSET(pnode->hSocket, &fdsetError);
+                recvSet = recv_set.count(pnode->hSocket) > 0;
+                sendSet = send_set.count(pnode->hSocket) > 0;
+                errorSet = error_set.count(pnode->hSocket) > 0;
+            } else {
+                // Same policy as GenerateSelectSet: drain the send buffer
+                // before receiving more
+                bool fHasSendData;
+                {
+                    LOCK(pnode->cs_vSend);
+                    fHasSendData = !pnode->vSendMsg.empty();
+                }
+                sendSet = fHasSendData && pnode->fCanSendData;
+                recvSet = !fHasSendData && !pnode->fPauseRecv && pnode->fHasRecvData;
             }
             if (recvSet || errorSet)
             {
@@ -1349,6 +1438,9 @@ void CConnman::ThreadSocketHandler()
                         continue;
                     nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
                 }
+                // A short read drained the socket, more data raises a new edge
+                if ((nBytes > 0 && (size_t)nBytes < sizeof(pchBuf)) || (nBytes < 0 && WSAGetLastError() == WSAEWOULDBLOCK))
+                    pnode->fHasRecvData = false;
                 if (nBytes > 0)
                 {
                     bool notify = false;
@@ -1403,6 +1495,9 @@ void CConnman::ThreadSocketHandler()
                 if (nBytes) {
                     RecordBytesSent(nBytes);
                 }
+                // SocketSendData only stops early when send() would block
+                if (!pnode->vSendMsg.empty())
+                    pnode->fCanSendData = false;
             }
 
             //
@@ -1987,10 +2082,7 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
         pnode->m_manual_connection = true;
 
     m_msgproc->InitializeNode(pnode);
-    {
-        LOCK(cs_vNodes);
-        vNodes.push_back(pnode);
-    }
+    AddNode(pnode);
 }
 
 void CConnman::ThreadMessageHandler()
@@ -2261,6 +2353,24 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         nMaxOutboundCycleStartTime = 0;
     }
 
+    socketEvents.reset(new CSocketEvents(socketEventsMode));
+    if (!socketEvents->Init()) {
+        if (socketEventsMode != SOCKETEVENTS_EPOLL) {
+            if (clientInterface) {
+                clientInterface->ThreadSafeMessageBox(
+                    strprintf(_("Socket events mode %s is not supported."), GetSocketEventsModeName(socketEventsMode)),
+                    "", CClientUIInterface::MSG_ERROR);
+            }
+            return false;
+        }
+        LogPrintf("epoll is not available, falling back to poll\n");
+        socketEvents.reset(new CSocketEvents(SOCKETEVENTS_POLL));
+        if (!socketEvents->Init()) {
+            return false;
+        }
+    }
+    LogPrintf("Using %s for socket events\n", GetSocketEventsModeName(socketEvents->GetMode()));
+
     if (fListen && !InitBinds(connOptions.vBinds, connOptions.vWhiteBinds)) {
         if (clientInterface) {
             clientInterface->ThreadSafeMessageBox(
@@ -2270,6 +2380,16 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         return false;
     }
 
+    if (!socketEvents->IsLevelTriggered()) {
+        // The listening sockets stay level triggered, AcceptConnection()
+        // only accepts one connection per wakeup
+        for (ListenSocket& hListenSocket : vhListenSocket) {
+            if (!socketEvents->Add(hListenSocket.socket, &hListenSocket, false)) {
+                return false;
+            }
+        }
+    }
+
     for (const auto& strDest : connOptions.vSeedNodes) {
         AddOneShot(strDest);
     }
@@ -2441,6 +2561,7 @@ void CConnman::Stop()
     vNodes.clear();
     vNodesDisconnected.clear();
     vhListenSocket.clear();
+    socketEvents.reset();
     semOutbound.reset();
     semAddnode.reset();
 }
@@ -2742,6 +2863,8 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     nextSendTimeFeeFilter = 0;
     fPauseRecv = false;
     fPauseSend = false;
+    fHasRecvData = false;
+    fCanSendData = false;
     nProcessQueueSize = 0;
 
     for (const std::string &msg : getAllNetMessageTypes())
@@ -2799,19 +2922,25 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
     return pnode && pnode->fSuccessfullyConnected && !pnode->fDisconnect;
 }
 
-void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
+static std::vector<unsigned char> SerializeMessageHeader(const CSerializedNetMsg& msg)
 {
-    size_t nMessageSize = msg.data.size();
-    size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
-    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n",  SanitizeString(msg.command.c_str()), nMessageSize, pnode->GetId());
-
     std::vector<unsigned char> serializedHeader;
     serializedHeader.reserve(CMessageHeader::HEADER_SIZE);
-    uint256 hash = Hash(msg.data.data(), msg.data.data() + nMessageSize);
-    CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), nMessageSize);
+    uint256 hash = Hash(msg.data.data(), msg.data.data() + msg.data.size());
+    CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), msg.data.size());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, serializedHeader, 0, hdr};
+    return serializedHeader;
+}
+
+void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
+{
+    size_t nMessageSize = msg.data.size();
+    size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
+    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n",  SanitizeString(msg.command.c_str()), nMessageSize, pnode->GetId());
+
+    std::vector<unsigned char> serializedHeader = SerializeMessageHeader(msg);
 
     size_t nBytesSent = 0;
     {
@@ -2824,9 +2953,50 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 
         if (pnode->nSendSize > nSendBufferMaxSize)
             pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
+        pnode->vSendMsg.emplace_back(std::move(serializedHeader));
         if (nMessageSize)
-            pnode->vSendMsg.push_back(std::move(msg.data));
+            pnode->vSendMsg.emplace_back(std::move(msg.data));
+
+        // If write queue empty, attempt "optimistic write"
+        if (optimisticSend == true)
+            nBytesSent = SocketSendData(pnode);
+    }
+    if (nBytesSent)
+        RecordBytesSent(nBytesSent);
+}
+
+CSharedNetMsg CConnman::MakeSharedMessage(CSerializedNetMsg&& msg)
+{
+    std::vector<unsigned char> serializedHeader = SerializeMessageHeader(msg);
+
+    std::shared_ptr<std::vector<unsigned char>> data = std::make_shared<std::vector<unsigned char>>();
+    data->reserve(serializedHeader.size() + msg.data.size());
+    data->insert(data->end(), serializedHeader.begin(), serializedHeader.end());
+    data->insert(data->end(), msg.data.begin(), msg.data.end());
+
+    CSharedNetMsg shared;
+    shared.data = std::move(data);
+    shared.command = std::move(msg.command);
+    return shared;
+}
+
+void CConnman::PushMessage(CNode* pnode, const CSharedNetMsg& msg)
+{
+    size_t nTotalSize = msg.data->size();
+    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n",  SanitizeString(msg.command.c_str()), nTotalSize - CMessageHeader::HEADER_SIZE, pnode->GetId());
+
+    size_t nBytesSent = 0;
+    {
+        LOCK(pnode->cs_vSend);
+        bool optimisticSend(pnode->vSendMsg.empty());
+
+        //log total amount of bytes per command
+        pnode->mapSendBytesPerMsgCmd[msg.command] += nTotalSize;
+        pnode->nSendSize += nTotalSize;
+
+        if (pnode->nSendSize > nSendBufferMaxSize)
+            pnode->fPauseSend = true;
+        pnode->vSendMsg.emplace_back(msg.data);
 
         // If write queue empty, attempt "optimistic write"
         if (optimisticSend == true)
@@ -17,6 +17,7 @@
 #include <policy/feerate.h>
 #include <protocol.h>
 #include <random.h>
+#include <socketevents.h>
 #include <streams.h>
 #include <sync.h>
 #include <uint256.h>
@@ -115,6 +116,31 @@ struct CSerializedNetMsg
     std::string command;
 };
 
+/**
+ * A message serialized once, header included, so that it can be queued for
+ * any number of peers without copying. See CConnman::MakeSharedMessage.
+ */
+struct CSharedNetMsg
+{
+    std::shared_ptr<const std::vector<unsigned char>> data;
+    std::string command;
+};
+
+/** Part of a message in a send queue, owned by the queue or shared with other peers */
+class CSendBuffer
+{
+public:
+    explicit CSendBuffer(std::vector<unsigned char>&& dataIn) : data(std::move(dataIn)) {}
+    explicit CSendBuffer(std::shared_ptr<const std::vector<unsigned char>> sharedIn) : shared(std::move(sharedIn)) {}
+
+    const unsigned char* begin() const { return shared ? shared->data() : data.data(); }
+    size_t size() const { return shared ? shared->size() : data.size(); }
+
+private:
+    std::vector<unsigned char> data;
+    std::shared_ptr<const std::vector<unsigned char>> shared;
+};
+
 class NetEventsInterface;
 class CConnman
 {
@@ -147,6 +173,7 @@ public:
         bool m_use_addrman_outgoing = true;
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
+        SocketEventsMode socketEventsMode = DEFAULT_SOCKETEVENTS;
     };
 
     void Init(const Options& connOptions) {
@@ -160,6 +187,7 @@ public:
         m_msgproc = connOptions.m_msgproc;
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
+        socketEventsMode = connOptions.socketEventsMode;
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
@@ -185,6 +213,10 @@ public:
     bool ForNode(NodeId id, std::function<bool(CNode* pnode)> func);
 
     void PushMessage(CNode* pnode, CSerializedNetMsg&& msg);
+    void PushMessage(CNode* pnode, const CSharedNetMsg& msg);
+
+    /** Serialize the header of msg once so it can be sent to many peers */
+    static CSharedNetMsg MakeSharedMessage(CSerializedNetMsg&& msg);
 
     template<typename Callable>
     void ForEachNode(Callable&& func)
@@ -333,6 +365,9 @@ private:
     void ThreadOpenConnections(std::vector<std::string> connect);
     void ThreadMessageHandler();
     void AcceptConnection(const ListenSocket& hListenSocket);
+    void AddNode(CNode* pnode);
+    bool GenerateSelectSet(std::set<SOCKET>& recv_set, std::set<SOCKET>& send_set, std::set<SOCKET>& error_set);
+    void SocketEvents(std::set<SOCKET>& recv_set, std::set<SOCKET>& send_set, std::set<SOCKET>& error_set);
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
 
@@ -390,6 +425,8 @@ private:
 
     std::vector<ListenSocket> vhListenSocket;
     std::atomic<bool> fNetworkActive;
+    SocketEventsMode socketEventsMode;
+    std::unique_ptr<CSocketEvents> socketEvents;
     banmap_t setBanned;
     CCriticalSection cs_setBanned;
     bool setBannedIsDirty;
@@ -609,7 +646,7 @@ public:
     size_t nSendSize; // total size of all vSendMsg entries
     size_t nSendOffset; // offset inside the first vSendMsg already sent
     uint64_t nSendBytes;
-    std::deque<std::vector<unsigned char>> vSendMsg;
+    std::deque<CSendBuffer> vSendMsg;
     CCriticalSection cs_vSend;
     CCriticalSection cs_hSocket;
     CCriticalSection cs_vRecv;
@@ -661,6 +698,10 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv;
     std::atomic_bool fPauseSend;
+    // Readiness reported by the edge triggered socket events backend, kept
+    // until a recv() or send() on the socket would block
+    std::atomic_bool fHasRecvData;
+    std::atomic_bool fCanSendData;
 protected:
 
     mapMsgCmdSize mapSendBytesPerMsgCmd;
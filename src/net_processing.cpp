@@ -855,9 +855,73 @@ static std::shared_ptr<const CBlockHeaderAndShortTxIDs> most_recent_compact_bloc
 static uint256 most_recent_block_hash;
 static bool fWitnessesPresentInMostRecentCompactBlock;
 
+/** Total size of the messages kept by CSerializedBlockCache */
+static const size_t MAX_SERIALIZED_BLOCK_CACHE_SIZE = 4 * MAX_BLOCK_SERIALIZED_SIZE;
+
+/**
+ * Block and cmpctblock messages for blocks near the tip, serialized once and
+ * shared by the send queues of every peer they go to. Most peers fetch a new
+ * block at about the same time, so this saves a serialization (and for
+ * getdata a disk read) per peer. Entries are keyed by block hash, command and
+ * serialization flags and the oldest are evicted first.
+ */
+class CSerializedBlockCache
+{
+public:
+    bool Get(const uint256& hash, const std::string& command, int nFlags, CSharedNetMsg& msg)
+    {
+        LOCK(cs);
+        auto it = mapMsg.find(std::make_tuple(hash, command, nFlags));
+        if (it == mapMsg.end())
+            return false;
+        msg = it->second;
+        return true;
+    }
+
+    void Put(const uint256& hash, const std::string& command, int nFlags, const CSharedNetMsg& msg)
+    {
+        LOCK(cs);
+        Key key = std::make_tuple(hash, command, nFlags);
+        if (!mapMsg.emplace(key, msg).second)
+            return;
+        vKey.push_back(key);
+        nSize += msg.data->size();
+        while (nSize > MAX_SERIALIZED_BLOCK_CACHE_SIZE && vKey.size() > 1) {
+            auto it = mapMsg.find(vKey.front());
+            nSize -= it->second.data->size();
+            mapMsg.erase(it);
+            vKey.pop_front();
+        }
+    }
+
+private:
+    typedef std::tuple<uint256, std::string, int> Key;
+
+    CCriticalSection cs;
+    std::map<Key, CSharedNetMsg> mapMsg;
+    std::deque<Key> vKey; //!< insertion order
+    size_t nSize = 0;
+};
+
+static CSerializedBlockCache serializedBlockCache;
+
+/**
+ * Get the shared message for the compact block of most_recent_compact_block,
+ * which is the only compact block of its hash that is cached.
+ */
+static CSharedNetMsg GetSharedCompactBlockMessage(const CBlockHeaderAndShortTxIDs& cmpctblock, int nFlags)
+{
+    const uint256 hash = cmpctblock.header.GetHash();
+    CSharedNetMsg msg;
+    if (!serializedBlockCache.Get(hash, NetMsgType::CMPCTBLOCK, nFlags, msg)) {
+        msg = CConnman::MakeSharedMessage(CNetMsgMaker(PROTOCOL_VERSION).Make(nFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
+        serializedBlockCache.Put(hash, NetMsgType::CMPCTBLOCK, nFlags, msg);
+    }
+    return msg;
+}
+
 void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock) {
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> pcmpctblock = std::make_shared<const CBlockHeaderAndShortTxIDs> (*pblock, true);
-    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
 
     LOCK(cs_main);
 
@@ -878,8 +942,7 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
         fWitnessesPresentInMostRecentCompactBlock = fWitnessEnabled;
     }
 
-    connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, fDrivechainEnabled, &hashBlock](CNode* pnode) {
-        // TODO: Avoid the repeated-serialization here
+    connman->ForEachNode([this, &pcmpctblock, pindex, fWitnessEnabled, fDrivechainEnabled, &hashBlock](CNode* pnode) {
         if (pnode->nVersion < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
             return;
         ProcessBlockAvailability(pnode->GetId());
@@ -894,10 +957,10 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
 
             bool fPeerHasDrivechain = state.fHaveDrivechain;
             if (fDrivechainEnabled && fPeerHasDrivechain) {
-                connman->PushMessage(pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+                connman->PushMessage(pnode, GetSharedCompactBlockMessage(*pcmpctblock, 0));
             }
             else {
-                connman->PushMessage(pnode, msgMaker.Make(SERIALIZE_TRANSACTION_NO_DRIVECHAIN, NetMsgType::CMPCTBLOCK, *pcmpctblock));
+                connman->PushMessage(pnode, GetSharedCompactBlockMessage(*pcmpctblock, SERIALIZE_TRANSACTION_NO_DRIVECHAIN));
             }
             state.pindexBestHeaderSent = pindex;
         }
@@ -1125,8 +1188,21 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
     // it's available before trying to send.
     if (send && (mi->second->nStatus & BLOCK_HAVE_DATA))
     {
+        int nBlockFlags = -1;
+        if (inv.type == MSG_BLOCK)
+            nBlockFlags = SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_TRANSACTION_NO_DRIVECHAIN;
+        else if (inv.type == MSG_WITNESS_BLOCK)
+            nBlockFlags = SERIALIZE_TRANSACTION_NO_DRIVECHAIN;
+        else if (inv.type == MSG_DRIVECHAIN_BLOCK)
+            nBlockFlags = 0;
+        // Full blocks near the tip are shared with the other peers requesting them
+        const bool fShareBlock = nBlockFlags >= 0 && mi->second->nHeight >= chainActive.Height() - MAX_BLOCKTXN_DEPTH;
+
         std::shared_ptr<const CBlock> pblock;
-        if (a_recent_block && a_recent_block->GetHash() == (*mi).second->GetBlockHash()) {
+        CSharedNetMsg blockMsg;
+        if (fShareBlock && serializedBlockCache.Get(inv.hash, NetMsgType::BLOCK, nBlockFlags, blockMsg)) {
+            // Already serialized, no need to load the block
+        } else if (a_recent_block && a_recent_block->GetHash() == (*mi).second->GetBlockHash()) {
             pblock = a_recent_block;
         } else {
             // Send block from disk
@@ -1135,14 +1211,15 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
                 assert(!"cannot load block from disk");
             pblock = pblockRead;
         }
-        if (inv.type == MSG_BLOCK) {
-            connman->PushMessage(pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_TRANSACTION_NO_DRIVECHAIN, NetMsgType::BLOCK, *pblock));
-        }
-        else if (inv.type == MSG_WITNESS_BLOCK) {
-            connman->PushMessage(pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_DRIVECHAIN, NetMsgType::BLOCK, *pblock));
-        }
-        else if (inv.type == MSG_DRIVECHAIN_BLOCK) {
-            connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
+        if (nBlockFlags >= 0) {
+            if (!blockMsg.data && fShareBlock) {
+                blockMsg = CConnman::MakeSharedMessage(msgMaker.Make(nBlockFlags, NetMsgType::BLOCK, *pblock));
+                serializedBlockCache.Put(inv.hash, NetMsgType::BLOCK, nBlockFlags, blockMsg);
+            }
+            if (blockMsg.data)
+                connman->PushMessage(pfrom, blockMsg);
+            else
+                connman->PushMessage(pfrom, msgMaker.Make(nBlockFlags, NetMsgType::BLOCK, *pblock));
         }
         else if (inv.type == MSG_FILTERED_BLOCK)
         {
@@ -1183,7 +1260,7 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
                 nSendFlags |= SERIALIZE_TRANSACTION_NO_DRIVECHAIN;
             if (CanDirectFetch(consensusParams) && mi->second->nHeight >= chainActive.Height() - MAX_CMPCTBLOCK_DEPTH) {
                 if ((fPeerWantsWitness || !fWitnessesPresentInARecentCompactBlock) && a_recent_compact_block && a_recent_compact_block->header.GetHash() == mi->second->GetBlockHash()) {
-                    connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *a_recent_compact_block));
+                    connman->PushMessage(pfrom, GetSharedCompactBlockMessage(*a_recent_compact_block, nSendFlags));
                 } else {
                     CBlockHeaderAndShortTxIDs cmpctblock(*pblock, fPeerWantsWitness);
                     connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
@@ -3415,7 +3492,7 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
                         LOCK(cs_most_recent_block);
                         if (most_recent_block_hash == pBestIndex->GetBlockHash()) {
                             if (state.fWantsCmpctWitness || !fWitnessesPresentInMostRecentCompactBlock)
-                                connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *most_recent_compact_block));
+                                connman->PushMessage(pto, GetSharedCompactBlockMessage(*most_recent_compact_block, nSendFlags));
                             else {
                                 CBlockHeaderAndShortTxIDs cmpctblock(*most_recent_block, state.fWantsCmpctWitness);
                                 connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
@@ -0,0 +1,193 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <qt/chainnotifier.h>
+
+#include <chain.h>
+#include <primitives/block.h>
+#include <sidechaindb.h>
+#include <sync.h>
+#include <validation.h>
+
+#include <QCoreApplication>
+
+ChainNotifier::ChainNotifier(QObject *parent) :
+    QObject(parent),
+    fRunning(false),
+    fSCDBSnapshotQueued(false)
+{
+}
+
+ChainNotifier* ChainNotifier::instance()
+{
+    // Owned by the application so that it outlives every model which is
+    // connected to it as well as any notification still queued for it.
+    static ChainNotifier* notifier = new ChainNotifier(QCoreApplication::instance());
+    return notifier;
+}
+
+void ChainNotifier::Start()
+{
+    if (fRunning)
+        return;
+
+    fRunning = true;
+    RegisterValidationInterface(this);
+
+    // Load the current tip and SCDB state. This is done on the validation
+    // interface queue as well so that the GUI thread doesn't block on cs_main.
+    CallFunctionInValidationInterfaceQueue([this] {
+        if (!fRunning)
+            return;
+
+        LOCK(cs_main);
+        SetPendingTip(chainActive.Tip());
+    });
+    QueueSCDBSnapshot();
+}
+
+void ChainNotifier::Stop()
+{
+    if (!fRunning)
+        return;
+
+    fRunning = false;
+    UnregisterValidationInterface(this);
+}
+
+void ChainNotifier::NotifySCDBChanged()
+{
+    if (fRunning)
+        QueueSCDBSnapshot();
+}
+
+void ChainNotifier::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload)
+{
+    // The models are refreshed once the initial download is finished
+    if (fInitialDownload || !fRunning)
+        return;
+
+    // Block index entries are never modified once they are part of the
+    // chain, so the new tip can be walked without cs_main.
+    SetPendingTip(pindexNew);
+    QueueSCDBSnapshot();
+}
+
+void ChainNotifier::BlockDisconnected(const std::shared_ptr<const CBlock> &block)
+{
+    if (!fRunning)
+        return;
+
+    // UpdatedBlockTip isn't sent when blocks are only disconnected (e.g.
+    // invalidateblock) so look up the new tip ourselves.
+    {
+        LOCK(cs_main);
+        BlockMap::const_iterator it = mapBlockIndex.find(block->hashPrevBlock);
+        if (it == mapBlockIndex.end())
+            return;
+
+        SetPendingTip(it->second);
+    }
+    QueueSCDBSnapshot();
+}
+
+void ChainNotifier::SetPendingTip(const CBlockIndex *pindex)
+{
+    std::vector<ChainTipBlock> vBlock;
+    vBlock.reserve(TIP_BLOCKS);
+    for (; pindex && (int)vBlock.size() < TIP_BLOCKS; pindex = pindex->pprev) {
+        ChainTipBlock block;
+        block.nHeight = pindex->nHeight;
+        block.hash = pindex->GetBlockHash();
+        block.nTime = pindex->GetBlockTime();
+        vBlock.push_back(block);
+    }
+
+    std::lock_guard<std::mutex> lock(cs_pending);
+    vPendingTipBlock = std::move(vBlock);
+    fTipPending = true;
+    QueueFlush();
+}
+
+void ChainNotifier::QueueSCDBSnapshot()
+{
+    // If a snapshot is already queued it hasn't been taken yet and will
+    // include this change as well.
+    if (fSCDBSnapshotQueued.exchange(true))
+        return;
+
+    CallFunctionInValidationInterfaceQueue([this] { TakeSCDBSnapshot(); });
+}
+
+void ChainNotifier::TakeSCDBSnapshot()
+{
+    fSCDBSnapshotQueued = false;
+    if (!fRunning)
+        return;
+
+    SCDBSnapshot snapshot;
+    {
+        LOCK(cs_main);
+        snapshot.fHasState = scdb.HasState();
+        snapshot.vActiveSidechain = scdb.GetActiveSidechains();
+        snapshot.mapCTIP = scdb.GetCTIP();
+
+        for (const Sidechain& s : snapshot.vActiveSidechain) {
+            std::vector<SidechainWithdrawalState> vState = scdb.GetState(s.nSidechain);
+            for (const SidechainWithdrawalState& state : vState) {
+                if (scdb.CheckWorkScore(state.nSidechain, state.hash))
+                    snapshot.setApprovedWithdrawal.insert(state.hash);
+            }
+            snapshot.vWithdrawalState.push_back(std::move(vState));
+        }
+
+        snapshot.vActivationStatus = scdb.GetSidechainActivationStatus();
+
+        std::vector<uint256> vAck = scdb.GetSidechainsToActivate();
+        snapshot.setSidechainAck.insert(vAck.begin(), vAck.end());
+    }
+
+    std::lock_guard<std::mutex> lock(cs_pending);
+    pendingSCDB = std::move(snapshot);
+    fSCDBPending = true;
+    QueueFlush();
+}
+
+void ChainNotifier::QueueFlush()
+{
+    // Only one flush is queued at a time, everything that arrives before it
+    // runs is delivered together.
+    if (fFlushQueued)
+        return;
+
+    fFlushQueued = true;
+    QMetaObject::invokeMethod(this, "flushPending", Qt::QueuedConnection);
+}
+
+void ChainNotifier::flushPending()
+{
+    bool fTip;
+    bool fSCDB;
+    {
+        std::lock_guard<std::mutex> lock(cs_pending);
+        fFlushQueued = false;
+
+        fTip = fTipPending;
+        if (fTip)
+            vTipBlock.swap(vPendingTipBlock);
+
+        fSCDB = fSCDBPending;
+        if (fSCDB)
+            std::swap(scdbSnapshot, pendingSCDB);
+
+        fTipPending = false;
+        fSCDBPending = false;
+    }
+
+    if (fTip)
+        Q_EMIT chainTipChanged(vTipBlock);
+
+    if (fSCDB)
+        Q_EMIT scdbChanged(scdbSnapshot);
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_QT_CHAINNOTIFIER_H
+#define BITCOIN_QT_CHAINNOTIFIER_H
+
+#include <sidechain.h>
+#include <uint256.h>
+#include <validationinterface.h>
+
+#include <QObject>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+/** Summary of a block on the active chain, as displayed by the GUI */
+struct ChainTipBlock
+{
+    int nHeight;
+    uint256 hash;
+    int64_t nTime;
+};
+
+/** Copy of the SCDB state that the sidechain table models display */
+struct SCDBSnapshot
+{
+    bool fHasState = false;
+
+    std::vector<Sidechain> vActiveSidechain;
+
+    std::map<uint8_t, SidechainCTIP> mapCTIP;
+
+    /** Withdrawal states of each active sidechain, in vActiveSidechain order */
+    std::vector<std::vector<SidechainWithdrawalState>> vWithdrawalState;
+
+    /** Hash of every withdrawal with a sufficient work score */
+    std::set<uint256> setApprovedWithdrawal;
+
+    std::vector<SidechainActivationStatus> vActivationStatus;
+
+    /** Hash of every sidechain proposal this node is set to ACK */
+    std::set<uint256> setSidechainAck;
+};
+
+/**
+ * Receives validation interface notifications on the scheduler thread and
+ * hands them to the GUI thread as coalesced deltas. Any number of block or
+ * SCDB changes which arrive before the GUI thread gets around to processing
+ * them are merged into a single update, and the GUI thread never has to
+ * lock cs_main to read chain or SCDB state.
+ */
+class ChainNotifier : public QObject, public CValidationInterface
+{
+    Q_OBJECT
+
+public:
+    /** Return the GUI's notifier, creating it on first use */
+    static ChainNotifier* instance();
+
+    /** Start receiving validation interface notifications */
+    void Start();
+
+    /** Stop receiving validation interface notifications */
+    void Stop();
+
+    /** Request a new SCDB snapshot after the GUI modified local SCDB data
+     * such as sidechain ACKs or custom withdrawal votes. */
+    void NotifySCDBChanged();
+
+    /** Latest delivered chain tip blocks, highest first */
+    const std::vector<ChainTipBlock>& GetTipBlocks() const { return vTipBlock; }
+
+    /** Latest delivered SCDB snapshot */
+    const SCDBSnapshot& GetSCDBSnapshot() const { return scdbSnapshot; }
+
+    /** Number of blocks to include in chain tip deltas */
+    static const int TIP_BLOCKS = 10;
+
+Q_SIGNALS:
+    void chainTipChanged(const std::vector<ChainTipBlock>& vBlock);
+    void scdbChanged(const SCDBSnapshot& snapshot);
+
+protected:
+    // CValidationInterface
+    void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
+    void BlockDisconnected(const std::shared_ptr<const CBlock> &block) override;
+
+private Q_SLOTS:
+    void flushPending();
+
+private:
+    explicit ChainNotifier(QObject *parent);
+
+    /** Replace the pending chain tip blocks with those ending at pindex */
+    void SetPendingTip(const CBlockIndex *pindex);
+
+    /** Queue a SCDB snapshot on the validation interface queue, unless one
+     * is already queued */
+    void QueueSCDBSnapshot();
+
+    /** Snapshot SCDB under cs_main. Scheduler thread only. */
+    void TakeSCDBSnapshot();
+
+    /** Schedule flushPending on the GUI thread. Requires cs_pending. */
+    void QueueFlush();
+
+    std::atomic<bool> fRunning;
+    std::atomic<bool> fSCDBSnapshotQueued;
+
+    std::mutex cs_pending;
+    bool fFlushQueued = false;
+    bool fTipPending = false;
+    bool fSCDBPending = false;
+    std::vector<ChainTipBlock> vPendingTipBlock;
+    SCDBSnapshot pendingSCDB;
+
+    // Owned by the GUI thread
+    std::vector<ChainTipBlock> vTipBlock;
+    SCDBSnapshot scdbSnapshot;
+};
+
+#endif // BITCOIN_QT_CHAINNOTIFIER_H
@@ -5,6 +5,7 @@
 #include <qt/clientmodel.h>
 
 #include <qt/bantablemodel.h>
+#include <qt/chainnotifier.h>
 #include <qt/guiconstants.h>
 #include <qt/guiutil.h>
 #include <qt/peertablemodel.h>
@@ -60,10 +61,14 @@ ClientModel::ClientModel(OptionsModel *_optionsModel, QObject *parent) :
     ignoredBlockChangeTimer->start(MODEL_UPDATE_DELAY * 2);
 
     subscribeToCoreSignals();
+
+    // The node is running now, start delivering chain updates to the models
+    ChainNotifier::instance()->Start();
 }
 
 ClientModel::~ClientModel()
 {
+    ChainNotifier::instance()->Stop();
     unsubscribeFromCoreSignals();
 }
 
@@ -24,6 +24,7 @@
 #include <net.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <utiltime.h>
 #include <validation.h>
 #include <wallet/wallet.h>
 #include <consensus/validation.h>
@@ -65,9 +66,9 @@ DenialDialog::DenialDialog(const PlatformStyle *_platformStyle, QWidget *parent)
     ui->tableWidgetCoins->horizontalHeader()->setStretchLastSection(false);
     ui->tableWidgetCoins->verticalHeader()->setVisible(false);
 
-    // Check for transactions to broadcast every 60 seconds
+    // The wallet broadcasts scheduled transactions, check for changes every 60 seconds
     scheduledTxTimer = new QTimer(this);
-    connect(scheduledTxTimer, SIGNAL(timeout()), this, SLOT(broadcastScheduledTransactions()));
+    connect(scheduledTxTimer, SIGNAL(timeout()), this, SLOT(updateScheduledTransactions()));
     scheduledTxTimer->start(60 * 1000);
 
     // Setup automatic denial timer
@@ -144,7 +145,8 @@ void DenialDialog::automaticDenial()
     QMessageBox messageBox;
     messageBox.setWindowTitle("Automatic denial failed!");
 
-    // Decide which coin to deny and schedule denial
+    // Deny every checked coin below the goal in one batch
+    std::vector<COutput> vCoinDeny;
     for (size_t i = 0; i < vCoin.size(); i++) {
         // Skip if denial score is already what we wanted
         if (vCoin[i].tx->nDenial >= nDenialGoal)
@@ -153,32 +155,25 @@ void DenialDialog::automaticDenial()
         // Skip if not checked
 
         if ((int) i >= ui->tableWidgetCoins->rowCount())
-            return;
+            break;
 
         bool fChecked = ui->tableWidgetCoins->item(i, COLUMN_CHECKBOX)->checkState() == Qt::Checked;
         if (!fChecked)
             continue;
 
-        // Schedule denial of coin
+        vCoinDeny.push_back(vCoin[i]);
+    }
 
-        CWalletTx wtx;
+    if (!vCoinDeny.empty()) {
+        // Schedule the denial transactions at random times over the delay
+        std::vector<ScheduledTransaction> vScheduled;
         std::string strFail = "";
-        if (!vpwallets[0]->DenyCoin(wtx, strFail, vCoin[i], false /* fBroadcast */)) {
+        if (!vpwallets[0]->DenyCoins(vCoinDeny, nDenialGoal, nAutoMinutes * 60, vScheduled, strFail)) {
             messageBox.setText(QString::fromStdString(strFail));
             messageBox.exec();
         }
 
-        // Add a random number of seconds to current time
-        QDateTime dateTime = QDateTime::currentDateTime().addSecs(GetRand(nAutoMinutes * 60));
-
-        std::string strTime = dateTime.toString(QString::fromStdString(SCHEDULED_TX_TIME_FORMAT)).toStdString();
-        if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), strTime)) {
-            messageBox.setText("Failed to schedule transaction!\n");
-            messageBox.exec();
-        }
-
         updateCoins();
-        break;
     }
 
     // Change automatic timer to new random time
@@ -317,12 +312,10 @@ void DenialDialog::on_pushButtonCreateAmount_clicked()
         }
 
         // TODO randomize time
-        QDateTime currentDateTime = QDateTime::currentDateTime();
-        QDateTime dateTime = currentDateTime;
+        int64_t nTime = GetTime();
 
         // Schedule for later
-        std::string strTime = dateTime.toString(QString::fromStdString(SCHEDULED_TX_TIME_FORMAT)).toStdString();
-        if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), strTime)) {
+        if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), nTime)) {
             messageBox.setText("Failed to schedule transaction!\n");
             messageBox.exec();
             return;
@@ -403,6 +396,7 @@ void DenialDialog::updateCoins()
     {
         LOCK2(cs_main, vpwallets[0]->cs_wallet);
         vpwallets[0]->AvailableCoins(vCoin);
+        nScheduled = vpwallets[0]->GetScheduled().size();
     }
 
     // Sort coins by denial score
@@ -497,42 +491,13 @@ void DenialDialog::on_tableWidgetCoins_doubleClicked(const QModelIndex& i)
     Deny(i);
 }
 
-void DenialDialog::broadcastScheduledTransactions()
+void DenialDialog::updateScheduledTransactions()
 {
-    if (vpwallets.empty() || vpwallets[0]->IsLocked())
+    if (vpwallets.empty())
         return;
 
-    // Get current time and day of the week
-    QDateTime currentDateTime = QDateTime::currentDateTime();
-    int nCurrentDay = currentDateTime.date().dayOfWeek();
-
-    std::vector<ScheduledTransaction> vScheduled = vpwallets[0]->GetScheduled();
-    std::vector<ScheduledTransaction> vComplete;
-    for (ScheduledTransaction& s : vScheduled) {
-        QDateTime txDateTime = QDateTime::fromString(
-                    QString::fromStdString(s.strTime),
-                    QString::fromStdString(SCHEDULED_TX_TIME_FORMAT));
-
-        if (nCurrentDay != txDateTime.date().dayOfWeek())
-            continue;
-
-        QTime currentTime = currentDateTime.time();
-        QTime txTime = txDateTime.time();
-
-        // Skip if the scheduled time is > 1 minute away from now
-        if (currentTime.secsTo(txTime) > 1 * 60)
-            continue;
-
-        if (!vpwallets[0]->BroadcastScheduled(s.wtxid))
-            continue;
-
-        vComplete.push_back(s);
-    }
-
-    for (ScheduledTransaction& s : vComplete)
-        vpwallets[0]->RemoveScheduledTransaction(s);
-
-    if (vComplete.size())
+    // Coins of scheduled transactions become available once they are broadcast
+    if (vpwallets[0]->GetScheduled().size() != nScheduled)
         updateCoins();
 }
 
@@ -605,8 +570,8 @@ void DenialDialog::Deny(const QModelIndex& index)
     }
 
     QDateTime dateTime = scheduleDialog.GetDateTime();
-    std::string strTime = dateTime.toString(QString::fromStdString(SCHEDULED_TX_TIME_FORMAT)).toStdString();
-    if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), strTime)) {
+    int64_t nTime = dateTime.toMSecsSinceEpoch() / 1000;
+    if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), nTime)) {
         messageBox.setText("Failed to schedule transaction!\n");
         messageBox.exec();
         return;
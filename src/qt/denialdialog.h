@@ -58,7 +58,7 @@ private Q_SLOTS:
     void on_checkBoxAll_toggled(bool fChecked);
     void updateCoins();
     void on_tableWidgetCoins_doubleClicked(const QModelIndex& i);
-    void broadcastScheduledTransactions();
+    void updateScheduledTransactions();
     void contextualMenu(const QPoint &);
     void on_denyAction_clicked();
     void automaticDenial();
@@ -88,6 +88,9 @@ private:
 
     ScheduledTransactionTableModel *scheduledModel;
 
+    // Number of scheduled transactions when the coins were last updated
+    size_t nScheduled = 0;
+
     void SortByDenial(std::vector<COutput>& vCoin);
     void Deny(const QModelIndex& index);
 
@@ -800,11 +800,6 @@ void BitcoinGUI::setWithdrawalModel(SidechainWithdrawalTableModel *model)
         if (walletFrame)
         {
             walletFrame->setWithdrawalModel(model);
-            if (clientModel) {
-                withdrawalModel->numBlocksChanged();
-                connect(clientModel, SIGNAL(numBlocksChanged(int,QDateTime,double,bool)),
-                        withdrawalModel, SLOT(numBlocksChanged()));
-            }
         }
 #endif // ENABLE_WALLET
     } else {
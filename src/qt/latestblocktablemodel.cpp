@@ -7,6 +7,7 @@
 #include <chain.h>
 #include <validation.h>
 
+#include <qt/chainnotifier.h>
 #include <qt/clientmodel.h>
 
 #include <QDateTime>
@@ -20,6 +21,11 @@ Q_DECLARE_METATYPE(BlockTableObject)
 LatestBlockTableModel::LatestBlockTableModel(QObject *parent) :
     QAbstractTableModel(parent)
 {
+    ChainNotifier* notifier = ChainNotifier::instance();
+    UpdateModel(notifier->GetTipBlocks());
+
+    connect(notifier, &ChainNotifier::chainTipChanged,
+            this, &LatestBlockTableModel::chainTipChanged);
 }
 
 int LatestBlockTableModel::rowCount(const QModelIndex & /*parent*/) const
@@ -105,55 +111,47 @@ QVariant LatestBlockTableModel::headerData(int section, Qt::Orientation orientat
 void LatestBlockTableModel::setClientModel(ClientModel *model)
 {
     this->clientModel = model;
-    if(model)
-    {
-        numBlocksChanged();
-
-        connect(model, SIGNAL(numBlocksChanged(int,QDateTime,double,bool)),
-                this, SLOT(numBlocksChanged()));
-    }
 }
 
-void LatestBlockTableModel::numBlocksChanged()
+void LatestBlockTableModel::chainTipChanged(const std::vector<ChainTipBlock>& vBlock)
 {
-    UpdateModel();
+    UpdateModel(vBlock);
 }
 
-void LatestBlockTableModel::UpdateModel()
+void LatestBlockTableModel::UpdateModel(const std::vector<ChainTipBlock>& vBlock)
 {
-    if (!clientModel)
-        return;
-
-    if (clientModel->inInitialBlockDownload())
-        return;
-
-    // Clear old data
-    beginResetModel();
-    model.clear();
-    endResetModel();
-
-    int nHeight = chainActive.Height() + 1;
-    int nBlocksToDisplay = 10;
-    if (nHeight < nBlocksToDisplay)
-        nBlocksToDisplay = nHeight;
+    std::set<uint256> setHash;
+    for (const ChainTipBlock& block : vBlock)
+        setHash.insert(block.hash);
+
+    // Remove blocks which have been disconnected or have fallen out of the
+    // range of blocks to display
+    for (int i = model.size() - 1; i >= 0; i--) {
+        BlockTableObject object = model[i].value<BlockTableObject>();
+        if (setHash.count(object.hash))
+            continue;
 
-    beginInsertRows(QModelIndex(), model.size(), model.size() + nBlocksToDisplay - 1);
-    for (int i = 0; i < nBlocksToDisplay; i++) {
-        CBlockIndex *index = chainActive[nHeight - i];
+        beginRemoveRows(QModelIndex(), i, i);
+        model.removeAt(i);
+        endRemoveRows();
+    }
 
-        // TODO add error message or something to table?
-        if (!index) {
+    // Insert new blocks. Both the model and vBlock are sorted by height, so
+    // any block that doesn't match the row at its position is new.
+    for (size_t i = 0; i < vBlock.size(); i++) {
+        const ChainTipBlock& block = vBlock[i];
+        if ((int)i < model.size() && model[i].value<BlockTableObject>().hash == block.hash)
             continue;
-        }
 
         BlockTableObject object;
-        object.nHeight = nHeight - i;
-        object.hash = index->GetBlockHash();
-        object.nTime = index->nTime;
+        object.nHeight = block.nHeight;
+        object.hash = block.hash;
+        object.nTime = block.nTime;
 
-        model.append(QVariant::fromValue(object));
+        beginInsertRows(QModelIndex(), i, i);
+        model.insert(i, QVariant::fromValue(object));
+        endInsertRows();
     }
-    endInsertRows();
 }
 
 CBlockIndex* LatestBlockTableModel::GetBlockIndex(const uint256& hash) const
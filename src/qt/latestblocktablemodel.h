@@ -10,8 +10,11 @@
 #include <QAbstractTableModel>
 #include <QList>
 
+#include <vector>
+
 class CBlockIndex;
 class ClientModel;
+struct ChainTipBlock;
 
 QT_BEGIN_NAMESPACE
 class QTimer;
@@ -46,14 +49,15 @@ public:
     };
 
 public Q_SLOTS:
-    void numBlocksChanged();
+    void chainTipChanged(const std::vector<ChainTipBlock>& vBlock);
 
 private:
     QList<QVariant> model;
 
     ClientModel *clientModel = nullptr;
 
-    void UpdateModel();
+    /** Update rows to match vBlock, only touching rows that changed */
+    void UpdateModel(const std::vector<ChainTipBlock>& vBlock);
 };
 
 #endif // LATESTBLOCKTABLEMODEL_H
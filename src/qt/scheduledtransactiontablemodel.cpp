@@ -4,6 +4,7 @@
 
 #include <qt/scheduledtransactiontablemodel.h>
 
+#include <QDateTime>
 #include <QMetaType>
 #include <QVariant>
 
@@ -94,11 +95,7 @@ void ScheduledTransactionTableModel::UpdateModel()
     if (vpwallets[0]->IsLocked())
         return;
 
-    std::vector<ScheduledTransaction> vScheduled;
-    {
-        LOCK(vpwallets[0]->cs_wallet);
-        vScheduled = vpwallets[0]->GetScheduled();
-    }
+    std::vector<ScheduledTransaction> vScheduled = vpwallets[0]->GetScheduled();
 
     beginResetModel();
     model.clear();
@@ -109,7 +106,7 @@ void ScheduledTransactionTableModel::UpdateModel()
         ScheduledTableObject object;
 
         object.txid = QString::fromStdString(tx.wtxid.ToString());
-        object.time = QString::fromStdString(tx.strTime);
+        object.time = QDateTime::fromMSecsSinceEpoch(tx.nTime * 1000).toString(QString::fromStdString(SCHEDULED_TX_TIME_FORMAT));
 
         model.append(QVariant::fromValue(object));
     }
@@ -5,6 +5,7 @@
 #include <qt/sidechainactivationdialog.h>
 #include <qt/forms/ui_sidechainactivationdialog.h>
 
+#include <qt/chainnotifier.h>
 #include <qt/platformstyle.h>
 #include <qt/sidechainactivationtablemodel.h>
 #include <qt/sidechainescrowtablemodel.h>
@@ -94,6 +95,7 @@ void SidechainActivationDialog::on_pushButtonActivate_clicked()
         if (activationModel->GetHashAtRow(selected[i].row(), hash))
             scdb.CacheSidechainHashToAck(hash);
     }
+    ChainNotifier::instance()->NotifySCDBChanged();
 }
 
 void SidechainActivationDialog::on_pushButtonReject_clicked()
@@ -105,6 +107,7 @@ void SidechainActivationDialog::on_pushButtonReject_clicked()
         if (activationModel->GetHashAtRow(selected[i].row(), hash))
             scdb.RemoveSidechainHashToAck(hash);
     }
+    ChainNotifier::instance()->NotifySCDBChanged();
 }
 
 void SidechainActivationDialog::on_pushButtonHelp_clicked()
@@ -8,9 +8,9 @@
 #include <QIcon>
 #include <QMetaType>
 #include <QPushButton>
-#include <QTimer>
 #include <QVariant>
 
+#include <qt/chainnotifier.h>
 #include <qt/guiconstants.h>
 #include <qt/guiutil.h>
 
@@ -19,12 +19,11 @@ Q_DECLARE_METATYPE(SidechainActivationTableObject)
 SidechainActivationTableModel::SidechainActivationTableModel(QObject *parent) :
     QAbstractTableModel(parent)
 {
-    // TODO update only when block connected or sidechain votes changed.
+    ChainNotifier* notifier = ChainNotifier::instance();
+    updateModel(notifier->GetSCDBSnapshot());
 
-    // This timer will be fired repeatedly to update the model
-    pollTimer = new QTimer(this);
-    connect(pollTimer, SIGNAL(timeout()), this, SLOT(updateModel()));
-    pollTimer->start(MODEL_UPDATE_DELAY);
+    connect(notifier, &ChainNotifier::scdbChanged,
+            this, &SidechainActivationTableModel::updateModel);
 }
 
 int SidechainActivationTableModel::rowCount(const QModelIndex & /*parent*/) const
@@ -124,90 +123,65 @@ QVariant SidechainActivationTableModel::headerData(int section, Qt::Orientation
     return QVariant();
 }
 
-void SidechainActivationTableModel::updateModel()
+void SidechainActivationTableModel::updateModel(const SCDBSnapshot& snapshot)
 {
-    // TODO there are many ways to improve the efficiency of this
+    const std::vector<SidechainActivationStatus>& vActivationStatus = snapshot.vActivationStatus;
 
-    std::vector<SidechainActivationStatus> vActivationStatus;
-    vActivationStatus = scdb.GetSidechainActivationStatus();
+    std::set<uint8_t> setActive;
+    for (const Sidechain& s : snapshot.vActiveSidechain)
+        setActive.insert(s.nSidechain);
+
+    std::map<QString, const SidechainActivationStatus*> mapStatus;
+    for (const SidechainActivationStatus& s : vActivationStatus)
+        mapStatus[QString::fromStdString(s.proposal.GetSerHash().ToString())] = &s;
 
     // Look for updates to sidechain activation status which is already
     // cached by the model and update our model / view.
     //
     // Also look for sidechains which have been removed from the pending list,
     // and remove them from our model / view.
-    std::vector<SidechainActivationTableObject> vRemoved;
-    for (int i = 0; i < model.size(); i++) {
+    std::set<QString> setCached;
+    for (int i = model.size() - 1; i >= 0; i--) {
         if (!model[i].canConvert<SidechainActivationTableObject>())
             return;
 
         SidechainActivationTableObject object = model[i].value<SidechainActivationTableObject>();
 
-        bool fFound = false;
-
-        // We have an update
-        for (const SidechainActivationStatus& s : vActivationStatus) {
-            if (s.proposal.GetSerHash() == uint256S(object.hash.toStdString())) {
-                // Update nAge
-                object.nAge = s.nAge;
-                // Update nFail
-                object.nFail = s.nFail;
-                // Update fAck
-                object.fAck = scdb.GetAckSidechain(s.proposal.GetSerHash());
-                // Update replacement status
-                object.fReplacement = scdb.IsSidechainActive(s.proposal.nSidechain);
-
-                // Emit signal that model data has changed
-                QModelIndex topLeft = index(i, 0);
-                QModelIndex topRight = index(i, columnCount() - 1);
-                Q_EMIT QAbstractItemModel::dataChanged(topLeft, topRight, {Qt::DecorationRole});
-
-                model[i] = QVariant::fromValue(object);
-
-                fFound = true;
-            }
+        std::map<QString, const SidechainActivationStatus*>::const_iterator it = mapStatus.find(object.hash);
+        if (it == mapStatus.end()) {
+            beginRemoveRows(QModelIndex(), i, i);
+            model.removeAt(i);
+            endRemoveRows();
+            continue;
         }
+        setCached.insert(object.hash);
 
-        // Add to vector of sidechains to be removed from model / view
-        if (!fFound) {
-            vRemoved.push_back(object);
-        }
-    }
+        const SidechainActivationStatus& s = *it->second;
+        const bool fAck = snapshot.setSidechainAck.count(s.proposal.GetSerHash());
+        const bool fReplacement = setActive.count(s.proposal.nSidechain);
+        if (object.nAge == s.nAge && object.nFail == s.nFail
+                && object.fAck == fAck && object.fReplacement == fReplacement)
+            continue;
 
-    // Loop through the model and remove expired sidechains
-    for (int i = 0; i < model.size(); i++) {
-        if (!model[i].canConvert<SidechainActivationTableObject>())
-            return;
+        object.nAge = s.nAge;
+        object.nFail = s.nFail;
+        object.fAck = fAck;
+        object.fReplacement = fReplacement;
 
-        SidechainActivationTableObject object = model[i].value<SidechainActivationTableObject>();
+        model[i] = QVariant::fromValue(object);
 
-        for (const SidechainActivationTableObject& s : vRemoved) {
-            if (s.hash == object.hash) {
-                beginRemoveRows(QModelIndex(), i, i);
-                model[i] = model.back();
-                model.pop_back();
-                endRemoveRows();
-            }
-        }
+        // Emit signal that model data has changed
+        QModelIndex topLeft = index(i, 0);
+        QModelIndex topRight = index(i, columnCount() - 1);
+        Q_EMIT QAbstractItemModel::dataChanged(topLeft, topRight, {Qt::DecorationRole});
     }
 
     // Check if any new sidechains have been added to the pending list,
     // collect them into a vector.
-    std::vector<SidechainActivationStatus> vNew;
+    std::vector<const SidechainActivationStatus*> vNew;
     for (const SidechainActivationStatus& s : vActivationStatus) {
-        bool fFound = false;
-
-        for (const QVariant& v : model) {
-            if (!v.canConvert<SidechainActivationTableObject>())
-                return;
-            SidechainActivationTableObject object = v.value<SidechainActivationTableObject>();
-
-            if (s.proposal.GetSerHash() == uint256S(object.hash.toStdString()))
-                fFound = true;
-        }
-
-        if (!fFound)
-            vNew.push_back(s);
+        if (!setCached.count(QString::fromStdString(s.proposal.GetSerHash().ToString())))
+            vNew.push_back(&s);
     }
 
     size_t nSidechains = vNew.size();
@@ -216,17 +190,17 @@ void SidechainActivationTableModel::updateModel()
 
     // Add new sidechains if we need to
     beginInsertRows(QModelIndex(), model.size(), model.size() + nSidechains - 1);
-    for (const SidechainActivationStatus& s : vNew) {
+    for (const SidechainActivationStatus* s : vNew) {
         SidechainActivationTableObject object;
 
-        object.fAck = scdb.GetAckSidechain(s.proposal.GetSerHash());
-        object.nSidechain = s.proposal.nSidechain;
-        object.fReplacement = scdb.IsSidechainActive(s.proposal.nSidechain);
-        object.title = QString::fromStdString(s.proposal.title);
-        object.description = QString::fromStdString(s.proposal.description);
-        object.nAge = s.nAge;
-        object.nFail = s.nFail;
-        object.hash = QString::fromStdString(s.proposal.GetSerHash().ToString());
+        object.fAck = snapshot.setSidechainAck.count(s->proposal.GetSerHash());
+        object.nSidechain = s->proposal.nSidechain;
+        object.fReplacement = setActive.count(s->proposal.nSidechain);
+        object.title = QString::fromStdString(s->proposal.title);
+        object.description = QString::fromStdString(s->proposal.description);
+        object.nAge = s->nAge;
+        object.nFail = s->nFail;
+        object.hash = QString::fromStdString(s->proposal.GetSerHash().ToString());
 
         model.append(QVariant::fromValue(object));
     }
@@ -6,9 +6,7 @@
 #include <QAbstractTableModel>
 #include <QList>
 
-QT_BEGIN_NAMESPACE
-class QTimer;
-QT_END_NAMESPACE
+struct SCDBSnapshot;
 
 struct SidechainActivationTableObject
 {
@@ -36,11 +34,10 @@ public:
     bool GetHashAtRow(int row, uint256& hash) const;
 
 public Q_SLOTS:
-    void updateModel();
+    void updateModel(const SCDBSnapshot& snapshot);
 
 private:
     QList<QVariant> model;
-    QTimer *pollTimer;
 };
 
 #endif // SIDECHAINACTIVATIONTABLEMODEL_H
@@ -1,5 +1,6 @@
 #include <qt/sidechainescrowtablemodel.h>
 
+#include <qt/chainnotifier.h>
 #include <qt/guiconstants.h>
 
 #include <base58.h>
@@ -11,7 +12,6 @@
 
 #include <QIcon>
 #include <QMetaType>
-#include <QTimer>
 #include <QVariant>
 
 Q_DECLARE_METATYPE(SidechainEscrowTableObject)
@@ -19,10 +19,11 @@ Q_DECLARE_METATYPE(SidechainEscrowTableObject)
 SidechainEscrowTableModel::SidechainEscrowTableModel(QObject *parent) :
     QAbstractTableModel(parent)
 {
-    // This timer will be fired repeatedly to update the model
-    pollTimer = new QTimer(this);
-    connect(pollTimer, SIGNAL(timeout()), this, SLOT(updateModel()));
-    pollTimer->start(MODEL_UPDATE_DELAY);
+    ChainNotifier* notifier = ChainNotifier::instance();
+    updateModel(notifier->GetSCDBSnapshot());
+
+    connect(notifier, &ChainNotifier::scdbChanged,
+            this, &SidechainEscrowTableModel::updateModel);
 }
 
 int SidechainEscrowTableModel::rowCount(const QModelIndex & /*parent*/) const
@@ -98,50 +99,84 @@ QVariant SidechainEscrowTableModel::headerData(int section, Qt::Orientation orie
     return QVariant();
 }
 
-void SidechainEscrowTableModel::updateModel()
+void SidechainEscrowTableModel::updateModel(const SCDBSnapshot& snapshot)
 {
-    // Clear old data
-    beginResetModel();
-    model.clear();
-    endResetModel();
+    if (fDemoMode)
+        return;
 
-    std::vector<Sidechain> vSidechain = scdb.GetActiveSidechains();
+    // Rows are sorted by sidechain number, as are the active sidechains
+    const std::vector<Sidechain>& vSidechain = snapshot.vActiveSidechain;
 
-    int nSidechains = vSidechain.size();
-    beginInsertRows(QModelIndex(), 0, nSidechains - 1);
+    // Remove sidechains which are no longer active
+    for (int i = model.size() - 1; i >= 0; i--) {
+        SidechainEscrowTableObject object = model[i].value<SidechainEscrowTableObject>();
+
+        bool fFound = false;
+        for (const Sidechain& s : vSidechain) {
+            if (s.nSidechain == object.nSidechain) {
+                fFound = true;
+                break;
+            }
+        }
+        if (fFound)
+            continue;
+
+        beginRemoveRows(QModelIndex(), i, i);
+        model.removeAt(i);
+        endRemoveRows();
+    }
+
+    for (size_t i = 0; i < vSidechain.size(); i++) {
+        const Sidechain& s = vSidechain[i];
 
-    for (const Sidechain& s : vSidechain) {
         SidechainEscrowTableObject object;
         object.nSidechain = s.nSidechain;
         object.fActive = true; // TODO
         object.name = QString::fromStdString(s.GetSidechainName());
 
         // Get the sidechain CTIP info
-        SidechainCTIP ctip;
-        if (scdb.GetCTIP(s.nSidechain, ctip)) {
-                object.CTIPIndex = QString::number(ctip.out.n);
-                object.CTIPTxID = QString::fromStdString(ctip.out.hash.ToString());
+        std::map<uint8_t, SidechainCTIP>::const_iterator it = snapshot.mapCTIP.find(s.nSidechain);
+        if (it != snapshot.mapCTIP.end()) {
+                object.CTIPIndex = QString::number(it->second.out.n);
+                object.CTIPTxID = QString::fromStdString(it->second.out.hash.ToString());
         } else {
                 object.CTIPIndex = "NA";
                 object.CTIPTxID = "NA";
         }
-        model.append(QVariant::fromValue(object));
-    }
 
-    endInsertRows();
+        // Add new sidechains
+        if ((int)i >= model.size()
+                || model[i].value<SidechainEscrowTableObject>().nSidechain != s.nSidechain) {
+            beginInsertRows(QModelIndex(), i, i);
+            model.insert(i, QVariant::fromValue(object));
+            endInsertRows();
+            continue;
+        }
+
+        // Update existing sidechains if the CTIP has changed
+        SidechainEscrowTableObject old = model[i].value<SidechainEscrowTableObject>();
+        if (old.name == object.name && old.CTIPTxID == object.CTIPTxID
+                && old.CTIPIndex == object.CTIPIndex)
+            continue;
+
+        model[i] = QVariant::fromValue(object);
+        Q_EMIT dataChanged(index(i, 0), index(i, columnCount() - 1));
+    }
 }
 
 void SidechainEscrowTableModel::AddDemoData()
 {
     // Stop updating the model with real data
-    pollTimer->stop();
+    fDemoMode = true;
 
     // Clear old data
     beginResetModel();
     model.clear();
     endResetModel();
 
-    std::vector<Sidechain> vSidechain = scdb.GetActiveSidechains();
+    const std::vector<Sidechain>& vSidechain = ChainNotifier::instance()->GetSCDBSnapshot().vActiveSidechain;
+    if (vSidechain.empty())
+        return;
 
     int nSidechains = vSidechain.size();
     beginInsertRows(QModelIndex(), 0, nSidechains - 1);
@@ -170,5 +205,6 @@ void SidechainEscrowTableModel::ClearDemoData()
     endResetModel();
 
     // Start updating the model with real data again
-    pollTimer->start();
+    fDemoMode = false;
+    updateModel(ChainNotifier::instance()->GetSCDBSnapshot());
 }
@@ -4,9 +4,7 @@
 #include <QAbstractTableModel>
 #include <QList>
 
-QT_BEGIN_NAMESPACE
-class QTimer;
-QT_END_NAMESPACE
+struct SCDBSnapshot;
 
 struct SidechainEscrowTableObject
 {
@@ -35,11 +33,13 @@ public:
     void ClearDemoData();
 
 public Q_SLOTS:
-    void updateModel();
+    void updateModel(const SCDBSnapshot& snapshot);
 
 private:
     QList<QVariant> model;
-    QTimer *pollTimer;
+
+    /** Ignore SCDB updates while showing demo data */
+    bool fDemoMode = false;
 };
 
 #endif // SIDECHAINESCROWTABLEMODEL_H
@@ -1,5 +1,6 @@
 #include <qt/sidechainwithdrawaltablemodel.h>
 
+#include <qt/chainnotifier.h>
 #include <qt/guiconstants.h>
 
 #include <random.h>
@@ -15,7 +16,6 @@
 
 #include <QIcon>
 #include <QMetaType>
-#include <QTimer>
 #include <QVariant>
 
 #include <base58.h>
@@ -40,6 +40,11 @@ Q_DECLARE_METATYPE(SidechainWithdrawalTableObject)
 SidechainWithdrawalTableModel::SidechainWithdrawalTableModel(QObject *parent) :
     QAbstractTableModel(parent)
 {
+    ChainNotifier* notifier = ChainNotifier::instance();
+    updateModel(notifier->GetSCDBSnapshot());
+
+    connect(notifier, &ChainNotifier::scdbChanged,
+            this, &SidechainWithdrawalTableModel::updateModel);
 }
 
 int SidechainWithdrawalTableModel::rowCount(const QModelIndex & /*parent*/) const
@@ -162,44 +167,72 @@ QVariant SidechainWithdrawalTableModel::headerData(int section, Qt::Orientation
     return QVariant();
 }
 
-void SidechainWithdrawalTableModel::updateModel()
+void SidechainWithdrawalTableModel::updateModel(const SCDBSnapshot& snapshot)
 {
-    // Clear old data
-    beginResetModel();
-    model.clear();
-    endResetModel();
-
-    if (!scdb.HasState())
+    if (fDemoMode)
         return;
 
-    std::vector<Sidechain> vSidechain = scdb.GetActiveSidechains();
-
-    int nSidechains = vSidechain.size();
-    beginInsertRows(QModelIndex(), model.size(), model.size() + nSidechains);
-    for (const Sidechain& s : vSidechain) {
-        std::vector<SidechainWithdrawalState> vState = scdb.GetState(s.nSidechain);
-        for (const SidechainWithdrawalState& state : vState) {
-            SidechainWithdrawalTableObject object;
-            object.sidechain = QString::fromStdString(s.GetSidechainName());
-            object.hash = QString::fromStdString(state.hash.ToString());
-            object.nAcks = state.nWorkScore;
-            object.nAge = abs(state.nBlocksLeft - SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD);
-            object.nMaxAge = SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD;
-            object.fApproved = scdb.CheckWorkScore(state.nSidechain, state.hash);
-
-            model.append(QVariant::fromValue(object));
+    std::vector<SidechainWithdrawalTableObject> vObject;
+    if (snapshot.fHasState) {
+        for (size_t x = 0; x < snapshot.vActiveSidechain.size(); x++) {
+            const Sidechain& s = snapshot.vActiveSidechain[x];
+            for (const SidechainWithdrawalState& state : snapshot.vWithdrawalState[x]) {
+                SidechainWithdrawalTableObject object;
+                object.sidechain = QString::fromStdString(s.GetSidechainName());
+                object.hash = QString::fromStdString(state.hash.ToString());
+                object.nAcks = state.nWorkScore;
+                object.nAge = abs(state.nBlocksLeft - SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD);
+                object.nMaxAge = SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD;
+                object.fApproved = snapshot.setApprovedWithdrawal.count(state.hash);
+
+                vObject.push_back(object);
+            }
         }
     }
-    endInsertRows();
-}
 
-void SidechainWithdrawalTableModel::numBlocksChanged()
-{
-    updateModel();
+    // Remove withdrawals which have been paid out, failed or disconnected
+    std::set<QString> setHash;
+    for (const SidechainWithdrawalTableObject& object : vObject)
+        setHash.insert(object.hash);
+
+    for (int i = model.size() - 1; i >= 0; i--) {
+        if (setHash.count(model[i].value<SidechainWithdrawalTableObject>().hash))
+            continue;
+
+        beginRemoveRows(QModelIndex(), i, i);
+        model.removeAt(i);
+        endRemoveRows();
+    }
+
+    // Insert new withdrawals and update the scores of existing ones. New
+    // withdrawals are always added after the existing withdrawals of a
+    // sidechain, so the remaining rows are in the same order as vObject.
+    for (size_t i = 0; i < vObject.size(); i++) {
+        const SidechainWithdrawalTableObject& object = vObject[i];
+
+        if ((int)i >= model.size()
+                || model[i].value<SidechainWithdrawalTableObject>().hash != object.hash) {
+            beginInsertRows(QModelIndex(), i, i);
+            model.insert(i, QVariant::fromValue(object));
+            endInsertRows();
+            continue;
+        }
+
+        SidechainWithdrawalTableObject old = model[i].value<SidechainWithdrawalTableObject>();
+        if (old.nAcks == object.nAcks && old.nAge == object.nAge
+                && old.fApproved == object.fApproved)
+            continue;
+
+        model[i] = QVariant::fromValue(object);
+        Q_EMIT dataChanged(index(i, 0), index(i, columnCount() - 1));
+    }
 }
 
 void SidechainWithdrawalTableModel::AddDemoData()
 {
+    // Stop updating the model with real data
+    fDemoMode = true;
+
     // Clear old data
     beginResetModel();
     model.clear();
@@ -298,4 +331,8 @@ void SidechainWithdrawalTableModel::ClearDemoData()
     beginResetModel();
     model.clear();
     endResetModel();
+
+    // Start updating the model with real data again
+    fDemoMode = false;
+    updateModel(ChainNotifier::instance()->GetSCDBSnapshot());
 }
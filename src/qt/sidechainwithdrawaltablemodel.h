@@ -4,9 +4,7 @@
 #include <QAbstractTableModel>
 #include <QList>
 
-QT_BEGIN_NAMESPACE
-class QTimer;
-QT_END_NAMESPACE
+struct SCDBSnapshot;
 
 struct SidechainWithdrawalTableObject
 {
@@ -41,12 +39,13 @@ public:
     void ClearDemoData();
 
 public Q_SLOTS:
-    void updateModel();
-
-    void numBlocksChanged();
+    void updateModel(const SCDBSnapshot& snapshot);
 
 private:
     QList<QVariant> model;
+
+    /** Ignore SCDB updates while showing demo data */
+    bool fDemoMode = false;
 };
 
 #endif // SIDECHAINWITHDRAWALTABLEMODEL_H
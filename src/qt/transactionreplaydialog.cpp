@@ -16,10 +16,10 @@
 #include <qt/platformstyle.h>
 #include <qt/walletmodel.h>
 
-#include <apiclient.h>
 #include <amount.h>
 #include <uint256.h>
 #include <primitives/transaction.h>
+#include <replaycheck.h>
 #include <utilmoneystr.h>
 #include <wallet/wallet.h>
 
@@ -250,34 +250,36 @@ void TransactionReplayDialog::on_pushButtonCheckReplay_clicked()
 
     progress.setValue(0);
 
-    // Check replay status & display progress
-    APIClient client;
+    // Skip checking transactions that have replay protection enabled
+    std::vector<uint256> vTxid;
     for (int i = 0; i < selection.size(); i++) {
-        progress.setValue(i);
-        if (progress.wasCanceled())
-            break;
-
         QVariant data = selection[i].data();
         uint256 txid = uint256S(data.toString().toStdString());
+        if (walletModel->GetReplayStatus(txid) != REPLAY_SPLIT)
+            vTxid.push_back(txid);
+    }
 
-        QString strStatus = strProgress;
-        strStatus += "Checking: ";
-        strStatus += QString::fromStdString(txid.ToString());
-        strStatus += "\n";
+    // Check replay status a batch at a time & display progress
+    std::map<uint256, int> mapReplayStatus;
+    for (size_t nStart = 0; nStart < vTxid.size() && g_replay_checker; nStart += REPLAY_BATCH_SIZE) {
+        progress.setValue(selection.size() - vTxid.size() + nStart);
+        if (progress.wasCanceled())
+            break;
 
+        size_t nEnd = std::min(vTxid.size(), nStart + REPLAY_BATCH_SIZE);
+        QString strStatus = strProgress;
+        strStatus += QString("Checking: %1 to %2 of %3\n").arg(nStart + 1).arg(nEnd).arg(vTxid.size());
         progress.setLabelText(strStatus);
 
-        // Skip checking transactions that have replay protection enabled
-        if (walletModel->GetReplayStatus(txid) == REPLAY_SPLIT)
-            continue;
-
-        // TODO handle request failure
-        if (client.IsTxReplayed(txid)) {
-            walletModel->UpdateReplayStatus(txid, REPLAY_TRUE);
-        } else {
-            walletModel->UpdateReplayStatus(txid, REPLAY_FALSE);
-        }
+        // Transactions that couldn't be checked are left out
+        std::map<uint256, bool> mapReplayed;
+        g_replay_checker->Check(std::vector<uint256>(vTxid.begin() + nStart, vTxid.begin() + nEnd), mapReplayed);
+        for (const std::pair<const uint256, bool>& replayed : mapReplayed)
+            mapReplayStatus[replayed.first] = replayed.second ? REPLAY_TRUE : REPLAY_FALSE;
     }
+
+    // Store the results in one batch
+    walletModel->UpdateReplayStatus(mapReplayStatus);
     progress.setValue(selection.size());
 
     // Update the model - replay status may have changed
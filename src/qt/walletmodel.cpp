@@ -755,3 +755,9 @@ void WalletModel::UpdateReplayStatus(const uint256& txid, const int nReplayStatu
     LOCK2(cs_main, wallet->cs_wallet);
     wallet->UpdateReplayStatus(txid, nReplayStatus);
 }
+
+void WalletModel::UpdateReplayStatus(const std::map<uint256, int>& mapReplayStatus)
+{
+    LOCK2(cs_main, wallet->cs_wallet);
+    wallet->UpdateReplayStatus(mapReplayStatus);
+}
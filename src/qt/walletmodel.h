@@ -225,6 +225,8 @@ public:
 
     void UpdateReplayStatus(const uint256& txid, const int nReplayStatus);
 
+    void UpdateReplayStatus(const std::map<uint256, int>& mapReplayStatus);
+
 private:
     CWallet *wallet;
     bool fHaveWatchOnly;
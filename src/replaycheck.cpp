@@ -0,0 +1,185 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <replaycheck.h>
+
+#include <blockimport.h>
+#include <clientversion.h>
+#include <primitives/transaction.h>
+#include <util.h>
+#include <utilstrencodings.h>
+#include <utiltime.h>
+#include <validation.h>
+
+#include <set>
+
+std::unique_ptr<CReplayChecker> g_replay_checker;
+
+CReplayChecker::CReplayChecker(const std::string& strEndpoint, const fs::path& pathBlocksDirIn, const CMessageHeader::MessageStartChars& magicIn, int64_t nCacheTTLIn) :
+    pathBlocksDir(pathBlocksDirIn),
+    nCacheTTL(nCacheTTLIn),
+    nScanFile(0),
+    nScanPos(0)
+{
+    fEndpoint = !strEndpoint.empty() && ParseAPIEndpoint(strEndpoint, endpoint);
+    memcpy(magic, magicIn, CMessageHeader::MESSAGE_START_SIZE);
+}
+
+void CReplayChecker::Check(const std::vector<uint256>& vTxid, std::map<uint256, bool>& mapReplayed)
+{
+    int64_t nNow = GetTime();
+    std::vector<uint256> vCheck;
+    {
+        LOCK(cs);
+        for (const uint256& txid : vTxid) {
+            std::map<uint256, CacheEntry>::const_iterator it = mapCache.find(txid);
+            if (it != mapCache.end() && (it->second.fReplayed || it->second.nExpire > nNow))
+                mapReplayed[txid] = it->second.fReplayed;
+            else
+                vCheck.push_back(txid);
+        }
+    }
+    if (vCheck.empty())
+        return;
+
+    // The transactions are checked without holding cs, checking the same
+    // transaction twice at the same time is harmless
+    std::map<uint256, bool> mapChecked;
+    if (!pathBlocksDir.empty()) {
+        CheckBlockFiles(vCheck, mapChecked);
+    } else if (fEndpoint) {
+        for (size_t nStart = 0; nStart < vCheck.size(); nStart += REPLAY_BATCH_SIZE) {
+            size_t nEnd = std::min(vCheck.size(), nStart + REPLAY_BATCH_SIZE);
+            std::vector<uint256> vBatch(vCheck.begin() + nStart, vCheck.begin() + nEnd);
+            // The following requests would most likely fail the same way
+            if (!CheckEndpoint(vBatch, mapChecked))
+                break;
+        }
+    } else {
+        APIClient client;
+        for (const uint256& txid : vCheck)
+            mapChecked[txid] = client.IsTxReplayed(txid);
+    }
+    LogPrint(BCLog::REPLAY, "%s: Checked %u of %u transactions, %u were cached\n", __func__, mapChecked.size(), vCheck.size(), vTxid.size() - vCheck.size());
+
+    LOCK(cs);
+    for (std::map<uint256, CacheEntry>::iterator it = mapCache.begin(); it != mapCache.end(); ) {
+        if (!it->second.fReplayed && it->second.nExpire <= nNow)
+            it = mapCache.erase(it);
+        else
+            ++it;
+    }
+    for (const std::pair<const uint256, bool>& checked : mapChecked) {
+        mapCache[checked.first] = CacheEntry{checked.second, nNow + nCacheTTL};
+        mapReplayed[checked.first] = checked.second;
+    }
+}
+
+bool CReplayChecker::CheckEndpoint(const std::vector<uint256>& vTxid, std::map<uint256, bool>& mapReplayed)
+{
+    APIClient client;
+    return client.GetReplayStatus(endpoint, vTxid, mapReplayed);
+}
+
+bool CReplayChecker::CheckBlockFiles(const std::vector<uint256>& vTxid, std::map<uint256, bool>& mapReplayed)
+{
+    // Bitcoin Core 28 and later can obfuscate the block files with a key
+    if (fs::exists(pathBlocksDir / "xor.dat"))
+        return error("%s: The block files in %s are obfuscated, which isn't supported", __func__, pathBlocksDir.string());
+
+    LOCK(csScan);
+    int64_t nStart = GetTimeMillis();
+
+    // Transactions that weren't looked for before can be anywhere in the
+    // block files, the others only in the blocks appended since the last scan
+    std::vector<uint256> vNew;
+    for (const uint256& txid : vTxid) {
+        if (mapScanned.emplace(txid, false).second)
+            vNew.push_back(txid);
+    }
+    const bool fFullScan = !vNew.empty();
+    std::set<uint256> setWanted;
+    for (const std::pair<const uint256, bool>& scanned : mapScanned) {
+        if (!scanned.second)
+            setWanted.insert(scanned.first);
+    }
+
+    const int nFirstFile = fFullScan ? 0 : nScanFile;
+    int nFile = nFirstFile;
+    uint64_t nPos = fFullScan ? 0 : nScanPos;
+    int nFilesRead = 0;
+    for (; !setWanted.empty(); nFile++, nPos = 0) {
+        FILE* file = fsbridge::fopen(pathBlocksDir / strprintf("blk%05u.dat", nFile), "rb");
+        if (!file)
+            break;
+        if (fseek(file, nPos, SEEK_SET)) {
+            fclose(file);
+            break;
+        }
+        nFilesRead++;
+
+        // The transactions of the other chain don't have drivechain data
+        CBlockFileReader reader(file, magic, CLIENT_VERSION | SERIALIZE_TRANSACTION_NO_DRIVECHAIN, GetNumCores());
+        CBlockFileReader::Record record;
+        uint64_t nEnd = nPos;
+        while (reader.Next(record)) {
+            // Positions are relative to where reading started
+            nEnd = nPos + record.nBlockPos + record.nSize;
+            if (!record.pblock)
+                continue;
+            for (const CTransactionRef& tx : record.pblock->vtx) {
+                if (setWanted.erase(tx->GetHash()))
+                    mapScanned[tx->GetHash()] = true;
+            }
+        }
+        nScanFile = nFile;
+        nScanPos = nEnd;
+    }
+    if (nFilesRead == 0 && !setWanted.empty()) {
+        for (const uint256& txid : vNew)
+            mapScanned.erase(txid);
+        return error("%s: No block files in %s", __func__, pathBlocksDir.string());
+    }
+
+    for (const uint256& txid : vTxid)
+        mapReplayed[txid] = mapScanned[txid];
+    LogPrint(BCLog::REPLAY, "%s: Read %d block files from blk%05u.dat in %dms\n", __func__, nFilesRead, nFirstFile, GetTimeMillis() - nStart);
+    return true;
+}
+
+bool InitReplayChecker(std::string& strError)
+{
+    std::string strEndpoint = gArgs.GetArg("-replayendpoint", "");
+    APIEndpoint endpoint;
+    if (!strEndpoint.empty() && !ParseAPIEndpoint(strEndpoint, endpoint)) {
+        strError = strprintf(_("Invalid -replayendpoint URL: '%s'"), strEndpoint);
+        return false;
+    }
+
+    fs::path pathBlocksDir;
+    if (gArgs.IsArgSet("-replayblocksdir")) {
+        pathBlocksDir = fs::system_complete(gArgs.GetArg("-replayblocksdir", ""));
+        if (!fs::is_directory(pathBlocksDir)) {
+            strError = strprintf(_("Specified -replayblocksdir \"%s\" does not exist."), gArgs.GetArg("-replayblocksdir", ""));
+            return false;
+        }
+    }
+
+    std::vector<unsigned char> vMagic = ParseHex(gArgs.GetArg("-replaymagic", DEFAULT_REPLAY_MAGIC));
+    if (vMagic.size() != CMessageHeader::MESSAGE_START_SIZE) {
+        strError = strprintf(_("Invalid -replaymagic: '%s'"), gArgs.GetArg("-replaymagic", ""));
+        return false;
+    }
+    CMessageHeader::MessageStartChars magic;
+    memcpy(magic, vMagic.data(), CMessageHeader::MESSAGE_START_SIZE);
+
+    int64_t nCacheTTL = gArgs.GetArg("-replaycachettl", DEFAULT_REPLAY_CACHE_TTL);
+    if (nCacheTTL < 0) {
+        strError = strprintf(_("Invalid -replaycachettl: %d"), nCacheTTL);
+        return false;
+    }
+
+    g_replay_checker.reset(new CReplayChecker(strEndpoint, pathBlocksDir, magic, nCacheTTL));
+    return true;
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_REPLAYCHECK_H
+#define BITCOIN_REPLAYCHECK_H
+
+#include <apiclient.h>
+#include <fs.h>
+#include <protocol.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! Default number of seconds the result that a transaction wasn't replayed is cached for
+static const int64_t DEFAULT_REPLAY_CACHE_TTL = 10 * 60;
+//! Number of transactions checked with one request to the replay status endpoint
+static const unsigned int REPLAY_BATCH_SIZE = 100;
+//! Default network magic of the block files replays are looked for in (Bitcoin)
+static const char* const DEFAULT_REPLAY_MAGIC = "f9beb4d9";
+
+/**
+ * Checks whether transactions were replayed on the chain this one split
+ * from. Transactions are looked for in the block files of a node of that
+ * chain if a blocks directory is set, and otherwise sent to a replay status
+ * endpoint REPLAY_BATCH_SIZE at a time. Without either of them every
+ * transaction is looked up with APIClient::IsTxReplayed.
+ *
+ * Results are cached. A transaction that was replayed stays replayed, the
+ * result that a transaction wasn't replayed expires after nCacheTTL seconds.
+ * Transactions that couldn't be checked aren't cached.
+ *
+ * The block files are read once for every batch of transactions that weren't
+ * looked for before. After that only the blocks appended since the last scan
+ * are read for them.
+ */
+class CReplayChecker
+{
+public:
+    CReplayChecker(const std::string& strEndpoint, const fs::path& pathBlocksDir, const CMessageHeader::MessageStartChars& magic, int64_t nCacheTTL);
+
+    /** Get whether the transactions were replayed, leaving out the ones that couldn't be checked */
+    void Check(const std::vector<uint256>& vTxid, std::map<uint256, bool>& mapReplayed);
+
+private:
+    bool CheckEndpoint(const std::vector<uint256>& vTxid, std::map<uint256, bool>& mapReplayed);
+    bool CheckBlockFiles(const std::vector<uint256>& vTxid, std::map<uint256, bool>& mapReplayed);
+
+    struct CacheEntry
+    {
+        bool fReplayed;
+        int64_t nExpire;
+    };
+
+    bool fEndpoint;
+    APIEndpoint endpoint;
+    const fs::path pathBlocksDir;
+    CMessageHeader::MessageStartChars magic;
+    const int64_t nCacheTTL;
+
+    CCriticalSection cs;
+    std::map<uint256, CacheEntry> mapCache;
+
+    //! Held while the block files are scanned
+    CCriticalSection csScan;
+    //! The block files were scanned up to this file and position
+    int nScanFile;
+    uint64_t nScanPos;
+    //! Transactions looked for in the scanned block files, and whether they were found
+    std::map<uint256, bool> mapScanned;
+};
+
+extern std::unique_ptr<CReplayChecker> g_replay_checker;
+
+/** Create g_replay_checker from the -replay* arguments */
+bool InitReplayChecker(std::string& strError);
+
+#endif // BITCOIN_REPLAYCHECK_H
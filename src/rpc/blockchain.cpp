@@ -13,6 +13,8 @@
 #include <consensus/validation.h>
 #include <validation.h>
 #include <core_io.h>
+#include <index/txindex.h>
+#include <init.h>
 #include <policy/feerate.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
@@ -35,6 +37,8 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <functional>
+#include <thread>
 
 struct CUpdatedBlock
 {
@@ -804,6 +808,13 @@ UniValue getblock(const JSONRPCRequest& request)
     return blockToJSON(block, pblockindex, verbosity >= 2);
 }
 
+/** Outputs held in escrow by a sidechain */
+struct CEscrowStats
+{
+    uint64_t nOutputs = 0;
+    CAmount nAmount = 0;
+};
+
 struct CCoinsStats
 {
     int nHeight;
@@ -814,64 +825,218 @@ struct CCoinsStats
     uint256 hashSerialized;
     uint64_t nDiskSize;
     CAmount nTotalAmount;
+    std::map<uint8_t, CEscrowStats> mapEscrow;
 
     CCoinsStats() : nHeight(0), nTransactions(0), nTransactionOutputs(0), nBogoSize(0), nDiskSize(0), nTotalAmount(0) {}
 };
 
-static void ApplyStats(CCoinsStats &stats, CHashWriter& ss, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
+//! Maximum number of threads computing UTXO set statistics
+static const int MAX_UTXO_STATS_THREADS = 16;
+//! Number of txid ranges the UTXO set is split into to compute statistics
+static const int UTXO_STATS_SHARDS = 64;
+//! Bytes of hash_serialized_2 data a thread collects before handing them over
+static const size_t UTXO_STATS_CHUNK_SIZE = 64 * 1024;
+//! Bytes of hash_serialized_2 data buffered for shards waiting to be hashed
+static const size_t MAX_UTXO_STATS_BUFFER = 32 * 1024 * 1024;
+
+/** Statistics of the coins of the txids in a range of first bytes */
+struct CCoinsStatsShard
+{
+    std::unique_ptr<CCoinsViewCursor> pcursor;
+    //! End of the range of txid first bytes, in database order
+    int nPrefixEnd;
+    CCoinsStats stats;
+    //! Data for hash_serialized_2 handed over and not hashed yet, it is
+    //! hashed in database order after the previous shards
+    CDataStream ss;
+    bool fDone;
+    bool fOk;
+
+    CCoinsStatsShard() : nPrefixEnd(0), ss(SER_GETHASH, PROTOCOL_VERSION), fDone(false), fOk(false) {}
+};
+
+static void ApplyStats(CCoinsStats &stats, CDataStream& ss, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
 {
-    assert(!outputs.empty());
-    ss << hash;
-    ss << VARINT(outputs.begin()->second.nHeight * 2 + outputs.begin()->second.fCoinBase);
+    HashTxOutputs(ss, hash, outputs);
     stats.nTransactions++;
-    for (const auto output : outputs) {
-        ss << VARINT(output.first + 1);
-        ss << output.second.out.scriptPubKey;
-        ss << VARINT(output.second.out.nValue);
+    for (const auto& output : outputs) {
         stats.nTransactionOutputs++;
         stats.nTotalAmount += output.second.out.nValue;
+        uint8_t nSidechain;
+        if (output.second.IsEscrow(nSidechain)) {
+            CEscrowStats& escrow = stats.mapEscrow[nSidechain];
+            escrow.nOutputs++;
+            escrow.nAmount += output.second.out.nValue;
+        }
         stats.nBogoSize += 32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
                            2 /* scriptPubKey len */ + output.second.out.scriptPubKey.size() /* scriptPubKey */;
     }
-    ss << VARINT(0);
 }
 
-//! Calculate statistics about the unspent transaction output set
-static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
+static void MergeStats(CCoinsStats &stats, const CCoinsStats &shard)
 {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
-    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
-    stats.hashBlock = pcursor->GetBestBlock();
-    {
-        LOCK(cs_main);
-        stats.nHeight = mapBlockIndex.find(stats.hashBlock)->second->nHeight;
+    stats.nTransactions += shard.nTransactions;
+    stats.nTransactionOutputs += shard.nTransactionOutputs;
+    stats.nBogoSize += shard.nBogoSize;
+    stats.nTotalAmount += shard.nTotalAmount;
+    for (const std::pair<uint8_t, CEscrowStats>& pair : shard.mapEscrow) {
+        CEscrowStats& escrow = stats.mapEscrow[pair.first];
+        escrow.nOutputs += pair.second.nOutputs;
+        escrow.nAmount += pair.second.nAmount;
     }
-    ss << stats.hashBlock;
+}
+
+/**
+ * Calculate statistics about the coins of one shard of the unspent transaction
+ * output set. The data to hash is handed to fnFlush in chunks, which returns
+ * false if the calculation is stopped.
+ */
+static bool GetUTXOShardStats(CCoinsStatsShard &shard, const std::function<bool(CDataStream&)>& fnFlush)
+{
+    CCoinsViewCursor* pcursor = shard.pcursor.get();
+    CDataStream ss(SER_GETHASH, PROTOCOL_VERSION);
     uint256 prevkey;
     std::map<uint32_t, Coin> outputs;
     while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
+        if (ShutdownRequested())
+            return false;
         COutPoint key;
         Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            if (!outputs.empty() && key.hash != prevkey) {
-                ApplyStats(stats, ss, prevkey, outputs);
-                outputs.clear();
-            }
-            prevkey = key.hash;
-            outputs[key.n] = std::move(coin);
-        } else {
+        if (!pcursor->GetKey(key))
+            return error("%s: unable to read key", __func__);
+        if (*key.hash.begin() >= shard.nPrefixEnd)
+            break;
+        if (!pcursor->GetValue(coin))
             return error("%s: unable to read value", __func__);
+        if (!outputs.empty() && key.hash != prevkey) {
+            ApplyStats(shard.stats, ss, prevkey, outputs);
+            outputs.clear();
+            if (ss.size() >= UTXO_STATS_CHUNK_SIZE && !fnFlush(ss))
+                return false;
         }
+        prevkey = key.hash;
+        outputs[key.n] = std::move(coin);
         pcursor->Next();
     }
     if (!outputs.empty()) {
-        ApplyStats(stats, ss, prevkey, outputs);
+        ApplyStats(shard.stats, ss, prevkey, outputs);
+    }
+    return fnFlush(ss);
+}
+
+/**
+ * Calculate statistics about the unspent transaction output set.
+ *
+ * The database is split into ranges of txid first bytes, which are read by
+ * a pool of threads. The data of each shard is hashed once the shards before
+ * it are, so that hash_serialized_2 is that of a single pass over the
+ * database. The shard being hashed is streamed, the threads reading the
+ * shards after it wait while they buffer more than MAX_UTXO_STATS_BUFFER bytes.
+ */
+static bool GetUTXOStats(CCoinsViewDB *view, CCoinsStats &stats)
+{
+    int64_t nTimeStart = GetTimeMicros();
+    std::vector<CCoinsStatsShard> vShard(UTXO_STATS_SHARDS);
+    {
+        LOCK(cs_main);
+        FlushStateToDisk();
+
+        // No coins are written while cs_main is held after a flush, so the
+        // database snapshots of the cursors are all the same
+        for (int i = 0; i < UTXO_STATS_SHARDS; i++) {
+            uint256 hashStart;
+            *hashStart.begin() = i * 256 / UTXO_STATS_SHARDS;
+            vShard[i].pcursor.reset(view->Cursor(hashStart));
+            vShard[i].nPrefixEnd = (i + 1) * 256 / UTXO_STATS_SHARDS;
+        }
+        stats.hashBlock = vShard[0].pcursor->GetBestBlock();
+        stats.nHeight = mapBlockIndex.find(stats.hashBlock)->second->nHeight;
     }
+
+    const int nThreads = std::max(1, std::min(GetNumCores(), MAX_UTXO_STATS_THREADS));
+    std::mutex mutex;
+    std::condition_variable cond;
+    int nNext = 0;
+    int nHashed = 0;
+    size_t nBuffered = 0;
+    bool fStop = false;
+
+    auto work = [&]() {
+        while (true) {
+            int i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&] { return fStop || nNext >= UTXO_STATS_SHARDS || nNext == nHashed || nBuffered <= MAX_UTXO_STATS_BUFFER; });
+                if (fStop || nNext >= UTXO_STATS_SHARDS)
+                    return;
+                i = nNext++;
+            }
+            auto flush = [&](CDataStream& ssChunk) {
+                std::unique_lock<std::mutex> lock(mutex);
+                vShard[i].ss.write(ssChunk.data(), ssChunk.size());
+                nBuffered += ssChunk.size();
+                ssChunk.clear();
+                cond.notify_all();
+                // The shard being hashed never waits, so the buffer drains
+                cond.wait(lock, [&] { return fStop || i == nHashed || nBuffered <= MAX_UTXO_STATS_BUFFER; });
+                return !fStop;
+            };
+            bool fOk;
+            try {
+                fOk = GetUTXOShardStats(vShard[i], flush);
+            } catch (const std::exception& e) {
+                fOk = error("%s: %s", __func__, e.what());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                vShard[i].fOk = fOk;
+                vShard[i].fDone = true;
+            }
+            cond.notify_all();
+        }
+    };
+    std::vector<std::thread> vThreads;
+    for (int i = 0; i < nThreads; i++)
+        vThreads.emplace_back(work);
+
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << stats.hashBlock;
+    bool fOk = true;
+    for (int i = 0; i < UTXO_STATS_SHARDS && fOk; i++) {
+        CCoinsStatsShard& shard = vShard[i];
+        bool fDone = false;
+        while (!fDone) {
+            CDataStream ssChunk(SER_GETHASH, PROTOCOL_VERSION);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&] { return shard.fDone || !shard.ss.empty(); });
+                fDone = shard.fDone;
+                std::swap(ssChunk, shard.ss);
+                nBuffered -= ssChunk.size();
+            }
+            cond.notify_all();
+            ss.write(ssChunk.data(), ssChunk.size());
+        }
+        fOk = shard.fOk;
+        if (fOk) {
+            MergeStats(stats, shard.stats);
+        }
+        shard.pcursor.reset();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            nHashed = i + 1;
+            fStop = !fOk;
+        }
+        cond.notify_all();
+    }
+    for (std::thread& thread : vThreads)
+        thread.join();
+    if (!fOk)
+        return false;
+
     stats.hashSerialized = ss.GetHash();
     stats.nDiskSize = view->EstimateSize();
+    LogPrint(BCLog::BENCH, "%s: %u outputs in %u shards on %d threads, %.2fms\n", __func__, stats.nTransactionOutputs, UTXO_STATS_SHARDS, nThreads, (GetTimeMicros() - nTimeStart) * 0.001);
     return true;
 }
 
@@ -941,6 +1106,13 @@ UniValue gettxoutsetinfo(const JSONRPCRequest& request)
             "  \"hash_serialized_2\": \"hash\", (string) The serialized hash\n"
             "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
+            "  \"escrow\": [               (array) Outputs held in escrow by each sidechain\n"
+            "    {\n"
+            "      \"nsidechain\": n,      (numeric) The sidechain number\n"
+            "      \"txouts\": n,          (numeric) The number of escrow outputs\n"
+            "      \"amount\": x.xxx       (numeric) The total amount in escrow\n"
+            "    }, ...\n"
+            "  ]\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("gettxoutsetinfo", "")
@@ -950,7 +1122,6 @@ UniValue gettxoutsetinfo(const JSONRPCRequest& request)
     UniValue ret(UniValue::VOBJ);
 
     CCoinsStats stats;
-    FlushStateToDisk();
     if (GetUTXOStats(pcoinsdbview.get(), stats)) {
         ret.push_back(Pair("height", (int64_t)stats.nHeight));
         ret.push_back(Pair("bestblock", stats.hashBlock.GetHex()));
@@ -960,12 +1131,118 @@ UniValue gettxoutsetinfo(const JSONRPCRequest& request)
         ret.push_back(Pair("hash_serialized_2", stats.hashSerialized.GetHex()));
         ret.push_back(Pair("disk_size", stats.nDiskSize));
         ret.push_back(Pair("total_amount", ValueFromAmount(stats.nTotalAmount)));
+
+        UniValue escrow(UniValue::VARR);
+        for (const std::pair<uint8_t, CEscrowStats>& pair : stats.mapEscrow) {
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("nsidechain", pair.first));
+            obj.push_back(Pair("txouts", (int64_t)pair.second.nOutputs));
+            obj.push_back(Pair("amount", ValueFromAmount(pair.second.nAmount)));
+            escrow.push_back(obj);
+        }
+        ret.push_back(Pair("escrow", escrow));
     } else {
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
     }
     return ret;
 }
 
+static UniValue SnapshotInfoToJSON(const CTxOutSetSnapshotInfo& info, const fs::path& path)
+{
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("bestblock", info.hashBlock.GetHex()));
+    ret.push_back(Pair("height", (int64_t)info.nHeight));
+    ret.push_back(Pair("txouts", (int64_t)info.nCoins));
+    ret.push_back(Pair("headers", (int64_t)info.nHeaders));
+    ret.push_back(Pair("hash_serialized_2", info.hashSerialized.GetHex()));
+    ret.push_back(Pair("hash_sidechain", info.hashSidechain.GetHex()));
+    ret.push_back(Pair("hash_snapshot", info.hashSnapshot.GetHex()));
+    ret.push_back(Pair("path", path.string()));
+    return ret;
+}
+
+UniValue dumptxoutset(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "dumptxoutset \"path\"\n"
+            "\nWrite a snapshot of the chainstate at the current tip to a file: the\n"
+            "unspent transaction output set, the headers of the active chain and the\n"
+            "sidechain state. Another node can load it with loadtxoutset.\n"
+            "Note this call may take some time.\n"
+            "\nArguments:\n"
+            "1. \"path\"    (string, required) The file to write, relative to the data directory if not absolute\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"bestblock\": \"hex\",          (string) The block of the snapshot\n"
+            "  \"height\": n,                 (numeric) The height of the block\n"
+            "  \"txouts\": n,                 (numeric) The number of unspent outputs\n"
+            "  \"headers\": n,                (numeric) The number of block headers\n"
+            "  \"hash_serialized_2\": \"hash\", (string) The hash of the UTXO set, as by gettxoutsetinfo\n"
+            "  \"hash_sidechain\": \"hash\",    (string) The hash of the sidechain state\n"
+            "  \"hash_snapshot\": \"hash\",     (string) The hash of the block, UTXO set and sidechain state, to pass to loadtxoutset\n"
+            "  \"path\": \"path\"               (string) The absolute path of the file\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("dumptxoutset", "\"utxo.dat\"")
+            + HelpExampleRpc("dumptxoutset", "\"utxo.dat\"")
+        );
+
+    fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+    if (fs::exists(path))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, path.string() + " already exists");
+
+    CTxOutSetSnapshotInfo info;
+    std::string strError;
+    if (!DumpTxOutSet(path, info, strError))
+        throw JSONRPCError(RPC_MISC_ERROR, strError);
+
+    return SnapshotInfoToJSON(info, path);
+}
+
+UniValue loadtxoutset(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 2)
+        throw std::runtime_error(
+            "loadtxoutset \"path\" \"hash\"\n"
+            "\nLoad a chainstate snapshot written by dumptxoutset and make its block the\n"
+            "tip of the active chain. Only possible while the active chain is at the\n"
+            "genesis block. The headers of the snapshot are validated, the blocks below\n"
+            "it are not downloaded and can't be served to peers or rescanned.\n"
+            "The UTXO set and the sidechain state are trusted if they match the hash_snapshot\n"
+            "that dumptxoutset reported on a trusted node.\n"
+            "Note this call may take some time.\n"
+            "\nArguments:\n"
+            "1. \"path\"    (string, required) The file to read, relative to the data directory if not absolute\n"
+            "2. \"hash\"    (string, required) The expected hash_snapshot of the snapshot\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"bestblock\": \"hex\",          (string) The block of the snapshot\n"
+            "  \"height\": n,                 (numeric) The height of the block\n"
+            "  \"txouts\": n,                 (numeric) The number of unspent outputs\n"
+            "  \"headers\": n,                (numeric) The number of block headers\n"
+            "  \"hash_serialized_2\": \"hash\", (string) The hash of the UTXO set, as by gettxoutsetinfo\n"
+            "  \"hash_sidechain\": \"hash\",    (string) The hash of the sidechain state\n"
+            "  \"hash_snapshot\": \"hash\",     (string) The hash of the block, UTXO set and sidechain state, to pass to loadtxoutset\n"
+            "  \"path\": \"path\"               (string) The absolute path of the file\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("loadtxoutset", "\"utxo.dat\" \"hash\"")
+            + HelpExampleRpc("loadtxoutset", "\"utxo.dat\", \"hash\"")
+        );
+
+    fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+
+    uint256 hashExpected = ParseHashV(request.params[1], "hash");
+
+    CTxOutSetSnapshotInfo info;
+    std::string strError;
+    if (!LoadTxOutSet(path, hashExpected, info, strError))
+        throw JSONRPCError(RPC_MISC_ERROR, strError);
+
+    return SnapshotInfoToJSON(info, path);
+}
+
 UniValue gettxout(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() < 2 || request.params.size() > 3)
@@ -1167,6 +1444,16 @@ UniValue getblockchaininfo(const JSONRPCRequest& request)
             "  \"pruneheight\": xxxxxx,        (numeric) lowest-height complete block stored (only present if pruning is enabled)\n"
             "  \"automatic_pruning\": xx,      (boolean) whether automatic pruning is enabled (only present if pruning is enabled)\n"
             "  \"prune_target_size\": xxxxxx,  (numeric) the target size used by pruning (only present if automatic pruning is enabled)\n"
+            "  \"coinscache\": {               (object) statistics of the in-memory UTXO cache (-dbcache)\n"
+            "     \"hits\": xxxxxx,             (numeric) coin lookups answered from the cache since startup\n"
+            "     \"misses\": xxxxxx,           (numeric) coin lookups that had to read the coins database\n"
+            "     \"prefetched\": xxxxxx,       (numeric) coins spent by blocks that were read into the cache ahead of ConnectBlock\n"
+            "     \"usage\": xxxxxx,            (numeric) memory used by the cache in bytes\n"
+            "     \"flushing\": xx,               (boolean) whether coins flushed from the cache are being written to disk in the background\n"
+            "     \"flushingusage\": xxxxxx,      (numeric) memory used by the coins being written in bytes\n"
+            "     \"lastflushtime\": xxxxxx,      (numeric) milliseconds the last write of the cache to disk took\n"
+            "     \"lastflushlocktime\": xxxxxx,  (numeric) milliseconds the last flush of the cache held up block processing\n"
+            "  },\n"
             "  \"softforks\": [                (array) status of softforks in progress\n"
             "     {\n"
             "        \"id\": \"xxxx\",           (string) name of softfork\n"
@@ -1230,6 +1517,17 @@ UniValue getblockchaininfo(const JSONRPCRequest& request)
         }
     }
 
+    UniValue coinscache(UniValue::VOBJ);
+    coinscache.push_back(Pair("hits",           pcoinsTip->GetCacheHits()));
+    coinscache.push_back(Pair("misses",         pcoinsTip->GetCacheMisses()));
+    coinscache.push_back(Pair("prefetched",     pcoinsTip->GetPrefetched()));
+    coinscache.push_back(Pair("usage",          (uint64_t)pcoinsTip->DynamicMemoryUsage()));
+    coinscache.push_back(Pair("flushing",       pcoinsflush->IsFlushing()));
+    coinscache.push_back(Pair("flushingusage",  (uint64_t)pcoinsflush->DynamicMemoryUsage()));
+    coinscache.push_back(Pair("lastflushtime",  pcoinsflush->GetLastFlushDuration() * 0.001));
+    coinscache.push_back(Pair("lastflushlocktime", nLastFlushLockTime * 0.001));
+    obj.push_back(Pair("coinscache",            coinscache));
+
     const Consensus::Params& consensusParams = Params().GetConsensus();
     CBlockIndex* tip = chainActive.Tip();
     UniValue softforks(UniValue::VARR);
@@ -1596,6 +1894,46 @@ UniValue getchaintxstats(const JSONRPCRequest& request)
     return ret;
 }
 
+UniValue getindexinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0) {
+        throw std::runtime_error(
+            "getindexinfo\n"
+            "\nReturns the status of the optional indices, which are built in the background.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"txindex\": {                 (json object) Present if -txindex is enabled\n"
+            "    \"synced\": true|false,      (boolean) Whether the index has caught up with the chain and is updated with new blocks\n"
+            "    \"best_block_height\": xxxxx, (numeric) The height of the last block in the index, or -1 if no block was indexed yet\n"
+            "    \"progress\": xxxx,          (numeric) Estimate of the share of the active chain which is indexed [0..1]\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getindexinfo", "")
+            + HelpExampleRpc("getindexinfo", "")
+        );
+    }
+
+    UniValue result(UniValue::VOBJ);
+    if (g_txindex) {
+        IndexSummary summary = g_txindex->GetSummary();
+
+        int nHeight;
+        {
+            LOCK(cs_main);
+            nHeight = chainActive.Height();
+        }
+
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("synced", summary.synced));
+        obj.push_back(Pair("best_block_height", summary.best_block_height));
+        obj.push_back(Pair("progress", summary.synced || nHeight < 0 ? 1.0 : (summary.best_block_height + 1) / (double)(nHeight + 1)));
+        result.push_back(Pair(summary.name, obj));
+    }
+
+    return result;
+}
+
 UniValue savemempool(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 0) {
@@ -1627,6 +1965,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getblockheader",         &getblockheader,         {"blockhash","verbose"} },
     { "blockchain",         "getchaintips",           &getchaintips,           {} },
     { "blockchain",         "getdifficulty",          &getdifficulty,          {} },
+    { "blockchain",         "getindexinfo",           &getindexinfo,           {} },
     { "blockchain",         "getmempoolancestors",    &getmempoolancestors,    {"txid","verbose"} },
     { "blockchain",         "getmempooldescendants",  &getmempooldescendants,  {"txid","verbose"} },
     { "blockchain",         "getmempoolentry",        &getmempoolentry,        {"txid"} },
@@ -1634,6 +1973,8 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
+    { "blockchain",         "dumptxoutset",           &dumptxoutset,           {"path"} },
+    { "blockchain",         "loadtxoutset",           &loadtxoutset,           {"path","hash"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
@@ -127,6 +127,16 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getmempoolancestors", 1, "verbose" },
     { "getmempooldescendants", 1, "verbose" },
     { "bumpfee", 1, "options" },
+    { "scheduletransaction", 1, "time" },
+    { "denycoins", 0, "goal" },
+    { "denycoins", 1, "window" },
+    { "denycoins", 2, "coins" },
+    { "denycoins", 3, "maxtxs" },
+    { "splitcoins", 0, "noutputs" },
+    { "splitcoins", 1, "amount" },
+    { "splitcoins", 2, "maxoutputspertx" },
+    { "splitcoins", 3, "dryrun" },
+    { "checkreplaystatus", 0, "txids" },
     { "logging", 0, "include" },
     { "logging", 1, "exclude" },
     { "disconnectnode", 1, "nodeid" },
@@ -137,6 +147,10 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "createbmmcriticaldatatx", 0, "amount" },
     { "createbmmcriticaldatatx", 1, "height" },
     { "createbmmcriticaldatatx", 3, "nsidechain" },
+    { "setbmmbidder", 0, "nsidechain" },
+    { "setbmmbidder", 2, "amount" },
+    { "setbmmbidder", 3, "maxbid" },
+    { "removebmmbidder", 0, "nsidechain" },
     { "createsidechainproposal", 0, "nsidechain" },
     { "createsidechainproposal", 3, "nversion" },
     { "havespentwithdrawal", 1, "nsidechain" },
@@ -153,11 +167,16 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "createsidechaindeposit", 0, "nsidechain" },
     { "createsidechaindeposit", 2, "amount" },
     { "createsidechaindeposit", 3, "fee" },
+    { "queuesidechaindeposit", 0, "nsidechain" },
+    { "queuesidechaindeposit", 2, "amount" },
+    { "queuesidechaindeposit", 3, "fee" },
     { "getaveragefee", 0, "blockcount" },
     { "getaveragefee", 1, "startheight" },
     { "getworkscore", 0, "nsidechain" },
     { "setwithdrawalvote", 1, "nsidechain" },
     { "listwithdrawalstatus", 0, "nsidechain" },
+    { "simulatewithdrawalvotes", 0, "scenarios" },
+    { "simulatewithdrawalvotes", 1, "nblocks" },
     { "listcachedwithdrawaltx", 0, "nsidechain" },
     { "verifydeposit", 2, "nTx" },
     { "verifybmm", 2, "nsidechain" },
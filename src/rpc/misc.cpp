@@ -20,6 +20,7 @@
 #include <rpc/util.h>
 #include <sidechain.h>
 #include <sidechaindb.h>
+#include <sidechainsim.h>
 #include <timedata.h>
 #include <txdb.h>
 #include <util.h>
@@ -779,7 +780,6 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
 
     UniValue arr(UniValue::VARR);
 
-#ifdef ENABLE_WALLET
     std::vector<SidechainDeposit> vDeposit = scdb.GetDeposits(nSidechain);
 
     for (auto rit = vDeposit.crbegin(); rit != vDeposit.crend(); rit++) {
@@ -821,9 +821,6 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
             LogPrintf("%s: %s\n", __func__, strError);
             throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
         }
-#endif
-
-#ifdef ENABLE_WALLET
         UniValue obj(UniValue::VOBJ);
         obj.push_back(Pair("nsidechain", d.nSidechain));
         obj.push_back(Pair("strdest", d.strDest));
@@ -833,7 +830,6 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
         obj.push_back(Pair("hashblock", d.hashBlock.ToString()));
 
         arr.push_back(obj);
-#endif
         if (fLimit) {
             count--;
             if (count <= 0)
@@ -938,7 +934,6 @@ UniValue listsidechaindepositsbyblock(const JSONRPCRequest& request)
 
     UniValue arr(UniValue::VARR);
 
-#ifdef ENABLE_WALLET
     std::vector<SidechainDeposit> vDeposit = scdb.GetDeposits(nSidechain);
 
     auto it = vDeposit.begin();
@@ -1000,9 +995,6 @@ UniValue listsidechaindepositsbyblock(const JSONRPCRequest& request)
         if (!endBlockHash.IsNull() && pblockindex->nHeight > endHeight) {
             break;
         }
-#endif
-
-#ifdef ENABLE_WALLET
         UniValue obj(UniValue::VOBJ);
         obj.push_back(Pair("nsidechain", d.nSidechain));
         obj.push_back(Pair("strdest", d.strDest));
@@ -1012,7 +1004,6 @@ UniValue listsidechaindepositsbyblock(const JSONRPCRequest& request)
         obj.push_back(Pair("hashblock", d.hashBlock.ToString()));
 
         arr.push_back(obj);
-#endif
     }
 
     return arr;
@@ -1108,6 +1099,8 @@ UniValue receivewithdrawalbundle(const JSONRPCRequest& request)
             + HelpExampleRpc("receivewithdrawalbundle", "")
      );
 
+    std::string strError;
+
 #ifndef ENABLE_WALLET
     strError = "Error: Wallet disabled";
     LogPrintf("%s: %s\n", __func__, strError);
@@ -1116,7 +1109,6 @@ UniValue receivewithdrawalbundle(const JSONRPCRequest& request)
 
 #ifdef ENABLE_WALLET
     // Check for active wallet
-    std::string strError;
     CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
     if (!pwallet) {
         strError = "Error: no wallets are available";
@@ -1125,6 +1117,8 @@ UniValue receivewithdrawalbundle(const JSONRPCRequest& request)
     }
 #endif
 
+    LOCK(cs_main);
+
     // Is nSidechain valid?
     int nSidechain = request.params[0].get_int();
     if (!scdb.IsSidechainActive(nSidechain)) {
@@ -1150,10 +1144,13 @@ UniValue receivewithdrawalbundle(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
 
+    // Parse the withdrawal outputs. SCDB keeps the result so that the outputs
+    // don't have to be parsed again when the withdrawal is paid out.
+    SidechainBundleInfo info = scdb.GetBundleInfo(withdrawal);
+
     // Reject the withdrawal if it spends more than the sidechain's CTIP as it won't
     // be accepted anyway
-    CAmount amount = withdrawal.GetValueOut();
-    std::vector<COutput> vSidechainCoin;
+    CAmount amount = info.amountOut;
     CScript scriptPubKey;
     if (!scdb.GetSidechainScript(nSidechain, scriptPubKey)) {
         strError = "Cannot get script for sidechain!";
@@ -1175,34 +1172,20 @@ UniValue receivewithdrawalbundle(const JSONRPCRequest& request)
     }
 
     // Check for the required withdrawal change return destination OP_RETURN output
-    for (size_t i = 0; i < mtx.vout.size(); i++) {
-        const CScript& scriptPubKey = mtx.vout[i].scriptPubKey;
-        if (!scriptPubKey.size())
-            continue;
-        if (scriptPubKey.front() != OP_RETURN)
-            continue;
-
-        if (scriptPubKey.size() < 3) {
-            strError = "Rejecting Withdrawal: First OP_RETURN output invalid size (too small)!\n";
-            LogPrintf("%s: %s\n", __func__, strError);
-            throw JSONRPCError(RPC_MISC_ERROR, strError);
-        }
-
-        CScript::const_iterator pDest = scriptPubKey.begin() + 1;
-        opcodetype opcode;
-        std::vector<unsigned char> vch;
-        if (!scriptPubKey.GetOp(pDest, opcode, vch) || vch.empty()) {
-            strError = "Rejecting Withdrawal: First OP_RETURN output invalid. (Failed GetOp)!\n";
-            LogPrintf("%s: %s\n", __func__, strError);
-            throw JSONRPCError(RPC_MISC_ERROR, strError);
-        }
-        std::string strDest((const char*)vch.data(), vch.size());
-        if (strDest != SIDECHAIN_WITHDRAWAL_RETURN_DEST) {
-            strError = "Rejecting Withdrawal: First OP_RETURN output invalid. (incorrect dest)!\n";
-            LogPrintf("%s: %s\n", __func__, strError);
-            throw JSONRPCError(RPC_MISC_ERROR, strError);
-        }
-        break;
+    if (info.destStatus == SidechainBundleInfo::DEST_TOO_SMALL) {
+        strError = "Rejecting Withdrawal: First OP_RETURN output invalid size (too small)!\n";
+        LogPrintf("%s: %s\n", __func__, strError);
+        throw JSONRPCError(RPC_MISC_ERROR, strError);
+    }
+    if (info.destStatus == SidechainBundleInfo::DEST_GETOP_FAILED) {
+        strError = "Rejecting Withdrawal: First OP_RETURN output invalid. (Failed GetOp)!\n";
+        LogPrintf("%s: %s\n", __func__, strError);
+        throw JSONRPCError(RPC_MISC_ERROR, strError);
+    }
+    if (info.destStatus == SidechainBundleInfo::DEST_INCORRECT) {
+        strError = "Rejecting Withdrawal: First OP_RETURN output invalid. (incorrect dest)!\n";
+        LogPrintf("%s: %s\n", __func__, strError);
+        throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
 
     // Add Withdrawal to our local cache so that we can create a Withdrawal hash commitment
@@ -1894,6 +1877,151 @@ UniValue listwithdrawalstatus(const JSONRPCRequest& request)
     return ret;
 }
 
+UniValue simulatewithdrawalvotes(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            "simulatewithdrawalvotes \"scenarios\" ( nblocks )\n"
+            "Project the work scores of the current Withdrawal(s) over future blocks\n"
+            "for each scenario of miner votes. Withdrawal(s) added in the future\n"
+            "blocks are not simulated.\n"
+            "\nArguments:\n"
+            "1. \"scenarios\"   (array, required) A json array of scenarios\n"
+            "     [\n"
+            "       [                  (array) Vote strategy of each sidechain, the rest abstain\n"
+            "         {\n"
+            "           \"nsidechain\": n,   (numeric, required) Sidechain number\n"
+            "           \"vote\": \"str\",     (string, required) \"upvote\", \"downvote\" or \"abstain\"\n"
+            "           \"hash\": \"hex\",     (string, optional) Withdrawal to upvote, required for upvote\n"
+            "           \"percent\": n       (numeric, optional, default=100) Percentage of blocks casting the vote\n"
+            "         }\n"
+            "         ,...\n"
+            "       ]\n"
+            "       ,...\n"
+            "     ]\n"
+            "2. nblocks       (numeric, optional, default=" + std::to_string(SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD) + ") Number of blocks to simulate\n"
+            "\nResult: (array) One array per scenario\n"
+            "[\n"
+            "  [\n"
+            "    {\n"
+            "      \"nsidechain\" : x,    (numeric) Sidechain number of Withdrawal\n"
+            "      \"hash\" : \"hex\",     (string) hash of Withdrawal\n"
+            "      \"status\" : \"str\",   (string) \"approved\", \"expired\" or \"pending\"\n"
+            "      \"height\" : x,        (numeric) First payout height if approved, or height removed at if expired\n"
+            "      \"nblocksleft\" : x,   (numeric) verification blocks remaining\n"
+            "      \"nworkscore\" : x     (numeric) workscore of Withdrawal\n"
+            "    }\n"
+            "    ,...\n"
+            "  ]\n"
+            "  ,...\n"
+            "]\n"
+            "\nExample:\n"
+            + HelpExampleCli("simulatewithdrawalvotes", "\"[[{\\\"nsidechain\\\":0,\\\"vote\\\":\\\"upvote\\\",\\\"hash\\\":\\\"hash\\\"}]]\"")
+            + HelpExampleRpc("simulatewithdrawalvotes", "[[{\"nsidechain\":0,\"vote\":\"downvote\",\"percent\":50}]], 1000")
+            );
+
+    RPCTypeCheck(request.params, {UniValue::VARR, UniValue::VNUM});
+
+    int nBlocks = SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD;
+    if (!request.params[1].isNull()) {
+        nBlocks = request.params[1].get_int();
+        if (nBlocks < 0 || nBlocks > SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid number of blocks");
+    }
+
+    std::vector<std::map<uint8_t, SidechainVoteStrategy>> vScenario;
+    const UniValue& scenarios = request.params[0].get_array();
+    for (size_t i = 0; i < scenarios.size(); i++) {
+        const UniValue& strategies = scenarios[i].get_array();
+
+        std::map<uint8_t, SidechainVoteStrategy> mapStrategy;
+        for (size_t j = 0; j < strategies.size(); j++) {
+            const UniValue& o = strategies[j].get_obj();
+            RPCTypeCheckObj(o,
+                {
+                    {"nsidechain", UniValueType(UniValue::VNUM)},
+                    {"vote", UniValueType(UniValue::VSTR)},
+                    {"hash", UniValueType(UniValue::VSTR)},
+                    {"percent", UniValueType(UniValue::VNUM)},
+                }, true);
+
+            int nSidechain = find_value(o, "nsidechain").get_int();
+            if (nSidechain < 0 || nSidechain >= SIDECHAIN_ACTIVATION_MAX_ACTIVE)
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid Sidechain number");
+            if (mapStrategy.count(nSidechain))
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Duplicate Sidechain number in scenario");
+
+            SidechainVoteStrategy strategy;
+            std::string strVote = find_value(o, "vote").get_str();
+            if (strVote == "upvote")
+                strategy.vote = SidechainVoteStrategy::UPVOTE;
+            else
+            if (strVote == "downvote")
+                strategy.vote = SidechainVoteStrategy::DOWNVOTE;
+            else
+            if (strVote != "abstain")
+                throw JSONRPCError(RPC_TYPE_ERROR, "Invalid vote (must be \"upvote\", \"downvote\" or \"abstain\")");
+
+            const UniValue& hash = find_value(o, "hash");
+            if (strategy.vote == SidechainVoteStrategy::UPVOTE) {
+                if (hash.isNull())
+                    throw JSONRPCError(RPC_TYPE_ERROR, "Withdrawal hash required for upvote");
+                if (hash.get_str().size() != 64)
+                    throw JSONRPCError(RPC_TYPE_ERROR, "Invalid Withdrawal hash length");
+                strategy.hash = uint256S(hash.get_str());
+                if (strategy.hash.IsNull())
+                    throw JSONRPCError(RPC_TYPE_ERROR, "Invalid Withdrawal hash");
+            }
+
+            const UniValue& percent = find_value(o, "percent");
+            if (!percent.isNull()) {
+                int nPercent = percent.get_int();
+                if (nPercent < 0 || nPercent > 100)
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid percent");
+                strategy.nPercent = nPercent;
+            }
+
+            mapStrategy[nSidechain] = strategy;
+        }
+        vScenario.push_back(std::move(mapStrategy));
+    }
+
+    // Only the withdrawal scores are copied under cs_main, the scenarios are
+    // simulated without holding it
+    std::unique_ptr<SidechainWithdrawalSim> sim;
+    {
+        LOCK(cs_main);
+        sim.reset(new SidechainWithdrawalSim(scdb.GetState(), chainActive.Height()));
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (const std::map<uint8_t, SidechainVoteStrategy>& mapStrategy : vScenario) {
+        std::vector<SidechainWithdrawalProjection> vProjection = sim->Run(mapStrategy, nBlocks);
+
+        UniValue arr(UniValue::VARR);
+        for (const SidechainWithdrawalProjection& p : vProjection) {
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("nsidechain", p.nSidechain));
+            obj.push_back(Pair("hash", p.hash.ToString()));
+            if (p.status == SidechainWithdrawalProjection::APPROVED)
+                obj.push_back(Pair("status", "approved"));
+            else
+            if (p.status == SidechainWithdrawalProjection::EXPIRED)
+                obj.push_back(Pair("status", "expired"));
+            else
+                obj.push_back(Pair("status", "pending"));
+            if (p.status != SidechainWithdrawalProjection::PENDING)
+                obj.push_back(Pair("height", p.nHeight));
+            obj.push_back(Pair("nblocksleft", p.nBlocksLeft));
+            obj.push_back(Pair("nworkscore", p.nWorkScore));
+            arr.push_back(obj);
+        }
+        ret.push_back(arr);
+    }
+
+    return ret;
+}
+
 UniValue listcachedwithdrawaltx(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -2308,6 +2436,7 @@ static const CRPCCommand commands[] =
     { "Drivechain",  "havefailedwithdrawal",          &havefailedwithdrawal,            {"hashwithdrawal", "nsidechain"}},
     { "Drivechain",  "listcachedwithdrawaltx",        &listcachedwithdrawaltx,          {"nsidechain"}},
     { "Drivechain",  "listwithdrawalstatus",          &listwithdrawalstatus,            {"nsidechain"}},
+    { "Drivechain",  "simulatewithdrawalvotes",       &simulatewithdrawalvotes,         {"scenarios", "nblocks"}},
     { "Drivechain",  "listspentwithdrawals",          &listspentwithdrawals,            {}},
     { "Drivechain",  "listfailedwithdrawals",         &listfailedwithdrawals,           {}},
     { "Drivechain",  "gettotalscdbhash",              &gettotalscdbhash,                {}},
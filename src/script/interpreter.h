@@ -120,7 +120,11 @@ struct PrecomputedTransactionData
     uint256 hashPrevouts, hashSequence, hashOutputs;
     bool ready = false;
 
-    explicit PrecomputedTransactionData(const CTransaction& tx);
+    /**
+     * Validation only computes the cache for transactions with witness.
+     * Signers compute it with fForce, before the transaction has any.
+     */
+    explicit PrecomputedTransactionData(const CTransaction& tx, bool fForce = false);
 };
 
 enum SigVersion
@@ -11,11 +11,14 @@
 #include <primitives/transaction.h>
 #include <script/standard.h>
 #include <uint256.h>
+#include <util.h>
 
 
 typedef std::vector<unsigned char> valtype;
 
-TransactionSignatureCreator::TransactionSignatureCreator(const CKeyStore* keystoreIn, const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, int nHashTypeIn) : BaseSignatureCreator(keystoreIn), txTo(txToIn), nIn(nInIn), nHashType(nHashTypeIn), amount(amountIn), checker(txTo, nIn, amountIn) {}
+TransactionSignatureCreator::TransactionSignatureCreator(const CKeyStore* keystoreIn, const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, int nHashTypeIn) : BaseSignatureCreator(keystoreIn), txTo(txToIn), nIn(nInIn), nHashType(nHashTypeIn), amount(amountIn), txdata(nullptr), checker(txTo, nIn, amountIn) {}
+
+TransactionSignatureCreator::TransactionSignatureCreator(const CKeyStore* keystoreIn, const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, const PrecomputedTransactionData& txdataIn, int nHashTypeIn) : BaseSignatureCreator(keystoreIn), txTo(txToIn), nIn(nInIn), nHashType(nHashTypeIn), amount(amountIn), txdata(&txdataIn), checker(txTo, nIn, amountIn, txdataIn) {}
 
 bool TransactionSignatureCreator::CreateSig(std::vector<unsigned char>& vchSig, const CKeyID& address, const CScript& scriptCode, SigVersion sigversion) const
 {
@@ -27,7 +30,7 @@ bool TransactionSignatureCreator::CreateSig(std::vector<unsigned char>& vchSig,
     if (sigversion == SIGVERSION_WITNESS_V0 && !key.IsCompressed())
         return false;
 
-    uint256 hash = SignatureHash(scriptCode, *txTo, nIn, nHashType, amount, sigversion);
+    uint256 hash = SignatureHash(scriptCode, *txTo, nIn, nHashType, amount, sigversion, txdata);
     if (!key.Sign(hash, vchSig))
         return false;
     vchSig.push_back((unsigned char)nHashType);
@@ -226,6 +229,32 @@ bool SignSignature(const CKeyStore &keystore, const CTransaction& txFrom, CMutab
     return SignSignature(keystore, txout.scriptPubKey, txTo, nIn, txout.nValue, nHashType);
 }
 
+bool SignTransactionInputs(const CKeyStore& keystore, CMutableTransaction& mtx, const std::vector<CTxOut>& vSpent, int nMaxThreads, int nHashType)
+{
+    assert(vSpent.size() <= mtx.vin.size());
+
+    // The signature hashes of the inputs don't cover the signatures of the
+    // others, so they can all be computed from the unsigned transaction
+    const CTransaction txToSign(mtx);
+    const PrecomputedTransactionData txdata(txToSign, true);
+
+    std::vector<SignatureData> vSigData(vSpent.size());
+    std::vector<char> vSigned(vSpent.size(), false);
+    ParallelFor(vSpent.size(), nMaxThreads, [&](size_t nIn) {
+        TransactionSignatureCreator creator(&keystore, &txToSign, nIn, vSpent[nIn].nValue, txdata, nHashType);
+        vSigned[nIn] = ProduceSignature(creator, vSpent[nIn].scriptPubKey, vSigData[nIn]);
+    });
+
+    bool fSigned = true;
+    for (size_t nIn = 0; nIn < vSpent.size(); nIn++) {
+        if (vSigned[nIn])
+            UpdateTransaction(mtx, nIn, vSigData[nIn]);
+        else
+            fSigned = false;
+    }
+    return fSigned;
+}
+
 static std::vector<valtype> CombineMultisig(const CScript& scriptPubKey, const BaseSignatureChecker& checker,
                                const std::vector<valtype>& vSolutions,
                                const std::vector<valtype>& sigs1, const std::vector<valtype>& sigs2, SigVersion sigversion)
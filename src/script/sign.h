@@ -12,6 +12,7 @@ class CKeyID;
 class CKeyStore;
 class CScript;
 class CTransaction;
+class CTxOut;
 
 struct CMutableTransaction;
 
@@ -36,10 +37,13 @@ class TransactionSignatureCreator : public BaseSignatureCreator {
     unsigned int nIn;
     int nHashType;
     CAmount amount;
+    const PrecomputedTransactionData* txdata;
     const TransactionSignatureChecker checker;
 
 public:
     TransactionSignatureCreator(const CKeyStore* keystoreIn, const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, int nHashTypeIn=SIGHASH_ALL);
+    /** Sign with the signature hash cache txdataIn of txToIn, which has to outlive the creator */
+    TransactionSignatureCreator(const CKeyStore* keystoreIn, const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, const PrecomputedTransactionData& txdataIn, int nHashTypeIn=SIGHASH_ALL);
     const BaseSignatureChecker& Checker() const override { return checker; }
     bool CreateSig(std::vector<unsigned char>& vchSig, const CKeyID& keyid, const CScript& scriptCode, SigVersion sigversion) const override;
 };
@@ -70,6 +74,14 @@ struct SignatureData {
 /** Produce a script signature using a generic signature creator. */
 bool ProduceSignature(const BaseSignatureCreator& creator, const CScript& scriptPubKey, SignatureData& sigdata);
 
+/**
+ * Sign the first vSpent.size() inputs of a transaction, which spend the
+ * outputs in vSpent, and leave the inputs after them as they are. The inputs
+ * share one signature hash cache and are signed on up to nMaxThreads
+ * threads. Returns false if any of them couldn't be signed.
+ */
+bool SignTransactionInputs(const CKeyStore& keystore, CMutableTransaction& mtx, const std::vector<CTxOut>& vSpent, int nMaxThreads = 1, int nHashType = SIGHASH_ALL);
+
 /** Produce a script signature for a transaction. */
 bool SignSignature(const CKeyStore &keystore, const CScript& fromPubKey, CMutableTransaction& txTo, unsigned int nIn, const CAmount& amount, int nHashType);
 bool SignSignature(const CKeyStore& keystore, const CTransaction& txFrom, CMutableTransaction& txTo, unsigned int nIn, int nHashType);
@@ -206,6 +206,42 @@ struct SidechainFailedWithdrawal {
     }
 };
 
+/**
+ * The outputs of a withdrawal bundle as the sidechain created them, which is
+ * every output except the sidechain change return added by the miner paying
+ * the bundle out. These are covered by the blind hash, so the result of
+ * parsing them is cached by SCDB with the blind hash as the key.
+ */
+struct SidechainBundleInfo {
+    //! Status of the first OP_RETURN output, which must encode SIDECHAIN_WITHDRAWAL_RETURN_DEST
+    enum ReturnDestStatus : uint8_t {
+        DEST_NOT_FOUND = 0,
+        DEST_VALID,
+        DEST_TOO_SMALL,
+        DEST_GETOP_FAILED,
+        DEST_INCORRECT,
+    };
+
+    uint256 hash;
+    ReturnDestStatus destStatus = DEST_NOT_FOUND;
+
+    //! Sum of withdrawal fees encoded in the second output
+    bool fFeesValid = false;
+    CAmount amountFees = 0;
+
+    //! Total value of the outputs, and how much of it is paid to sidechains
+    CAmount amountOut = 0;
+    CAmount amountSidechainOut = 0;
+
+    //! Number of sidechain outputs, and the index & sidechain of the first one
+    uint32_t nSidechainOutputs = 0;
+    uint32_t nFirstSidechainOutput = 0;
+    uint8_t nFirstSidechain = 0;
+
+    //! Whether the raw bundle is in SCDB's withdrawal transaction cache
+    bool fTxCached = false;
+};
+
 struct SidechainCTIP {
     COutPoint out;
     CAmount amount;
@@ -16,6 +16,30 @@
 #include <util.h>
 #include <utilstrencodings.h>
 
+/** Check the first OP_RETURN output of a withdrawal bundle, which must encode
+ * SIDECHAIN_WITHDRAWAL_RETURN_DEST. Returns DEST_NOT_FOUND if script is not
+ * an OP_RETURN script. */
+static SidechainBundleInfo::ReturnDestStatus CheckWithdrawalReturnDest(const CScript& scriptPubKey)
+{
+    if (!scriptPubKey.size() || scriptPubKey.front() != OP_RETURN)
+        return SidechainBundleInfo::DEST_NOT_FOUND;
+
+    if (scriptPubKey.size() < 3)
+        return SidechainBundleInfo::DEST_TOO_SMALL;
+
+    CScript::const_iterator pDest = scriptPubKey.begin() + 1;
+    opcodetype opcode;
+    std::vector<unsigned char> vch;
+    if (!scriptPubKey.GetOp(pDest, opcode, vch) || vch.empty())
+        return SidechainBundleInfo::DEST_GETOP_FAILED;
+
+    std::string strDest((const char*)vch.data(), vch.size());
+    if (strDest != SIDECHAIN_WITHDRAWAL_RETURN_DEST)
+        return SidechainBundleInfo::DEST_INCORRECT;
+
+    return SidechainBundleInfo::DEST_VALID;
+}
+
 SidechainDB::SidechainDB()
 {
     Reset();
@@ -215,6 +239,10 @@ bool SidechainDB::CacheWithdrawalTx(const CTransaction& tx, uint8_t nSidechain)
 
     vWithdrawalTxCache.push_back(std::make_pair(nSidechain, tx));
 
+    // The bundle outputs are parsed here so that every later check of this
+    // bundle can use the cached result.
+    CacheBundleInfo(tx.GetHash(), tx.vout, tx.vout.size()).fTxCached = true;
+
     return true;
 }
 
@@ -325,6 +353,38 @@ bool SidechainDB::GetCachedWithdrawalTx(const uint256& hash, CMutableTransaction
     return false;
 }
 
+bool SidechainDB::GetBlindHash(const CTransaction& tx, uint256& hashBlind)
+{
+    std::map<uint256, uint256>::const_iterator it = mapBundleBlindHash.find(tx.GetHash());
+    if (it != mapBundleBlindHash.end()) {
+        hashBlind = it->second;
+        return true;
+    }
+
+    if (!tx.GetBlindHash(hashBlind))
+        return false;
+
+    mapBundleBlindHash[tx.GetHash()] = hashBlind;
+
+    return true;
+}
+
+SidechainBundleInfo SidechainDB::GetBundleInfo(const CTransaction& tx)
+{
+    return CacheBundleInfo(tx.GetHash(), tx.vout, tx.vout.size());
+}
+
+bool SidechainDB::GetBundleInfo(const uint256& hashBlind, SidechainBundleInfo& info) const
+{
+    std::map<uint256, SidechainBundleInfo>::const_iterator it = mapBundleInfo.find(hashBlind);
+    if (it == mapBundleInfo.end())
+        return false;
+
+    info = it->second;
+
+    return true;
+}
+
 std::map<uint8_t, SidechainCTIP> SidechainDB::GetCTIP() const
 {
     return mapCTIP;
@@ -574,11 +634,11 @@ bool SidechainDB::HaveFailedWithdrawal(const uint256& hash, const uint8_t nSidec
 
 bool SidechainDB::HaveWithdrawalTxCached(const uint256& hash) const
 {
-    for (const std::pair<uint8_t, CMutableTransaction>& pair : vWithdrawalTxCache) {
-        if (pair.second.GetHash() == hash)
-            return true;
-    }
-    return false;
+    std::map<uint256, SidechainBundleInfo>::const_iterator it = mapBundleInfo.find(hash);
+    if (it == mapBundleInfo.end())
+        return false;
+
+    return it->second.fTxCached;
 }
 
 bool SidechainDB::HaveWorkScore(const uint256& hash, uint8_t nSidechain) const
@@ -637,12 +697,16 @@ void SidechainDB::RemoveExpiredWithdrawals()
                             AddFailedWithdrawals(std::vector<SidechainFailedWithdrawal>{ failed });
 
                             // Remove the cached transaction for the failed Withdrawal
-                            for (size_t i = 0; i < vWithdrawalTxCache.size(); i++) {
-                                if (vWithdrawalTxCache[i].second.GetHash() == state.hash) {
-                                    vWithdrawalTxCache[i] = vWithdrawalTxCache.back();
-                                    vWithdrawalTxCache.pop_back();
-                                    break;
+                            std::map<uint256, SidechainBundleInfo>::iterator it = mapBundleInfo.find(state.hash);
+                            if (it != mapBundleInfo.end() && it->second.fTxCached) {
+                                for (size_t i = 0; i < vWithdrawalTxCache.size(); i++) {
+                                    if (vWithdrawalTxCache[i].second.GetHash() == state.hash) {
+                                        vWithdrawalTxCache[i] = vWithdrawalTxCache.back();
+                                        vWithdrawalTxCache.pop_back();
+                                        break;
+                                    }
                                 }
+                                it->second.fTxCached = false;
                             }
                             return true;
                         } else {
@@ -704,6 +768,10 @@ void SidechainDB::Reset()
     // Clear out cached Withdrawal serializations
     vWithdrawalTxCache.clear();
 
+    // Clear out parsed Withdrawal bundles
+    mapBundleInfo.clear();
+    mapBundleBlindHash.clear();
+
     // Clear out Withdrawal state
     ResetWithdrawalState();
 
@@ -755,7 +823,7 @@ bool SidechainDB::SpendWithdrawal(uint8_t nSidechain, const uint256& hashBlock,
     }
 
     uint256 hashBlind;
-    if (!tx.GetBlindHash(hashBlind)) {
+    if (!GetBlindHash(tx, hashBlind)) {
         if (fDebug) {
             LogPrintf("SCDB %s: Cannot spend Withdrawal (txid): %s for sidechain number: %u.\n Cannot get blind hash.\n",
                 __func__,
@@ -775,89 +843,72 @@ bool SidechainDB::SpendWithdrawal(uint8_t nSidechain, const uint256& hashBlock,
         return false;
     }
 
-    // Find the required change output returning to the sidechain script as well
-    // as the required SIDECHAIN_WITHDRAWAL_RETURN_DEST OP_RETURN output.
-    bool fChangeOutputFound = false;
-    bool fReturnDestFound = false;
-    uint32_t nBurnIndex = 0;
-    uint8_t nSidechainScript;
-    CAmount amountChange = 0;
-    for (size_t i = 0; i < tx.vout.size(); i++) {
-        const CScript &scriptPubKey = tx.vout[i].scriptPubKey;
-
-        // This would be non-standard but still checking
-        if (!scriptPubKey.size())
-            continue;
-
-        // The first OP_RETURN output we find must be an encoding of the
-        // SIDECHAIN_WITHDRAWAL_RETURN_DEST char. So once we find an OP_RETURN in
-        // this loop it must have the correct data encoded. We will return false
-        // if it does not and skip this code if we've already found it.
-        // Is this the SIDECHAIN_WITHDRAWAL_RETURN_DEST OP_RETURN output?
-        if (!fReturnDestFound && scriptPubKey.front() == OP_RETURN) {
-            if (scriptPubKey.size() < 3) {
-                if (fDebug) {
-                    LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. First OP_RETURN output is invalid size for destination. (too small)\n",
-                        __func__,
-                        hashBlind.ToString(),
-                        nSidechain);
-                }
-                return false;
-            }
-
-            CScript::const_iterator pDest = scriptPubKey.begin() + 1;
-            opcodetype opcode;
-            std::vector<unsigned char> vch;
-            if (!scriptPubKey.GetOp(pDest, opcode, vch) || vch.empty()) {
-                if (fDebug) {
-                    LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. First OP_RETURN output is invalid. (GetOp failed)\n",
-                        __func__,
-                        hashBlind.ToString(),
-                        nSidechain);
-                }
-                return false;
-            }
+    // Every output except the final one was created by the sidechain and is
+    // covered by the blind hash, so those are only parsed once per bundle.
+    // The final output is checked in the same way here.
+    const SidechainBundleInfo& info = CacheBundleInfo(hashBlind, tx.vout, tx.vout.size() - 1);
+    const CTxOut& outFinal = tx.vout.back();
 
-            std::string strDest((const char*)vch.data(), vch.size());
+    // The first OP_RETURN output we find must be an encoding of the
+    // SIDECHAIN_WITHDRAWAL_RETURN_DEST char.
+    SidechainBundleInfo::ReturnDestStatus destStatus = info.destStatus;
+    if (destStatus == SidechainBundleInfo::DEST_NOT_FOUND)
+        destStatus = CheckWithdrawalReturnDest(outFinal.scriptPubKey);
 
-            if (strDest != SIDECHAIN_WITHDRAWAL_RETURN_DEST) {
-                if (fDebug) {
-                    LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. Missing SIDECHAIN_WITHDRAWAL_RETURN_DEST output.\n",
-                        __func__,
-                        hashBlind.ToString(),
-                        nSidechain);
-                }
-                return false;
-            }
-            fReturnDestFound = true;
+    if (destStatus == SidechainBundleInfo::DEST_TOO_SMALL) {
+        if (fDebug) {
+            LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. First OP_RETURN output is invalid size for destination. (too small)\n",
+                __func__,
+                hashBlind.ToString(),
+                nSidechain);
         }
+        return false;
+    }
+    if (destStatus == SidechainBundleInfo::DEST_GETOP_FAILED) {
+        if (fDebug) {
+            LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. First OP_RETURN output is invalid. (GetOp failed)\n",
+                __func__,
+                hashBlind.ToString(),
+                nSidechain);
+        }
+        return false;
+    }
+    if (destStatus == SidechainBundleInfo::DEST_INCORRECT) {
+        if (fDebug) {
+            LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. Missing SIDECHAIN_WITHDRAWAL_RETURN_DEST output.\n",
+                __func__,
+                hashBlind.ToString(),
+                nSidechain);
+        }
+        return false;
+    }
 
-        if (scriptPubKey.IsDrivechain(nSidechainScript)) {
-            if (fChangeOutputFound) {
-                // We already found a sidechain script output. This second
-                // sidechain output makes the Withdrawal invalid.
-                if (fDebug) {
-                    LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. Multiple sidechain return outputs in Withdrawal.\n",
-                        __func__,
-                        hashBlind.ToString(),
-                        nSidechain);
-                }
-                return false;
-            }
-
-            // Copy output index of sidechain change return deposit
-            nBurnIndex = i;
-            fChangeOutputFound = true;
-
-            // Copy amount of sidechain change
-            amountChange = tx.vout[i].nValue;
+    // Find the required change output returning to the sidechain script
+    uint32_t nSidechainOutputs = info.nSidechainOutputs;
+    uint32_t nBurnIndex = info.nFirstSidechainOutput;
+    uint8_t nSidechainScript = info.nFirstSidechain;
+    uint8_t nSidechainFinal;
+    if (outFinal.scriptPubKey.IsDrivechain(nSidechainFinal)) {
+        if (!nSidechainOutputs) {
+            nBurnIndex = tx.vout.size() - 1;
+            nSidechainScript = nSidechainFinal;
+        }
+        nSidechainOutputs++;
+    }
 
-            continue;
+    if (nSidechainOutputs > 1) {
+        // A second sidechain output makes the Withdrawal invalid.
+        if (fDebug) {
+            LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. Multiple sidechain return outputs in Withdrawal.\n",
+                __func__,
+                hashBlind.ToString(),
+                nSidechain);
         }
+        return false;
     }
 
     // Make sure that the sidechain output was found
-    if (!fChangeOutputFound) {
+    if (!nSidechainOutputs) {
         if (fDebug) {
             LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. No sidechain return output in Withdrawal.\n",
                 __func__,
@@ -867,6 +918,9 @@ bool SidechainDB::SpendWithdrawal(uint8_t nSidechain, const uint256& hashBlock,
         return false;
     }
 
+    // Copy amount of sidechain change
+    CAmount amountChange = tx.vout[nBurnIndex].nValue;
+
     // Make sure that the sidechain output is to the correct sidechain
     if (nSidechainScript != nSidechain) {
         if (fDebug) {
@@ -912,9 +966,8 @@ bool SidechainDB::SpendWithdrawal(uint8_t nSidechain, const uint256& hashBlock,
        return false;
     }
 
-    // Decode sum of withdrawal fees
-    CAmount amountFees = 0;
-    if (!DecodeWithdrawalFees(tx.vout[1].scriptPubKey, amountFees)) {
+    // Sum of withdrawal fees
+    if (!info.fFeesValid) {
         if (fDebug) {
             LogPrintf("SCDB %s: Cannot spend Withdrawal: %s for sidechain number: %u. failed to decode withdrawal fees!\n",
                 __func__,
@@ -924,11 +977,13 @@ bool SidechainDB::SpendWithdrawal(uint8_t nSidechain, const uint256& hashBlock,
        return false;
     }
 
+    CAmount amountFees = info.amountFees;
+
     // Get the total value out of the blind Withdrawal
-    CAmount amountBlind = tx.GetBlindValueOut();
+    CAmount amountBlind = info.amountOut;
 
     CAmount amountInput = ctip.amount;
-    CAmount amountOutput = tx.GetValueOut();
+    CAmount amountOutput = amountBlind + outFinal.nValue;
 
     // Check output amount
     if (amountBlind != amountOutput - amountChange) {
@@ -976,12 +1031,15 @@ bool SidechainDB::SpendWithdrawal(uint8_t nSidechain, const uint256& hashBlock,
     // until the miner manually clears them out with an RPC command or similar.
     //
     // Find the cached transaction for the Withdrawal we spent and remove it
-    for (size_t i = 0; i < vWithdrawalTxCache.size(); i++) {
-        if (vWithdrawalTxCache[i].second.GetHash() == hashBlind) {
-            vWithdrawalTxCache[i] = vWithdrawalTxCache.back();
-            vWithdrawalTxCache.pop_back();
-            break;
+    if (info.fTxCached) {
+        for (size_t i = 0; i < vWithdrawalTxCache.size(); i++) {
+            if (vWithdrawalTxCache[i].second.GetHash() == hashBlind) {
+                vWithdrawalTxCache[i] = vWithdrawalTxCache.back();
+                vWithdrawalTxCache.pop_back();
+                break;
+            }
         }
+        mapBundleInfo[hashBlind].fTxCached = false;
     }
 
     SidechainSpentWithdrawal spent;
@@ -1126,11 +1184,16 @@ bool SidechainDB::Update(int nHeight, const uint256& hashBlock, const uint256& h
 {
     // Make a copy of SCDB to test update
     SidechainDB scdbCopy = (*this);
-    if (scdbCopy.ApplyUpdate(nHeight, hashBlock, hashPrevBlock, vout, fJustCheck, fDebug)) {
-        return ApplyUpdate(nHeight, hashBlock, hashPrevBlock, vout, fJustCheck, fDebug);
-    } else {
+    if (!scdbCopy.ApplyUpdate(nHeight, hashBlock, hashPrevBlock, vout, fJustCheck, fDebug))
         return false;
-    }
+
+    if (!ApplyUpdate(nHeight, hashBlock, hashPrevBlock, vout, fJustCheck, fDebug))
+        return false;
+
+    if (!fJustCheck)
+        PruneBundleCache();
+
+    return true;
 }
 
 bool SidechainDB::ApplyUpdate(int nHeight, const uint256& hashBlock, const uint256& hashPrevBlock, const std::vector<CTxOut>& vout, bool fJustCheck, bool fDebug)
@@ -1569,6 +1632,44 @@ bool SidechainDB::UpdateSCDBIndex(const std::vector<std::string>& vVote, bool fD
     return true;
 }
 
+SidechainBundleInfo& SidechainDB::CacheBundleInfo(const uint256& hashBlind, const std::vector<CTxOut>& vout, size_t nOutputs)
+{
+    std::map<uint256, SidechainBundleInfo>::iterator it = mapBundleInfo.find(hashBlind);
+    if (it != mapBundleInfo.end())
+        return it->second;
+
+    SidechainBundleInfo& info = mapBundleInfo[hashBlind];
+    info.hash = hashBlind;
+    ParseWithdrawalBundle(vout, nOutputs, info);
+
+    return info;
+}
+
+void SidechainDB::PruneBundleCache()
+{
+    std::set<uint256> setTracked;
+    for (const std::vector<SidechainWithdrawalState>& vState : vWithdrawalStatus) {
+        for (const SidechainWithdrawalState& state : vState)
+            setTracked.insert(state.hash);
+    }
+
+    // Keep bundles that are still being voted on or are waiting to be
+    // committed by this node
+    for (auto it = mapBundleInfo.begin(); it != mapBundleInfo.end(); ) {
+        if (it->second.fTxCached || setTracked.count(it->first))
+            it++;
+        else
+            it = mapBundleInfo.erase(it);
+    }
+
+    for (auto it = mapBundleBlindHash.begin(); it != mapBundleBlindHash.end(); ) {
+        if (mapBundleInfo.count(it->second))
+            it++;
+        else
+            it = mapBundleBlindHash.erase(it);
+    }
+}
+
 void SidechainDB::ApplyDefaultUpdate()
 {
     if (!HasState())
@@ -1799,6 +1900,33 @@ bool DecodeWithdrawalFees(const CScript& script, CAmount& amount)
     return true;
 }
 
+void ParseWithdrawalBundle(const std::vector<CTxOut>& vout, size_t nOutputs, SidechainBundleInfo& info)
+{
+    nOutputs = std::min(nOutputs, vout.size());
+    for (size_t i = 0; i < nOutputs; i++) {
+        const CScript& scriptPubKey = vout[i].scriptPubKey;
+
+        info.amountOut += vout[i].nValue;
+
+        if (info.destStatus == SidechainBundleInfo::DEST_NOT_FOUND)
+            info.destStatus = CheckWithdrawalReturnDest(scriptPubKey);
+
+        uint8_t nSidechain;
+        if (scriptPubKey.IsDrivechain(nSidechain)) {
+            if (!info.nSidechainOutputs) {
+                info.nFirstSidechainOutput = i;
+                info.nFirstSidechain = nSidechain;
+            }
+            info.nSidechainOutputs++;
+            info.amountSidechainOut += vout[i].nValue;
+        }
+    }
+
+    // The second output encodes the sum of withdrawal fees
+    if (nOutputs >= 2)
+        info.fFeesValid = DecodeWithdrawalFees(vout[1].scriptPubKey, info.amountFees);
+}
+
 bool SortDeposits(const std::vector<SidechainDeposit>& vDeposit, std::vector<SidechainDeposit>& vDepositSorted)
 {
     if (vDeposit.empty())
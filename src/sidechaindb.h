@@ -25,6 +25,7 @@ class uint256;
 struct Sidechain;
 struct SidechainActivationStatus;
 struct SidechainBlockData;
+struct SidechainBundleInfo;
 struct SidechainCTIP;
 struct SidechainDeposit;
 struct SidechainWithdrawalState;
@@ -96,6 +97,17 @@ public:
     /** Get list of all sidechains */
     std::vector<Sidechain> GetSidechains() const;
 
+    /** Get the blind hash of a withdrawal bundle payout. Remembered by txid
+     * as SpendWithdrawal is called more than once for each payout. */
+    bool GetBlindHash(const CTransaction& tx, uint256& hashBlind);
+
+    /** Return the parsed outputs of a bundle received from a sidechain, which
+     * does not have a change return yet. Parsed the first time it is seen. */
+    SidechainBundleInfo GetBundleInfo(const CTransaction& tx);
+
+    /** Look up the parsed outputs of a cached bundle by blind hash */
+    bool GetBundleInfo(const uint256& hashBlind, SidechainBundleInfo& info) const;
+
     /** Get list of BMM txid that miner removed from the mempool. */
     std::set<uint256> GetRemovedBMM() const;
 
@@ -233,6 +245,12 @@ private:
     /** Apply the changes in a block to SCDB */
     bool ApplyUpdate(int nHeight, const uint256& hashBlock, const uint256& hashPrevBlock, const std::vector<CTxOut>& vout, bool fJustCheck = false, bool fDebug = false);
 
+    /** Parse & cache the first nOutputs of vout as the outputs of hashBlind */
+    SidechainBundleInfo& CacheBundleInfo(const uint256& hashBlind, const std::vector<CTxOut>& vout, size_t nOutputs);
+
+    /** Drop parsed bundles that SCDB is no longer tracking */
+    void PruneBundleCache();
+
     /** Takes a list of sidechain hashes to upvote */
     void UpdateActivationStatus(const std::vector<uint256>& vHash);
 
@@ -277,6 +295,12 @@ private:
      * TODO consider refactoring to use CTransactionRef */
     std::vector<std::pair<uint8_t, CMutableTransaction>> vWithdrawalTxCache;
 
+    /** Parsed withdrawal bundle outputs. Key: blind hash */
+    std::map<uint256, SidechainBundleInfo> mapBundleInfo;
+
+    /** Blind hash of withdrawal bundle payouts. Key: txid */
+    std::map<uint256, uint256> mapBundleBlindHash;
+
     /** Tracks verification status of withdrawals
      * x = nSidechain
      * y = state of withdrawals for nSidechain */
@@ -305,6 +329,9 @@ private:
 /** Read encoded sum of withdrawal fees output script */
 bool DecodeWithdrawalFees(const CScript& script, CAmount& amount);
 
+/** Parse the first nOutputs of a withdrawal bundle */
+void ParseWithdrawalBundle(const std::vector<CTxOut>& vout, size_t nOutputs, SidechainBundleInfo& info);
+
 /** Sort deposits by CTIP UTXO spending order */
 bool SortDeposits(const std::vector<SidechainDeposit>& vDeposit, std::vector<SidechainDeposit>& vDepositSorted);
 
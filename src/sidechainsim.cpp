@@ -0,0 +1,127 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <sidechainsim.h>
+
+#include <algorithm>
+
+SidechainWithdrawalSim::SidechainWithdrawalSim(const std::vector<std::vector<SidechainWithdrawalState>>& vState, int nHeightIn)
+{
+    nHeight = nHeightIn;
+    for (const std::vector<SidechainWithdrawalState>& v : vState) {
+        for (const SidechainWithdrawalState& state : v) {
+            Withdrawal w;
+            w.nSidechain = state.nSidechain;
+            w.nBlocksLeft = state.nBlocksLeft;
+            w.nWorkScore = state.nWorkScore;
+            w.hash = state.hash;
+            vWithdrawal.push_back(w);
+        }
+    }
+}
+
+namespace {
+
+//! Blocks after which every vote strategy repeats, see IsVoting
+static const int VOTE_PERIOD = 100;
+
+//! Whether a strategy casting its vote in nPercent of blocks votes in nBlock
+inline bool IsVoting(int nBlock, unsigned int nPercent)
+{
+    return ((nBlock + 1) * nPercent) / VOTE_PERIOD != (nBlock * nPercent) / VOTE_PERIOD;
+}
+
+} // namespace
+
+std::vector<SidechainWithdrawalProjection> SidechainWithdrawalSim::Run(const std::map<uint8_t, SidechainVoteStrategy>& mapStrategy, int nBlocks) const
+{
+    std::vector<SidechainWithdrawalProjection> vProjection(vWithdrawal.size());
+
+    for (size_t i = 0; i < vWithdrawal.size(); i++) {
+        const Withdrawal& w = vWithdrawal[i];
+
+        SidechainWithdrawalProjection& projection = vProjection[i];
+        projection.nSidechain = w.nSidechain;
+        projection.hash = w.hash;
+
+        // The score change in blocks which vote and the share of those blocks
+        int nDelta = 0;
+        unsigned int nPercent = 0;
+        std::map<uint8_t, SidechainVoteStrategy>::const_iterator it = mapStrategy.find(w.nSidechain);
+        if (it != mapStrategy.end() && it->second.vote != SidechainVoteStrategy::ABSTAIN) {
+            const SidechainVoteStrategy& strategy = it->second;
+            if (strategy.vote == SidechainVoteStrategy::UPVOTE && strategy.hash == w.hash)
+                nDelta = 1;
+            else
+                nDelta = -1;
+            nPercent = std::min(strategy.nPercent, (unsigned int)VOTE_PERIOD);
+        }
+
+        int nBlocksLeft = w.nBlocksLeft;
+        int nWorkScore = w.nWorkScore;
+
+        // Already approved, can be paid out in the next block
+        if (nWorkScore >= SIDECHAIN_WITHDRAWAL_MIN_WORKSCORE)
+            projection.status = SidechainWithdrawalProjection::APPROVED;
+
+        int nBlock = 0;
+        while (nBlock < nBlocks && projection.status == SidechainWithdrawalProjection::PENDING) {
+            // Each VOTE_PERIOD blocks from the start of the simulation cast
+            // the vote exactly nPercent times. Work scores only change in one
+            // direction and the gap between the work score needed and the
+            // blocks left never shrinks, so if the withdrawal is neither
+            // approved nor expired at the end of the period it wasn't in any
+            // block of the period either and the whole period can be skipped.
+            if (nBlock % VOTE_PERIOD == 0 && nBlocks - nBlock >= VOTE_PERIOD && nBlocksLeft >= VOTE_PERIOD) {
+                int nWorkScoreEnd = nWorkScore;
+                if (nDelta > 0)
+                    nWorkScoreEnd = std::min(nWorkScore + (int)nPercent, 65535);
+                else
+                if (nDelta < 0)
+                    nWorkScoreEnd = std::max(nWorkScore - (int)nPercent, 0);
+
+                int nBlocksLeftEnd = nBlocksLeft - VOTE_PERIOD;
+                if (nWorkScoreEnd < SIDECHAIN_WITHDRAWAL_MIN_WORKSCORE &&
+                        SIDECHAIN_WITHDRAWAL_MIN_WORKSCORE - nWorkScoreEnd <= nBlocksLeftEnd) {
+                    nWorkScore = nWorkScoreEnd;
+                    nBlocksLeft = nBlocksLeftEnd;
+                    nBlock += VOTE_PERIOD;
+                    continue;
+                }
+            }
+
+            // Same order as UpdateSCDBIndex: remove expired withdrawals, age
+            // the rest and then apply the votes of this block
+            const int nBlockHeight = nHeight + nBlock + 1;
+            if (nBlocksLeft == 0 || SIDECHAIN_WITHDRAWAL_MIN_WORKSCORE - nWorkScore > nBlocksLeft) {
+                projection.status = SidechainWithdrawalProjection::EXPIRED;
+                projection.nHeight = nBlockHeight;
+                break;
+            }
+
+            nBlocksLeft--;
+            if (nDelta && IsVoting(nBlock, nPercent)) {
+                if (nDelta > 0 && nWorkScore < 65535)
+                    nWorkScore++;
+                else
+                if (nDelta < 0 && nWorkScore > 0)
+                    nWorkScore--;
+            }
+            nBlock++;
+
+            // Withdrawals are approved after the block at nBlockHeight is
+            // connected and can be paid out by the next one
+            if (nWorkScore >= SIDECHAIN_WITHDRAWAL_MIN_WORKSCORE)
+                projection.status = SidechainWithdrawalProjection::APPROVED;
+        }
+
+        if (projection.status == SidechainWithdrawalProjection::APPROVED)
+            projection.nHeight = nHeight + nBlock + 1;
+
+        projection.nWorkScore = nWorkScore;
+        projection.nBlocksLeft = nBlocksLeft;
+    }
+
+    return vProjection;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SIDECHAINSIM_H
+#define BITCOIN_SIDECHAINSIM_H
+
+#include <sidechain.h>
+#include <uint256.h>
+
+#include <map>
+#include <vector>
+
+/** How miners vote on the withdrawals of one sidechain in a simulation */
+struct SidechainVoteStrategy
+{
+    enum VoteType : uint8_t {
+        ABSTAIN = 0,
+        UPVOTE,
+        DOWNVOTE,
+    };
+
+    VoteType vote = ABSTAIN;
+
+    //! The withdrawal to upvote, every other withdrawal is downvoted
+    uint256 hash;
+
+    //! Percentage of blocks which cast the vote, the rest abstain
+    unsigned int nPercent = 100;
+};
+
+/** The projected outcome of a withdrawal at the end of a simulation */
+struct SidechainWithdrawalProjection
+{
+    enum Status : uint8_t {
+        PENDING = 0,
+        APPROVED,
+        EXPIRED,
+    };
+
+    uint8_t nSidechain = 0;
+    uint256 hash;
+    Status status = PENDING;
+
+    //! Work score and blocks left when approved, expired or the simulation ended
+    uint16_t nWorkScore = 0;
+    uint16_t nBlocksLeft = 0;
+
+    //! First height the withdrawal can be paid out at if APPROVED, or the
+    //! height it is removed at if EXPIRED
+    int nHeight = -1;
+};
+
+/**
+ * Projects withdrawal work scores into the future by applying the same score
+ * changes as SidechainDB::UpdateSCDBIndex for each simulated block. Only the
+ * scores and blocks remaining are copied out of SCDB, so many vote strategies
+ * can be simulated against one snapshot without holding cs_main. New
+ * withdrawals which may be added during the simulated blocks are ignored.
+ */
+class SidechainWithdrawalSim
+{
+public:
+    /** Snapshot the withdrawal state of SCDB after the block at nHeight */
+    SidechainWithdrawalSim(const std::vector<std::vector<SidechainWithdrawalState>>& vState, int nHeight);
+
+    /** Simulate nBlocks blocks voting with mapStrategy. Sidechains without a
+     * strategy abstain. Results are in the order of the snapshot. */
+    std::vector<SidechainWithdrawalProjection> Run(const std::map<uint8_t, SidechainVoteStrategy>& mapStrategy, int nBlocks) const;
+
+    /** Number of withdrawals in the snapshot */
+    size_t GetWithdrawalCount() const { return vWithdrawal.size(); }
+
+private:
+    struct Withdrawal {
+        uint8_t nSidechain;
+        uint16_t nBlocksLeft;
+        uint16_t nWorkScore;
+        uint256 hash;
+    };
+
+    std::vector<Withdrawal> vWithdrawal;
+    int nHeight;
+};
+
+#endif // BITCOIN_SIDECHAINSIM_H
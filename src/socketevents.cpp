@@ -0,0 +1,261 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <socketevents.h>
+
+#include <netbase.h>
+#include <util.h>
+
+#include <algorithm>
+#include <assert.h>
+
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode)
+{
+#ifndef USE_POLL
+    if (str == "select") {
+        mode = SOCKETEVENTS_SELECT;
+        return true;
+    }
+#else
+    if (str == "poll") {
+        mode = SOCKETEVENTS_POLL;
+        return true;
+    }
+#endif
+#ifdef USE_EPOLL
+    if (str == "epoll") {
+        mode = SOCKETEVENTS_EPOLL;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string GetSocketEventsModeName(SocketEventsMode mode)
+{
+    switch (mode) {
+    case SOCKETEVENTS_SELECT: return "select";
+    case SOCKETEVENTS_POLL: return "poll";
+    case SOCKETEVENTS_EPOLL: return "epoll";
+    }
+    return "unknown";
+}
+
+std::string GetSupportedSocketEventsModes()
+{
+    std::vector<std::string> vModes;
+#ifndef USE_POLL
+    vModes.push_back(GetSocketEventsModeName(SOCKETEVENTS_SELECT));
+#else
+    vModes.push_back(GetSocketEventsModeName(SOCKETEVENTS_POLL));
+#endif
+#ifdef USE_EPOLL
+    vModes.push_back(GetSocketEventsModeName(SOCKETEVENTS_EPOLL));
+#endif
+    std::string strModes;
+    for (const std::string& str : vModes) {
+        if (!strModes.empty())
+            strModes += ", ";
+        strModes += str;
+    }
+    return strModes;
+}
+
+CSocketEvents::CSocketEvents(SocketEventsMode modeIn) : mode(modeIn), epollfd(-1)
+{
+}
+
+CSocketEvents::~CSocketEvents()
+{
+#ifdef USE_EPOLL
+    if (epollfd != -1)
+        close(epollfd);
+#endif
+}
+
+bool CSocketEvents::Init()
+{
+    switch (mode) {
+    case SOCKETEVENTS_SELECT:
+#ifndef USE_POLL
+        return true;
+#else
+        // Sockets beyond FD_SETSIZE are accepted when poll is available
+        return false;
+#endif
+    case SOCKETEVENTS_POLL:
+#ifdef USE_POLL
+        return true;
+#else
+        return false;
+#endif
+    case SOCKETEVENTS_EPOLL:
+#ifdef USE_EPOLL
+        if (epollfd == -1)
+            epollfd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollfd == -1) {
+            LogPrintf("epoll_create1 failed: %s\n", NetworkErrorString(WSAGetLastError()));
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool CSocketEvents::Wait(std::set<SOCKET>& recv_set, std::set<SOCKET>& send_set, std::set<SOCKET>& error_set, int64_t nTimeoutMillis)
+{
+    assert(IsLevelTriggered());
+
+#ifdef USE_POLL
+    // Merge the sets into one pollfd per socket, all three are sorted
+    vPollFd.clear();
+    std::set<SOCKET>::const_iterator itRecv = recv_set.begin(), itSend = send_set.begin(), itError = error_set.begin();
+    while (itRecv != recv_set.end() || itSend != send_set.end() || itError != error_set.end()) {
+        SOCKET hSocket = INVALID_SOCKET;
+        if (itRecv != recv_set.end()) hSocket = std::min(hSocket, *itRecv);
+        if (itSend != send_set.end()) hSocket = std::min(hSocket, *itSend);
+        if (itError != error_set.end()) hSocket = std::min(hSocket, *itError);
+
+        struct pollfd pfd = {};
+        pfd.fd = hSocket;
+        if (itRecv != recv_set.end() && *itRecv == hSocket) {
+            pfd.events |= POLLIN;
+            ++itRecv;
+        }
+        if (itSend != send_set.end() && *itSend == hSocket) {
+            pfd.events |= POLLOUT;
+            ++itSend;
+        }
+        if (itError != error_set.end() && *itError == hSocket) {
+            // POLLERR and POLLHUP are always reported
+            ++itError;
+        }
+        vPollFd.push_back(pfd);
+    }
+
+    recv_set.clear();
+    send_set.clear();
+    error_set.clear();
+
+    if (poll(vPollFd.data(), vPollFd.size(), nTimeoutMillis) == SOCKET_ERROR) {
+        return false;
+    }
+
+    for (const struct pollfd& pfd : vPollFd) {
+        if (pfd.revents & POLLIN)            recv_set.insert(pfd.fd);
+        if (pfd.revents & POLLOUT)           send_set.insert(pfd.fd);
+        if (pfd.revents & (POLLERR|POLLHUP)) error_set.insert(pfd.fd);
+    }
+    return true;
+#else
+    struct timeval timeout;
+    timeout.tv_sec = nTimeoutMillis / 1000;
+    timeout.tv_usec = (nTimeoutMillis % 1000) * 1000;
+
+    fd_set fdsetRecv;
+    fd_set fdsetSend;
+    fd_set fdsetError;
+    FD_ZERO(&fdsetRecv);
+    FD_ZERO(&fdsetSend);
+    FD_ZERO(&fdsetError);
+    SOCKET hSocketMax = 0;
+
+    for (SOCKET hSocket : recv_set) {
+        FD_SET(hSocket, &fdsetRecv);
+        hSocketMax = std::max(hSocketMax, hSocket);
+    }
+    for (SOCKET hSocket : send_set) {
+        FD_SET(hSocket, &fdsetSend);
+        hSocketMax = std::max(hSocketMax, hSocket);
+    }
+    for (SOCKET hSocket : error_set) {
+        FD_SET(hSocket, &fdsetError);
+        hSocketMax = std::max(hSocketMax, hSocket);
+    }
+
+    bool have_fds = !recv_set.empty() || !send_set.empty() || !error_set.empty();
+    int nSelect = select(have_fds ? hSocketMax + 1 : 0,
+                         &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+    if (nSelect == SOCKET_ERROR) {
+        return false;
+    }
+
+    for (std::set<SOCKET>::iterator it = recv_set.begin(); it != recv_set.end(); ) {
+        if (FD_ISSET(*it, &fdsetRecv)) ++it; else it = recv_set.erase(it);
+    }
+    for (std::set<SOCKET>::iterator it = send_set.begin(); it != send_set.end(); ) {
+        if (FD_ISSET(*it, &fdsetSend)) ++it; else it = send_set.erase(it);
+    }
+    for (std::set<SOCKET>::iterator it = error_set.begin(); it != error_set.end(); ) {
+        if (FD_ISSET(*it, &fdsetError)) ++it; else it = error_set.erase(it);
+    }
+    return true;
+#endif
+}
+
+bool CSocketEvents::Add(SOCKET hSocket, void* data, bool fEdgeTriggered)
+{
+    assert(mode == SOCKETEVENTS_EPOLL);
+
+#ifdef USE_EPOLL
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    if (fEdgeTriggered)
+        ev.events |= EPOLLOUT | EPOLLET;
+    ev.data.ptr = data;
+    if (epoll_ctl(epollfd, EPOLL_CTL_ADD, hSocket, &ev) == SOCKET_ERROR) {
+        LogPrintf("epoll_ctl add failed: %s\n", NetworkErrorString(WSAGetLastError()));
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool CSocketEvents::Remove(SOCKET hSocket)
+{
+    assert(mode == SOCKETEVENTS_EPOLL);
+
+#ifdef USE_EPOLL
+    // Kernels before 2.6.9 require a non-null event for EPOLL_CTL_DEL
+    struct epoll_event ev = {};
+    return epoll_ctl(epollfd, EPOLL_CTL_DEL, hSocket, &ev) != SOCKET_ERROR;
+#else
+    return false;
+#endif
+}
+
+bool CSocketEvents::WaitEvents(std::vector<Event>& vEvents, int64_t nTimeoutMillis)
+{
+    assert(mode == SOCKETEVENTS_EPOLL);
+    vEvents.clear();
+
+#ifdef USE_EPOLL
+    // Sockets that are not returned in one call are returned by the next
+    // one, so the buffer doesn't need to be as large as the interest list
+    vEpollEvents.resize(1024);
+    int nEvents = epoll_wait(epollfd, vEpollEvents.data(), vEpollEvents.size(), nTimeoutMillis);
+    if (nEvents == SOCKET_ERROR) {
+        return false;
+    }
+
+    vEvents.reserve(nEvents);
+    for (int i = 0; i < nEvents; i++) {
+        const struct epoll_event& ev = vEpollEvents[i];
+        Event event;
+        event.data = ev.data.ptr;
+        event.fRecv = ev.events & (EPOLLIN | EPOLLRDHUP);
+        event.fSend = ev.events & EPOLLOUT;
+        event.fError = ev.events & (EPOLLERR | EPOLLHUP);
+        vEvents.push_back(event);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
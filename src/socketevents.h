@@ -0,0 +1,94 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SOCKETEVENTS_H
+#define BITCOIN_SOCKETEVENTS_H
+
+#include <compat.h>
+
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/** Readiness notification backends for the socket handler thread */
+enum SocketEventsMode {
+    SOCKETEVENTS_SELECT,
+    SOCKETEVENTS_POLL,
+    SOCKETEVENTS_EPOLL,
+};
+
+#if defined(USE_EPOLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_EPOLL;
+#elif defined(USE_POLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_POLL;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_SELECT;
+#endif
+
+/** Parse a -socketevents value, fails for backends not available on this platform */
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode);
+std::string GetSocketEventsModeName(SocketEventsMode mode);
+/** Comma separated names of the backends available on this platform */
+std::string GetSupportedSocketEventsModes();
+
+/**
+ * Waits for sockets to become ready using select(), poll() or epoll.
+ *
+ * The select and poll backends are level triggered: the sockets of interest
+ * are passed to Wait() every time and the sets are replaced by the sockets
+ * that are ready.
+ *
+ * The epoll backend keeps a persistent interest list. Sockets are added once
+ * with Add() and WaitEvents() returns the caller's pointer for every socket
+ * that is ready, so each wakeup only costs the number of ready sockets.
+ * Sockets added with fEdgeTriggered are only reported when their state
+ * changes: the caller has to remember the readiness until a recv() or send()
+ * returns EWOULDBLOCK. Sockets are removed from the interest list
+ * automatically when they are closed.
+ */
+class CSocketEvents
+{
+public:
+    struct Event {
+        void* data;
+        bool fRecv;
+        bool fSend;
+        bool fError;
+    };
+
+    explicit CSocketEvents(SocketEventsMode modeIn);
+    ~CSocketEvents();
+
+    CSocketEvents(const CSocketEvents&) = delete;
+    CSocketEvents& operator=(const CSocketEvents&) = delete;
+
+    /** Set up the backend, false if it is not available */
+    bool Init();
+
+    SocketEventsMode GetMode() const { return mode; }
+    bool IsLevelTriggered() const { return mode != SOCKETEVENTS_EPOLL; }
+
+    /** Wait until one of the sockets is ready (select and poll) */
+    bool Wait(std::set<SOCKET>& recv_set, std::set<SOCKET>& send_set, std::set<SOCKET>& error_set, int64_t nTimeoutMillis);
+
+    /** Add a socket to the interest list (epoll) */
+    bool Add(SOCKET hSocket, void* data, bool fEdgeTriggered);
+    /** Remove a socket from the interest list (epoll) */
+    bool Remove(SOCKET hSocket);
+    /** Wait for events on the sockets of the interest list (epoll) */
+    bool WaitEvents(std::vector<Event>& vEvents, int64_t nTimeoutMillis);
+
+private:
+    SocketEventsMode mode;
+    int epollfd;
+#ifdef USE_POLL
+    std::vector<struct pollfd> vPollFd;
+#endif
+#ifdef USE_EPOLL
+    std::vector<struct epoll_event> vEpollEvents;
+#endif
+};
+
+#endif // BITCOIN_SOCKETEVENTS_H
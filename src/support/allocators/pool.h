@@ -0,0 +1,194 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SUPPORT_ALLOCATORS_POOL_H
+#define BITCOIN_SUPPORT_ALLOCATORS_POOL_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Memory resource for node based containers that allocate many small
+ * objects of the same size, like the coins cache map.
+ *
+ * Small blocks are carved from chunks and, once deallocated, kept in a free
+ * list per size class to be handed out again. This saves the bookkeeping
+ * that malloc keeps for every allocation, and the fragmentation of many
+ * small allocations. Chunks are only returned when the resource is
+ * destroyed. They start at MIN_CHUNK_SIZE and double up to MAX_CHUNK_SIZE,
+ * so that short lived containers stay cheap. Blocks larger than
+ * MAX_BLOCK_SIZE or with a stricter alignment come from operator new.
+ */
+class PoolResource
+{
+public:
+    static const size_t ELEM_ALIGN = alignof(void*);
+    static const size_t MAX_BLOCK_SIZE = 128;
+    static const size_t MIN_CHUNK_SIZE = 4 * 1024;
+    static const size_t MAX_CHUNK_SIZE = 256 * 1024;
+
+    PoolResource() : pAvailable(nullptr), nAvailable(0), nChunkBytes(0), nLargeBytes(0)
+    {
+        freeLists.fill(nullptr);
+    }
+
+    ~PoolResource()
+    {
+        for (void* chunk : vChunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    void* Allocate(size_t bytes, size_t alignment)
+    {
+        if (!IsPooled(bytes, alignment)) {
+            nLargeBytes += bytes;
+            return ::operator new(bytes);
+        }
+        const size_t nClass = SizeClass(bytes);
+        if (freeLists[nClass]) {
+            ListNode* node = freeLists[nClass];
+            freeLists[nClass] = node->next;
+            return node;
+        }
+        const size_t nBlockSize = nClass * ELEM_ALIGN;
+        if (nAvailable < nBlockSize) {
+            AllocateChunk();
+        }
+        void* p = pAvailable;
+        pAvailable += nBlockSize;
+        nAvailable -= nBlockSize;
+        return p;
+    }
+
+    void Deallocate(void* p, size_t bytes, size_t alignment) noexcept
+    {
+        if (!IsPooled(bytes, alignment)) {
+            nLargeBytes -= bytes;
+            ::operator delete(p);
+            return;
+        }
+        Push(p, SizeClass(bytes));
+    }
+
+    /** Bytes held in chunks, used or not */
+    size_t ChunkBytes() const { return nChunkBytes; }
+    /** Bytes currently allocated outside of the chunks */
+    size_t LargeBytes() const { return nLargeBytes; }
+
+private:
+    struct ListNode {
+        ListNode* next;
+    };
+
+    static bool IsPooled(size_t bytes, size_t alignment)
+    {
+        return bytes <= MAX_BLOCK_SIZE && alignment <= ELEM_ALIGN;
+    }
+
+    /** Blocks are rounded up to a multiple of the alignment, a block fits a free list node */
+    static size_t SizeClass(size_t bytes)
+    {
+        return (std::max(bytes, sizeof(ListNode)) + ELEM_ALIGN - 1) / ELEM_ALIGN;
+    }
+
+    void Push(void* p, size_t nClass)
+    {
+        ListNode* node = new (p) ListNode;
+        node->next = freeLists[nClass];
+        freeLists[nClass] = node;
+    }
+
+    void AllocateChunk()
+    {
+        // Keep the rest of the current chunk, it is a multiple of ELEM_ALIGN
+        if (nAvailable >= sizeof(ListNode)) {
+            Push(pAvailable, nAvailable / ELEM_ALIGN);
+        }
+        size_t nChunkSize = MIN_CHUNK_SIZE << std::min<size_t>(vChunks.size(), 6);
+        if (nChunkSize > MAX_CHUNK_SIZE)
+            nChunkSize = MAX_CHUNK_SIZE;
+        pAvailable = static_cast<char*>(::operator new(nChunkSize));
+        nAvailable = nChunkSize;
+        vChunks.push_back(pAvailable);
+        nChunkBytes += nChunkSize;
+    }
+
+    std::array<ListNode*, MAX_BLOCK_SIZE / ELEM_ALIGN + 1> freeLists;
+    std::vector<void*> vChunks;
+    char* pAvailable;
+    size_t nAvailable;
+    size_t nChunkBytes;
+    size_t nLargeBytes;
+};
+
+/**
+ * Allocator that takes its memory from a PoolResource, or from operator new
+ * when it was default constructed. Containers using it must not outlive the
+ * resource.
+ */
+template <typename T>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind {
+        typedef PoolAllocator<U> other;
+    };
+
+    PoolAllocator() noexcept : resource(nullptr) {}
+    explicit PoolAllocator(PoolResource* resourceIn) noexcept : resource(resourceIn) {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : resource(other.GetResource()) {}
+
+    T* allocate(size_t n)
+    {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+        if (!resource)
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(resource->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (!resource) {
+            ::operator delete(p);
+            return;
+        }
+        resource->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    PoolResource* GetResource() const { return resource; }
+
+private:
+    PoolResource* resource;
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept
+{
+    return a.GetResource() == b.GetResource();
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept
+{
+    return !(a == b);
+}
+
+#endif // BITCOIN_SUPPORT_ALLOCATORS_POOL_H
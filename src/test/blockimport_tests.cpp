@@ -0,0 +1,206 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockimport.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <streams.h>
+#include <validation.h>
+#include <test/test_drivechain.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockimport_tests, BasicTestingSetup)
+
+static CBlock MakeBlock(uint32_t nNonce, size_t nOutputs = 1)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << nNonce << OP_0;
+    tx.vout.resize(nOutputs);
+    for (CTxOut& txout : tx.vout) {
+        txout.nValue = 50 * COIN;
+        txout.scriptPubKey = CScript() << OP_TRUE;
+    }
+
+    CBlock block;
+    block.nVersion = 1;
+    block.nTime = 1500000000;
+    block.nNonce = nNonce;
+    block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+    return block;
+}
+
+/** Append a block the way it is stored in blk?????.dat, returns the position of the block data */
+static uint64_t AppendBlock(CDataStream& ss, const CBlock& block)
+{
+    ss << FLATDATA(Params().MessageStart());
+    ss << (unsigned int)::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+    uint64_t nBlockPos = ss.size();
+    ss << block;
+    return nBlockPos;
+}
+
+static FILE* WriteTempFile(const CDataStream& ss)
+{
+    FILE* file = tmpfile();
+    BOOST_REQUIRE(file);
+    BOOST_REQUIRE_EQUAL(fwrite(ss.data(), 1, ss.size(), file), ss.size());
+    rewind(file);
+    return file;
+}
+
+BOOST_AUTO_TEST_CASE(blockfilereader_order)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    std::vector<CBlock> vBlocks;
+    std::vector<uint64_t> vPos;
+    for (uint32_t i = 0; i < 200; i++) {
+        // Differently sized blocks finish deserializing out of order
+        vBlocks.push_back(MakeBlock(i, 1 + (i * 37) % 100));
+        vPos.push_back(AppendBlock(ss, vBlocks.back()));
+        // Unused space between blocks, as left behind by preallocation
+        if (i % 10 == 0)
+            ss << std::vector<unsigned char>(100, 0);
+    }
+
+    for (int nThreads : {1, 4}) {
+        CBlockFileReader reader(WriteTempFile(ss), Params(), nThreads, false);
+        CBlockFileReader::Record record;
+        size_t nBlocks = 0;
+        while (reader.Next(record)) {
+            BOOST_REQUIRE(nBlocks < vBlocks.size());
+            BOOST_REQUIRE(record.pblock);
+            BOOST_CHECK(record.hash == vBlocks[nBlocks].GetHash());
+            BOOST_CHECK(record.pblock->vtx[0]->GetHash() == vBlocks[nBlocks].vtx[0]->GetHash());
+            BOOST_CHECK_EQUAL(record.nBlockPos, vPos[nBlocks]);
+            BOOST_CHECK_EQUAL(record.nSize, ::GetSerializeSize(vBlocks[nBlocks], SER_DISK, CLIENT_VERSION));
+            nBlocks++;
+        }
+        BOOST_CHECK_EQUAL(nBlocks, vBlocks.size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(blockfilereader_corrupt)
+{
+    // A record whose data doesn't deserialize, with a valid block inside of
+    // it, followed by another valid block
+    CBlock block1 = MakeBlock(1), block2 = MakeBlock(2), block3 = MakeBlock(3);
+    CDataStream ssInner(SER_DISK, CLIENT_VERSION);
+    uint64_t nInnerPos = AppendBlock(ssInner, block2);
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    uint64_t nPos1 = AppendBlock(ss, block1);
+    ss << FLATDATA(Params().MessageStart());
+    ss << (unsigned int)(100 + ssInner.size() + 16);
+    uint64_t nCorruptPos = ss.size();
+    // Fails at the length of the header signature
+    std::vector<char> vGarbage(100, '\xff');
+    ss.write(vGarbage.data(), 100);
+    ss.write(ssInner.data(), ssInner.size());
+    ss.write(vGarbage.data(), 16);
+    uint64_t nPos3 = AppendBlock(ss, block3);
+
+    CBlockFileReader reader(WriteTempFile(ss), Params(), 2, false);
+    CBlockFileReader::Record record;
+
+    BOOST_REQUIRE(reader.Next(record));
+    BOOST_CHECK(record.hash == block1.GetHash());
+    BOOST_CHECK_EQUAL(record.nBlockPos, nPos1);
+
+    BOOST_REQUIRE(reader.Next(record));
+    BOOST_CHECK(!record.pblock);
+    BOOST_CHECK(!record.strError.empty());
+    BOOST_CHECK_EQUAL(record.nBlockPos, nCorruptPos);
+
+    // Scanning resumed inside of the corrupted data
+    BOOST_REQUIRE(reader.Next(record));
+    BOOST_REQUIRE(record.pblock);
+    BOOST_CHECK(record.hash == block2.GetHash());
+    BOOST_CHECK_EQUAL(record.nBlockPos, nCorruptPos + 100 + nInnerPos);
+
+    BOOST_REQUIRE(reader.Next(record));
+    BOOST_CHECK(record.hash == block3.GetHash());
+    BOOST_CHECK_EQUAL(record.nBlockPos, nPos3);
+
+    BOOST_CHECK(!reader.Next(record));
+}
+
+BOOST_AUTO_TEST_CASE(imported_block_cache)
+{
+    CImportedBlockCache cache(1000);
+    std::vector<std::shared_ptr<const CBlock>> vBlocks;
+    for (uint32_t i = 0; i < 4; i++) {
+        vBlocks.push_back(std::make_shared<const CBlock>(MakeBlock(i)));
+        cache.Add(vBlocks[i]->GetHash(), vBlocks[i], 300);
+    }
+    BOOST_CHECK_EQUAL(cache.GetSize(), 1200U);
+    BOOST_CHECK(cache.IsFull());
+
+    BOOST_CHECK(cache.Take(vBlocks[1]->GetHash()) == vBlocks[1]);
+    BOOST_CHECK(cache.Take(vBlocks[1]->GetHash()) == nullptr);
+    BOOST_CHECK_EQUAL(cache.GetSize(), 900U);
+    BOOST_CHECK(!cache.IsFull());
+
+    // A block already in the cache isn't counted twice
+    cache.Add(vBlocks[2]->GetHash(), vBlocks[2], 300);
+    BOOST_CHECK_EQUAL(cache.GetSize(), 900U);
+    BOOST_CHECK(cache.Take(vBlocks[2]->GetHash()) == vBlocks[2]);
+
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.GetSize(), 0U);
+    BOOST_CHECK(cache.Take(vBlocks[3]->GetHash()) == nullptr);
+}
+
+BOOST_FIXTURE_TEST_CASE(chain_block_reader, TestingSetup)
+{
+    const CBlockIndex* pindexGenesis;
+    {
+        LOCK(cs_main);
+        pindexGenesis = chainActive.Genesis();
+    }
+
+    // Only the genesis block is in the active chain, it has a single transaction
+    {
+        CChainBlockReader reader(0, Params().GetConsensus(), 2);
+        CChainBlockReader::Record record;
+        reader.Next(record);
+        BOOST_CHECK(record.pindex == pindexGenesis);
+        BOOST_REQUIRE(record.pblock);
+        BOOST_CHECK(record.pblock->GetHash() == Params().GenesisBlock().GetHash());
+        BOOST_REQUIRE_EQUAL(record.vMatch.size(), 1U);
+        BOOST_CHECK(record.vMatch[0]);
+
+        // Heights past the tip
+        for (int i = 0; i < 2 * DEFAULT_CHAIN_READAHEAD_BLOCKS; i++) {
+            reader.Next(record);
+            BOOST_CHECK(!record.pindex);
+            BOOST_CHECK(!record.pblock);
+        }
+    }
+
+    // The workers don't take cs_main, so callers may hold it
+    {
+        LOCK(cs_main);
+        CChainBlockReader reader(0, Params().GetConsensus(), 2);
+        CChainBlockReader::Record record;
+        reader.Next(record);
+        BOOST_CHECK(record.pindex == pindexGenesis);
+        BOOST_CHECK(record.pblock);
+    }
+
+    // The filter decides which transactions are matched
+    int nFiltered = 0;
+    CChainBlockReader reader(0, Params().GetConsensus(), 1, [&nFiltered](const CBlock& block, std::vector<bool>& vMatch) {
+        nFiltered++;
+    }, 1);
+    CChainBlockReader::Record record;
+    reader.Next(record);
+    BOOST_REQUIRE(record.pblock);
+    BOOST_REQUIRE_EQUAL(record.vMatch.size(), 1U);
+    BOOST_CHECK(!record.vMatch[0]);
+    BOOST_CHECK_EQUAL(nFiltered, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <chainparams.h>
+#include <test/test_drivechain.h>
+#include <txdb.h>
+#include <util.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockindex_tests, TestingSetup)
+
+/** Block index entries loaded outside of mapBlockIndex */
+struct TestBlockIndex
+{
+    std::map<uint256, std::unique_ptr<CBlockIndex>> mapIndex;
+    std::vector<CBlockIndex*> vIndex;
+
+    bool Load()
+    {
+        mapIndex.clear();
+        vIndex.clear();
+        return pblocktree->LoadFlatBlockIndex(Params().GetConsensus(), [this](const uint256& hash) {
+            auto it = mapIndex.emplace(hash, std::unique_ptr<CBlockIndex>(new CBlockIndex())).first;
+            it->second->phashBlock = &it->first;
+            return it->second.get();
+        }, vIndex);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(flat_block_index)
+{
+    const CBlockIndex* pindexGenesis;
+    {
+        LOCK(cs_main);
+        FlushStateToDisk();
+        pindexGenesis = chainActive.Genesis();
+    }
+
+    // Nothing to load before it's written
+    TestBlockIndex index;
+    BOOST_CHECK(!index.Load());
+
+    BOOST_REQUIRE(DumpBlockIndex());
+    BOOST_CHECK(fs::exists(GetDataDir() / "blocks" / "blockindex.dat"));
+    BOOST_REQUIRE(index.Load());
+    BOOST_REQUIRE_EQUAL(index.vIndex.size(), 1U);
+    const CBlockIndex* pindex = index.vIndex[0];
+    BOOST_CHECK(pindex->GetBlockHash() == pindexGenesis->GetBlockHash());
+    BOOST_CHECK(pindex->pprev == nullptr);
+    BOOST_CHECK_EQUAL(pindex->nHeight, 0);
+    BOOST_CHECK_EQUAL(pindex->nStatus, pindexGenesis->nStatus);
+    BOOST_CHECK_EQUAL(pindex->nTx, pindexGenesis->nTx);
+    BOOST_CHECK_EQUAL(pindex->nFile, pindexGenesis->nFile);
+    BOOST_CHECK_EQUAL(pindex->nDataPos, pindexGenesis->nDataPos);
+    BOOST_CHECK(pindex->GetBlockHeader().GetHash() == pindexGenesis->GetBlockHash());
+
+    // Writing the index again makes the file stale
+    {
+        std::vector<const CBlockIndex*> vBlocks{pindexGenesis};
+        BOOST_REQUIRE(pblocktree->WriteBatchSync({}, 0, vBlocks));
+    }
+    BOOST_CHECK(!index.Load());
+
+    // Blocks stored by a version that doesn't know the file make it stale
+    BOOST_REQUIRE(DumpBlockIndex());
+    BOOST_REQUIRE(index.Load());
+    {
+        CBlockFileInfo info;
+        BOOST_REQUIRE(pblocktree->ReadBlockFileInfo(0, info));
+        CBlockFileInfo infoStored = info;
+        infoStored.AddBlock(1, 0);
+        BOOST_REQUIRE(pblocktree->WriteBatchSync({{0, &infoStored}}, 0, {}));
+        BOOST_CHECK(!index.Load());
+        BOOST_REQUIRE(pblocktree->WriteBatchSync({{0, &info}}, 0, {}));
+    }
+
+    // A corrupted file isn't loaded
+    BOOST_REQUIRE(DumpBlockIndex());
+    {
+        fs::path path = GetDataDir() / "blocks" / "blockindex.dat";
+        FILE* file = fsbridge::fopen(path, "rb+");
+        BOOST_REQUIRE(file);
+        BOOST_REQUIRE_EQUAL(fseek(file, fs::file_size(path) - 40, SEEK_SET), 0);
+        int ch = fgetc(file);
+        BOOST_REQUIRE_EQUAL(fseek(file, -1, SEEK_CUR), 0);
+        fputc(ch ^ 1, file);
+        fclose(file);
+    }
+    BOOST_CHECK(!index.Load());
+
+    // The block index database is loaded instead
+    BOOST_REQUIRE(DumpBlockIndex());
+    {
+        fs::path path = GetDataDir() / "blocks" / "blockindex.dat";
+        fs::resize_file(path, fs::file_size(path) - 1);
+    }
+    LOCK(cs_main);
+    uint256 hashGenesis = pindexGenesis->GetBlockHash();
+    UnloadBlockIndex();
+    BOOST_REQUIRE(LoadBlockIndex(Params()));
+    BOOST_CHECK_EQUAL(mapBlockIndex.size(), 1U);
+    BOOST_CHECK(mapBlockIndex.count(hashGenesis));
+
+    // An entry that a corrupted file has twice is dropped once
+    {
+        std::vector<const CBlockIndex*> vBlocks{mapBlockIndex[hashGenesis], mapBlockIndex[hashGenesis]};
+        BOOST_REQUIRE(pblocktree->WriteFlatBlockIndex(vBlocks));
+        fs::path path = GetDataDir() / "blocks" / "blockindex.dat";
+        FILE* file = fsbridge::fopen(path, "rb+");
+        BOOST_REQUIRE(file);
+        BOOST_REQUIRE_EQUAL(fseek(file, -1, SEEK_END), 0);
+        int ch = fgetc(file);
+        BOOST_REQUIRE_EQUAL(fseek(file, -1, SEEK_END), 0);
+        fputc(ch ^ 1, file);
+        fclose(file);
+    }
+    UnloadBlockIndex();
+    BOOST_REQUIRE(LoadBlockIndex(Params()));
+    BOOST_CHECK_EQUAL(mapBlockIndex.size(), 1U);
+    BOOST_CHECK(mapBlockIndex.count(hashGenesis));
+
+    // The flat file is loaded into mapBlockIndex
+    BOOST_REQUIRE(DumpBlockIndex());
+    UnloadBlockIndex();
+    BOOST_REQUIRE(LoadBlockIndex(Params()));
+    BOOST_REQUIRE_EQUAL(mapBlockIndex.size(), 1U);
+    BOOST_CHECK(mapBlockIndex.count(hashGenesis));
+    BOOST_CHECK(*mapBlockIndex[hashGenesis]->phashBlock == hashGenesis);
+    BOOST_REQUIRE(LoadChainTip(Params()));
+    BOOST_CHECK(chainActive.Tip()->GetBlockHash() == hashGenesis);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
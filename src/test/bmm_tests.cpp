@@ -8,6 +8,8 @@
 #include <random.h>
 #include <script/sign.h>
 #include <sidechain.h>
+#include <sidechaindb.h>
+#include <txmempool.h>
 #include <uint256.h>
 #include <utilstrencodings.h>
 #include <validation.h>
@@ -399,4 +401,60 @@ BOOST_AUTO_TEST_CASE(bmm_prevbytes_mempool)
     mempool.removeRecursive(CTransaction(mtx));
 }
 
+BOOST_AUTO_TEST_CASE(bmm_select_highest_bid)
+{
+    // Activate the sidechain the BMM requests are for
+    Sidechain proposal;
+    proposal.nSidechain = 0;
+    proposal.nVersion = 0;
+    proposal.title = "test";
+    proposal.description = "description";
+    proposal.hashID1 = GetRandHash();
+    proposal.hashID2 = uint160S("31d98584f3c570961359c308619f5cf2e9178482");
+    BOOST_REQUIRE(ActivateSidechain(scdb, proposal, 0));
+
+    CScript bytes;
+    bytes.resize(8);
+    bytes[0] = 0x00;
+    bytes[1] = 0xbf;
+    bytes[2] = 0x00;
+    bytes[3] = uint8_t(0);
+
+    // BMM requests bidding with their fee and their OP_TRUE output
+    std::vector<CTransaction> vRequest;
+    const std::vector<std::pair<CAmount, CAmount>> vBid = {
+        {1000, 10 * CENT}, {50000, 10 * CENT}, {1000, 5 * CENT}, {20000, 10 * CENT}};
+    TestMemPoolEntryHelper entry;
+    for (const std::pair<CAmount, CAmount>& bid : vBid) {
+        CMutableTransaction mtx;
+        mtx.nVersion = 3;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout.hash = GetRandHash();
+        mtx.vin[0].prevout.n = 0;
+        mtx.vout.resize(1);
+        mtx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        mtx.vout[0].nValue = bid.second;
+        mtx.nLockTime = 100;
+        mtx.criticalData.vBytes = ToByteVector(bytes);
+        mtx.criticalData.hashCritical = GetRandHash();
+        vRequest.push_back(CTransaction(mtx));
+
+        LOCK(mempool.cs);
+        mempool.addUnchecked(vRequest.back().GetHash(), entry.Fee(bid.first).FromTx(vRequest.back()));
+        BOOST_CHECK_EQUAL(GetBMMRequestBid(*mempool.mapTx.find(vRequest.back().GetHash())), bid.first + bid.second);
+    }
+
+    // Only the BMM request that pays the miner the most is kept
+    std::vector<uint256> vHashRemoved;
+    mempool.SelectBMMRequests(vHashRemoved);
+    BOOST_CHECK_EQUAL(vHashRemoved.size(), 3U);
+    BOOST_CHECK_EQUAL(mempool.size(), 1U);
+    BOOST_CHECK(mempool.exists(vRequest[1].GetHash()));
+
+    mempool.clear();
+
+    // Don't leave the sidechain active for the next tests
+    scdb.Reset();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 
 #include <coins.h>
 #include <script/standard.h>
+#include <tinyformat.h>
 #include <uint256.h>
 #include <undo.h>
 #include <utilstrencodings.h>
@@ -859,4 +860,167 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_escrow)
+{
+    uint8_t nSidechain = 0;
+
+    // Regular output
+    Coin coin(CTxOut(50 * CENT, CScript() << OP_TRUE), 1, false);
+    BOOST_CHECK(!coin.IsEscrow(nSidechain));
+
+    // Sidechain escrow output
+    CScript scriptEscrow = CScript() << OP_DRIVECHAIN;
+    scriptEscrow.push_back(7);
+    Coin coinEscrow(CTxOut(50 * CENT, scriptEscrow), 1, false);
+    BOOST_CHECK(coinEscrow.IsEscrow(nSidechain));
+    BOOST_CHECK_EQUAL(nSidechain, 7);
+
+    // The flag isn't serialized, it must be recomputed when read
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << coinEscrow << coin;
+
+    Coin coinRead;
+    ss >> coinRead;
+    nSidechain = 0;
+    BOOST_CHECK(coinRead.IsEscrow(nSidechain));
+    BOOST_CHECK_EQUAL(nSidechain, 7);
+
+    ss >> coinRead;
+    BOOST_CHECK(!coinRead.IsEscrow(nSidechain));
+
+    coinRead.Clear();
+    BOOST_CHECK(!coinRead.IsEscrow(nSidechain));
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_prefetch)
+{
+    CCoinsViewTest base;
+    COutPoint outpoint1(InsecureRand256(), 0), outpoint2(InsecureRand256(), 1);
+    Coin coin1(CTxOut(10 * CENT, CScript() << OP_TRUE), 1, false);
+    Coin coin2(CTxOut(20 * CENT, CScript() << OP_TRUE), 2, false);
+    {
+        CCoinsViewCacheTest setup(&base);
+        setup.AddCoin(outpoint1, Coin(coin1), false);
+        setup.AddCoin(outpoint2, Coin(coin2), false);
+        BOOST_CHECK(setup.Flush());
+    }
+
+    CCoinsViewCacheTest cache(&base);
+    BOOST_CHECK(cache.SpendCoin(outpoint2, false));
+
+    // Prefetched coins are not modified, spent entries are not replaced
+    cache.AddPrefetchedCoin(outpoint1, Coin(coin1));
+    cache.AddPrefetchedCoin(outpoint2, Coin(coin2));
+    BOOST_CHECK_EQUAL(cache.GetPrefetched(), 1U);
+    BOOST_CHECK(cache.map().at(outpoint1).flags == 0);
+    BOOST_CHECK(cache.map().at(outpoint2).coin.IsSpent());
+    cache.SelfTest();
+
+    uint64_t nHits = cache.GetCacheHits(), nMisses = cache.GetCacheMisses();
+    BOOST_CHECK(cache.AccessCoin(outpoint1) == coin1);
+    BOOST_CHECK(!cache.HaveCoin(outpoint2));
+    BOOST_CHECK_EQUAL(cache.GetCacheHits(), nHits + 2);
+    BOOST_CHECK_EQUAL(cache.GetCacheMisses(), nMisses);
+
+    BOOST_CHECK(!cache.HaveCoin(COutPoint(InsecureRand256(), 0)));
+    BOOST_CHECK_EQUAL(cache.GetCacheMisses(), nMisses + 1);
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_pool_usage)
+{
+    CCoinsView base;
+    CCoinsViewCacheTest cache(&base);
+    const size_t nCoins = 100000;
+    CTxOut txout(CENT, GetScriptForDestination(CKeyID(uint160())));
+    for (size_t i = 0; i < nCoins; i++) {
+        cache.AddCoin(COutPoint(InsecureRand256(), 0), Coin(CTxOut(txout), 1, false), false);
+    }
+    cache.SelfTest();
+
+    // The pool doesn't pay the malloc overhead for every entry
+    size_t nUsage = cache.DynamicMemoryUsage();
+    size_t nMallocUsage = memusage::MallocUsage(sizeof(memusage::unordered_node<CCoinsMap::value_type>)) * nCoins +
+                          memusage::MallocUsage(sizeof(void*) * cache.map().bucket_count());
+    BOOST_CHECK(nUsage < nMallocUsage);
+    BOOST_TEST_MESSAGE(strprintf("coins per GB: %u pooled, %u with malloc", (1ULL << 30) * nCoins / nUsage, (1ULL << 30) * nCoins / nMallocUsage));
+
+    // Erased entries are reused
+    std::vector<COutPoint> vErase;
+    for (const auto& entry : cache.map()) {
+        if (vErase.size() < nCoins / 2)
+            vErase.push_back(entry.first);
+    }
+    for (const COutPoint& outpoint : vErase) {
+        BOOST_CHECK(cache.SpendCoin(outpoint, false));
+    }
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), nCoins - vErase.size());
+    for (size_t i = 0; i < vErase.size(); i++) {
+        cache.AddCoin(COutPoint(InsecureRand256(), 0), Coin(CTxOut(txout), 1, false), false);
+    }
+    cache.SelfTest();
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage(), nUsage);
+
+    // Flushing gives the memory back
+    cache.Flush();
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage(), 0U);
+    cache.AddCoin(COutPoint(InsecureRand256(), 0), Coin(CTxOut(txout), 1, false), false);
+    cache.SelfTest();
+}
+
+BOOST_FIXTURE_TEST_CASE(coins_background_flush, TestingSetup)
+{
+    CCoinsViewDB db(1 << 23, true);
+    CCoinsViewBackgroundFlush flush(&db);
+    CCoinsViewCache cache(&flush);
+    CTxOut txout(CENT, GetScriptForDestination(CKeyID(uint160())));
+
+    std::vector<COutPoint> vOutPoints;
+    for (int i = 0; i < 10000; i++) {
+        vOutPoints.emplace_back(InsecureRand256(), 0);
+        cache.AddCoin(vOutPoints.back(), Coin(CTxOut(txout), 1, false), false);
+    }
+    uint256 hashBlock1 = InsecureRand256();
+    cache.SetBestBlock(hashBlock1);
+    BOOST_REQUIRE(flush.StartFlush(cache));
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    BOOST_CHECK(cache.GetBestBlock() == hashBlock1);
+
+    // The coins can be read while they are written
+    for (const COutPoint& outpoint : vOutPoints) {
+        BOOST_CHECK(flush.HaveCoin(outpoint));
+    }
+    BOOST_CHECK(flush.GetBestBlock() == hashBlock1);
+
+    // Spend half of them and flush again, after the first write
+    for (size_t i = 0; i < vOutPoints.size(); i += 2) {
+        BOOST_CHECK(cache.SpendCoin(vOutPoints[i], false));
+    }
+    uint256 hashBlock2 = InsecureRand256();
+    cache.SetBestBlock(hashBlock2);
+    BOOST_REQUIRE(flush.StartFlush(cache));
+    for (size_t i = 0; i < vOutPoints.size(); i++) {
+        BOOST_CHECK_EQUAL(cache.HaveCoin(vOutPoints[i]), i % 2 == 1);
+    }
+
+    BOOST_REQUIRE(flush.WaitForFlush());
+    BOOST_CHECK(!flush.IsFlushing());
+    BOOST_CHECK(!flush.FlushFailed());
+    BOOST_CHECK_EQUAL(flush.DynamicMemoryUsage(), 0U);
+
+    // The database is consistent with the last flushed block
+    BOOST_CHECK(db.GetBestBlock() == hashBlock2);
+    BOOST_CHECK(db.GetHeadBlocks().empty());
+    for (size_t i = 0; i < vOutPoints.size(); i++) {
+        BOOST_CHECK_EQUAL(db.HaveCoin(vOutPoints[i]), i % 2 == 1);
+    }
+
+    // A synchronous flush is written before it returns
+    cache.SpendCoin(vOutPoints[1], false);
+    cache.SetBestBlock(hashBlock1);
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK(!db.HaveCoin(vOutPoints[1]));
+    BOOST_CHECK(db.GetBestBlock() == hashBlock1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -10,6 +10,7 @@
 #include <crypto/sha512.h>
 #include <crypto/hmac_sha256.h>
 #include <crypto/hmac_sha512.h>
+#include <hash.h>
 #include <random.h>
 #include <utilstrencodings.h>
 #include <test/test_drivechain.h>
@@ -524,6 +525,38 @@ BOOST_AUTO_TEST_CASE(chacha20_testvector)
                  "fab78c9");
 }
 
+static void TestSHA256D64()
+{
+    for (int i = 0; i <= 32; ++i) {
+        unsigned char in[64 * 32];
+        unsigned char out1[32 * 32], out2[32 * 32];
+        for (int j = 0; j < 64 * i; ++j) {
+            in[j] = InsecureRandBits(8);
+        }
+        for (int j = 0; j < i; ++j) {
+            CHash256().Write(in + 64 * j, 64).Finalize(out1 + 32 * j);
+        }
+        SHA256D64(out2, in, i);
+        BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sha256d64)
+{
+    // Check every backend which this CPU supports against the generic one
+    static const sha256_implementation::UseImplementation vImplementation[] = {
+        sha256_implementation::STANDARD,
+        sha256_implementation::USE_SSE4,
+        static_cast<sha256_implementation::UseImplementation>(sha256_implementation::USE_SSE4 | sha256_implementation::USE_AVX2),
+        sha256_implementation::USE_SHANI,
+    };
+    for (const sha256_implementation::UseImplementation use : vImplementation) {
+        BOOST_TEST_MESSAGE("Testing SHA256D64 with " + SHA256AutoDetect(use));
+        TestSHA256D64();
+    }
+    SHA256AutoDetect();
+}
+
 BOOST_AUTO_TEST_CASE(countbits_tests)
 {
     FastRandomContext ctx;
@@ -10,6 +10,7 @@
 #include <streams.h>
 #include <net.h>
 #include <netbase.h>
+#include <netmessagemaker.h>
 #include <chainparams.h>
 #include <util.h>
 
@@ -185,4 +186,141 @@ BOOST_AUTO_TEST_CASE(cnode_simple_test)
     BOOST_CHECK(pnode2->fFeeler == false);
 }
 
+#ifndef WIN32
+static std::vector<unsigned char> RecvBytes(SOCKET hSocket, size_t nBytes)
+{
+    std::vector<unsigned char> vch(nBytes);
+    size_t nRead = 0;
+    while (nRead < nBytes) {
+        ssize_t n = recv(hSocket, (char*)vch.data() + nRead, nBytes - nRead, 0);
+        if (n <= 0)
+            break;
+        nRead += n;
+    }
+    vch.resize(nRead);
+    return vch;
+}
+
+BOOST_AUTO_TEST_CASE(cnode_push_shared_message)
+{
+    CConnman connman(0x1337, 0x1337);
+    CConnman::Options options;
+    options.nSendBufferMaxSize = 1000 * DEFAULT_MAXSENDBUFFER;
+    connman.Init(options);
+
+    int sv1[2], sv2[2];
+    BOOST_REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sv1) == 0);
+    BOOST_REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sv2) == 0);
+    CAddress addr(CService(), NODE_NONE);
+    CNode node1(0, NODE_NETWORK, 0, sv1[0], addr, 0, 0, CAddress(), "", false);
+    CNode node2(1, NODE_NETWORK, 0, sv2[0], addr, 0, 0, CAddress(), "", false);
+
+    // One serialization, header included, for both peers
+    std::vector<unsigned char> vPayload(20000, 0xab);
+    CSharedNetMsg shared = CConnman::MakeSharedMessage(CNetMsgMaker(PROTOCOL_VERSION).Make(NetMsgType::BLOCK, vPayload));
+    BOOST_CHECK_EQUAL(shared.command, NetMsgType::BLOCK);
+    const size_t nPayloadSize = shared.data->size() - CMessageHeader::HEADER_SIZE;
+    BOOST_CHECK_EQUAL(nPayloadSize, GetSerializeSize(vPayload, SER_NETWORK, PROTOCOL_VERSION));
+
+    connman.PushMessage(&node1, shared);
+    connman.PushMessage(&node2, shared);
+    // Queued behind the shared buffer of node1
+    connman.PushMessage(&node1, CNetMsgMaker(PROTOCOL_VERSION).Make(NetMsgType::PING, (uint64_t)42));
+    BOOST_CHECK(node1.vSendMsg.empty());
+    BOOST_CHECK(node2.vSendMsg.empty());
+    BOOST_CHECK_EQUAL(node1.nSendSize, 0U);
+
+    std::vector<unsigned char> vRecv1 = RecvBytes(sv1[1], shared.data->size());
+    std::vector<unsigned char> vRecv2 = RecvBytes(sv2[1], shared.data->size());
+    BOOST_CHECK(vRecv1 == *shared.data);
+    BOOST_CHECK(vRecv2 == *shared.data);
+
+    CDataStream ssHeader(vRecv1, SER_NETWORK, PROTOCOL_VERSION);
+    CMessageHeader hdr(Params().MessageStart());
+    ssHeader >> hdr;
+    BOOST_CHECK(hdr.IsValid(Params().MessageStart()));
+    BOOST_CHECK_EQUAL(hdr.GetCommand(), NetMsgType::BLOCK);
+    BOOST_CHECK_EQUAL(hdr.nMessageSize, nPayloadSize);
+    uint256 hash = Hash(vRecv1.begin() + CMessageHeader::HEADER_SIZE, vRecv1.end());
+    BOOST_CHECK(memcmp(hash.begin(), hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) == 0);
+
+    // The ping follows the block
+    std::vector<unsigned char> vPing = RecvBytes(sv1[1], CMessageHeader::HEADER_SIZE + 8);
+    CDataStream ssPing(vPing, SER_NETWORK, PROTOCOL_VERSION);
+    ssPing >> hdr;
+    BOOST_CHECK_EQUAL(hdr.GetCommand(), NetMsgType::PING);
+    uint64_t nonce = 0;
+    ssPing >> nonce;
+    BOOST_CHECK_EQUAL(nonce, 42U);
+
+    SOCKET hRemote1 = sv1[1], hRemote2 = sv2[1];
+    CloseSocket(hRemote1);
+    CloseSocket(hRemote2);
+}
+#endif
+
+#ifdef USE_POLL
+BOOST_AUTO_TEST_CASE(socket_events)
+{
+    int sv[2];
+    BOOST_REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    SOCKET hLocal = sv[0];
+    SOCKET hRemote = sv[1];
+    char ch = 0;
+
+    // Level triggered: every wait reports the state of the given sockets
+    CSocketEvents poll_events(SOCKETEVENTS_POLL);
+    BOOST_REQUIRE(poll_events.Init());
+    std::set<SOCKET> recv_set{hLocal}, send_set, error_set{hLocal};
+    BOOST_CHECK(poll_events.Wait(recv_set, send_set, error_set, 0));
+    BOOST_CHECK(recv_set.empty());
+
+    BOOST_CHECK_EQUAL(send(hRemote, &ch, 1, 0), 1);
+    for (int i = 0; i < 2; i++) {
+        recv_set = {hLocal};
+        send_set = {hLocal};
+        error_set = {hLocal};
+        BOOST_CHECK(poll_events.Wait(recv_set, send_set, error_set, 0));
+        BOOST_CHECK(recv_set.count(hLocal));
+        BOOST_CHECK(send_set.count(hLocal));
+        BOOST_CHECK(error_set.empty());
+    }
+    BOOST_CHECK_EQUAL(recv(hLocal, &ch, 1, 0), 1);
+
+#ifdef USE_EPOLL
+    // Edge triggered: readiness is only reported when it changes
+    CSocketEvents epoll_events(SOCKETEVENTS_EPOLL);
+    BOOST_REQUIRE(epoll_events.Init());
+    BOOST_CHECK(epoll_events.Add(hLocal, &hLocal, true));
+
+    std::vector<CSocketEvents::Event> vEvents;
+    BOOST_CHECK(epoll_events.WaitEvents(vEvents, 0));
+    BOOST_REQUIRE_EQUAL(vEvents.size(), 1U);
+    BOOST_CHECK(vEvents[0].data == &hLocal);
+    BOOST_CHECK(!vEvents[0].fRecv);
+    BOOST_CHECK(vEvents[0].fSend);
+
+    BOOST_CHECK(epoll_events.WaitEvents(vEvents, 0));
+    BOOST_CHECK(vEvents.empty());
+
+    BOOST_CHECK_EQUAL(send(hRemote, &ch, 1, 0), 1);
+    BOOST_CHECK(epoll_events.WaitEvents(vEvents, 0));
+    BOOST_REQUIRE_EQUAL(vEvents.size(), 1U);
+    BOOST_CHECK(vEvents[0].fRecv);
+    // Not reported again while the data is still unread
+    BOOST_CHECK(epoll_events.WaitEvents(vEvents, 0));
+    BOOST_CHECK(vEvents.empty());
+
+    BOOST_CHECK_EQUAL(recv(hLocal, &ch, 1, 0), 1);
+    BOOST_CHECK(epoll_events.Remove(hLocal));
+    BOOST_CHECK_EQUAL(send(hRemote, &ch, 1, 0), 1);
+    BOOST_CHECK(epoll_events.WaitEvents(vEvents, 0));
+    BOOST_CHECK(vEvents.empty());
+#endif
+
+    CloseSocket(hLocal);
+    CloseSocket(hRemote);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
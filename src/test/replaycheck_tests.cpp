@@ -0,0 +1,309 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <replaycheck.h>
+
+#include <clientversion.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <univalue.h>
+#include <utiltime.h>
+#include <test/test_drivechain.h>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+
+using boost::asio::ip::tcp;
+
+/**
+ * A replay status endpoint on localhost that answers every request with
+ * handler(body), or with a server error if the handler returns false.
+ */
+class StubServer
+{
+public:
+    typedef std::function<bool(const std::string& strBody, std::string& strReply)> Handler;
+
+    explicit StubServer(Handler handlerIn) :
+        nRequests(0),
+        handler(handlerIn),
+        acceptor(io_service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)),
+        fStop(false)
+    {
+        thread = std::thread(&StubServer::Run, this);
+    }
+
+    ~StubServer()
+    {
+        // Wake up the accept
+        fStop = true;
+        boost::asio::io_service io_service_stop;
+        tcp::socket socket(io_service_stop);
+        socket.connect(acceptor.local_endpoint());
+        thread.join();
+    }
+
+    std::string GetURL() const
+    {
+        return strprintf("http://127.0.0.1:%d/replaystatus", acceptor.local_endpoint().port());
+    }
+
+    std::atomic<int> nRequests;
+
+private:
+    void Run()
+    {
+        while (true) {
+            tcp::socket socket(io_service);
+            acceptor.accept(socket);
+            if (fStop)
+                return;
+            try {
+                boost::asio::streambuf buf;
+                size_t nHeader = boost::asio::read_until(socket, buf, "\r\n\r\n");
+                std::string strData(boost::asio::buffers_begin(buf.data()), boost::asio::buffers_end(buf.data()));
+                std::string strHeader = strData.substr(0, nHeader);
+                size_t nLength = strHeader.find("Content-Length: ");
+                size_t nBody = nLength == std::string::npos ? 0 : atoi(strHeader.substr(nLength + 16));
+                if (strData.size() < nHeader + nBody)
+                    boost::asio::read(socket, buf, boost::asio::transfer_exactly(nHeader + nBody - strData.size()));
+                std::string strRequest(boost::asio::buffers_begin(buf.data()), boost::asio::buffers_end(buf.data()));
+                nRequests++;
+
+                std::string strReply;
+                std::string strResponse;
+                if (handler(strRequest.substr(nHeader), strReply))
+                    strResponse = strprintf("HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n\r\n%s", strReply.size(), strReply);
+                else
+                    strResponse = "HTTP/1.0 500 Internal Server Error\r\nContent-Length: 0\r\n\r\n";
+                boost::asio::write(socket, boost::asio::buffer(strResponse));
+            } catch (const std::exception&) {
+            }
+        }
+    }
+
+    Handler handler;
+    boost::asio::io_service io_service;
+    tcp::acceptor acceptor;
+    std::atomic<bool> fStop;
+    std::thread thread;
+};
+
+// Transactions with an even first byte were replayed
+static bool IsReplayed(const uint256& txid)
+{
+    return (*txid.begin() & 1) == 0;
+}
+
+static bool ReplyReplayed(const std::string& strBody, std::string& strReply)
+{
+    UniValue request;
+    if (!request.read(strBody))
+        return false;
+    const UniValue& txids = find_value(request, "txids");
+    UniValue reply(UniValue::VOBJ);
+    for (size_t i = 0; i < txids.size(); i++)
+        reply.pushKV(txids[i].get_str(), UniValue(IsReplayed(uint256S(txids[i].get_str()))));
+    strReply = reply.write();
+    return true;
+}
+
+static const CMessageHeader::MessageStartChars MAGIC = {0xf9, 0xbe, 0xb4, 0xd9};
+
+BOOST_FIXTURE_TEST_SUITE(replaycheck_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(parse_endpoint)
+{
+    APIEndpoint endpoint;
+    BOOST_CHECK(ParseAPIEndpoint("https://example.com/api/replay", endpoint));
+    BOOST_CHECK_EQUAL(endpoint.strHost, "example.com");
+    BOOST_CHECK_EQUAL(endpoint.nPort, 443);
+    BOOST_CHECK(endpoint.fTLS);
+    BOOST_CHECK_EQUAL(endpoint.strPath, "/api/replay");
+
+    BOOST_CHECK(ParseAPIEndpoint("http://127.0.0.1:8080", endpoint));
+    BOOST_CHECK_EQUAL(endpoint.strHost, "127.0.0.1");
+    BOOST_CHECK_EQUAL(endpoint.nPort, 8080);
+    BOOST_CHECK(!endpoint.fTLS);
+    BOOST_CHECK_EQUAL(endpoint.strPath, "/");
+
+    BOOST_CHECK(!ParseAPIEndpoint("example.com/api", endpoint));
+    BOOST_CHECK(!ParseAPIEndpoint("http://", endpoint));
+    BOOST_CHECK(!ParseAPIEndpoint("http://example.com:99999/", endpoint));
+}
+
+BOOST_AUTO_TEST_CASE(endpoint_batches)
+{
+    StubServer server(ReplyReplayed);
+    CReplayChecker checker(server.GetURL(), fs::path(), MAGIC, 60);
+
+    SetMockTime(1500000000);
+    std::vector<uint256> vTxid;
+    for (unsigned int i = 0; i < 2 * REPLAY_BATCH_SIZE + 10; i++)
+        vTxid.push_back(InsecureRand256());
+
+    std::map<uint256, bool> mapReplayed;
+    checker.Check(vTxid, mapReplayed);
+    BOOST_CHECK_EQUAL(server.nRequests, 3);
+    BOOST_CHECK_EQUAL(mapReplayed.size(), vTxid.size());
+    for (const uint256& txid : vTxid)
+        BOOST_CHECK_EQUAL(mapReplayed[txid], IsReplayed(txid));
+
+    // The results are cached
+    mapReplayed.clear();
+    checker.Check(vTxid, mapReplayed);
+    BOOST_CHECK_EQUAL(server.nRequests, 3);
+    BOOST_CHECK_EQUAL(mapReplayed.size(), vTxid.size());
+
+    // Only transactions that weren't replayed are checked again once their
+    // result expired
+    size_t nNotReplayed = 0;
+    for (const uint256& txid : vTxid)
+        nNotReplayed += !IsReplayed(txid);
+    SetMockTime(1500000000 + 60);
+    mapReplayed.clear();
+    checker.Check(vTxid, mapReplayed);
+    BOOST_CHECK_EQUAL(server.nRequests, 3 + (int)((nNotReplayed + REPLAY_BATCH_SIZE - 1) / REPLAY_BATCH_SIZE));
+    BOOST_CHECK_EQUAL(mapReplayed.size(), vTxid.size());
+
+    SetMockTime(0);
+}
+
+BOOST_AUTO_TEST_CASE(endpoint_failure)
+{
+    std::atomic<bool> fFail(true);
+    StubServer server([&fFail](const std::string& strBody, std::string& strReply) {
+        return !fFail && ReplyReplayed(strBody, strReply);
+    });
+    CReplayChecker checker(server.GetURL(), fs::path(), MAGIC, 60);
+
+    std::vector<uint256> vTxid;
+    for (unsigned int i = 0; i < 2 * REPLAY_BATCH_SIZE; i++)
+        vTxid.push_back(InsecureRand256());
+
+    // The following batches aren't sent after a failed request, and nothing
+    // is cached
+    std::map<uint256, bool> mapReplayed;
+    checker.Check(vTxid, mapReplayed);
+    BOOST_CHECK_EQUAL(server.nRequests, 1);
+    BOOST_CHECK(mapReplayed.empty());
+
+    fFail = false;
+    checker.Check(vTxid, mapReplayed);
+    BOOST_CHECK_EQUAL(server.nRequests, 3);
+    BOOST_CHECK_EQUAL(mapReplayed.size(), vTxid.size());
+
+    // Transactions the endpoint leaves out aren't returned
+    StubServer serverEmpty([](const std::string& strBody, std::string& strReply) {
+        strReply = "{}";
+        return true;
+    });
+    CReplayChecker checkerNothing(serverEmpty.GetURL(), fs::path(), MAGIC, 60);
+    mapReplayed.clear();
+    checkerNothing.Check(vTxid, mapReplayed);
+    BOOST_CHECK(mapReplayed.empty());
+}
+
+BOOST_AUTO_TEST_CASE(block_files)
+{
+    fs::path pathBlocksDir = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(pathBlocksDir);
+    const int nVersion = CLIENT_VERSION | SERIALIZE_TRANSACTION_NO_DRIVECHAIN;
+
+    std::vector<uint256> vReplayed;
+    for (int nFile = 0; nFile < 2; nFile++) {
+        CDataStream ss(SER_DISK, nVersion);
+        for (int nBlock = 0; nBlock < 3; nBlock++) {
+            CBlock block;
+            block.nVersion = 1;
+            block.nTime = 1500000000;
+            block.nNonce = nFile * 3 + nBlock;
+            for (int i = 0; i < 5; i++) {
+                CMutableTransaction tx;
+                // Version 3 transactions of the other chain don't have critical data
+                tx.nVersion = i % 2 ? 3 : 2;
+                tx.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+                tx.vout.emplace_back(COIN, CScript() << OP_TRUE);
+                block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+                vReplayed.push_back(block.vtx.back()->GetHash());
+            }
+            // Junk between the blocks is skipped
+            ss << std::vector<unsigned char>(10, 0xf9);
+            ss << FLATDATA(MAGIC);
+            ss << (unsigned int)::GetSerializeSize(block, SER_DISK, nVersion);
+            ss << block;
+        }
+        CAutoFile file(fsbridge::fopen(pathBlocksDir / strprintf("blk%05u.dat", nFile), "wb"), SER_DISK, nVersion);
+        file.write(ss.data(), ss.size());
+    }
+
+    std::vector<uint256> vTxid = {vReplayed[0], vReplayed[7], vReplayed[29], InsecureRand256()};
+    CReplayChecker checker("", pathBlocksDir, MAGIC, 60);
+    std::map<uint256, bool> mapReplayed;
+    checker.Check(vTxid, mapReplayed);
+    BOOST_CHECK_EQUAL(mapReplayed.size(), vTxid.size());
+    BOOST_CHECK(mapReplayed[vReplayed[0]]);
+    BOOST_CHECK(mapReplayed[vReplayed[7]]);
+    BOOST_CHECK(mapReplayed[vReplayed[29]]);
+    BOOST_CHECK(!mapReplayed[vTxid[3]]);
+
+    // Block files of a chain with another magic don't have the transactions
+    const CMessageHeader::MessageStartChars magicOther = {0x0b, 0x11, 0x09, 0x07};
+    CReplayChecker checkerOther("", pathBlocksDir, magicOther, 60);
+    mapReplayed.clear();
+    checkerOther.Check(vTxid, mapReplayed);
+    BOOST_CHECK_EQUAL(mapReplayed.size(), vTxid.size());
+    BOOST_CHECK(!mapReplayed[vReplayed[0]]);
+
+    // Obfuscated block files can't be read
+    CAutoFile(fsbridge::fopen(pathBlocksDir / "xor.dat", "wb"), SER_DISK, CLIENT_VERSION) << std::vector<unsigned char>(8, 1);
+    CReplayChecker checkerXor("", pathBlocksDir, MAGIC, 60);
+    mapReplayed.clear();
+    checkerXor.Check(vTxid, mapReplayed);
+    BOOST_CHECK(mapReplayed.empty());
+    fs::remove(pathBlocksDir / "xor.dat");
+
+    // Later checks only read the blocks appended since the last scan
+    CBlock blockLater;
+    blockLater.nVersion = 1;
+    blockLater.nTime = 1500000000;
+    CMutableTransaction txLater;
+    txLater.nVersion = 2;
+    txLater.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    txLater.vout.emplace_back(COIN, CScript() << OP_TRUE);
+    blockLater.vtx.push_back(MakeTransactionRef(std::move(txLater)));
+    const uint256 hashLater = blockLater.vtx.back()->GetHash();
+
+    CReplayChecker checkerLater("", pathBlocksDir, MAGIC, 0);
+    mapReplayed.clear();
+    checkerLater.Check({vReplayed[0], hashLater}, mapReplayed);
+    BOOST_CHECK(mapReplayed[vReplayed[0]]);
+    BOOST_CHECK(!mapReplayed[hashLater]);
+
+    fs::remove(pathBlocksDir / "blk00000.dat");
+    {
+        CAutoFile file(fsbridge::fopen(pathBlocksDir / "blk00002.dat", "wb"), SER_DISK, nVersion);
+        file << FLATDATA(MAGIC);
+        file << (unsigned int)::GetSerializeSize(blockLater, SER_DISK, nVersion);
+        file << blockLater;
+    }
+    mapReplayed.clear();
+    checkerLater.Check({vReplayed[0], hashLater}, mapReplayed);
+    BOOST_CHECK_EQUAL(mapReplayed.size(), 2U);
+    BOOST_CHECK(mapReplayed[vReplayed[0]]);
+    BOOST_CHECK(mapReplayed[hashLater]);
+
+    // A transaction that wasn't looked for before needs all the block files
+    mapReplayed.clear();
+    checkerLater.Check({InsecureRand256()}, mapReplayed);
+    BOOST_CHECK(mapReplayed.empty());
+
+    fs::remove_all(pathBlocksDir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
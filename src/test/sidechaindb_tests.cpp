@@ -12,6 +12,7 @@
 #include "script/sigcache.h"
 #include "sidechain.h"
 #include "sidechaindb.h"
+#include "sidechainsim.h"
 #include "uint256.h"
 #include "utilstrencodings.h"
 #include "validation.h"
@@ -399,6 +400,203 @@ BOOST_AUTO_TEST_CASE(sidechaindb_wallet_ctip_spend_withdrawal)
     BOOST_CHECK(ctip2.out.n == 1);
 }
 
+BOOST_AUTO_TEST_CASE(sidechaindb_withdrawal_bundle_cache)
+{
+    // Cache a withdrawal bundle as received from the sidechain, then pay it
+    // out using the parsed outputs cached by SCDB.
+
+    SidechainDB scdbTest;
+
+    BOOST_CHECK(ActivateTestSidechain(scdbTest));
+
+    CScript sidechainScript;
+    BOOST_CHECK(scdbTest.GetSidechainScript(0, sidechainScript));
+
+    // Create deposit
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.SetNull();
+    mtx.vout.push_back(CTxOut(CAmount(0), CScript() << OP_RETURN << ToByteVector(GetRandHash())));
+    mtx.vout.push_back(CTxOut(50 * CENT, sidechainScript));
+
+    SidechainDeposit deposit;
+    deposit.nSidechain = 0;
+    deposit.strDest = "";
+    deposit.tx = mtx;
+    deposit.nBurnIndex = 1;
+    deposit.nTx = 1;
+
+    scdbTest.AddDeposits(std::vector<SidechainDeposit>{ deposit });
+
+    SidechainCTIP ctip;
+    BOOST_CHECK(scdbTest.GetCTIP(0, ctip));
+
+    CKey key;
+    key.MakeNewKey(true);
+
+    // Create the withdrawal bundle the way the sidechain does, without an
+    // input or change return
+    CMutableTransaction bmtx;
+    bmtx.nVersion = 2;
+    bmtx.vin.resize(1);
+    bmtx.vin[0].scriptSig = CScript() << OP_0;
+    bmtx.vout.push_back(CTxOut(CAmount(0), CScript() << OP_RETURN << ParseHex(HexStr(SIDECHAIN_WITHDRAWAL_RETURN_DEST) )));
+    bmtx.vout.push_back(CTxOut(CAmount(0), EncodeWithdrawalFees(1 * CENT)));
+    bmtx.vout.push_back(CTxOut(25 * CENT, GetScriptForDestination(key.GetPubKey().GetID())));
+
+    CTransaction bundle(bmtx);
+
+    // Parse without caching the raw transaction
+    SidechainBundleInfo info = scdbTest.GetBundleInfo(bundle);
+    BOOST_CHECK(info.hash == bundle.GetHash());
+    BOOST_CHECK(info.destStatus == SidechainBundleInfo::DEST_VALID);
+    BOOST_CHECK(info.fFeesValid && info.amountFees == 1 * CENT);
+    BOOST_CHECK(info.amountOut == 25 * CENT);
+    BOOST_CHECK(info.nSidechainOutputs == 0);
+    BOOST_CHECK(!info.fTxCached);
+    BOOST_CHECK(!scdbTest.HaveWithdrawalTxCached(bundle.GetHash()));
+
+    BOOST_CHECK(scdbTest.CacheWithdrawalTx(bundle, 0));
+    BOOST_CHECK(scdbTest.HaveWithdrawalTxCached(bundle.GetHash()));
+    BOOST_CHECK(!scdbTest.CacheWithdrawalTx(bundle, 0));
+
+    // Create the payout which spends the CTIP
+    CMutableTransaction wmtx(bmtx);
+    wmtx.vin[0] = CTxIn(ctip.out);
+    wmtx.vout.push_back(CTxOut(24 * CENT, sidechainScript));
+
+    CTransaction payout(wmtx);
+
+    uint256 hashBlind;
+    BOOST_CHECK(scdbTest.GetBlindHash(payout, hashBlind));
+    BOOST_CHECK(hashBlind == bundle.GetHash());
+
+    // Give the bundle sufficient work score
+    scdbTest.AddWithdrawal(0, hashBlind, 0);
+    std::vector<std::string> vVote(SIDECHAIN_ACTIVATION_MAX_ACTIVE, std::string(1, SCDB_ABSTAIN));
+    vVote[0] = hashBlind.ToString();
+    for (int i = 1; i < SIDECHAIN_WITHDRAWAL_MIN_WORKSCORE; i++)
+        BOOST_CHECK(scdbTest.UpdateSCDBIndex(vVote));
+
+    // A payout with the wrong change amount is rejected
+    CMutableTransaction wmtxBad(wmtx);
+    wmtxBad.vout.back().nValue = 25 * CENT;
+    BOOST_CHECK(!scdbTest.SpendWithdrawal(0, GetRandHash(), wmtxBad, 1, true /* fJustCheck */));
+
+    // Check and then spend the payout like ConnectBlock does
+    uint256 hashBlock = GetRandHash();
+    BOOST_CHECK(scdbTest.SpendWithdrawal(0, hashBlock, payout, 1, true /* fJustCheck */));
+    BOOST_CHECK(scdbTest.HaveWithdrawalTxCached(hashBlind));
+    BOOST_CHECK(scdbTest.SpendWithdrawal(0, hashBlock, payout, 1));
+
+    // The raw bundle is removed from the cache once paid out
+    BOOST_CHECK(!scdbTest.HaveWithdrawalTxCached(hashBlind));
+
+    SidechainCTIP ctipFinal;
+    BOOST_CHECK(scdbTest.GetCTIP(0, ctipFinal));
+    BOOST_CHECK(ctipFinal.out == COutPoint(payout.GetHash(), 3));
+    BOOST_CHECK(ctipFinal.amount == 24 * CENT);
+
+    // A bundle whose first OP_RETURN isn't the return destination is invalid
+    CMutableTransaction bmtxBad(bmtx);
+    bmtxBad.vout[0].scriptPubKey = CScript() << OP_RETURN << ParseHex("ff");
+    BOOST_CHECK(scdbTest.GetBundleInfo(bmtxBad).destStatus == SidechainBundleInfo::DEST_INCORRECT);
+}
+
+BOOST_AUTO_TEST_CASE(sidechaindb_withdrawal_simulation)
+{
+    // Check that the projected outcome of a vote strategy matches what
+    // actually happens when SCDB is updated with the same votes
+    SidechainDB scdbBase;
+    BOOST_CHECK(ActivateTestSidechain(scdbBase));
+
+    uint256 hashA = GetRandHash();
+    uint256 hashB = GetRandHash();
+
+    std::vector<std::string> vAbstain(SIDECHAIN_ACTIVATION_MAX_ACTIVE, std::string(1, SCDB_ABSTAIN));
+    std::vector<std::string> vUpvoteA = vAbstain;
+    vUpvoteA[0] = hashA.ToString();
+
+    std::map<uint8_t, uint256> mapNewWithdrawal;
+    mapNewWithdrawal[0] = hashA;
+    BOOST_CHECK(scdbBase.UpdateSCDBIndex(vAbstain, false, mapNewWithdrawal));
+    mapNewWithdrawal[0] = hashB;
+    BOOST_CHECK(scdbBase.UpdateSCDBIndex(vAbstain, false, mapNewWithdrawal));
+    for (int i = 0; i < 100; i++)
+        BOOST_CHECK(scdbBase.UpdateSCDBIndex(vUpvoteA));
+
+    const int nHeight = 1000;
+    SidechainWithdrawalSim sim(scdbBase.GetState(), nHeight);
+    BOOST_CHECK_EQUAL(sim.GetWithdrawalCount(), 2);
+
+    std::vector<SidechainVoteStrategy> vStrategy(4);
+    vStrategy[0].vote = SidechainVoteStrategy::UPVOTE;
+    vStrategy[0].hash = hashA;
+    vStrategy[1].vote = SidechainVoteStrategy::UPVOTE;
+    vStrategy[1].hash = hashA;
+    vStrategy[1].nPercent = 75;
+    vStrategy[2].vote = SidechainVoteStrategy::DOWNVOTE;
+    vStrategy[2].nPercent = 50;
+    vStrategy[3].vote = SidechainVoteStrategy::ABSTAIN;
+
+    for (const SidechainVoteStrategy& strategy : vStrategy) {
+        std::map<uint8_t, SidechainVoteStrategy> mapStrategy;
+        mapStrategy[0] = strategy;
+        std::vector<SidechainWithdrawalProjection> vProjection = sim.Run(mapStrategy, SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD);
+        BOOST_REQUIRE(vProjection.size() == 2);
+
+        std::vector<std::string> vVote = vAbstain;
+        if (strategy.vote == SidechainVoteStrategy::UPVOTE)
+            vVote[0] = strategy.hash.ToString();
+        else
+        if (strategy.vote == SidechainVoteStrategy::DOWNVOTE)
+            vVote[0] = std::string(1, SCDB_DOWNVOTE);
+
+        // Update a copy of SCDB with the same votes and record the heights
+        // each withdrawal was approved or removed at
+        SidechainDB scdbTest = scdbBase;
+        std::map<uint256, int> mapApproved;
+        std::map<uint256, int> mapExpired;
+        for (int i = 0; i < SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD; i++) {
+            int nBlockHeight = nHeight + i + 1;
+            bool fVote = ((i + 1) * strategy.nPercent) / 100 != (i * strategy.nPercent) / 100;
+            BOOST_CHECK(scdbTest.UpdateSCDBIndex(fVote ? vVote : vAbstain));
+
+            for (const uint256& hash : {hashA, hashB}) {
+                if (mapApproved.count(hash) || mapExpired.count(hash))
+                    continue;
+                if (!scdbTest.HaveWorkScore(hash, 0))
+                    mapExpired[hash] = nBlockHeight;
+                else
+                if (scdbTest.CheckWorkScore(0, hash))
+                    mapApproved[hash] = nBlockHeight + 1;
+            }
+        }
+
+        for (const SidechainWithdrawalProjection& p : vProjection) {
+            if (p.status == SidechainWithdrawalProjection::APPROVED) {
+                BOOST_CHECK(mapApproved.count(p.hash));
+                BOOST_CHECK_EQUAL(p.nHeight, mapApproved[p.hash]);
+            }
+            else
+            if (p.status == SidechainWithdrawalProjection::EXPIRED) {
+                BOOST_CHECK(mapExpired.count(p.hash));
+                BOOST_CHECK_EQUAL(p.nHeight, mapExpired[p.hash]);
+            } else {
+                BOOST_CHECK(!mapApproved.count(p.hash) && !mapExpired.count(p.hash));
+            }
+        }
+
+        if (strategy.vote == SidechainVoteStrategy::UPVOTE) {
+            BOOST_CHECK(vProjection[0].status == SidechainWithdrawalProjection::APPROVED);
+            BOOST_CHECK(vProjection[1].status == SidechainWithdrawalProjection::EXPIRED);
+        } else {
+            BOOST_CHECK(vProjection[0].status == SidechainWithdrawalProjection::EXPIRED);
+            BOOST_CHECK(vProjection[1].status == SidechainWithdrawalProjection::EXPIRED);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(IsWithdrawalHashCommit)
 {
     // TODO test invalid
@@ -84,7 +84,8 @@ TestingSetup::TestingSetup(const std::string& chainName) : BasicTestingSetup(cha
         psidechaintree.reset(new CSidechainTreeDB(1 << 20, true));
         popreturndb.reset(new OPReturnDB(1 << 20, true));
         pcoinsdbview.reset(new CCoinsViewDB(1 << 23, true));
-        pcoinsTip.reset(new CCoinsViewCache(pcoinsdbview.get()));
+        pcoinsflush.reset(new CCoinsViewBackgroundFlush(pcoinsdbview.get()));
+        pcoinsTip.reset(new CCoinsViewCache(pcoinsflush.get()));
         if (!LoadGenesisBlock(chainparams)) {
             throw std::runtime_error("LoadGenesisBlock failed.");
         }
@@ -112,6 +113,7 @@ TestingSetup::~TestingSetup()
         peerLogic.reset();
         UnloadBlockIndex();
         pcoinsTip.reset();
+        pcoinsflush.reset();
         pcoinsdbview.reset();
         pblocktree.reset();
         psidechaintree.reset();
@@ -492,6 +492,61 @@ BOOST_AUTO_TEST_CASE(test_big_witness_transaction) {
     threadGroup.join_all();
 }
 
+BOOST_AUTO_TEST_CASE(test_sign_inputs_parallel)
+{
+    CBasicKeyStore keystore;
+    CMutableTransaction mtx;
+    std::vector<CTxOut> vSpent;
+    std::vector<CKeyID> vKeyID;
+
+    // Legacy and segwit inputs, each paying a key of its own
+    for (uint32_t i = 0; i < 64; i++) {
+        CKey key;
+        key.MakeNewKey(true);
+        keystore.AddKey(key);
+        vKeyID.push_back(key.GetPubKey().GetID());
+        CScript scriptPubKey = GetScriptForDestination(vKeyID.back());
+        if (i % 2)
+            scriptPubKey = GetScriptForWitness(scriptPubKey);
+        vSpent.emplace_back(1000, scriptPubKey);
+        mtx.vin.emplace_back(COutPoint(InsecureRand256(), i));
+    }
+    mtx.vout.emplace_back(64 * 1000 - 1000, CScript() << OP_TRUE);
+
+    CMutableTransaction mtxSerial = mtx;
+    BOOST_CHECK(SignTransactionInputs(keystore, mtx, vSpent, 8));
+    BOOST_CHECK(SignTransactionInputs(keystore, mtxSerial, vSpent, 1));
+
+    const CTransaction tx(mtx);
+    PrecomputedTransactionData txdata(tx);
+    for (uint32_t i = 0; i < tx.vin.size(); i++) {
+        ScriptError err;
+        BOOST_CHECK(VerifyScript(tx.vin[i].scriptSig, vSpent[i].scriptPubKey, &tx.vin[i].scriptWitness, STANDARD_SCRIPT_VERIFY_FLAGS, TransactionSignatureChecker(&tx, i, vSpent[i].nValue, txdata), &err));
+        BOOST_CHECK_EQUAL(err, SCRIPT_ERR_OK);
+
+        // Signing serially produces the same signatures
+        BOOST_CHECK(tx.vin[i].scriptSig == mtxSerial.vin[i].scriptSig);
+        BOOST_CHECK(tx.vin[i].scriptWitness.stack == mtxSerial.vin[i].scriptWitness.stack);
+    }
+
+    // Without a witness the cache is only computed when forced, and a
+    // forced cache gives the same signature hashes
+    CMutableTransaction mtxUnsigned = mtx;
+    for (CTxIn& txin : mtxUnsigned.vin) {
+        txin.scriptSig = CScript();
+        txin.scriptWitness.SetNull();
+    }
+    const CTransaction txUnsigned(mtxUnsigned);
+    BOOST_CHECK(!PrecomputedTransactionData(txUnsigned).ready);
+    const PrecomputedTransactionData txdataForced(txUnsigned, true);
+    BOOST_CHECK(txdataForced.ready);
+    for (uint32_t i = 0; i < txUnsigned.vin.size(); i++) {
+        const CScript scriptCode = GetScriptForDestination(vKeyID[i]);
+        BOOST_CHECK(SignatureHash(scriptCode, txUnsigned, i, SIGHASH_ALL, vSpent[i].nValue, SIGVERSION_WITNESS_V0, &txdataForced) ==
+                    SignatureHash(scriptCode, txUnsigned, i, SIGHASH_ALL, vSpent[i].nValue, SIGVERSION_WITNESS_V0));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(test_witness)
 {
     CBasicKeyStore keystore, keystore2;
@@ -0,0 +1,79 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <index/txindex.h>
+#include <test/test_drivechain.h>
+#include <util.h>
+#include <utiltime.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(txindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
+{
+    TxIndex txindex(1 << 20, true);
+
+    // Transactions of the blocks that were connected before the index started
+    std::vector<std::pair<uint256, CTransactionRef>> vTx;
+    {
+        LOCK(cs_main);
+        for (const CBlockIndex* pindex = chainActive.Genesis(); pindex; pindex = chainActive.Next(pindex)) {
+            CBlock block;
+            BOOST_REQUIRE(ReadBlockFromDisk(block, pindex, Params().GetConsensus()));
+            for (const CTransactionRef& tx : block.vtx) {
+                vTx.emplace_back(pindex->GetBlockHash(), tx);
+            }
+        }
+    }
+    BOOST_REQUIRE(!vTx.empty());
+
+    CTransactionRef tx_disk;
+    uint256 block_hash;
+
+    // Transaction should not be found in the index before it is started.
+    for (const auto& tx : vTx) {
+        BOOST_CHECK(!txindex.FindTx(tx.second->GetHash(), block_hash, tx_disk));
+    }
+
+    // BlockUntilSyncedToCurrentChain should return false before txindex is started.
+    BOOST_CHECK(!txindex.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(!txindex.GetSummary().synced);
+    BOOST_CHECK_EQUAL(txindex.GetSummary().best_block_height, -1);
+
+    txindex.Start();
+
+    // Allow tx index to catch up with the block index.
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!txindex.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+    BOOST_CHECK(txindex.GetSummary().synced);
+    BOOST_CHECK_EQUAL(txindex.GetSummary().best_block_height, chainActive.Height());
+
+    // Check that txindex has all txs that were in the chain before it started.
+    for (const auto& tx : vTx) {
+        if (!txindex.FindTx(tx.second->GetHash(), block_hash, tx_disk)) {
+            BOOST_ERROR("FindTx failed");
+        } else if (tx_disk->GetHash() != tx.second->GetHash()) {
+            BOOST_ERROR("Read incorrect tx");
+        } else {
+            BOOST_CHECK(block_hash == tx.first);
+        }
+    }
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    txindex.Stop();
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <coins.h>
+#include <hash.h>
+#include <rpc/server.h>
+#include <script/script.h>
+#include <test/test_drivechain.h>
+#include <util.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+extern UniValue CallRPC(std::string args);
+
+BOOST_FIXTURE_TEST_SUITE(txoutset_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(txoutset_dump)
+{
+    // Blocks can't be created without the header signing key, add coins
+    // to the chainstate at the genesis block instead
+    std::map<uint256, std::map<uint32_t, Coin>> mapOutputs;
+    {
+        LOCK(cs_main);
+        for (int i = 0; i < 10; i++) {
+            uint256 txid = InsecureRand256();
+            for (uint32_t n = 0; n < 3; n++) {
+                Coin coin(CTxOut(i * COIN + n, CScript() << OP_TRUE), 1, i == 0);
+                mapOutputs[txid][n] = coin;
+                pcoinsTip->AddCoin(COutPoint(txid, n), std::move(coin), false);
+            }
+        }
+    }
+
+    // The UTXO set hash is the same as hash_serialized_2 of gettxoutsetinfo
+    uint256 hashGenesis = Params().GetConsensus().hashGenesisBlock;
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << hashGenesis;
+    for (const auto& outputs : mapOutputs)
+        HashTxOutputs(ss, outputs.first, outputs.second);
+
+    fs::path path = GetDataDir() / "utxo.dat";
+    CTxOutSetSnapshotInfo info;
+    std::string strError;
+    BOOST_REQUIRE_MESSAGE(DumpTxOutSet(path, info, strError), strError);
+    BOOST_CHECK(info.hashBlock == hashGenesis);
+    BOOST_CHECK_EQUAL(info.nHeight, 0);
+    BOOST_CHECK_EQUAL(info.nHeaders, 0U);
+    BOOST_CHECK_EQUAL(info.nCoins, 30U);
+    BOOST_CHECK(info.hashSerialized == ss.GetHash());
+
+    // The snapshot hash commits to the sidechain state too
+    CHashWriter ssSnapshot(SER_GETHASH, PROTOCOL_VERSION);
+    ssSnapshot << info.hashBlock << info.hashSerialized << info.hashSidechain;
+    BOOST_CHECK(info.hashSnapshot == ssSnapshot.GetHash());
+    BOOST_CHECK(!info.hashSidechain.IsNull());
+
+    BOOST_CHECK(fs::exists(path));
+    BOOST_CHECK(!fs::exists(GetDataDir() / "utxo.dat.new"));
+
+    // The same chainstate gives the same snapshot
+    CTxOutSetSnapshotInfo infoDump;
+    BOOST_REQUIRE_MESSAGE(DumpTxOutSet(GetDataDir() / "utxo2.dat", infoDump, strError), strError);
+    BOOST_CHECK(infoDump.hashSerialized == info.hashSerialized);
+    BOOST_CHECK(infoDump.hashSidechain == info.hashSidechain);
+    BOOST_CHECK(infoDump.hashSnapshot == info.hashSnapshot);
+    BOOST_CHECK_EQUAL(fs::file_size(path), fs::file_size(GetDataDir() / "utxo2.dat"));
+
+    // The expected hash is required
+    CTxOutSetSnapshotInfo infoLoad;
+    BOOST_CHECK(!LoadTxOutSet(path, uint256(), infoLoad, strError));
+    BOOST_CHECK_EQUAL(strError, "The expected hash of the UTXO snapshot is required");
+
+    // A snapshot at the genesis block has nothing to load
+    BOOST_CHECK(!LoadTxOutSet(path, info.hashSnapshot, infoLoad, strError));
+    BOOST_CHECK(!IsSnapshotChainstate());
+    BOOST_CHECK(!LoadTxOutSet(GetDataDir() / "missing.dat", info.hashSnapshot, infoLoad, strError));
+}
+
+BOOST_AUTO_TEST_CASE(txoutset_load_invalid)
+{
+    std::string strError;
+    CTxOutSetSnapshotInfo info;
+
+    // Snapshot of another network
+    fs::path path = GetDataDir() / "utxo.dat";
+    {
+        CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!file.IsNull());
+        const unsigned char messageStart[4] = {0x00, 0x01, 0x02, 0x03};
+        file << FLATDATA(messageStart);
+        file << (uint64_t)1;
+    }
+    BOOST_CHECK(!LoadTxOutSet(path, uint256S("01"), info, strError));
+    BOOST_CHECK_EQUAL(strError, "The UTXO snapshot is for a different network");
+
+    // Truncated snapshot
+    {
+        CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!file.IsNull());
+        file << FLATDATA(Params().MessageStart());
+        file << (uint64_t)1;
+        file << uint256S("01");
+    }
+    BOOST_CHECK(!LoadTxOutSet(path, uint256S("01"), info, strError));
+    BOOST_CHECK(!IsSnapshotChainstate());
+    BOOST_CHECK_EQUAL(chainActive.Height(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(txoutset_stats)
+{
+    // Enough transactions for every shard of gettxoutsetinfo to have coins
+    CAmount nTotal = 0;
+    CAmount nEscrow = 0;
+    {
+        LOCK(cs_main);
+        for (int i = 0; i < 500; i++) {
+            uint256 txid = InsecureRand256();
+            for (uint32_t n = 0; n < 2; n++) {
+                CScript script = CScript() << OP_TRUE;
+                if (i % 10 == 0 && n == 0) {
+                    script = CScript() << OP_DRIVECHAIN;
+                    script.push_back(7);
+                    nEscrow += i;
+                }
+                nTotal += i;
+                pcoinsTip->AddCoin(COutPoint(txid, n), Coin(CTxOut(i, script), 1, false), false);
+            }
+        }
+    }
+
+    UniValue result = CallRPC("gettxoutsetinfo");
+    BOOST_CHECK_EQUAL(find_value(result, "transactions").get_int(), 500);
+    BOOST_CHECK_EQUAL(find_value(result, "txouts").get_int(), 1000);
+    BOOST_CHECK_EQUAL(AmountFromValue(find_value(result, "total_amount")), nTotal);
+
+    const UniValue& escrow = find_value(result, "escrow");
+    BOOST_REQUIRE_EQUAL(escrow.size(), 1U);
+    BOOST_CHECK_EQUAL(find_value(escrow[0], "nsidechain").get_int(), 7);
+    BOOST_CHECK_EQUAL(find_value(escrow[0], "txouts").get_int(), 50);
+    BOOST_CHECK_EQUAL(AmountFromValue(find_value(escrow[0], "amount")), nEscrow);
+
+    // The shards are hashed in database order, as by a snapshot
+    CTxOutSetSnapshotInfo info;
+    std::string strError;
+    BOOST_REQUIRE_MESSAGE(DumpTxOutSet(GetDataDir() / "utxo.dat", info, strError), strError);
+    BOOST_CHECK_EQUAL(find_value(result, "hash_serialized_2").get_str(), info.hashSerialized.GetHex());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,14 +19,15 @@
 #include <script/standard.h>
 #include <base58.h>
 
+#include <functional>
 #include <stdint.h>
+#include <unordered_map>
 
 #include <boost/thread.hpp>
 
 static const char DB_COIN = 'C';
 static const char DB_COINS = 'c';
 static const char DB_BLOCK_FILES = 'f';
-static const char DB_TXINDEX = 't';
 static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
@@ -34,6 +35,8 @@ static const char DB_HEAD_BLOCKS = 'H';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
+static const char DB_SNAPSHOT_BASE = 'S';
+static const char DB_FLAT_BLOCK_INDEX = 'I';
 
 static const char DB_OP_RETURN = 'x';
 static const char DB_OP_RETURN_TYPES = 'X';
@@ -96,6 +99,15 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
 }
 
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+    bool ret = WriteCoins(mapCoins, hashBlock);
+    // The nodes belong to the pool of the cache, erasing them while writing
+    // wouldn't give back any memory
+    mapCoins.clear();
+    return ret;
+}
+
+bool CCoinsViewDB::WriteCoins(const CCoinsMap &mapCoins, const uint256 &hashBlock, bool fComplete) {
+    int64_t nStart = GetTimeMicros();
     CDBBatch batch(db);
     size_t count = 0;
     size_t changed = 0;
@@ -120,7 +132,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     batch.Erase(DB_BEST_BLOCK);
     batch.Write(DB_HEAD_BLOCKS, std::vector<uint256>{hashBlock, old_tip});
 
-    for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+    for (CCoinsMap::const_iterator it = mapCoins.begin(); it != mapCoins.end(); it++) {
         if (it->second.flags & CCoinsCacheEntry::DIRTY) {
             CoinEntry entry(&it->first);
             if (it->second.coin.IsSpent())
@@ -130,8 +142,6 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
             changed++;
         }
         count++;
-        CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
         if (batch.SizeEstimate() > batch_size) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
             db.WriteBatch(batch);
@@ -147,12 +157,14 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     }
 
     // In the last batch, mark the database as consistent with hashBlock again.
-    batch.Erase(DB_HEAD_BLOCKS);
-    batch.Write(DB_BEST_BLOCK, hashBlock);
+    if (fComplete) {
+        batch.Erase(DB_HEAD_BLOCKS);
+        batch.Write(DB_BEST_BLOCK, hashBlock);
+    }
 
     LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
     bool ret = db.WriteBatch(batch);
-    LogPrint(BCLog::COINDB, "Committed %u changed transaction outputs (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
+    LogPrint(BCLog::COINDB, "Committed %u changed transaction outputs (out of %u) to coin database in %.2fms\n", (unsigned int)changed, (unsigned int)count, (GetTimeMicros() - nStart) * 0.001);
     return ret;
 }
 
@@ -161,7 +173,148 @@ size_t CCoinsViewDB::EstimateSize() const
     return db.EstimateSize(DB_COIN, (char)(DB_COIN+1));
 }
 
+CCoinsViewBackgroundFlush::CCoinsViewBackgroundFlush(CCoinsViewDB* dbIn) : CCoinsViewBacked(dbIn), db(dbIn), fFailed(false), nLastFlushDuration(0)
+{
+}
+
+CCoinsViewBackgroundFlush::~CCoinsViewBackgroundFlush()
+{
+    WaitForFlush();
+    if (threadFlush.joinable())
+        threadFlush.join();
+}
+
+std::shared_ptr<const CCoinsCacheSnapshot> CCoinsViewBackgroundFlush::GetSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return snapshot;
+}
+
+bool CCoinsViewBackgroundFlush::GetCoin(const COutPoint &outpoint, Coin &coin) const
+{
+    std::shared_ptr<const CCoinsCacheSnapshot> pending = GetSnapshot();
+    if (pending) {
+        CCoinsMap::const_iterator it = pending->map.find(outpoint);
+        if (it != pending->map.end()) {
+            if (it->second.coin.IsSpent())
+                return false;
+            coin = it->second.coin;
+            return true;
+        }
+    }
+    return base->GetCoin(outpoint, coin);
+}
+
+bool CCoinsViewBackgroundFlush::HaveCoin(const COutPoint &outpoint) const
+{
+    std::shared_ptr<const CCoinsCacheSnapshot> pending = GetSnapshot();
+    if (pending) {
+        CCoinsMap::const_iterator it = pending->map.find(outpoint);
+        if (it != pending->map.end())
+            return !it->second.coin.IsSpent();
+    }
+    return base->HaveCoin(outpoint);
+}
+
+uint256 CCoinsViewBackgroundFlush::GetBestBlock() const
+{
+    std::shared_ptr<const CCoinsCacheSnapshot> pending = GetSnapshot();
+    if (pending)
+        return pending->hashBlock;
+    return base->GetBestBlock();
+}
+
+bool CCoinsViewBackgroundFlush::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock)
+{
+    if (!WaitForFlush())
+        return false;
+    int64_t nStart = GetTimeMicros();
+    bool ret = base->BatchWrite(mapCoins, hashBlock);
+    std::lock_guard<std::mutex> lock(mutex);
+    nLastFlushDuration = GetTimeMicros() - nStart;
+    return ret;
+}
+
+CCoinsViewCursor *CCoinsViewBackgroundFlush::Cursor() const
+{
+    WaitForFlush();
+    return base->Cursor();
+}
+
+bool CCoinsViewBackgroundFlush::StartFlush(CCoinsViewCache& cache)
+{
+    if (!WaitForFlush())
+        return false;
+    if (threadFlush.joinable())
+        threadFlush.join();
+
+    std::shared_ptr<const CCoinsCacheSnapshot> pending(cache.Detach());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = pending;
+    }
+    threadFlush = std::thread(&TraceThread<std::function<void()>>, "coinsflush", std::function<void()>(std::bind(&CCoinsViewBackgroundFlush::ThreadFlush, this)));
+    return true;
+}
+
+void CCoinsViewBackgroundFlush::ThreadFlush()
+{
+    // Keep a reference, so that the entries are freed by this thread
+    std::shared_ptr<const CCoinsCacheSnapshot> pending = GetSnapshot();
+    int64_t nStart = GetTimeMicros();
+    bool fOk = false;
+    try {
+        fOk = db->WriteCoins(pending->map, pending->hashBlock);
+    } catch (const std::runtime_error& e) {
+        LogPrintf("%s: Error writing to coin database: %s\n", __func__, e.what());
+    }
+    int64_t nDuration = GetTimeMicros() - nStart;
+    LogPrint(BCLog::COINDB, "Background flush of %u cache entries for block %s took %.2fms\n", (unsigned int)pending->map.size(), pending->hashBlock.ToString(), nDuration * 0.001);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fOk) {
+        snapshot.reset();
+        nLastFlushDuration = nDuration;
+    } else {
+        // Keep answering from the entries, the database is behind them
+        fFailed = true;
+    }
+    condFlushed.notify_all();
+}
+
+bool CCoinsViewBackgroundFlush::WaitForFlush() const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    condFlushed.wait(lock, [this] { return !snapshot || fFailed; });
+    return !fFailed;
+}
+
+bool CCoinsViewBackgroundFlush::IsFlushing() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return snapshot != nullptr;
+}
+
+bool CCoinsViewBackgroundFlush::FlushFailed() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return fFailed;
+}
+
+size_t CCoinsViewBackgroundFlush::DynamicMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return snapshot ? snapshot->nUsage : 0;
+}
+
+int64_t CCoinsViewBackgroundFlush::GetLastFlushDuration() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return nLastFlushDuration;
+}
+
 CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe) {
+    fFlatBlockIndex = Exists(DB_FLAT_BLOCK_INDEX);
 }
 
 bool CBlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo &info) {
@@ -185,12 +338,18 @@ bool CBlockTreeDB::ReadLastBlockFile(int &nFile) {
 }
 
 CCoinsViewCursor *CCoinsViewDB::Cursor() const
+{
+    return Cursor(uint256());
+}
+
+CCoinsViewCursor *CCoinsViewDB::Cursor(const uint256 &hashStart) const
 {
     CCoinsViewDBCursor *i = new CCoinsViewDBCursor(const_cast<CDBWrapper&>(db).NewIterator(), GetBestBlock());
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
        that restriction.  */
-    i->pcursor->Seek(DB_COIN);
+    COutPoint outpoint(hashStart, 0);
+    i->pcursor->Seek(CoinEntry(&outpoint));
     // Cache key of first record
     if (i->pcursor->Valid()) {
         CoinEntry entry(&i->keyTmp.second);
@@ -247,18 +406,15 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     for (std::vector<const CBlockIndex*>::const_iterator it=blockinfo.begin(); it != blockinfo.end(); it++) {
         batch.Write(std::make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), CDiskBlockIndex(*it));
     }
-    return WriteBatch(batch, true);
-}
-
-bool CBlockTreeDB::ReadTxIndex(const uint256 &txid, CDiskTxPos &pos) {
-    return Read(std::make_pair(DB_TXINDEX, txid), pos);
-}
-
-bool CBlockTreeDB::WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<uint256,CDiskTxPos> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Write(std::make_pair(DB_TXINDEX, it->first), it->second);
-    return WriteBatch(batch);
+    // The flat block index file doesn't have the new entries
+    bool fEraseFlatBlockIndex = fFlatBlockIndex && !blockinfo.empty();
+    if (fEraseFlatBlockIndex)
+        batch.Erase(DB_FLAT_BLOCK_INDEX);
+    if (!WriteBatch(batch, true))
+        return false;
+    if (fEraseFlatBlockIndex)
+        fFlatBlockIndex = false;
+    return true;
 }
 
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
@@ -273,6 +429,35 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
+bool CBlockTreeDB::WriteSnapshotBase(const uint256 &hash, uint64_t nChainTx) {
+    return Write(DB_SNAPSHOT_BASE, std::make_pair(hash, nChainTx));
+}
+
+bool CBlockTreeDB::ReadSnapshotBase(uint256 &hash, uint64_t &nChainTx) {
+    std::pair<uint256, uint64_t> base;
+    if (!Read(DB_SNAPSHOT_BASE, base))
+        return false;
+    hash = base.first;
+    nChainTx = base.second;
+    return true;
+}
+
+static void SetDiskBlockIndex(CBlockIndex* pindex, const CDiskBlockIndex& diskindex)
+{
+    pindex->nHeight        = diskindex.nHeight;
+    pindex->nFile          = diskindex.nFile;
+    pindex->nDataPos       = diskindex.nDataPos;
+    pindex->nUndoPos       = diskindex.nUndoPos;
+    pindex->nVersion       = diskindex.nVersion;
+    pindex->hashMerkleRoot = diskindex.hashMerkleRoot;
+    pindex->nTime          = diskindex.nTime;
+    pindex->nBits          = diskindex.nBits;
+    pindex->nNonce         = diskindex.nNonce;
+    pindex->vHeaderSig     = diskindex.vHeaderSig;
+    pindex->nStatus        = diskindex.nStatus;
+    pindex->nTx            = diskindex.nTx;
+}
+
 bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
 {
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
@@ -288,19 +473,8 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
             if (pcursor->GetValue(diskindex)) {
                 // Construct block index object
                 CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->vHeaderSig     = diskindex.vHeaderSig;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
+                pindexNew->pprev = insertBlockIndex(diskindex.hashPrev);
+                SetDiskBlockIndex(pindexNew, diskindex);
 
                 if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, consensusParams))
                     return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
@@ -317,6 +491,181 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
     return true;
 }
 
+/**
+ * The flat block index file has a header with the version, a random id that
+ * is also written to the database, and the number of entries. Each entry has
+ * the block hash, the position of the parent entry and the CDiskBlockIndex.
+ * A hash of the header and entries ends the file.
+ *
+ * The database entry repeats the header and has a hash of the state of the
+ * block files, so that the file isn't loaded after a version that doesn't
+ * know it stored blocks.
+ *
+ * Reading it doesn't need to hash the block headers again or to look up the
+ * parents by hash, and the entries are already sorted by height.
+ */
+static const uint32_t FLAT_BLOCK_INDEX_VERSION = 1;
+static const uint32_t FLAT_BLOCK_INDEX_NO_PREV = std::numeric_limits<uint32_t>::max();
+static const uint64_t FLAT_BLOCK_INDEX_BUFFER_SIZE = 8 << 20;
+
+struct CFlatBlockIndexEntry
+{
+    uint32_t nVersion;
+    uint256 id;
+    uint64_t nEntries;
+    uint256 hashBlockFiles;
+
+    CFlatBlockIndexEntry() : nVersion(0), nEntries(0) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nVersion);
+        READWRITE(id);
+        READWRITE(nEntries);
+        READWRITE(hashBlockFiles);
+    }
+};
+
+uint256 CBlockTreeDB::GetBlockFilesHash()
+{
+    // Storing a block updates the information of the last block file
+    int nLastFile = 0;
+    CBlockFileInfo info;
+    if (ReadLastBlockFile(nLastFile))
+        ReadBlockFileInfo(nLastFile, info);
+    CHashWriter hasher(SER_DISK, CLIENT_VERSION);
+    hasher << nLastFile << info;
+    return hasher.GetHash();
+}
+
+static fs::path GetFlatBlockIndexPath()
+{
+    return GetDataDir() / "blocks" / "blockindex.dat";
+}
+
+bool CBlockTreeDB::WriteFlatBlockIndex(const std::vector<const CBlockIndex*>& vIndex)
+{
+    fs::path path = GetFlatBlockIndexPath();
+    fs::path pathNew = path;
+    pathNew += ".new";
+    CFlatBlockIndexEntry entry;
+    entry.nVersion = FLAT_BLOCK_INDEX_VERSION;
+    entry.id = GetRandHash();
+    entry.nEntries = vIndex.size();
+    entry.hashBlockFiles = GetBlockFilesHash();
+
+    // Any earlier file stops matching the database once it's replaced
+    if (fFlatBlockIndex) {
+        if (!Erase(DB_FLAT_BLOCK_INDEX, true))
+            return error("%s: failed to erase the flat block index id", __func__);
+        fFlatBlockIndex = false;
+    }
+
+    try {
+        CAutoFile fileout(fsbridge::fopen(pathNew, "wb"), SER_DISK, CLIENT_VERSION);
+        if (fileout.IsNull())
+            return error("%s: failed to open %s", __func__, pathNew.string());
+
+        CHashWriter hasher(SER_DISK, CLIENT_VERSION);
+        hasher << entry.nVersion << entry.id << entry.nEntries;
+        fileout << entry.nVersion << entry.id << entry.nEntries;
+
+        std::unordered_map<const CBlockIndex*, uint32_t> mapPos;
+        mapPos.reserve(vIndex.size());
+        for (const CBlockIndex* pindex : vIndex) {
+            uint32_t nPrev = FLAT_BLOCK_INDEX_NO_PREV;
+            if (pindex->pprev) {
+                auto it = mapPos.find(pindex->pprev);
+                if (it == mapPos.end())
+                    return error("%s: parent of %s is not written before it", __func__, pindex->GetBlockHash().ToString());
+                nPrev = it->second;
+            }
+            mapPos.emplace(pindex, mapPos.size());
+
+            CDiskBlockIndex diskindex(pindex);
+            hasher << pindex->GetBlockHash() << nPrev << diskindex;
+            fileout << pindex->GetBlockHash() << nPrev << diskindex;
+        }
+        fileout << hasher.GetHash();
+
+        FileCommit(fileout.Get());
+        fileout.fclose();
+    } catch (const std::exception& e) {
+        return error("%s: %s", __func__, e.what());
+    }
+
+    if (!RenameOver(pathNew, path))
+        return error("%s: failed to rename %s", __func__, pathNew.string());
+    if (!Write(DB_FLAT_BLOCK_INDEX, entry, true))
+        return error("%s: failed to write the flat block index id", __func__);
+    fFlatBlockIndex = true;
+    return true;
+}
+
+bool CBlockTreeDB::LoadFlatBlockIndex(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, std::vector<CBlockIndex*>& vIndex)
+{
+    CFlatBlockIndexEntry entry;
+    if (!fFlatBlockIndex || !Read(DB_FLAT_BLOCK_INDEX, entry))
+        return false;
+    if (entry.hashBlockFiles != GetBlockFilesHash())
+        return error("%s: the block files changed since the flat block index was written", __func__);
+
+    fs::path path = GetFlatBlockIndexPath();
+    FILE* file = fsbridge::fopen(path, "rb");
+    if (!file)
+        return error("%s: failed to open %s", __func__, path.string());
+    CBufferedFile filein(file, FLAT_BLOCK_INDEX_BUFFER_SIZE, 0, SER_DISK, CLIENT_VERSION);
+
+    try {
+        CHashVerifier<CBufferedFile> verifier(&filein);
+        uint32_t nVersion;
+        uint256 idFile;
+        uint64_t nEntries;
+        verifier >> nVersion >> idFile >> nEntries;
+        if (nVersion != FLAT_BLOCK_INDEX_VERSION || nVersion != entry.nVersion || idFile != entry.id || nEntries != entry.nEntries)
+            return error("%s: %s doesn't match the block index database", __func__, path.string());
+        // Every entry takes more than a byte
+        if (nEntries > fs::file_size(path))
+            return error("%s: invalid number of entries %u", __func__, nEntries);
+        vIndex.reserve(nEntries);
+
+        for (uint64_t i = 0; i < nEntries; i++) {
+            boost::this_thread::interruption_point();
+            uint256 hash;
+            uint32_t nPrev;
+            CDiskBlockIndex diskindex;
+            verifier >> hash >> nPrev >> diskindex;
+
+            CBlockIndex* pprev = nullptr;
+            if (nPrev != FLAT_BLOCK_INDEX_NO_PREV) {
+                if (nPrev >= vIndex.size() || vIndex[nPrev]->GetBlockHash() != diskindex.hashPrev)
+                    return error("%s: invalid parent of %s", __func__, hash.ToString());
+                pprev = vIndex[nPrev];
+            } else if (!diskindex.hashPrev.IsNull()) {
+                return error("%s: missing parent of %s", __func__, hash.ToString());
+            }
+
+            CBlockIndex* pindexNew = insertBlockIndex(hash);
+            vIndex.push_back(pindexNew);
+            pindexNew->pprev = pprev;
+            SetDiskBlockIndex(pindexNew, diskindex);
+
+            if (!CheckProofOfWork(hash, pindexNew->nBits, consensusParams))
+                return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
+        }
+
+        uint256 hashFile;
+        filein >> hashFile;
+        if (hashFile != verifier.GetHash())
+            return error("%s: checksum mismatch in %s", __func__, path.string());
+    } catch (const std::exception& e) {
+        return error("%s: deserialize or I/O error - %s", __func__, e.what());
+    }
+    return true;
+}
+
 CSidechainTreeDB::CSidechainTreeDB(size_t nCacheSize, bool fMemory, bool fWipe)
     : CDBWrapper(GetDataDir() / "blocks" / "sidechain", nCacheSize, fMemory, fWipe) { }
 
@@ -11,8 +11,12 @@
 #include <dbwrapper.h>
 #include <sidechain.h>
 
+#include <condition_variable>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -30,12 +34,12 @@ static const int64_t nDefaultDbBatchSize = 16 << 20;
 static const int64_t nMaxDbCache = sizeof(void*) > 4 ? 16384 : 1024;
 //! min. -dbcache (MiB)
 static const int64_t nMinDbCache = 4;
-//! Max memory allocated to block tree DB specific cache, if no -txindex (MiB)
+//! Max memory allocated to block tree DB specific cache (MiB)
 static const int64_t nMaxBlockDBCache = 2;
-//! Max memory allocated to block tree DB specific cache, if -txindex (MiB)
+//! Max memory allocated to tx index DB specific cache (MiB)
 // Unlike for the UTXO database, for the txindex scenario the leveldb cache make
 // a meaningful difference: https://github.com/bitcoin/bitcoin/pull/8273#issuecomment-229601991
-static const int64_t nMaxBlockDBAndTxIndexCache = 1024;
+static const int64_t nMaxTxIndexCache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
 
@@ -80,12 +84,77 @@ public:
     std::vector<uint256> GetHeadBlocks() const override;
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
+    //! Cursor positioned at the first coin of a txid not before hashStart, in database order
+    CCoinsViewCursor *Cursor(const uint256 &hashStart) const;
+
+    //! Write the dirty entries of mapCoins, leaving the map unmodified for concurrent readers.
+    //! Unless fComplete, the database stays marked as partially written up
+    //! to hashBlock, for writes that are continued by further calls.
+    bool WriteCoins(const CCoinsMap &mapCoins, const uint256 &hashBlock, bool fComplete = true);
 
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
 };
 
+/**
+ * Layer on top of the coin database that writes a flushed coins cache to it
+ * on a background thread, so that the caller doesn't have to hold cs_main
+ * for the whole write.
+ *
+ * Until the write has finished, the flushed entries are answered from
+ * memory, so that the view represents the flushed state at all times. The
+ * database itself is written in -dbbatchsize chunks between the head blocks
+ * marker and the best block, as by BatchWrite, which makes an interrupted
+ * write recoverable by ReplayBlocks.
+ */
+class CCoinsViewBackgroundFlush final : public CCoinsViewBacked
+{
+public:
+    explicit CCoinsViewBackgroundFlush(CCoinsViewDB* dbIn);
+    ~CCoinsViewBackgroundFlush();
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+    uint256 GetBestBlock() const override;
+    //! Waits for the background write, then writes mapCoins synchronously
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    //! Waits for the background write, the cursor iterates over the database
+    CCoinsViewCursor *Cursor() const override;
+
+    /**
+     * Detach the entries of cache, which must be backed by this view, and
+     * write them to the database in the background. Waits for an earlier
+     * write to finish first. Returns false if that write failed.
+     */
+    bool StartFlush(CCoinsViewCache& cache);
+    //! Wait for the background write to finish, false if it failed
+    bool WaitForFlush() const;
+    //! Whether a write is in progress, or failed
+    bool IsFlushing() const;
+    //! Whether the last write failed, the flushed entries are kept in memory then
+    bool FlushFailed() const;
+
+    //! Memory used by the entries that are being written
+    size_t DynamicMemoryUsage() const;
+    //! Duration of the last completed write in microseconds
+    int64_t GetLastFlushDuration() const;
+
+private:
+    void ThreadFlush();
+    std::shared_ptr<const CCoinsCacheSnapshot> GetSnapshot() const;
+
+    CCoinsViewDB* db;
+
+    mutable std::mutex mutex;
+    mutable std::condition_variable condFlushed;
+    //! The entries being written, shared with concurrent readers
+    std::shared_ptr<const CCoinsCacheSnapshot> snapshot;
+    bool fFailed;
+    int64_t nLastFlushDuration;
+    std::thread threadFlush;
+};
+
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
 class CCoinsViewDBCursor: public CCoinsViewCursor
 {
@@ -122,11 +191,31 @@ public:
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindexing);
     bool ReadReindexing(bool &fReindexing);
-    bool ReadTxIndex(const uint256 &txid, CDiskTxPos &pos);
-    bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &vect);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
+    //! Block a UTXO snapshot was loaded at, and its number of transactions in the chain
+    bool WriteSnapshotBase(const uint256 &hash, uint64_t nChainTx);
+    bool ReadSnapshotBase(uint256 &hash, uint64_t &nChainTx);
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
+
+    /**
+     * Write all block index entries to a flat file (blocks/blockindex.dat),
+     * which is loaded instead of the entries in the database until they are
+     * written again. Parents must come before their children in vIndex.
+     */
+    bool WriteFlatBlockIndex(const std::vector<const CBlockIndex*>& vIndex);
+    /**
+     * Load the flat block index file if it matches the database. The
+     * entries are added to vIndex in file order, also if loading fails.
+     */
+    bool LoadFlatBlockIndex(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, std::vector<CBlockIndex*>& vIndex);
+
+private:
+    //! Whether the flat block index file matches the database, until block index entries are written
+    bool fFlatBlockIndex;
+
+    //! Hash of the last block file number and its information
+    uint256 GetBlockFilesHash();
 };
 
 /** Access to the sidechain database (blocks/sidechain/) */
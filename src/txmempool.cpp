@@ -1049,6 +1049,18 @@ const CTxMemPool::setEntries & CTxMemPool::GetMemPoolChildren(txiter entry) cons
     return it->second.children;
 }
 
+CAmount GetBMMRequestBid(const CTxMemPoolEntry& entry)
+{
+    // The miner takes the fee and the OP_TRUE outputs of critical data
+    // transactions
+    CAmount nBid = entry.GetModifiedFee();
+    for (const CTxOut& out : entry.GetTx().vout) {
+        if (out.scriptPubKey == CScript() << OP_TRUE)
+            nBid += out.nValue;
+    }
+    return nBid;
+}
+
 void CTxMemPool::RemoveExpiredCriticalRequests(std::vector<uint256>& vHashRemoved)
 {
     LOCK(cs);
@@ -1073,16 +1085,16 @@ void CTxMemPool::SelectBMMRequests(std::vector<uint256>& vHashRemoved)
 {
     // TODO
     // For now, this is just making sure that we only accept 1 BMM request
-    // per block per sidechain. Eventually though, we should allow options
-    // such as minimum payment amount, filter by sidechain, etc.
+    // per block per sidechain, the one that pays the most. Eventually though,
+    // we should allow options such as minimum payment amount, filter by
+    // sidechain, etc.
     //
 
     LOCK(cs);
 
-    // We only want 1 BMM request per sidechain so track whether we've
-    // already found one for a given sidechain
-    std::vector<bool> vSidechain;
-    vSidechain.resize(SIDECHAIN_ACTIVATION_MAX_ACTIVE);
+    // We only want 1 BMM request per sidechain so track the best one we've
+    // found for each sidechain so far
+    std::vector<const CTxMemPoolEntry*> vBest(SIDECHAIN_ACTIVATION_MAX_ACTIVE, nullptr);
 
     std::vector<CTransaction> vTxRemove;
     for (indexed_transaction_set::const_iterator it = mapTx.begin(); it != mapTx.end(); it++) {
@@ -1099,17 +1111,22 @@ void CTxMemPool::SelectBMMRequests(std::vector<uint256>& vHashRemoved)
                     continue;
                 }
 
-                if (nSidechain >= vSidechain.size()) {
+                if (nSidechain >= vBest.size()) {
                     vTxRemove.push_back(it->GetTx());
                     continue;
                 }
 
-                if (vSidechain[nSidechain] == false) {
+                if (!vBest[nSidechain]) {
                     // Track that we have found a BMM request for this sidechain
-                    vSidechain[nSidechain] = true;
+                    vBest[nSidechain] = &*it;
+                } else if (GetBMMRequestBid(*it) > GetBMMRequestBid(*vBest[nSidechain])) {
+                    // This BMM request outbids the one we selected before, so
+                    // remove that one instead
+                    vTxRemove.push_back(vBest[nSidechain]->GetTx());
+                    vBest[nSidechain] = &*it;
                 } else {
-                    // We already have a BMM request selected for this sidechain
-                    // so remove any extras
+                    // We already have a better BMM request selected for this
+                    // sidechain so remove any extras
                     vTxRemove.push_back(it->GetTx());
                 }
             }
@@ -730,6 +730,9 @@ private:
     void removeUnchecked(txiter entry, MemPoolRemovalReason reason = MemPoolRemovalReason::UNKNOWN);
 };
 
+/** What a BMM request pays the miner that selects it, its fee and its OP_TRUE outputs */
+CAmount GetBMMRequestBid(const CTxMemPoolEntry& entry);
+
 /**
  * CCoinsView that brings transactions from a memorypool into view.
  * It does not check for spendings by memory pool transactions.
@@ -12,6 +12,7 @@
 #include <utilstrencodings.h>
 
 #include <stdarg.h>
+#include <thread>
 
 #if (defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__DragonFly__))
 #include <pthread.h>
@@ -249,6 +250,7 @@ const CLogCategoryDesc LogCategories[] =
     {BCLog::COINDB, "coindb"},
     {BCLog::QT, "qt"},
     {BCLog::LEVELDB, "leveldb"},
+    {BCLog::REPLAY, "replay"},
     {BCLog::ALL, "1"},
     {BCLog::ALL, "all"},
 };
@@ -937,6 +939,23 @@ int GetNumCores()
 #endif
 }
 
+void ParallelFor(size_t n, int nMaxThreads, const std::function<void(size_t)>& f)
+{
+    std::atomic<size_t> nNext(0);
+    auto run = [&]() {
+        size_t i;
+        while ((i = nNext++) < n)
+            f(i);
+    };
+    const int nThreads = std::max<int>(1, std::min<size_t>(std::min(GetNumCores(), nMaxThreads), n));
+    std::vector<std::thread> vThreads;
+    for (int i = 1; i < nThreads; i++)
+        vThreads.emplace_back(run);
+    run();
+    for (std::thread& thread : vThreads)
+        thread.join();
+}
+
 std::string CopyrightHolders(const std::string& strPrefix)
 {
     std::string strCopyrightHolders = strPrefix + strprintf(_(COPYRIGHT_HOLDERS), _(COPYRIGHT_HOLDERS_SUBSTITUTION));
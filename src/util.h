@@ -22,6 +22,7 @@
 
 #include <atomic>
 #include <exception>
+#include <functional>
 #include <map>
 #include <stdint.h>
 #include <string>
@@ -103,6 +104,7 @@ namespace BCLog {
         COINDB      = (1 << 18),
         QT          = (1 << 19),
         LEVELDB     = (1 << 20),
+        REPLAY      = (1 << 21),
         ALL         = ~(uint32_t)0,
     };
 }
@@ -313,6 +315,12 @@ std::string HelpMessageOpt(const std::string& option, const std::string& message
  */
 int GetNumCores();
 
+/**
+ * Call f(i) for every i in [0, n), on the calling thread and on up to
+ * nMaxThreads - 1 more threads, but no more threads than there are cores.
+ */
+void ParallelFor(size_t n, int nMaxThreads, const std::function<void(size_t)>& f);
+
 void RenameThread(const char* name);
 
 /**
@@ -8,6 +8,7 @@
 #include <addressbook.h>
 #include <arith_uint256.h>
 #include <base58.h>
+#include <blockimport.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -18,6 +19,7 @@
 #include <consensus/validation.h>
 #include <cuckoocache.h>
 #include <hash.h>
+#include <index/txindex.h>
 #include <init.h>
 #include <merkleblock.h>
 #include <policy/fees.h>
@@ -159,6 +161,8 @@ public:
     BlockMap mapBlockIndex;
     std::multimap<CBlockIndex*, CBlockIndex*> mapBlocksUnlinked;
     CBlockIndex *pindexBestInvalid = nullptr;
+    //! The block a UTXO snapshot was loaded at, the blocks below it have no data
+    CBlockIndex *pindexSnapshotBase = nullptr;
 
     bool LoadBlockIndex(const Consensus::Params& consensus_params, CBlockTreeDB& blocktree);
 
@@ -186,6 +190,9 @@ public:
 
     void PruneBlockIndexCandidates();
 
+    /** Make the block a UTXO snapshot was loaded at the tip of chainActive */
+    void ActivateSnapshotBase(CBlockIndex* pindex, unsigned int nChainTx);
+
     void UnloadBlockIndex();
     void UnloadWBlockIndex();
 
@@ -218,7 +225,6 @@ CConditionVariable cvBlockChange;
 int nScriptCheckThreads = 0;
 std::atomic_bool fImporting(false);
 std::atomic_bool fReindex(false);
-bool fTxIndex = false;
 bool fHavePruned = false;
 bool fPruneMode = false;
 bool fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
@@ -226,7 +232,9 @@ bool fRequireStandard = true;
 bool fCMPCTWit = false;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
+bool fBackgroundFlush = DEFAULT_BACKGROUND_FLUSH;
 size_t nCoinCacheUsage = 5000 * 300;
+int64_t nLastFlushLockTime = 0;
 uint64_t nPruneTarget = 0;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
 bool fEnableReplacement = DEFAULT_ENABLE_REPLACEMENT;
@@ -293,11 +301,15 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 }
 
 std::unique_ptr<CCoinsViewDB> pcoinsdbview;
+std::unique_ptr<CCoinsViewBackgroundFlush> pcoinsflush;
 std::unique_ptr<CCoinsViewCache> pcoinsTip;
 std::unique_ptr<CBlockTreeDB> pblocktree;
 std::unique_ptr<CSidechainTreeDB> psidechaintree;
 std::unique_ptr<OPReturnDB> popreturndb;
 
+/** Blocks stored by LoadExternalBlockFile that ConnectTip can use without reading them back */
+static CImportedBlockCache importedBlockCache(MAX_IMPORTED_BLOCK_CACHE_SIZE);
+
 enum FlushStateMode {
     FLUSH_STATE_NONE,
     FLUSH_STATE_IF_NEEDED,
@@ -573,7 +585,7 @@ bool GetDrivechainAmounts(const CCoinsView& coins, const CTransaction &tx,
             return false;
         }
 
-        vCoin.push_back(coin);
+        vCoin.push_back(std::move(coin));
     }
 
     // Count value of inputs and make sure there is only 1 CTIP input
@@ -581,8 +593,7 @@ bool GetDrivechainAmounts(const CCoinsView& coins, const CTransaction &tx,
     uint8_t nSidechainIn;
     for (const Coin& c : vCoin) {
         const CTxOut& out = c.out;
-        const CScript& scriptPubKey = out.scriptPubKey;
-        if (scriptPubKey.IsDrivechain(nSidechainIn)) {
+        if (c.IsEscrow(nSidechainIn)) {
             if (fSidechainInputFound) {
                 strFail = "Multiple sidechain inputs!";
                 return false;
@@ -599,7 +610,7 @@ bool GetDrivechainAmounts(const CCoinsView& coins, const CTransaction &tx,
     bool fSidechainOutputFound = false;
     uint8_t nSidechainOut;
     for (const CTxOut& out : tx.vout) {
-        const CScript scriptPubKey = out.scriptPubKey;
+        const CScript& scriptPubKey = out.scriptPubKey;
         uint8_t nSidechainOutScript;
         if (scriptPubKey.IsDrivechain(nSidechainOutScript)) {
             if (fSidechainInputFound && nSidechainOutScript != nSidechainIn) {
@@ -1238,28 +1249,8 @@ bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus
             return true;
         }
 
-        if (fTxIndex) {
-            CDiskTxPos postx;
-            if (pblocktree->ReadTxIndex(hash, postx)) {
-                CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
-                if (file.IsNull())
-                    return error("%s: OpenBlockFile failed", __func__);
-                CBlockHeader header;
-                try {
-                    file >> header;
-                    fseek(file.Get(), postx.nTxOffset, SEEK_CUR);
-                    file >> txOut;
-                } catch (const std::exception& e) {
-                    return error("%s: Deserialize or I/O error - %s", __func__, e.what());
-                }
-                hashBlock = header.GetHash();
-                if (txOut->GetHash() != hash)
-                    return error("%s: txid mismatch", __func__);
-                return true;
-            }
-
-            // transaction not found in index, nothing more can be done
-            return false;
+        if (g_txindex) {
+            return g_txindex->FindTx(hash, hashBlock, txOut);
         }
 
         if (fAllowSlow) { // use coin database to locate block that contains transaction, and scan it
@@ -1885,31 +1876,94 @@ static bool WriteUndoDataForBlock(const CBlockUndo& blockundo, CValidationState&
     return true;
 }
 
-static bool WriteTxIndexDataForBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex)
+static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+
+void ThreadScriptCheck() {
+    RenameThread("bitcoin-scriptch");
+    scriptcheckqueue.Thread();
+}
+
+/**
+ * Closure reading one coin spent by a block from the coins database.
+ * Read errors are left to ConnectBlock, which reads the coin again.
+ */
+class CCoinPrefetch
 {
-    if (!fTxIndex) return true;
+private:
+    const CCoinsView* view;
+    COutPoint outpoint;
+    Coin* pcoin;
 
-    CDiskTxPos pos(pindex->GetBlockPos(), GetSizeOfCompactSize(block.vtx.size()));
-    std::vector<std::pair<uint256, CDiskTxPos> > vPos;
-    vPos.reserve(block.vtx.size());
-    for (const CTransactionRef& tx : block.vtx)
-    {
-        vPos.push_back(std::make_pair(tx->GetHash(), pos));
-        pos.nTxOffset += ::GetSerializeSize(*tx, SER_DISK, CLIENT_VERSION);
+public:
+    CCoinPrefetch() : view(nullptr), pcoin(nullptr) {}
+    CCoinPrefetch(const CCoinsView* viewIn, const COutPoint& outpointIn, Coin* pcoinIn) :
+        view(viewIn), outpoint(outpointIn), pcoin(pcoinIn) {}
+
+    bool operator()() {
+        try {
+            if (!view->GetCoin(outpoint, *pcoin))
+                pcoin->Clear();
+        } catch (const std::runtime_error&) {
+            pcoin->Clear();
+        }
+        return true;
     }
 
-    if (!pblocktree->WriteTxIndex(vPos)) {
-        return AbortNode(state, "Failed to write transaction index");
+    void swap(CCoinPrefetch& check) {
+        std::swap(view, check.view);
+        std::swap(outpoint, check.outpoint);
+        std::swap(pcoin, check.pcoin);
     }
+};
 
-    return true;
+static CCheckQueue<CCoinPrefetch> coinprefetchqueue(128);
+
+void ThreadCoinPrefetch() {
+    RenameThread("bitcoin-coinpref");
+    coinprefetchqueue.Thread();
 }
 
-static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+/**
+ * Read the coins a block spends from the coins database (through pcoinsflush,
+ * which has the entries of a flush in progress) on the prefetch
+ * threads and add them to pcoinsTip, so that ConnectBlock finds them in the
+ * cache instead of reading them one at a time. Outputs created by the block
+ * itself are skipped.
+ */
+static void PrefetchBlockInputs(const CBlock& block)
+{
+    AssertLockHeld(cs_main);
+    if (!nScriptCheckThreads)
+        return;
 
-void ThreadScriptCheck() {
-    RenameThread("bitcoin-scriptch");
-    scriptcheckqueue.Thread();
+    std::vector<COutPoint> vOutPoints;
+    std::set<uint256> setBlockTxids;
+    for (const auto& tx : block.vtx) {
+        if (!tx->IsCoinBase()) {
+            for (const CTxIn& txin : tx->vin) {
+                if (!setBlockTxids.count(txin.prevout.hash) && !pcoinsTip->HaveCoinInCache(txin.prevout))
+                    vOutPoints.push_back(txin.prevout);
+            }
+        }
+        setBlockTxids.insert(tx->GetHash());
+    }
+    if (vOutPoints.empty())
+        return;
+
+    std::vector<Coin> vCoins(vOutPoints.size());
+    std::vector<CCoinPrefetch> vChecks;
+    vChecks.reserve(vOutPoints.size());
+    for (size_t i = 0; i < vOutPoints.size(); i++) {
+        vChecks.emplace_back(pcoinsflush.get(), vOutPoints[i], &vCoins[i]);
+    }
+    CCheckQueueControl<CCoinPrefetch> control(&coinprefetchqueue);
+    control.Add(vChecks);
+    control.Wait();
+
+    for (size_t i = 0; i < vOutPoints.size(); i++) {
+        if (!vCoins[i].IsSpent())
+            pcoinsTip->AddPrefetchedCoin(vOutPoints[i], std::move(vCoins[i]));
+    }
 }
 
 // Protected by cs_main
@@ -2190,8 +2244,8 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
             // Set fSidechainInputs & nSidechain
             if (drivechainsEnabled) {
                 for (const CTxIn& in : tx.vin) {
-                    Coin coin = view.AccessCoin(in.prevout);
-                    if (coin.out.scriptPubKey.IsDrivechain(nSidechain)) {
+                    const Coin& coin = view.AccessCoin(in.prevout);
+                    if (coin.IsEscrow(nSidechain)) {
                         fSidechainInputs = true;
                         break;
                     }
@@ -2253,7 +2307,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
             // We must get the Withdrawal hash as work is applied to
             // Withdrawal before inputs and the change output are known.
             uint256 hashBlind;
-            if (!tx.GetBlindHash(hashBlind))
+            if (!scdb.GetBlindHash(tx, hashBlind))
                 return error("ConnectBlock(): Withdrawal (full id): %s has invalid format", tx.GetHash().ToString());
 
             // Get values to and from sidechain
@@ -2279,7 +2333,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
             // Check for possible sidechain deposits
             bool fSidechainOutput = false;
             uint8_t nSidechain;
-            for (const CTxOut out : tx.vout) {
+            for (const CTxOut& out : tx.vout) {
                 const CScript& scriptPubKey = out.scriptPubKey;
                 if (scriptPubKey.IsDrivechain(nSidechain)) {
                     fSidechainOutput = true;
@@ -2338,7 +2392,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
             int nTx = std::get<2>(vWithdrawalToSpend[i]);
 
             uint256 hashBlind;
-            tx.GetBlindHash(hashBlind);
+            scdb.GetBlindHash(tx, hashBlind);
             if (!scdb.SpendWithdrawal(nSidechain, block.GetHash(), tx, nTx, fJustCheck, true /* fDebug */)) {
                 return error("ConnectBlock(): Final spend Withdrawal failed (blind Withdrawal hash : txid): %s : %s.\n nSidechain: %u\n", hashBlind.ToString(), tx.GetHash().ToString(), nSidechain);
             }
@@ -2367,9 +2421,6 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
         setDirtyBlockIndex.insert(pindex);
     }
 
-    if (!WriteTxIndexDataForBlock(block, state, pindex))
-        return false;
-
     // TODO
     // Instead of writing the entire vector of sidechains with each block for
     // undo purposes, store the sidechain only once with LDB and then maintain
@@ -2423,6 +2474,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &state, FlushStateMode mode, int nManualPruneHeight) {
     int64_t nMempoolUsage = mempool.DynamicMemoryUsage();
     LOCK(cs_main);
+    const int64_t nLockStart = GetTimeMicros();
     static int64_t nLastWrite = 0;
     static int64_t nLastFlush = 0;
     static int64_t nLastSetChain = 0;
@@ -2431,6 +2483,8 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
     bool fDoFullFlush = false;
     int64_t nNow = 0;
     try {
+    if (pcoinsflush->FlushFailed())
+        return AbortNode(state, "Failed to write to coin database");
     {
         LOCK(cs_LastBlockFile);
         if (fPruneMode && (fCheckForPruning || nManualPruneHeight > 0) && !fReindex) {
@@ -2461,11 +2515,13 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
         }
         int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
         int64_t cacheSize = pcoinsTip->DynamicMemoryUsage();
+        // Coins that are still being written in the background
+        int64_t nFlushingSize = pcoinsflush->DynamicMemoryUsage();
         int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
         // The cache is large and we're within 10% and 10 MiB of the limit, but we have time now (not in the middle of a block processing).
         bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && cacheSize > std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
         // The cache is over the limit, we have to write now.
-        bool fCacheCritical = mode == FLUSH_STATE_IF_NEEDED && cacheSize > nTotalSpace;
+        bool fCacheCritical = mode == FLUSH_STATE_IF_NEEDED && cacheSize + nFlushingSize > nTotalSpace;
         // It's been a while since we wrote the block index to disk. Do this frequently, so we don't need to redownload after a crash.
         bool fPeriodicWrite = mode == FLUSH_STATE_PERIODIC && nNow > nLastWrite + (int64_t)DATABASE_WRITE_INTERVAL * 1000000;
         // It's been very long since we flushed the cache. Do this infrequently, to optimize cache usage.
@@ -2497,9 +2553,13 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
                     return AbortNode(state, "Failed to write to block index database");
                 }
             }
-            // Finally remove any pruned files
-            if (fFlushForPrune)
+            // Finally remove any pruned files. A background flush may still
+            // need them to be replayed after a crash.
+            if (fFlushForPrune) {
+                if (!pcoinsflush->WaitForFlush())
+                    return AbortNode(state, "Failed to write to coin database");
                 UnlinkPrunedFiles(setFilesToPrune);
+            }
             nLastWrite = nNow;
         }
         // Flush best chain related state. This can only be done if the blocks / block index write was also done.
@@ -2512,9 +2572,19 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             if (!CheckDiskSpace(48 * 2 * 2 * pcoinsTip->GetCacheSize()))
                 return state.Error("out of disk space");
             // Flush the chainstate (which may refer to block index entries).
-            if (!pcoinsTip->Flush())
+            // Unless all state has to be on disk when we return, write it in
+            // the background and only hold cs_main to take the entries out of
+            // the cache.
+            bool fBackground = fBackgroundFlush && (mode == FLUSH_STATE_PERIODIC || mode == FLUSH_STATE_IF_NEEDED) && !fFlushForPrune;
+            if (fBackground) {
+                if (!pcoinsflush->StartFlush(*pcoinsTip))
+                    return AbortNode(state, "Failed to write to coin database");
+            } else if (!pcoinsTip->Flush()) {
                 return AbortNode(state, "Failed to write to coin database");
+            }
             nLastFlush = nNow;
+            nLastFlushLockTime = GetTimeMicros() - nLockStart;
+            LogPrint(BCLog::BENCH, "%s: %s chainstate flush held cs_main for %.2fms\n", __func__, fBackground ? "background" : "synchronous", nLastFlushLockTime * 0.001);
         }
     }
     if (fDoFullFlush || ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) && nNow > nLastSetChain + (int64_t)DATABASE_WRITE_INTERVAL * 1000000)) {
@@ -2660,6 +2730,7 @@ bool CChainState::DisconnectTip(CValidationState& state, const CChainParams& cha
 }
 
 static int64_t nTimeReadFromDisk = 0;
+static int64_t nTimePrefetch = 0;
 static int64_t nTimeConnectTotal = 0;
 static int64_t nTimeFlush = 0;
 static int64_t nTimeChainState = 0;
@@ -2742,7 +2813,9 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     // Read block from disk.
     int64_t nTime1 = GetTimeMicros();
     std::shared_ptr<const CBlock> pthisBlock;
-    if (!pblock) {
+    if (!pblock && (pthisBlock = importedBlockCache.Take(pindexNew->GetBlockHash()))) {
+        // Imported from a block file by LoadExternalBlockFile
+    } else if (!pblock) {
         std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
         if (!ReadBlockFromDisk(*pblockNew, pindexNew, chainparams.GetConsensus()))
             return AbortNode(state, "Failed to read block");
@@ -2755,6 +2828,9 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     int64_t nTime2 = GetTimeMicros(); nTimeReadFromDisk += nTime2 - nTime1;
     int64_t nTime3;
     LogPrint(BCLog::BENCH, "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * MILLI, nTimeReadFromDisk * MICRO);
+    PrefetchBlockInputs(blockConnecting);
+    int64_t nTimePrefetched = GetTimeMicros(); nTimePrefetch += nTimePrefetched - nTime2;
+    LogPrint(BCLog::BENCH, "  - Prefetch inputs: %.2fms [%.2fs]\n", (nTimePrefetched - nTime2) * MILLI, nTimePrefetch * MICRO);
     {
         CCoinsViewCache view(pcoinsTip.get());
         bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
@@ -2764,8 +2840,8 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
                 InvalidBlockFound(pindexNew, state);
             return error("ConnectTip(): ConnectBlock %s failed", pindexNew->GetBlockHash().ToString());
         }
-        nTime3 = GetTimeMicros(); nTimeConnectTotal += nTime3 - nTime2;
-        LogPrint(BCLog::BENCH, "  - Connect total: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime3 - nTime2) * MILLI, nTimeConnectTotal * MICRO, nTimeConnectTotal * MILLI / nBlocksTotal);
+        nTime3 = GetTimeMicros(); nTimeConnectTotal += nTime3 - nTimePrefetched;
+        LogPrint(BCLog::BENCH, "  - Connect total: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime3 - nTimePrefetched) * MILLI, nTimeConnectTotal * MICRO, nTimeConnectTotal * MILLI / nBlocksTotal);
         bool flushed = view.Flush();
         assert(flushed);
     }
@@ -2868,6 +2944,41 @@ void CChainState::PruneBlockIndexCandidates() {
     assert(!setBlockIndexCandidates.empty());
 }
 
+void CChainState::ActivateSnapshotBase(CBlockIndex* pindexBase, unsigned int nChainTx)
+{
+    AssertLockHeld(cs_main);
+
+    // The snapshot block counts as connected, without having its data
+    setBlockIndexCandidates.erase(pindexBase);
+    pindexBase->RaiseValidity(BLOCK_VALID_SCRIPTS);
+    setDirtyBlockIndex.insert(pindexBase);
+    pindexSnapshotBase = pindexBase;
+
+    // Descendants that were received already can be connected now
+    std::deque<CBlockIndex*> queue;
+    queue.push_back(pindexBase);
+    while (!queue.empty()) {
+        CBlockIndex *pindex = queue.front();
+        queue.pop_front();
+        pindex->nChainTx = pindex == pindexBase ? nChainTx : pindex->pprev->nChainTx + pindex->nTx;
+        {
+            LOCK(cs_nBlockSequenceId);
+            pindex->nSequenceId = nBlockSequenceId++;
+        }
+        setBlockIndexCandidates.insert(pindex);
+        std::pair<std::multimap<CBlockIndex*, CBlockIndex*>::iterator, std::multimap<CBlockIndex*, CBlockIndex*>::iterator> range = mapBlocksUnlinked.equal_range(pindex);
+        while (range.first != range.second) {
+            std::multimap<CBlockIndex*, CBlockIndex*>::iterator it = range.first;
+            queue.push_back(it->second);
+            range.first++;
+            mapBlocksUnlinked.erase(it);
+        }
+    }
+
+    chainActive.SetTip(pindexBase);
+    PruneBlockIndexCandidates();
+}
+
 /**
  * Try to make some progress towards making pindexMostWork the active block.
  * pblock is either nullptr or a pointer to a CBlock corresponding to pindexMostWork.
@@ -4446,20 +4557,54 @@ CBlockIndex * CChainState::InsertBlockIndex(const uint256& hash)
 
 bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlockTreeDB& blocktree)
 {
-    if (!blocktree.LoadBlockIndexGuts(consensus_params, [this](const uint256& hash){ return this->InsertBlockIndex(hash); }))
-        return false;
+    int64_t nStart = GetTimeMillis();
+    std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
+    std::vector<CBlockIndex*> vFlatIndex;
+    if (blocktree.LoadFlatBlockIndex(consensus_params, [this](const uint256& hash){ return this->InsertBlockIndex(hash); }, vFlatIndex)) {
+        LogPrintf("%s: loaded %u block index entries from the flat file in %dms\n", __func__, vFlatIndex.size(), GetTimeMillis() - nStart);
+
+        // The entries are already sorted by height
+        vSortedByHeight.reserve(vFlatIndex.size());
+        for (CBlockIndex* pindex : vFlatIndex)
+            vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
+    } else {
+        // Drop what was read of a flat file that doesn't match, a corrupt
+        // file can have an entry twice
+        std::sort(vFlatIndex.begin(), vFlatIndex.end());
+        vFlatIndex.erase(std::unique(vFlatIndex.begin(), vFlatIndex.end()), vFlatIndex.end());
+        for (CBlockIndex* pindex : vFlatIndex) {
+            uint256 hash = pindex->GetBlockHash();
+            mapBlockIndex.erase(hash);
+            delete pindex;
+        }
+
+        if (!blocktree.LoadBlockIndexGuts(consensus_params, [this](const uint256& hash){ return this->InsertBlockIndex(hash); }))
+            return false;
+        LogPrintf("%s: loaded %u block index entries from the database in %dms\n", __func__, mapBlockIndex.size(), GetTimeMillis() - nStart);
+
+        vSortedByHeight.reserve(mapBlockIndex.size());
+        for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex)
+        {
+            CBlockIndex* pindex = item.second;
+            vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
+        }
+        sort(vSortedByHeight.begin(), vSortedByHeight.end());
+    }
 
     boost::this_thread::interruption_point();
 
-    // Calculate nChainWork
-    std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
-    vSortedByHeight.reserve(mapBlockIndex.size());
-    for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex)
-    {
-        CBlockIndex* pindex = item.second;
-        vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
+    // A chainstate loaded from a UTXO snapshot has no transactions below
+    // the snapshot block, its nChainTx was stored when it was loaded
+    uint256 hashSnapshotBase;
+    uint64_t nSnapshotChainTx = 0;
+    if (blocktree.ReadSnapshotBase(hashSnapshotBase, nSnapshotChainTx)) {
+        BlockMap::iterator it = mapBlockIndex.find(hashSnapshotBase);
+        if (it == mapBlockIndex.end())
+            return error("%s: UTXO snapshot block %s not found", __func__, hashSnapshotBase.ToString());
+        pindexSnapshotBase = it->second;
     }
-    sort(vSortedByHeight.begin(), vSortedByHeight.end());
+
+    // Calculate nChainWork
     for (const std::pair<int, CBlockIndex*>& item : vSortedByHeight)
     {
         CBlockIndex* pindex = item.second;
@@ -4467,7 +4612,9 @@ bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlo
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
         // We can link the chain of blocks for which we've received transactions at some point.
         // Pruned nodes may have deleted the block.
-        if (pindex->nTx > 0) {
+        if (pindex == pindexSnapshotBase) {
+            pindex->nChainTx = nSnapshotChainTx;
+        } else if (pindex->nTx > 0) {
             if (pindex->pprev) {
                 if (pindex->pprev->nChainTx) {
                     pindex->nChainTx = pindex->pprev->nChainTx + pindex->nTx;
@@ -4546,10 +4693,6 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     pblocktree->ReadReindexing(fReindexing);
     if(fReindexing) fReindex = true;
 
-    // Check whether we have a transaction index
-    pblocktree->ReadFlag("txindex", fTxIndex);
-    LogPrintf("%s: transaction index %s\n", __func__, fTxIndex ? "enabled" : "disabled");
-
     return true;
 }
 
@@ -4622,9 +4765,9 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
         uiInterface.ShowProgress(_("Verifying blocks..."), percentageDone, false);
         if (pindex->nHeight < chainActive.Height()-nCheckDepth)
             break;
-        if (fPruneMode && !(pindex->nStatus & BLOCK_HAVE_DATA)) {
-            // If pruning, only go back as far as we have data.
-            LogPrintf("%s: block verification stopping at height %d (pruning, no data)\n", __func__, pindex->nHeight);
+        if ((fPruneMode || IsSnapshotChainstate()) && !(pindex->nStatus & BLOCK_HAVE_DATA)) {
+            // If pruning or loaded from a UTXO snapshot, only go back as far as we have data.
+            LogPrintf("%s: block verification stopping at height %d (no data)\n", __func__, pindex->nHeight);
             break;
         }
         CBlock block;
@@ -4783,7 +4926,8 @@ bool CChainState::RewindBlockIndex(const CChainParams& params)
 
     // Note that during -reindex-chainstate we are called with an empty chainActive!
 
-    int nHeight = 1;
+    // The blocks up to a UTXO snapshot were never downloaded
+    int nHeight = pindexSnapshotBase ? pindexSnapshotBase->nHeight + 1 : 1;
     while (nHeight <= chainActive.Height()) {
         if (IsWitnessEnabled(chainActive[nHeight - 1], params.GetConsensus()) && !(chainActive[nHeight]->nStatus & BLOCK_OPT_WITNESS)) {
             break;
@@ -4885,6 +5029,7 @@ void CChainState::UnloadBlockIndex() {
     nBlockSequenceId = 1;
     g_failed_blocks.clear();
     setBlockIndexCandidates.clear();
+    pindexSnapshotBase = nullptr;
 }
 
 void CChainState::UnloadWBlockIndex() {
@@ -4968,9 +5113,6 @@ bool LoadBlockIndex(const CChainParams& chainparams)
         // needs_init.
 
         LogPrintf("Initializing databases...\n");
-        // Use the provided setting for -txindex in the new database
-        fTxIndex = gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX);
-        pblocktree->WriteFlag("txindex", fTxIndex);
     }
     return true;
 }
@@ -5007,6 +5149,11 @@ bool LoadGenesisBlock(const CChainParams& chainparams)
     return g_chainstate.LoadGenesisBlock(chainparams);
 }
 
+void ClearImportedBlocks()
+{
+    importedBlockCache.Clear();
+}
+
 bool LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, CDiskBlockPos *dbp)
 {
     // Map of disk positions for blocks with unknown parent (only used for reindex)
@@ -5015,51 +5162,30 @@ bool LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, CDiskB
 
     int nLoaded = 0;
     try {
-        // This takes over fileIn and calls fclose() on it in the CBufferedFile destructor
-        CBufferedFile blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION);
-        uint64_t nRewind = blkdat.GetPos();
-        while (!blkdat.eof()) {
+        // This takes over fileIn and calls fclose() on it when it is destroyed.
+        // The script check threads are idle while importing, use as many
+        // threads to deserialize and check the blocks.
+        CBlockFileReader reader(fileIn, chainparams, nScriptCheckThreads);
+        CBlockFileReader::Record record;
+        while (reader.Next(record)) {
             boost::this_thread::interruption_point();
 
-            blkdat.SetPos(nRewind);
-            nRewind++; // start one byte further next time, in case of failure
-            blkdat.SetLimit(); // remove former limit
-            unsigned int nSize = 0;
-            try {
-                // locate a header
-                unsigned char buf[CMessageHeader::MESSAGE_START_SIZE];
-                blkdat.FindByte(chainparams.MessageStart()[0]);
-                nRewind = blkdat.GetPos()+1;
-                blkdat >> FLATDATA(buf);
-                if (memcmp(buf, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE))
-                    continue;
-                // read size
-                blkdat >> nSize;
-                if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
-                    continue;
-            } catch (const std::exception&) {
-                // no valid block header found; don't complain
-                break;
+            if (!record.pblock) {
+                LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, record.strError);
+                continue;
             }
+            if (dbp)
+                dbp->nPos = record.nBlockPos;
             try {
-                // read block
-                uint64_t nBlockPos = blkdat.GetPos();
-                if (dbp)
-                    dbp->nPos = nBlockPos;
-                blkdat.SetLimit(nBlockPos + nSize);
-                blkdat.SetPos(nBlockPos);
-                std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-                CBlock& block = *pblock;
-                blkdat >> block;
-                nRewind = blkdat.GetPos();
+                std::shared_ptr<CBlock> pblock = record.pblock;
+                const uint256& hash = record.hash;
 
                 // detect out of order blocks, and store them for later
-                uint256 hash = block.GetHash();
-                if (hash != chainparams.GetConsensus().hashGenesisBlock && mapBlockIndex.find(block.hashPrevBlock) == mapBlockIndex.end()) {
+                if (hash != chainparams.GetConsensus().hashGenesisBlock && mapBlockIndex.find(pblock->hashPrevBlock) == mapBlockIndex.end()) {
                     LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
-                            block.hashPrevBlock.ToString());
+                            pblock->hashPrevBlock.ToString());
                     if (dbp)
-                        mapBlocksUnknownParent.insert(std::make_pair(block.hashPrevBlock, *dbp));
+                        mapBlocksUnknownParent.insert(std::make_pair(pblock->hashPrevBlock, *dbp));
                     continue;
                 }
 
@@ -5067,8 +5193,13 @@ bool LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, CDiskB
                 if (mapBlockIndex.count(hash) == 0 || (mapBlockIndex[hash]->nStatus & BLOCK_HAVE_DATA) == 0) {
                     LOCK(cs_main);
                     CValidationState state;
-                    if (g_chainstate.AcceptBlock(pblock, state, chainparams, nullptr, true, dbp, nullptr, true /* fFromDisk */))
+                    if (g_chainstate.AcceptBlock(pblock, state, chainparams, nullptr, true, dbp, nullptr, true /* fFromDisk */)) {
                         nLoaded++;
+                        // Blocks are connected in about the order they are
+                        // imported, keep the first ones once the cache is full
+                        if (!importedBlockCache.IsFull())
+                            importedBlockCache.Add(hash, pblock, record.nSize);
+                    }
                     if (state.IsError())
                         break;
                 } else if (hash != chainparams.GetConsensus().hashGenesisBlock && mapBlockIndex[hash]->nHeight % 1000 == 0) {
@@ -5165,11 +5296,32 @@ void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
     CBlockIndex* pindexFirstNotTransactionsValid = nullptr; // Oldest ancestor of pindex which does not have BLOCK_VALID_TRANSACTIONS (regardless of being valid or not).
     CBlockIndex* pindexFirstNotChainValid = nullptr; // Oldest ancestor of pindex which does not have BLOCK_VALID_CHAIN (regardless of being valid or not).
     CBlockIndex* pindexFirstNotScriptsValid = nullptr; // Oldest ancestor of pindex which does not have BLOCK_VALID_SCRIPTS (regardless of being valid or not).
+    // The blocks up to a UTXO snapshot base were never downloaded. The base
+    // counts as connected with all its parents; the properties of the path
+    // leading to it are restored when the search leaves its subtree.
+    CBlockIndex* pindexSnapshotFirstMissing = nullptr;
+    CBlockIndex* pindexSnapshotFirstNeverProcessed = nullptr;
+    CBlockIndex* pindexSnapshotFirstNotTransactionsValid = nullptr;
+    CBlockIndex* pindexSnapshotFirstNotChainValid = nullptr;
+    CBlockIndex* pindexSnapshotFirstNotScriptsValid = nullptr;
     while (pindex != nullptr) {
         nNodes++;
+        bool fSnapshotBase = pindex == pindexSnapshotBase;
+        if (fSnapshotBase) {
+            pindexSnapshotFirstMissing = pindexFirstMissing;
+            pindexSnapshotFirstNeverProcessed = pindexFirstNeverProcessed;
+            pindexSnapshotFirstNotTransactionsValid = pindexFirstNotTransactionsValid;
+            pindexSnapshotFirstNotChainValid = pindexFirstNotChainValid;
+            pindexSnapshotFirstNotScriptsValid = pindexFirstNotScriptsValid;
+            pindexFirstMissing = nullptr;
+            pindexFirstNeverProcessed = nullptr;
+            pindexFirstNotTransactionsValid = nullptr;
+            pindexFirstNotChainValid = nullptr;
+            pindexFirstNotScriptsValid = nullptr;
+        }
         if (pindexFirstInvalid == nullptr && pindex->nStatus & BLOCK_FAILED_VALID) pindexFirstInvalid = pindex;
-        if (pindexFirstMissing == nullptr && !(pindex->nStatus & BLOCK_HAVE_DATA)) pindexFirstMissing = pindex;
-        if (pindexFirstNeverProcessed == nullptr && pindex->nTx == 0) pindexFirstNeverProcessed = pindex;
+        if (pindexFirstMissing == nullptr && !(pindex->nStatus & BLOCK_HAVE_DATA) && !fSnapshotBase) pindexFirstMissing = pindex;
+        if (pindexFirstNeverProcessed == nullptr && pindex->nTx == 0 && !fSnapshotBase) pindexFirstNeverProcessed = pindex;
         if (pindex->pprev != nullptr && pindexFirstNotTreeValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_TREE) pindexFirstNotTreeValid = pindex;
         if (pindex->pprev != nullptr && pindexFirstNotTransactionsValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_TRANSACTIONS) pindexFirstNotTransactionsValid = pindex;
         if (pindex->pprev != nullptr && pindexFirstNotChainValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_CHAIN) pindexFirstNotChainValid = pindex;
@@ -5193,7 +5345,7 @@ void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
             if (pindex->nStatus & BLOCK_HAVE_DATA) assert(pindex->nTx > 0);
         }
         if (pindex->nStatus & BLOCK_HAVE_UNDO) assert(pindex->nStatus & BLOCK_HAVE_DATA);
-        assert(((pindex->nStatus & BLOCK_VALID_MASK) >= BLOCK_VALID_TRANSACTIONS) == (pindex->nTx > 0)); // This is pruning-independent.
+        assert(fSnapshotBase || ((pindex->nStatus & BLOCK_VALID_MASK) >= BLOCK_VALID_TRANSACTIONS) == (pindex->nTx > 0)); // This is pruning-independent. The snapshot base is valid without its transactions.
         // All parents having had data (at some point) is equivalent to all parents being VALID_TRANSACTIONS, which is equivalent to nChainTx being set.
         assert((pindexFirstNeverProcessed != nullptr) == (pindex->nChainTx == 0)); // nChainTx != 0 is used to signal that all parent blocks have been processed (but may have been pruned).
         assert((pindexFirstNotTransactionsValid != nullptr) == (pindex->nChainTx == 0));
@@ -5281,6 +5433,13 @@ void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
             if (pindex == pindexFirstNotTransactionsValid) pindexFirstNotTransactionsValid = nullptr;
             if (pindex == pindexFirstNotChainValid) pindexFirstNotChainValid = nullptr;
             if (pindex == pindexFirstNotScriptsValid) pindexFirstNotScriptsValid = nullptr;
+            if (pindex == pindexSnapshotBase) {
+                pindexFirstMissing = pindexSnapshotFirstMissing;
+                pindexFirstNeverProcessed = pindexSnapshotFirstNeverProcessed;
+                pindexFirstNotTransactionsValid = pindexSnapshotFirstNotTransactionsValid;
+                pindexFirstNotChainValid = pindexSnapshotFirstNotChainValid;
+                pindexFirstNotScriptsValid = pindexSnapshotFirstNotScriptsValid;
+            }
             // Find our parent.
             CBlockIndex* pindexPar = pindex->pprev;
             // Find which child we just visited.
@@ -5416,6 +5575,26 @@ bool LoadMempool(void)
     return true;
 }
 
+bool DumpBlockIndex()
+{
+    int64_t nStart = GetTimeMillis();
+    LOCK(cs_main);
+    if (!setDirtyBlockIndex.empty())
+        return error("%s: the block index has unwritten entries", __func__);
+
+    // Parents have a lower height than their children
+    std::vector<const CBlockIndex*> vIndex;
+    vIndex.reserve(mapBlockIndex.size());
+    for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex)
+        vIndex.push_back(item.second);
+    std::sort(vIndex.begin(), vIndex.end(), [](const CBlockIndex* a, const CBlockIndex* b) { return a->nHeight < b->nHeight; });
+
+    if (!pblocktree->WriteFlatBlockIndex(vIndex))
+        return false;
+    LogPrintf("Dumped %u block index entries to the flat file in %dms\n", vIndex.size(), GetTimeMillis() - nStart);
+    return true;
+}
+
 bool DumpMempool(void)
 {
     int64_t start = GetTimeMicros();
@@ -5465,6 +5644,439 @@ bool DumpMempool(void)
     return true;
 }
 
+static const uint64_t UTXO_SNAPSHOT_VERSION = 1;
+
+/** Number of coins that are written to the coin database at once when loading a UTXO snapshot */
+static const size_t UTXO_SNAPSHOT_LOAD_BATCH = 100000;
+
+/** Sidechain state of a UTXO snapshot, at the snapshot block */
+struct SidechainSnapshot
+{
+    SidechainBlockData data;
+    std::vector<SidechainDeposit> vDeposit;
+    std::vector<std::pair<uint8_t, CMutableTransaction>> vWithdrawalTx;
+    std::vector<SidechainSpentWithdrawal> vSpent;
+    std::vector<SidechainFailedWithdrawal> vFailed;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(data);
+        READWRITE(vDeposit);
+        READWRITE(vWithdrawalTx);
+        READWRITE(vSpent);
+        READWRITE(vFailed);
+    }
+};
+
+/** Write the unspent outputs of a transaction to a UTXO snapshot */
+static void WriteSnapshotCoins(CAutoFile& file, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
+{
+    file << hash;
+    WriteCompactSize(file, outputs.size());
+    for (const auto& output : outputs) {
+        file << VARINT(output.first);
+        file << output.second;
+    }
+}
+
+/** Read the unspent outputs of the next transaction of a UTXO snapshot, false after the last one */
+static bool ReadSnapshotCoins(CAutoFile& file, uint256& hash, std::map<uint32_t, Coin>& outputs)
+{
+    outputs.clear();
+    file >> hash;
+    if (hash.IsNull())
+        return false;
+
+    uint64_t nOutputs = ReadCompactSize(file);
+    if (nOutputs == 0)
+        throw std::ios_base::failure("transaction without outputs");
+    for (uint64_t i = 0; i < nOutputs; i++) {
+        uint32_t n = 0;
+        Coin coin;
+        file >> VARINT(n);
+        file >> coin;
+        if (coin.IsSpent())
+            throw std::ios_base::failure("spent output");
+        outputs[n] = std::move(coin);
+    }
+    return true;
+}
+
+/** The hash a snapshot is loaded with, it commits to its block, UTXO set and sidechain state */
+static uint256 GetSnapshotHash(const CTxOutSetSnapshotInfo& info)
+{
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << info.hashBlock;
+    ss << info.hashSerialized;
+    ss << info.hashSidechain;
+    return ss.GetHash();
+}
+
+static bool WriteTxOutSet(CAutoFile& fileout, CTxOutSetSnapshotInfo& info, std::string& strError)
+{
+    const CChainParams& chainparams = Params();
+
+    std::unique_ptr<CCoinsViewCursor> pcursor;
+    {
+        LOCK(cs_main);
+        FlushStateToDisk();
+
+        // The cursor iterates over a snapshot of the database, which is
+        // consistent with the active chain and SCDB while cs_main is held
+        pcursor.reset(pcoinsdbview->Cursor());
+        const CBlockIndex* pindex = chainActive.Tip();
+        if (pcursor->GetBestBlock() != pindex->GetBlockHash()) {
+            strError = "The coin database is not at the tip of the active chain";
+            return false;
+        }
+
+        info.hashBlock = pindex->GetBlockHash();
+        info.nHeight = pindex->nHeight;
+        info.nHeaders = pindex->nHeight;
+
+        fileout << FLATDATA(chainparams.MessageStart());
+        fileout << UTXO_SNAPSHOT_VERSION;
+        fileout << info.hashBlock;
+        fileout << info.nHeight;
+        fileout << (uint64_t)pindex->nChainTx;
+        fileout << info.nHeaders;
+        for (int nHeight = 1; nHeight <= pindex->nHeight; nHeight++)
+            fileout << chainActive[nHeight]->GetBlockHeader();
+
+        SidechainSnapshot sidechain;
+        sidechain.data.vWithdrawalStatus = scdb.GetState();
+        sidechain.data.vActivationStatus = scdb.GetSidechainActivationStatus();
+        sidechain.data.vSidechain = scdb.GetSidechains();
+        if (sidechain.data.vSidechain.empty()) {
+            // Initialize with blank inactive sidechains, as ConnectBlock does
+            sidechain.data.vSidechain.resize(SIDECHAIN_ACTIVATION_MAX_ACTIVE);
+            for (size_t i = 0; i < sidechain.data.vSidechain.size(); i++)
+                sidechain.data.vSidechain[i].nSidechain = i;
+        }
+        for (const Sidechain& s : scdb.GetActiveSidechains()) {
+            std::vector<SidechainDeposit> vSidechainDeposit = scdb.GetDeposits(s.nSidechain);
+            sidechain.vDeposit.insert(sidechain.vDeposit.end(), vSidechainDeposit.begin(), vSidechainDeposit.end());
+        }
+        sidechain.vWithdrawalTx = scdb.GetWithdrawalTxCache();
+        sidechain.vSpent = scdb.GetSpentWithdrawalCache();
+        sidechain.vFailed = scdb.GetFailedWithdrawalCache();
+
+        fileout << sidechain;
+        info.hashSidechain = SerializeHash(sidechain);
+    }
+
+    // Outputs are grouped by transaction, in the order of the database, so
+    // that the hash is the same as hash_serialized_2 of gettxoutsetinfo
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << info.hashBlock;
+    uint256 prevkey;
+    std::map<uint32_t, Coin> outputs;
+    while (pcursor->Valid()) {
+        COutPoint key;
+        Coin coin;
+        if (!pcursor->GetKey(key) || !pcursor->GetValue(coin)) {
+            strError = "Unable to read UTXO set";
+            return false;
+        }
+        if (!outputs.empty() && key.hash != prevkey) {
+            HashTxOutputs(ss, prevkey, outputs);
+            WriteSnapshotCoins(fileout, prevkey, outputs);
+            outputs.clear();
+        }
+        prevkey = key.hash;
+        outputs[key.n] = std::move(coin);
+        info.nCoins++;
+        pcursor->Next();
+    }
+    if (!outputs.empty()) {
+        HashTxOutputs(ss, prevkey, outputs);
+        WriteSnapshotCoins(fileout, prevkey, outputs);
+    }
+    info.hashSerialized = ss.GetHash();
+    info.hashSnapshot = GetSnapshotHash(info);
+
+    // A null txid ends the coins
+    fileout << uint256();
+    fileout << info.nCoins;
+    fileout << info.hashSerialized;
+    fileout << info.hashSidechain;
+
+    return true;
+}
+
+bool DumpTxOutSet(const fs::path& path, CTxOutSetSnapshotInfo& info, std::string& strError)
+{
+    int64_t nStart = GetTimeMicros();
+
+    fs::path pathTmp = path;
+    pathTmp += ".new";
+    FILE* filestr = fsbridge::fopen(pathTmp, "wb");
+    if (!filestr) {
+        strError = strprintf("Unable to open %s for writing", pathTmp.string());
+        return false;
+    }
+
+    CAutoFile fileout(filestr, SER_DISK, CLIENT_VERSION);
+    bool fOk = false;
+    try {
+        fOk = WriteTxOutSet(fileout, info, strError);
+        if (fOk)
+            FileCommit(fileout.Get());
+    } catch (const std::exception& e) {
+        strError = strprintf("Unable to write UTXO snapshot: %s", e.what());
+    }
+    fileout.fclose();
+
+    if (!fOk || !RenameOver(pathTmp, path)) {
+        if (fOk)
+            strError = strprintf("Unable to rename %s", pathTmp.string());
+        fs::remove(pathTmp);
+        return false;
+    }
+
+    LogPrintf("Dumped UTXO snapshot of %u coins at block %s (height %d): %.2fs\n",
+            info.nCoins, info.hashBlock.ToString(), info.nHeight, (GetTimeMicros() - nStart) * MICRO);
+    return true;
+}
+
+/** Whether a UTXO snapshot can be loaded into the chainstate */
+static bool CanLoadTxOutSet(std::string& strError)
+{
+    AssertLockHeld(cs_main);
+
+    if (g_chainstate.pindexSnapshotBase) {
+        strError = "A UTXO snapshot was loaded already";
+        return false;
+    }
+    if (chainActive.Height() != 0) {
+        strError = "A UTXO snapshot can only be loaded while the active chain is at the genesis block";
+        return false;
+    }
+    if (g_txindex) {
+        strError = "Loading a UTXO snapshot is not supported with -txindex";
+        return false;
+    }
+    return true;
+}
+
+bool LoadTxOutSet(const fs::path& path, const uint256& hashExpected, CTxOutSetSnapshotInfo& info, std::string& strError)
+{
+    const CChainParams& chainparams = Params();
+    int64_t nStart = GetTimeMicros();
+
+    if (hashExpected.IsNull()) {
+        strError = "The expected hash of the UTXO snapshot is required";
+        return false;
+    }
+
+    {
+        LOCK(cs_main);
+        if (!CanLoadTxOutSet(strError))
+            return false;
+    }
+
+    CAutoFile filein(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        strError = strprintf("Unable to open %s", path.string());
+        return false;
+    }
+
+    // First pass: accept the headers and verify the hashes of the snapshot,
+    // before anything is written to the coin database
+    uint64_t nChainTx = 0;
+    SidechainSnapshot sidechain;
+    long nCoinsPos = 0;
+    try {
+        CMessageHeader::MessageStartChars messageStart;
+        uint64_t nVersion = 0;
+        filein >> FLATDATA(messageStart);
+        filein >> nVersion;
+        if (memcmp(messageStart, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE)) {
+            strError = "The UTXO snapshot is for a different network";
+            return false;
+        }
+        if (nVersion != UTXO_SNAPSHOT_VERSION) {
+            strError = strprintf("Unsupported UTXO snapshot version %u", nVersion);
+            return false;
+        }
+        filein >> info.hashBlock;
+        filein >> info.nHeight;
+        filein >> nChainTx;
+        filein >> info.nHeaders;
+        if (info.nHeight <= 0 || info.nHeaders != (uint64_t)info.nHeight) {
+            strError = "The UTXO snapshot must be above the genesis block and have its headers";
+            return false;
+        }
+
+        // The headers are checked like headers received from a peer
+        std::vector<CBlockHeader> vHeaders;
+        const CBlockIndex* pindexLast = nullptr;
+        for (uint64_t i = 0; i < info.nHeaders; i++) {
+            CBlockHeader header;
+            filein >> header;
+            vHeaders.push_back(header);
+            if (vHeaders.size() == MAX_HEADERS_RESULTS || i + 1 == info.nHeaders) {
+                CValidationState state;
+                if (!ProcessNewBlockHeaders(vHeaders, state, chainparams, &pindexLast)) {
+                    strError = strprintf("Invalid block header in UTXO snapshot: %s", FormatStateMessage(state));
+                    return false;
+                }
+                vHeaders.clear();
+            }
+        }
+        if (!pindexLast || pindexLast->GetBlockHash() != info.hashBlock || pindexLast->nHeight != info.nHeight) {
+            strError = "The headers of the UTXO snapshot don't lead to its block";
+            return false;
+        }
+
+        filein >> sidechain;
+        info.hashSidechain = SerializeHash(sidechain);
+
+        nCoinsPos = ftell(filein.Get());
+        if (nCoinsPos < 0) {
+            strError = "Unable to read UTXO snapshot position";
+            return false;
+        }
+
+        CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+        ss << info.hashBlock;
+        uint256 hash;
+        std::map<uint32_t, Coin> outputs;
+        while (ReadSnapshotCoins(filein, hash, outputs)) {
+            HashTxOutputs(ss, hash, outputs);
+            info.nCoins += outputs.size();
+        }
+        info.hashSerialized = ss.GetHash();
+
+        uint64_t nCoins = 0;
+        uint256 hashSerialized;
+        uint256 hashSidechain;
+        filein >> nCoins;
+        filein >> hashSerialized;
+        filein >> hashSidechain;
+        if (nCoins != info.nCoins || hashSerialized != info.hashSerialized || hashSidechain != info.hashSidechain) {
+            strError = "The UTXO snapshot is corrupt, its contents don't match its hashes";
+            return false;
+        }
+    } catch (const std::exception& e) {
+        strError = strprintf("Unable to read UTXO snapshot: %s", e.what());
+        return false;
+    }
+
+    info.hashSnapshot = GetSnapshotHash(info);
+    if (info.hashSnapshot != hashExpected) {
+        strError = strprintf("The hash %s of the UTXO snapshot doesn't match the expected hash %s",
+                info.hashSnapshot.ToString(), hashExpected.ToString());
+        return false;
+    }
+
+    LogPrintf("%s: Verified UTXO snapshot of %u coins at block %s (height %d): %.2fs\n", __func__,
+            info.nCoins, info.hashBlock.ToString(), info.nHeight, (GetTimeMicros() - nStart) * MICRO);
+
+    // Second pass: write the coins to the database. cs_main is held until
+    // the snapshot block is the tip, so that no block is connected meanwhile.
+    LOCK(cs_main);
+    if (!CanLoadTxOutSet(strError))
+        return false;
+
+    // Leave the coins cache and the background flush idle at genesis
+    FlushStateToDisk();
+
+    CBlockIndex* pindex = mapBlockIndex.find(info.hashBlock)->second;
+
+    try {
+        if (fseek(filein.Get(), nCoinsPos, SEEK_SET)) {
+            strError = "Unable to read UTXO snapshot position";
+            return false;
+        }
+
+        // Until the last batch the database is marked as being in the middle
+        // of a write to the snapshot block, an interrupted load has to be
+        // recovered with -reindex-chainstate
+        CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+        ss << info.hashBlock;
+        CCoinsMap mapCoins;
+        uint64_t nWritten = 0;
+        uint256 hash;
+        std::map<uint32_t, Coin> outputs;
+        while (ReadSnapshotCoins(filein, hash, outputs)) {
+            HashTxOutputs(ss, hash, outputs);
+            for (auto& output : outputs) {
+                CCoinsCacheEntry& entry = mapCoins[COutPoint(hash, output.first)];
+                entry.coin = std::move(output.second);
+                entry.flags = CCoinsCacheEntry::DIRTY | CCoinsCacheEntry::FRESH;
+            }
+            if (mapCoins.size() >= UTXO_SNAPSHOT_LOAD_BATCH) {
+                if (!pcoinsdbview->WriteCoins(mapCoins, info.hashBlock, false)) {
+                    strError = "Failed to write to coin database";
+                    return false;
+                }
+                nWritten += mapCoins.size();
+                mapCoins.clear();
+                LogPrint(BCLog::COINDB, "Loaded %u of %u coins from UTXO snapshot\n", nWritten, info.nCoins);
+            }
+        }
+        if (ss.GetHash() != info.hashSerialized) {
+            strError = "The UTXO snapshot changed while it was loaded, restart with -reindex-chainstate";
+            return false;
+        }
+        if (!pcoinsdbview->WriteCoins(mapCoins, info.hashBlock, true)) {
+            strError = "Failed to write to coin database";
+            return false;
+        }
+    } catch (const std::exception& e) {
+        strError = strprintf("Unable to read UTXO snapshot: %s, restart with -reindex-chainstate", e.what());
+        return false;
+    }
+
+    // Make the snapshot block the tip. It is recorded before the block
+    // index is flushed, so that it is found again by LoadBlockIndex.
+    if (!pblocktree->WriteSnapshotBase(info.hashBlock, nChainTx)) {
+        strError = "Failed to write to block index database";
+        return false;
+    }
+    pcoinsTip->SetBestBlock(info.hashBlock);
+    g_chainstate.ActivateSnapshotBase(pindex, nChainTx);
+
+    // Load the sidechain state of the snapshot block
+    scdb.ApplyLDBData(info.hashBlock, sidechain.data);
+    scdb.AddDeposits(sidechain.vDeposit);
+    for (const std::pair<uint8_t, CMutableTransaction>& pair : sidechain.vWithdrawalTx)
+        scdb.CacheWithdrawalTx(CTransaction(pair.second), pair.first);
+    scdb.AddSpentWithdrawals(sidechain.vSpent);
+    scdb.AddFailedWithdrawals(sidechain.vFailed);
+    if (!psidechaintree->HaveBlockData(info.hashBlock) &&
+            !psidechaintree->WriteSidechainBlockData(std::make_pair(info.hashBlock, sidechain.data)))
+    {
+        strError = "Failed to write sidechain block data";
+        return false;
+    }
+    mempool.UpdateCTIPFromBlock(scdb.GetCTIP(), false /* fDisconnect */);
+    DumpSCDBCache();
+
+    CValidationState state;
+    if (!FlushStateToDisk(chainparams, state, FLUSH_STATE_ALWAYS)) {
+        strError = FormatStateMessage(state);
+        return false;
+    }
+    UpdateTip(pindex, chainparams);
+
+    GetMainSignals().UpdatedBlockTip(pindex, chainActive.Genesis(), IsInitialBlockDownload());
+    uiInterface.NotifyBlockTip(IsInitialBlockDownload(), pindex);
+
+    LogPrintf("Loaded UTXO snapshot of %u coins at block %s (height %d): %.2fs\n",
+            info.nCoins, info.hashBlock.ToString(), info.nHeight, (GetTimeMicros() - nStart) * MICRO);
+    return true;
+}
+
+bool IsSnapshotChainstate()
+{
+    LOCK(cs_main);
+    return g_chainstate.pindexSnapshotBase != nullptr;
+}
+
 static const uint64_t SCDB_DUMP_VERSION = 1;
 
 bool LoadCustomVoteCache()
@@ -34,6 +34,8 @@ class AddressBook;
 class CBlockIndex;
 class CBlockTreeDB;
 class CChainParams;
+class CHashWriter;
+class CCoinsViewBackgroundFlush;
 class CCoinsViewDB;
 class CInv;
 class CConnman;
@@ -138,6 +140,8 @@ static const bool DEFAULT_TXINDEX = false;
 static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
+/** Default for -backgroundflush */
+static const bool DEFAULT_BACKGROUND_FLUSH = true;
 /** Default for -mempoolreplacement */
 static const bool DEFAULT_ENABLE_REPLACEMENT = true;
 /** Default for using fee filter */
@@ -181,13 +185,15 @@ extern CConditionVariable cvBlockChange;
 extern std::atomic_bool fImporting;
 extern std::atomic_bool fReindex;
 extern int nScriptCheckThreads;
-extern bool fTxIndex;
 extern bool fIsBareMultisigStd;
 extern bool fRequireStandard;
 extern bool fCMPCTWit;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
+extern bool fBackgroundFlush;
 extern size_t nCoinCacheUsage;
+/** Time in microseconds that the last chainstate flush held cs_main (protected by cs_main) */
+extern int64_t nLastFlushLockTime;
 /** A fee rate smaller than this is considered zero fee (for relaying, mining and transaction creation) */
 extern CFeeRate minRelayTxFee;
 /** Absolute maximum transaction fee (in satoshis) used by wallet and mempool (rejects high fee in sendrawtransaction) */
@@ -275,6 +281,8 @@ FILE* OpenBlockFile(const CDiskBlockPos &pos, bool fReadOnly = false);
 fs::path GetBlockPosFilename(const CDiskBlockPos &pos, const char *prefix);
 /** Import blocks from an external file */
 bool LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, CDiskBlockPos *dbp = nullptr);
+/** Drop the imported blocks ConnectTip didn't use, once the imports are connected */
+void ClearImportedBlocks();
 /** Ensures we have a genesis block in the block tree, possibly writing one to disk. */
 bool LoadGenesisBlock(const CChainParams& chainparams);
 /** Load the block tree and coins database from disk,
@@ -288,6 +296,8 @@ void CompactWitBlockIndex();
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the thread reading the coins spent by a block ahead of ConnectBlock */
+void ThreadCoinPrefetch();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Retrieve a transaction (from memory pool, or from disk, if possible) */
@@ -499,6 +509,9 @@ extern CChain& chainActive;
 /** Global variable that points to the coins database (protected by cs_main) */
 extern std::unique_ptr<CCoinsViewDB> pcoinsdbview;
 
+/** Global variable that points to the layer writing flushed coins to pcoinsdbview in the background */
+extern std::unique_ptr<CCoinsViewBackgroundFlush> pcoinsflush;
+
 /** Global variable that points to the active CCoinsView (protected by cs_main) */
 extern std::unique_ptr<CCoinsViewCache> pcoinsTip;
 
@@ -534,12 +547,68 @@ static const unsigned int REJECT_HIGHFEE = 0x100;
 /** Get block file info entry for one block file */
 CBlockFileInfo* GetBlockFileInfo(size_t n);
 
+/** Dump the block index to a flat file, which is loaded faster than the block tree database. */
+bool DumpBlockIndex();
+
 /** Dump the mempool to disk. */
 bool DumpMempool();
 
 /** Load the mempool from disk. */
 bool LoadMempool();
 
+/** Summary of a UTXO set snapshot */
+struct CTxOutSetSnapshotInfo
+{
+    uint256 hashBlock;
+    int nHeight = 0;
+    uint64_t nCoins = 0;
+    uint64_t nHeaders = 0;
+    //! Hash of the UTXO set, the same as hash_serialized_2 of gettxoutsetinfo
+    uint256 hashSerialized;
+    //! Hash of the sidechain state in the snapshot
+    uint256 hashSidechain;
+    //! Hash of the block, the UTXO set and the sidechain state, which
+    //! loadtxoutset requires
+    uint256 hashSnapshot;
+};
+
+/**
+ * Write a snapshot of the chainstate to path: the UTXO set, the headers of
+ * the active chain and the sidechain state (SCDB and its deposits) at the
+ * chainstate's best block.
+ */
+bool DumpTxOutSet(const fs::path& path, CTxOutSetSnapshotInfo& info, std::string& strError);
+
+/**
+ * Load a snapshot written by DumpTxOutSet into a chainstate that is still at
+ * the genesis block and make its block the tip of the active chain. The
+ * headers are validated like headers from the network. The UTXO set and the
+ * sidechain state are only trusted if hashSnapshot matches hashExpected.
+ */
+bool LoadTxOutSet(const fs::path& path, const uint256& hashExpected, CTxOutSetSnapshotInfo& info, std::string& strError);
+
+/** Whether the active chain was loaded from a UTXO snapshot, without the blocks below it */
+bool IsSnapshotChainstate();
+
+/**
+ * Add the unspent outputs of a transaction to a hash_serialized_2 hash of the
+ * UTXO set. Any stream of type SER_GETHASH can buffer the data, to be hashed
+ * in database order later.
+ */
+template <typename Stream>
+void HashTxOutputs(Stream& ss, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
+{
+    assert(!outputs.empty());
+    ss << hash;
+    ss << VARINT(outputs.begin()->second.nHeight * 2 + outputs.begin()->second.fCoinBase);
+    for (const auto& output : outputs) {
+        ss << VARINT(output.first + 1);
+        ss << output.second.out.scriptPubKey;
+        ss << VARINT(output.second.out.nValue);
+    }
+    ss << VARINT(0);
+}
+
 /** Load cache of user set votes for withdrawals */
 bool LoadCustomVoteCache();
 
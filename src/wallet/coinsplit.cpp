@@ -0,0 +1,169 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/coinsplit.h>
+
+#include <consensus/consensus.h>
+#include <policy/policy.h>
+#include <tinyformat.h>
+#include <txmempool.h>
+#include <util.h>
+#include <validation.h>
+#include <wallet/coincontrol.h>
+#include <wallet/fees.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+/** A tree of split transactions, root first */
+struct SplitTree
+{
+    //! Number of transactions and of the outputs they create, per level
+    std::vector<std::pair<unsigned int, unsigned int>> vLevel;
+    unsigned int nTx;
+    uint64_t nSize;
+    //! Size of the largest chain of transactions from the root to a leaf
+    uint64_t nPathSize;
+};
+
+uint64_t SplitTxSize(uint64_t nOutputs)
+{
+    return SPLIT_TX_OVERHEAD_SIZE + SPLIT_INPUT_SIZE + nOutputs * SPLIT_OUTPUT_SIZE;
+}
+
+/** The tree with the fewest levels holding nOutputs with at most nMaxOutputs outputs per transaction */
+SplitTree GetSplitTree(unsigned int nOutputs, unsigned int nMaxOutputs)
+{
+    SplitTree tree;
+
+    // Levels from the leaves up, until the root can fund the level below
+    // it and still have an output left for the change
+    std::vector<std::pair<unsigned int, unsigned int>> vLevel;
+    unsigned int nNeeded = nOutputs;
+    while (nNeeded > nMaxOutputs - 1) {
+        unsigned int nTx = (nNeeded + nMaxOutputs - 1) / nMaxOutputs;
+        vLevel.emplace_back(nTx, nNeeded);
+        nNeeded = nTx;
+    }
+    vLevel.emplace_back(1, nNeeded + 1);
+    tree.vLevel.assign(vLevel.rbegin(), vLevel.rend());
+
+    tree.nTx = 0;
+    tree.nSize = 0;
+    tree.nPathSize = 0;
+    for (const std::pair<unsigned int, unsigned int>& level : tree.vLevel) {
+        tree.nTx += level.first;
+        tree.nSize += level.first * SplitTxSize(0) + (uint64_t)level.second * SPLIT_OUTPUT_SIZE;
+        tree.nPathSize += SplitTxSize((level.second + level.first - 1) / level.first);
+    }
+    return tree;
+}
+
+bool SplitTreeFits(const SplitTree& tree, const CoinSplitLimits& limits)
+{
+    return tree.nTx <= limits.nMaxDescendants &&
+           tree.vLevel.size() <= limits.nMaxAncestors &&
+           tree.nSize <= limits.nMaxDescendantSize &&
+           tree.nPathSize <= limits.nMaxAncestorSize;
+}
+
+/** Value a tree takes from its coin, one satoshi of fee rounding per transaction */
+CAmount SplitTreeCost(const SplitTree& tree, unsigned int nOutputs, CAmount nAmount, const CFeeRate& feeRate)
+{
+    return nOutputs * nAmount + feeRate.GetFee(tree.nSize) + tree.nTx;
+}
+
+} // namespace
+
+CFeeRate GetCoinSplitFeeRate()
+{
+    CCoinControl coin_control;
+    return CFeeRate(GetMinimumFee(1000, coin_control, ::mempool, ::feeEstimator, nullptr));
+}
+
+CoinSplitLimits GetCoinSplitLimits(unsigned int nMaxTxOutputs)
+{
+    CoinSplitLimits limits;
+    limits.nMaxTxOutputs = nMaxTxOutputs;
+    limits.nMaxTxSize = MAX_STANDARD_TX_WEIGHT / WITNESS_SCALE_FACTOR;
+    limits.nMaxAncestors = gArgs.GetArg("-limitancestorcount", DEFAULT_ANCESTOR_LIMIT);
+    limits.nMaxAncestorSize = gArgs.GetArg("-limitancestorsize", DEFAULT_ANCESTOR_SIZE_LIMIT) * 1000;
+    limits.nMaxDescendants = gArgs.GetArg("-limitdescendantcount", DEFAULT_DESCENDANT_LIMIT);
+    limits.nMaxDescendantSize = gArgs.GetArg("-limitdescendantsize", DEFAULT_DESCENDANT_SIZE_LIMIT) * 1000;
+    return limits;
+}
+
+bool PlanCoinSplit(const std::vector<CAmount>& vCoinValue, unsigned int nOutputs, CAmount nAmount, const CFeeRate& feeRate, const CoinSplitLimits& limits, std::vector<PlannedSplitTx>& vPlan, std::string& strFail)
+{
+    vPlan.clear();
+
+    const unsigned int nMaxOutputs = std::min<uint64_t>(limits.nMaxTxOutputs, (limits.nMaxTxSize - SplitTxSize(0)) / SPLIT_OUTPUT_SIZE);
+    if (nMaxOutputs < 2) {
+        strFail = "Split transactions need at least two outputs!\n";
+        return false;
+    }
+    if (nOutputs == 0 || nAmount <= 0) {
+        strFail = "Invalid number of outputs or amount!\n";
+        return false;
+    }
+
+    // Largest coins first
+    std::vector<size_t> vCoin(vCoinValue.size());
+    std::iota(vCoin.begin(), vCoin.end(), 0);
+    std::stable_sort(vCoin.begin(), vCoin.end(), [&vCoinValue](size_t a, size_t b) {
+        return vCoinValue[a] > vCoinValue[b];
+    });
+
+    unsigned int nRemaining = nOutputs;
+    for (size_t nCoin : vCoin) {
+        if (nRemaining == 0)
+            break;
+
+        // The most outputs a tree on this coin can hold, the size of a tree
+        // and what it costs only grow with the outputs it holds
+        unsigned int nLow = 0;
+        unsigned int nHigh = std::min<CAmount>(nRemaining, vCoinValue[nCoin] / nAmount);
+        while (nLow < nHigh) {
+            unsigned int nMid = nLow + (nHigh - nLow + 1) / 2;
+            SplitTree tree = GetSplitTree(nMid, nMaxOutputs);
+            if (SplitTreeFits(tree, limits) && SplitTreeCost(tree, nMid, nAmount, feeRate) <= vCoinValue[nCoin])
+                nLow = nMid;
+            else
+                nHigh = nMid - 1;
+        }
+        if (nLow == 0)
+            continue;
+
+        // Every transaction of a level funds an even share of the level
+        // below it, the leaves split an even share of the outputs
+        const SplitTree tree = GetSplitTree(nLow, nMaxOutputs);
+        std::vector<size_t> vParents{vPlan.size()};
+        vPlan.push_back(PlannedSplitTx{-1, nCoin, 0, 0, {}});
+        for (size_t nLevel = 1; nLevel < tree.vLevel.size(); nLevel++) {
+            const unsigned int nTx = tree.vLevel[nLevel].first;
+            std::vector<size_t> vLevel;
+            for (unsigned int i = 0; i < nTx; i++) {
+                size_t nParent = vParents[(uint64_t)i * vParents.size() / nTx];
+                vPlan[nParent].vChildren.push_back(vPlan.size());
+                vLevel.push_back(vPlan.size());
+                vPlan.push_back(PlannedSplitTx{(int)nParent, nCoin, (unsigned int)nLevel, 0, {}});
+            }
+            vParents.swap(vLevel);
+        }
+        for (size_t i = 0; i < vParents.size(); i++)
+            vPlan[vParents[i]].nSplitOutputs = (uint64_t)(i + 1) * nLow / vParents.size() - (uint64_t)i * nLow / vParents.size();
+
+        nRemaining -= nLow;
+    }
+
+    if (nRemaining > 0) {
+        strFail = strprintf("The confirmed coins can only hold %u of the %u outputs within the mempool limits!\n", nOutputs - nRemaining, nOutputs);
+        vPlan.clear();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_WALLET_COINSPLIT_H
+#define BITCOIN_WALLET_COINSPLIT_H
+
+#include <amount.h>
+#include <policy/feerate.h>
+
+#include <string>
+#include <vector>
+
+//! Default maximum number of outputs of one coin split transaction
+static const unsigned int DEFAULT_SPLIT_TX_OUTPUTS = 1000;
+//! Maximum number of threads signing coin split transactions
+static const int MAX_SPLIT_SIGNING_THREADS = 8;
+
+//! Virtual sizes coin splits are planned with, for replay protected transactions with signed legacy inputs
+static const unsigned int SPLIT_TX_OVERHEAD_SIZE = 13;
+static const unsigned int SPLIT_INPUT_SIZE = 149;
+static const unsigned int SPLIT_OUTPUT_SIZE = 34;
+
+/** Size and mempool chain limits the transactions of a coin split fit in, sizes in virtual bytes */
+struct CoinSplitLimits
+{
+    unsigned int nMaxTxOutputs;
+    unsigned int nMaxTxSize;
+    unsigned int nMaxAncestors;
+    unsigned int nMaxAncestorSize;
+    unsigned int nMaxDescendants;
+    unsigned int nMaxDescendantSize;
+};
+
+/** Fee rate of coin split transactions, the minimum fee rate of the wallet */
+CFeeRate GetCoinSplitFeeRate();
+
+/** The limits of the standardness policy and the -limit* arguments, with at most nMaxTxOutputs outputs per transaction */
+CoinSplitLimits GetCoinSplitLimits(unsigned int nMaxTxOutputs);
+
+/**
+ * A transaction of a coin split. A root spends a coin, every other
+ * transaction spends an output of its parent. A transaction creates
+ * nSplitOutputs of the split outputs and an output funding each of its
+ * children, and a root also has a change output.
+ */
+struct PlannedSplitTx
+{
+    //! Index of the parent in the plan, -1 for a root
+    int nParent;
+    //! Index of the coin a root spends
+    size_t nCoin;
+    //! Number of transactions between this one and its root
+    unsigned int nDepth;
+    unsigned int nSplitOutputs;
+    std::vector<size_t> vChildren;
+};
+
+/**
+ * Plan the transactions splitting coins into nOutputs outputs of nAmount.
+ *
+ * Every coin used is the root of a tree of transactions that stays within
+ * the limits while none of it is confirmed. Transactions fund up to
+ * nMaxTxOutputs children or split outputs, so a tree takes as few levels
+ * as possible. The largest coins are used first and their trees hold as
+ * many outputs as the limits and the coin allow, which keeps the number of
+ * transactions, and so the fee, low.
+ *
+ * Parents come before their children in vPlan. Returns false if the coins
+ * can't hold every output.
+ */
+bool PlanCoinSplit(const std::vector<CAmount>& vCoinValue, unsigned int nOutputs, CAmount nAmount, const CFeeRate& feeRate, const CoinSplitLimits& limits, std::vector<PlannedSplitTx>& vPlan, std::string& strFail);
+
+#endif // BITCOIN_WALLET_COINSPLIT_H
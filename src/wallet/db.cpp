@@ -54,6 +54,35 @@ void CheckUniqueFileid(const CDBEnv& env, const std::string& filename, Db& db)
 }
 } // namespace
 
+bool ParseWalletDBFormat(const std::string& strFormat, WalletDBFormat& format)
+{
+    if (strFormat == "bdb") {
+        format = WALLETDB_BDB;
+        return true;
+    }
+    if (strFormat == "log") {
+        format = WALLETDB_LOG;
+        return true;
+    }
+    return false;
+}
+
+std::string FormatWalletDBFormat(WalletDBFormat format)
+{
+    return format == WALLETDB_LOG ? "log" : "bdb";
+}
+
+WalletDBFormat GetWalletDBFormat(const std::string& strFile)
+{
+    fs::path path = GetWalletDir() / strFile;
+    if (fs::exists(path))
+        return CWalletLogDB::IsLogFile(path) ? WALLETDB_LOG : WALLETDB_BDB;
+
+    WalletDBFormat format = WALLETDB_BDB;
+    ParseWalletDBFormat(gArgs.GetArg("-walletformat", DEFAULT_WALLET_FORMAT), format);
+    return format;
+}
+
 //
 // CDB
 //
@@ -301,6 +330,13 @@ bool CDB::VerifyEnvironment(const std::string& walletFile, const fs::path& walle
 
 bool CDB::VerifyDatabaseFile(const std::string& walletFile, const fs::path& walletDir, std::string& warningStr, std::string& errorStr, CDBEnv::recoverFunc_type recoverFunc)
 {
+    if (fs::exists(walletDir / walletFile) && CWalletLogDB::IsLogFile(walletDir / walletFile))
+    {
+        // A wallet log drops a batch that was left incomplete when it is
+        // read, there is nothing else to recover
+        CWalletLogDB logdb(walletDir / walletFile);
+        return logdb.Open(false, errorStr);
+    }
     if (fs::exists(walletDir / walletFile))
     {
         std::string backup_filename;
@@ -398,7 +434,14 @@ void CDBEnv::CheckpointLSN(const std::string& strFile)
 }
 
 
-CDB::CDB(CWalletDBWrapper& dbw, const char* pszMode, bool fFlushOnCloseIn) : pdb(nullptr), activeTxn(nullptr)
+CWalletDBWrapper::CWalletDBWrapper(CDBEnv *env_in, const std::string &strFile_in, WalletDBFormat format) :
+    nUpdateCounter(0), nLastSeen(0), nLastFlushed(0), nLastWalletUpdate(0), env(env_in), strFile(strFile_in)
+{
+    if (format == WALLETDB_LOG)
+        logdb.reset(new CWalletLogDB(GetWalletDir() / strFile));
+}
+
+CDB::CDB(CWalletDBWrapper& dbw, const char* pszMode, bool fFlushOnCloseIn) : pdb(nullptr), plog(nullptr), fLogTxn(false), activeTxn(nullptr)
 {
     fReadOnly = (!strchr(pszMode, '+') && !strchr(pszMode, 'w'));
     fFlushOnClose = fFlushOnCloseIn;
@@ -409,6 +452,22 @@ CDB::CDB(CWalletDBWrapper& dbw, const char* pszMode, bool fFlushOnCloseIn) : pdb
     const std::string &strFilename = dbw.strFile;
 
     bool fCreate = strchr(pszMode, 'c') != nullptr;
+
+    if (dbw.logdb) {
+        std::string strError;
+        if (!dbw.logdb->Open(fCreate, strError))
+            throw std::runtime_error(strprintf("CDB: %s", strError));
+        plog = dbw.logdb.get();
+        strFile = strFilename;
+        if (fCreate && !Exists(std::string("version"))) {
+            bool fTmp = fReadOnly;
+            fReadOnly = false;
+            WriteVersion(CLIENT_VERSION);
+            fReadOnly = fTmp;
+        }
+        return;
+    }
+
     unsigned int nFlags = DB_THREAD;
     if (fCreate)
         nFlags |= DB_CREATE;
@@ -461,6 +520,13 @@ CDB::CDB(CWalletDBWrapper& dbw, const char* pszMode, bool fFlushOnCloseIn) : pdb
 
 void CDB::Flush()
 {
+    if (plog) {
+        // Append the writes made so far without syncing, like the
+        // checkpoint of BerkeleyDB
+        if (!fLogTxn)
+            plog->Flush(false);
+        return;
+    }
     if (activeTxn)
         return;
 
@@ -479,6 +545,14 @@ void CWalletDBWrapper::IncrementUpdateCounter()
 
 void CDB::Close()
 {
+    if (plog) {
+        if (fLogTxn)
+            TxnAbort();
+        if (fFlushOnClose)
+            Flush();
+        plog = nullptr;
+        return;
+    }
     if (!pdb)
         return;
     if (activeTxn)
@@ -509,8 +583,83 @@ void CDBEnv::CloseDb(const std::string& strFile)
     }
 }
 
+bool CDB::ReadLog(const CWalletLogDB::Data& key, CWalletLogDB::Data& value)
+{
+    // The open transaction sees its own changes
+    for (std::vector<CWalletLogDB::Op>::reverse_iterator it = vLogTxn.rbegin(); it != vLogTxn.rend(); ++it) {
+        if (it->key == key) {
+            if (it->fErase)
+                return false;
+            value = it->value;
+            return true;
+        }
+    }
+    return plog->Read(key, value);
+}
+
+bool CDB::ReadLog(const CDataStream& ssKey, CDataStream& ssValue)
+{
+    CWalletLogDB::Data value;
+    if (!ReadLog(CWalletLogDB::Data(ssKey.begin(), ssKey.end()), value))
+        return false;
+    ssValue.write((const char*)value.data(), value.size());
+    return true;
+}
+
+bool CDB::WriteLog(const CDataStream& ssKey, const CDataStream* pssValue, bool fOverwrite)
+{
+    CWalletLogDB::Op op;
+    op.fErase = pssValue == nullptr;
+    op.key.assign(ssKey.begin(), ssKey.end());
+    if (pssValue)
+        op.value.assign(pssValue->begin(), pssValue->end());
+
+    if (!fOverwrite) {
+        CWalletLogDB::Data value;
+        if (ReadLog(op.key, value))
+            return false;
+    }
+
+    if (fLogTxn) {
+        vLogTxn.push_back(std::move(op));
+        return true;
+    }
+    return plog->Apply({op}, false);
+}
+
+int CDB::ReadAtLogCursor(CDBCursor* pcursor, CDataStream& ssKey, CDataStream& ssValue, bool setRange)
+{
+    CWalletLogDB::Data key;
+    CWalletLogDB::Data value;
+    bool fFound;
+    if (setRange)
+        fFound = plog->Seek(CWalletLogDB::Data(ssKey.begin(), ssKey.end()), true, key, value);
+    else
+        fFound = plog->Seek(pcursor->keyLast, !pcursor->fStarted, key, value);
+    if (!fFound)
+        return DB_NOTFOUND;
+    pcursor->keyLast = key;
+    pcursor->fStarted = true;
+
+    // Convert to streams
+    ssKey.SetType(SER_DISK);
+    ssKey.clear();
+    ssKey.write((const char*)key.data(), key.size());
+    ssValue.SetType(SER_DISK);
+    ssValue.clear();
+    ssValue.write((const char*)value.data(), value.size());
+    return 0;
+}
+
 bool CDB::Rewrite(CWalletDBWrapper& dbw, const char* pszSkip)
 {
+    if (dbw.logdb) {
+        std::string strError;
+        if (!dbw.logdb->Open(false, strError))
+            return error("CDB::Rewrite: %s", strError);
+        LogPrintf("CDB::Rewrite: Rewriting %s...\n", dbw.strFile);
+        return dbw.logdb->Compact(pszSkip);
+    }
     if (dbw.IsDummy()) {
         return true;
     }
@@ -543,17 +692,17 @@ bool CDB::Rewrite(CWalletDBWrapper& dbw, const char* pszSkip)
                         fSuccess = false;
                     }
 
-                    Dbc* pcursor = db.GetCursor();
+                    std::unique_ptr<CDBCursor> pcursor = db.GetCursor();
                     if (pcursor)
                         while (fSuccess) {
                             CDataStream ssKey(SER_DISK, CLIENT_VERSION);
                             CDataStream ssValue(SER_DISK, CLIENT_VERSION);
-                            int ret1 = db.ReadAtCursor(pcursor, ssKey, ssValue);
+                            int ret1 = db.ReadAtCursor(pcursor.get(), ssKey, ssValue);
                             if (ret1 == DB_NOTFOUND) {
-                                pcursor->close();
+                                pcursor.reset();
                                 break;
                             } else if (ret1 != 0) {
-                                pcursor->close();
+                                pcursor.reset();
                                 fSuccess = false;
                                 break;
                             }
@@ -640,6 +789,10 @@ void CDBEnv::Flush(bool fShutdown)
 
 bool CDB::PeriodicFlush(CWalletDBWrapper& dbw)
 {
+    if (dbw.logdb) {
+        LogPrint(BCLog::DB, "Flushing %s\n", dbw.strFile);
+        return dbw.logdb->Flush(true) && dbw.logdb->MaybeCompact();
+    }
     if (dbw.IsDummy()) {
         return true;
     }
@@ -688,6 +841,27 @@ bool CWalletDBWrapper::Rewrite(const char* pszSkip)
 
 bool CWalletDBWrapper::Backup(const std::string& strDest)
 {
+    if (logdb) {
+        fs::path pathDest(strDest);
+        if (fs::is_directory(pathDest))
+            pathDest /= strFile;
+
+        try {
+            if (fs::exists(pathDest) && fs::equivalent(GetWalletDir() / strFile, pathDest)) {
+                LogPrintf("cannot backup to wallet source file %s\n", pathDest.string());
+                return false;
+            }
+        } catch (const fs::filesystem_error& e) {
+            LogPrintf("error copying %s to %s - %s\n", strFile, pathDest.string(), e.what());
+            return false;
+        }
+
+        // The records in memory are written out, waiting writes included
+        if (!logdb->Backup(pathDest))
+            return false;
+        LogPrintf("copied %s to %s\n", strFile, pathDest.string());
+        return true;
+    }
     if (IsDummy()) {
         return false;
     }
@@ -729,7 +903,95 @@ bool CWalletDBWrapper::Backup(const std::string& strDest)
 
 void CWalletDBWrapper::Flush(bool shutdown)
 {
+    if (logdb) {
+        logdb->Flush(true);
+        if (shutdown)
+            logdb->MaybeCompact();
+    }
     if (!IsDummy()) {
         env->Flush(shutdown);
     }
 }
+
+void CWalletDBWrapper::Close()
+{
+    if (logdb) {
+        logdb.reset(new CWalletLogDB(GetWalletDir() / strFile));
+    } else if (!IsDummy()) {
+        LOCK(env->cs_db);
+        env->CloseDb(strFile);
+        env->CheckpointLSN(strFile);
+        env->mapFileUseCount.erase(strFile);
+    }
+}
+
+bool CDB::Migrate(const std::string& walletFile, WalletDBFormat format, std::string& errorStr)
+{
+    WalletDBFormat formatFrom = GetWalletDBFormat(walletFile);
+    if (formatFrom == format)
+        return true;
+
+    fs::path path = GetWalletDir() / walletFile;
+    const std::string strFileNew = walletFile + ".migrate";
+    fs::path pathNew = GetWalletDir() / strFileNew;
+    fs::path pathBackup = GetWalletDir() / strprintf("%s.%s.bak", walletFile, FormatWalletDBFormat(formatFrom));
+    if (fs::exists(pathNew) || fs::exists(pathBackup)) {
+        errorStr = strprintf(_("Can't migrate wallet %s, %s or %s already exists"), walletFile, pathNew.string(), pathBackup.string());
+        return false;
+    }
+
+    LogPrintf("Migrating wallet %s from %s to %s\n", walletFile, FormatWalletDBFormat(formatFrom), FormatWalletDBFormat(format));
+    int64_t nStart = GetTimeMillis();
+    bool fSuccess = false;
+    unsigned int nRecords = 0;
+    {
+        CWalletDBWrapper dbwFrom(&bitdb, walletFile, formatFrom);
+        CWalletDBWrapper dbwTo(&bitdb, strFileNew, format);
+        try {
+            CDB dbFrom(dbwFrom, "r", false);
+            CDB dbTo(dbwTo, "cw");
+            // The new file only replaces the wallet once it is complete, a
+            // transaction isn't needed
+            std::unique_ptr<CDBCursor> pcursor = dbFrom.GetCursor();
+            fSuccess = pcursor != nullptr;
+            while (fSuccess) {
+                CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+                CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+                int ret = dbFrom.ReadAtCursor(pcursor.get(), ssKey, ssValue);
+                if (ret == DB_NOTFOUND)
+                    break;
+                fSuccess = ret == 0 && dbTo.Write(ssKey, ssValue);
+                nRecords++;
+            }
+        } catch (const std::exception& e) {
+            LogPrintf("CDB::Migrate: %s\n", e.what());
+            fSuccess = false;
+        }
+        dbwFrom.Close();
+        dbwTo.Close();
+    }
+
+    try {
+        if (fSuccess) {
+            fs::rename(path, pathBackup);
+            try {
+                fs::rename(pathNew, path);
+            } catch (const fs::filesystem_error&) {
+                fs::rename(pathBackup, path);
+                throw;
+            }
+        } else {
+            fs::remove(pathNew);
+        }
+    } catch (const fs::filesystem_error& e) {
+        LogPrintf("CDB::Migrate: %s\n", e.what());
+        fSuccess = false;
+    }
+    if (!fSuccess) {
+        errorStr = strprintf(_("Failed to migrate wallet %s"), walletFile);
+        return false;
+    }
+
+    LogPrintf("Migrated %u records of wallet %s in %dms, the original is kept as %s\n", nRecords, walletFile, GetTimeMillis() - nStart, pathBackup.string());
+    return true;
+}
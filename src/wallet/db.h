@@ -12,9 +12,11 @@
 #include <streams.h>
 #include <sync.h>
 #include <version.h>
+#include <wallet/logdb.h>
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -22,6 +24,19 @@
 
 static const unsigned int DEFAULT_WALLET_DBLOGSIZE = 100;
 static const bool DEFAULT_WALLET_PRIVDB = true;
+static const char* const DEFAULT_WALLET_FORMAT = "bdb";
+
+/** Storage engine of a wallet database */
+enum WalletDBFormat
+{
+    WALLETDB_BDB,
+    WALLETDB_LOG,
+};
+
+bool ParseWalletDBFormat(const std::string& strFormat, WalletDBFormat& format);
+std::string FormatWalletDBFormat(WalletDBFormat format);
+/** Format of a file in the wallet directory, the one of -walletformat if it doesn't exist yet */
+WalletDBFormat GetWalletDBFormat(const std::string& strFile);
 
 class CDBEnv
 {
@@ -88,7 +103,8 @@ public:
 extern CDBEnv bitdb;
 
 /** An instance of this class represents one database.
- * For BerkeleyDB this is just a (env, strFile) tuple.
+ * For BerkeleyDB this is just a (env, strFile) tuple, a wallet log is kept
+ * open in memory by it.
  **/
 class CWalletDBWrapper
 {
@@ -100,10 +116,7 @@ public:
     }
 
     /** Create DB handle to real database */
-    CWalletDBWrapper(CDBEnv *env_in, const std::string &strFile_in) :
-        nUpdateCounter(0), nLastSeen(0), nLastFlushed(0), nLastWalletUpdate(0), env(env_in), strFile(strFile_in)
-    {
-    }
+    CWalletDBWrapper(CDBEnv *env_in, const std::string &strFile_in, WalletDBFormat format = WALLETDB_BDB);
 
     /** Rewrite the entire database on disk, with the exception of key pszSkip if non-zero
      */
@@ -121,6 +134,12 @@ public:
      */
     void Flush(bool shutdown);
 
+    /** Close the database file so that it can be moved, it must not be in use
+     */
+    void Close();
+
+    WalletDBFormat GetFormat() const { return logdb ? WALLETDB_LOG : WALLETDB_BDB; }
+
     void IncrementUpdateCounter();
 
     std::atomic<unsigned int> nUpdateCounter;
@@ -133,19 +152,50 @@ private:
     CDBEnv *env;
     std::string strFile;
 
+    /** Wallet log specific */
+    std::unique_ptr<CWalletLogDB> logdb;
+
     /** Return whether this database handle is a dummy for testing.
      * Only to be used at a low level, application should ideally not care
      * about this.
      */
-    bool IsDummy() { return env == nullptr; }
+    bool IsDummy() { return env == nullptr && !logdb; }
 };
 
+/** Cursor over the records of a database, closed when it goes out of scope */
+class CDBCursor
+{
+    friend class CDB;
+public:
+    explicit CDBCursor(Dbc* pcursorIn) : pcursor(pcursorIn), plog(nullptr), fStarted(false) {}
+    explicit CDBCursor(CWalletLogDB* plogIn) : pcursor(nullptr), plog(plogIn), fStarted(false) {}
+    ~CDBCursor()
+    {
+        if (pcursor)
+            pcursor->close();
+    }
+
+    CDBCursor(const CDBCursor&) = delete;
+    CDBCursor& operator=(const CDBCursor&) = delete;
 
-/** RAII class that provides access to a Berkeley database */
+private:
+    Dbc* pcursor;
+    CWalletLogDB* plog;
+    //! Key of the last record read from a wallet log
+    CWalletLogDB::Data keyLast;
+    bool fStarted;
+};
+
+
+/** RAII class that provides access to a Berkeley database or a wallet log */
 class CDB
 {
 protected:
     Db* pdb;
+    CWalletLogDB* plog;
+    //! Changes made in the open transaction of a wallet log
+    std::vector<CWalletLogDB::Op> vLogTxn;
+    bool fLogTxn;
     std::string strFile;
     DbTxn* activeTxn;
     bool fReadOnly;
@@ -170,18 +220,38 @@ public:
     static bool VerifyEnvironment(const std::string& walletFile, const fs::path& walletDir, std::string& errorStr);
     /* verifies the database file */
     static bool VerifyDatabaseFile(const std::string& walletFile, const fs::path& walletDir, std::string& warningStr, std::string& errorStr, CDBEnv::recoverFunc_type recoverFunc);
+    /* copies the records of the database file to a new file of the given format, which replaces it */
+    static bool Migrate(const std::string& walletFile, WalletDBFormat format, std::string& errorStr);
+
+private:
+    bool ReadLog(const CWalletLogDB::Data& key, CWalletLogDB::Data& value);
+    bool ReadLog(const CDataStream& ssKey, CDataStream& ssValue);
+    bool WriteLog(const CDataStream& ssKey, const CDataStream* pssValue, bool fOverwrite);
+    int ReadAtLogCursor(CDBCursor* pcursor, CDataStream& ssKey, CDataStream& ssValue, bool setRange);
 
 public:
     template <typename K, typename T>
     bool Read(const K& key, T& value)
     {
-        if (!pdb)
+        if (!pdb && !plog)
             return false;
 
         // Key
         CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         ssKey.reserve(1000);
         ssKey << key;
+
+        if (plog) {
+            CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+            if (!ReadLog(ssKey, ssValue))
+                return false;
+            try {
+                ssValue >> value;
+            } catch (const std::exception&) {
+                return false;
+            }
+            return true;
+        }
         Dbt datKey(ssKey.data(), ssKey.size());
 
         // Read
@@ -210,7 +280,7 @@ public:
     template <typename K, typename T>
     bool Write(const K& key, const T& value, bool fOverwrite = true)
     {
-        if (!pdb)
+        if (!pdb && !plog)
             return true;
         if (fReadOnly)
             assert(!"Write called on database in read-only mode");
@@ -225,6 +295,9 @@ public:
         CDataStream ssValue(SER_DISK, CLIENT_VERSION);
         ssValue.reserve(10000);
         ssValue << value;
+
+        if (plog)
+            return WriteLog(ssKey, &ssValue, fOverwrite);
         Dbt datValue(ssValue.data(), ssValue.size());
 
         // Write
@@ -239,7 +312,7 @@ public:
     template <typename K>
     bool Erase(const K& key)
     {
-        if (!pdb)
+        if (!pdb && !plog)
             return false;
         if (fReadOnly)
             assert(!"Erase called on database in read-only mode");
@@ -248,6 +321,9 @@ public:
         CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         ssKey.reserve(1000);
         ssKey << key;
+
+        if (plog)
+            return WriteLog(ssKey, nullptr, true);
         Dbt datKey(ssKey.data(), ssKey.size());
 
         // Erase
@@ -261,13 +337,18 @@ public:
     template <typename K>
     bool Exists(const K& key)
     {
-        if (!pdb)
+        if (!pdb && !plog)
             return false;
 
         // Key
         CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         ssKey.reserve(1000);
         ssKey << key;
+
+        if (plog) {
+            CWalletLogDB::Data value;
+            return ReadLog(CWalletLogDB::Data(ssKey.begin(), ssKey.end()), value);
+        }
         Dbt datKey(ssKey.data(), ssKey.size());
 
         // Exists
@@ -278,19 +359,24 @@ public:
         return (ret == 0);
     }
 
-    Dbc* GetCursor()
+    std::unique_ptr<CDBCursor> GetCursor()
     {
+        if (plog)
+            return std::unique_ptr<CDBCursor>(new CDBCursor(plog));
         if (!pdb)
             return nullptr;
         Dbc* pcursor = nullptr;
         int ret = pdb->cursor(nullptr, &pcursor, 0);
         if (ret != 0)
             return nullptr;
-        return pcursor;
+        return std::unique_ptr<CDBCursor>(new CDBCursor(pcursor));
     }
 
-    int ReadAtCursor(Dbc* pcursor, CDataStream& ssKey, CDataStream& ssValue, bool setRange = false)
+    int ReadAtCursor(CDBCursor* pcursor, CDataStream& ssKey, CDataStream& ssValue, bool setRange = false)
     {
+        if (pcursor->plog)
+            return ReadAtLogCursor(pcursor, ssKey, ssValue, setRange);
+
         // Read at cursor
         Dbt datKey;
         unsigned int fFlags = DB_NEXT;
@@ -302,7 +388,7 @@ public:
         Dbt datValue;
         datKey.set_flags(DB_DBT_MALLOC);
         datValue.set_flags(DB_DBT_MALLOC);
-        int ret = pcursor->get(&datKey, &datValue, fFlags);
+        int ret = pcursor->pcursor->get(&datKey, &datValue, fFlags);
         if (ret != 0)
             return ret;
         else if (datKey.get_data() == nullptr || datValue.get_data() == nullptr)
@@ -327,6 +413,12 @@ public:
 public:
     bool TxnBegin()
     {
+        if (plog) {
+            if (fLogTxn)
+                return false;
+            fLogTxn = true;
+            return true;
+        }
         if (!pdb || activeTxn)
             return false;
         DbTxn* ptxn = bitdb.TxnBegin();
@@ -338,6 +430,15 @@ public:
 
     bool TxnCommit()
     {
+        if (plog) {
+            if (!fLogTxn)
+                return false;
+            // The changes are appended to the log as one batch
+            std::vector<CWalletLogDB::Op> vOps;
+            vOps.swap(vLogTxn);
+            fLogTxn = false;
+            return plog->Apply(vOps, true);
+        }
         if (!pdb || !activeTxn)
             return false;
         int ret = activeTxn->commit(0);
@@ -347,6 +448,13 @@ public:
 
     bool TxnAbort()
     {
+        if (plog) {
+            if (!fLogTxn)
+                return false;
+            vLogTxn.clear();
+            fLogTxn = false;
+            return true;
+        }
         if (!pdb || !activeTxn)
             return false;
         int ret = activeTxn->abort();
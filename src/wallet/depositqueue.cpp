@@ -0,0 +1,112 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/depositqueue.h>
+
+#include <consensus/validation.h>
+#include <sidechain.h>
+#include <util.h>
+#include <validation.h>
+
+#include <algorithm>
+
+void InsertQueuedDeposit(std::vector<QueuedDeposit>& vQueue, const QueuedDeposit& deposit)
+{
+    vQueue.insert(std::upper_bound(vQueue.begin(), vQueue.end(), deposit, [](const QueuedDeposit& a, const QueuedDeposit& b) {
+        return a.nOrderPos < b.nOrderPos;
+    }), deposit);
+}
+
+void ProcessDepositQueue(std::vector<QueuedDeposit>& vQueue, const SidechainCTIP* pctip, bool fSubmit, DepositQueueHandler& handler)
+{
+    // Drop the deposits that were confirmed
+    for (std::vector<QueuedDeposit>::iterator it = vQueue.begin(); it != vQueue.end(); ) {
+        if (!it->txid.IsNull() && handler.IsConfirmed(*it)) {
+            handler.Erase(*it);
+            it = vQueue.erase(it);
+            continue;
+        }
+        ++it;
+    }
+
+    size_t nStart = 0;
+    while (nStart < vQueue.size() && !vQueue[nStart].txid.IsNull() && handler.InMempool(vQueue[nStart]))
+        nStart++;
+
+    SidechainCTIP ctip;
+    bool fCTIP = pctip != nullptr;
+    if (fCTIP)
+        ctip = *pctip;
+    bool fRebuild = false;
+    for (size_t i = nStart; i < vQueue.size(); i++) {
+        QueuedDeposit& deposit = vQueue[i];
+
+        if (deposit.tx && (fCTIP ? deposit.outCTIP != ctip.out : !deposit.outCTIP.IsNull()))
+            fRebuild = true;
+
+        if (!deposit.tx || fRebuild) {
+            std::vector<COutPoint> vReuse;
+            handler.Discard(deposit, vReuse);
+            if (!handler.Build(deposit, fCTIP ? &ctip : nullptr, i > 0 ? &vQueue[i - 1] : nullptr, vReuse)) {
+                LogPrintf("%s: Failed to build queued deposit %s: %s\n", __func__, deposit.id.ToString(), deposit.strError);
+                break;
+            }
+        }
+
+        // The deposit after this one spends its deposit output
+        ctip.out = COutPoint(deposit.tx->GetHash(), deposit.tx->vout.size() - 1);
+        ctip.amount = deposit.tx->vout.back().nValue;
+        fCTIP = true;
+
+        // Deposits after one that wasn't accepted stay built, so that they
+        // can be submitted right away when there is room in the mempool
+        if (!fSubmit)
+            continue;
+
+        CValidationState state;
+        if (!handler.Submit(deposit, state)) {
+            deposit.strError = FormatStateMessage(state);
+            LogPrintf("%s: Queued deposit %s not accepted: %s\n", __func__, deposit.id.ToString(), deposit.strError);
+            fSubmit = false;
+
+            // Only the ancestor limits are lifted by waiting, otherwise the
+            // deposit has to be built again
+            if (state.GetRejectReason() != "too-long-mempool-chain") {
+                std::vector<COutPoint> vReuse;
+                handler.Discard(deposit, vReuse);
+                break;
+            }
+        }
+    }
+}
+
+bool ChooseQueuedDepositCoins(const std::vector<CInputCoin>& vReuse, const CInputCoin* pchange, const CAmount& nTarget,
+        const std::function<bool(const CAmount&, const std::set<CInputCoin>&, std::set<CInputCoin>&, CAmount&)>& selectConfirmed,
+        std::set<CInputCoin>& setCoins, CAmount& nValueIn)
+{
+    setCoins.clear();
+    nValueIn = 0;
+
+    for (const CInputCoin& coin : vReuse) {
+        if (setCoins.insert(coin).second)
+            nValueIn += coin.txout.nValue;
+    }
+
+    // The change of the deposit before this one doesn't add an ancestor to
+    // the chain of deposits, it is spent first
+    if (pchange && setCoins.insert(*pchange).second)
+        nValueIn += pchange->txout.nValue;
+
+    // Confirmed coins cover the rest, unconfirmed ones would add ancestors
+    if (nValueIn < nTarget) {
+        std::set<CInputCoin> setSelected;
+        CAmount nSelected = 0;
+        if (!selectConfirmed(nTarget - nValueIn, setCoins, setSelected, nSelected))
+            return false;
+        setCoins.insert(setSelected.begin(), setSelected.end());
+        nValueIn += nSelected;
+    }
+
+    return true;
+}
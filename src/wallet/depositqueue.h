@@ -0,0 +1,73 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_WALLET_DEPOSITQUEUE_H
+#define BITCOIN_WALLET_DEPOSITQUEUE_H
+
+#include <amount.h>
+#include <wallet/wallet.h>
+
+#include <functional>
+#include <set>
+#include <vector>
+
+class CValidationState;
+struct SidechainCTIP;
+
+/**
+ * What processing a deposit queue needs from the wallet and the mempool.
+ * Every call is made with the locks of the wallet held.
+ */
+class DepositQueueHandler
+{
+public:
+    virtual ~DepositQueueHandler() {}
+
+    /** Whether the submitted transaction of a deposit was confirmed */
+    virtual bool IsConfirmed(const QueuedDeposit& deposit) = 0;
+
+    /** Whether the submitted transaction of a deposit is in the mempool */
+    virtual bool InMempool(const QueuedDeposit& deposit) = 0;
+
+    /** Build the transaction of a deposit on pctip, see CWallet::BuildQueuedDeposit */
+    virtual bool Build(QueuedDeposit& deposit, const SidechainCTIP* pctip, const QueuedDeposit* pprev, const std::vector<COutPoint>& vReuse) = 0;
+
+    /** Submit the transaction of a deposit to the mempool */
+    virtual bool Submit(QueuedDeposit& deposit, CValidationState& state) = 0;
+
+    /** Drop the transaction of a deposit, adding the inputs of a submitted one to vReuse */
+    virtual void Discard(QueuedDeposit& deposit, std::vector<COutPoint>& vReuse) = 0;
+
+    /** Remove a confirmed deposit from the wallet */
+    virtual void Erase(const QueuedDeposit& deposit) = 0;
+};
+
+/** Insert a deposit loaded from the wallet after the deposits queued before it */
+void InsertQueuedDeposit(std::vector<QueuedDeposit>& vQueue, const QueuedDeposit& deposit);
+
+/**
+ * Drop the confirmed deposits of a queue, rebuild the deposits that no
+ * longer chain onto the mempool CTIP pctip and, if fSubmit, submit the
+ * deposits that aren't in the mempool, in queue order, until one of them is
+ * rejected.
+ *
+ * The deposits at the front of the queue that are in the mempool stay. The
+ * rest are chained onto the mempool CTIP, which is the deposit output of the
+ * deposit before them unless another deposit to the sidechain came in
+ * between. Deposits already built on the CTIP they spend now are kept, from
+ * the first one that isn't on they are rebuilt.
+ */
+void ProcessDepositQueue(std::vector<QueuedDeposit>& vQueue, const SidechainCTIP* pctip, bool fSubmit, DepositQueueHandler& handler);
+
+/**
+ * Choose the coins of a queued deposit of nTarget including the fee. It
+ * spends the coins in vReuse, the inputs of its transaction that was
+ * discarded, then pchange, the change of the deposit queued before it, and
+ * selectConfirmed covers the rest with confirmed coins not in setCoins.
+ */
+bool ChooseQueuedDepositCoins(const std::vector<CInputCoin>& vReuse, const CInputCoin* pchange, const CAmount& nTarget,
+        const std::function<bool(const CAmount&, const std::set<CInputCoin>&, std::set<CInputCoin>&, CAmount&)>& selectConfirmed,
+        std::set<CInputCoin>& setCoins, CAmount& nValueIn);
+
+#endif // BITCOIN_WALLET_DEPOSITQUEUE_H
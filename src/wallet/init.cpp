@@ -27,6 +27,7 @@ std::string GetWalletHelpString(bool showDebug)
     strUsage += HelpMessageOpt("-fallbackfee=<amt>", strprintf(_("A fee rate (in %s/kB) that will be used when fee estimation has insufficient data (default: %s)"),
                                                                CURRENCY_UNIT, FormatMoney(DEFAULT_FALLBACK_FEE)));
     strUsage += HelpMessageOpt("-keypool=<n>", strprintf(_("Set key pool size to <n> (default: %u)"), DEFAULT_KEYPOOL_SIZE));
+    strUsage += HelpMessageOpt("-migratewallet", _("Convert the wallet files to the format of -walletformat on startup, keeping the originals as backups"));
     strUsage += HelpMessageOpt("-mintxfee=<amt>", strprintf(_("Fees (in %s/kB) smaller than this are considered zero fee for transaction creation (default: %s)"),
                                                             CURRENCY_UNIT, FormatMoney(DEFAULT_TRANSACTION_MINFEE)));
     strUsage += HelpMessageOpt("-paytxfee=<amt>", strprintf(_("Fee (in %s/kB) to add to transactions you send (default: %s)"),
@@ -39,6 +40,7 @@ std::string GetWalletHelpString(bool showDebug)
     strUsage += HelpMessageOpt("-wallet=<file>", _("Specify wallet file (within data directory)") + " " + strprintf(_("(default: %s)"), DEFAULT_WALLET_DAT));
     strUsage += HelpMessageOpt("-walletbroadcast", _("Make the wallet broadcast transactions") + " " + strprintf(_("(default: %u)"), DEFAULT_WALLETBROADCAST));
     strUsage += HelpMessageOpt("-walletdir=<dir>", _("Specify directory to hold wallets (default: <datadir>/wallets if it exists, otherwise <datadir>)"));
+    strUsage += HelpMessageOpt("-walletformat=<format>", strprintf(_("Storage format of new wallet files, \"bdb\" or \"log\" for an append-only log (default: %s)"), DEFAULT_WALLET_FORMAT));
     strUsage += HelpMessageOpt("-walletnotify=<cmd>", _("Execute command when a wallet transaction changes (%s in cmd is replaced by TxID)"));
     strUsage += HelpMessageOpt("-walletrbf", strprintf(_("Send transactions with full-RBF opt-in enabled (RPC only, default: %u)"), DEFAULT_WALLET_RBF));
     strUsage += HelpMessageOpt("-zapwallettxes=<mode>", _("Delete all wallet transactions and only recover those parts of the blockchain through -rescan on startup") +
@@ -106,6 +108,10 @@ bool WalletParameterInteraction()
         }
     }
 
+    WalletDBFormat format;
+    if (!ParseWalletDBFormat(gArgs.GetArg("-walletformat", DEFAULT_WALLET_FORMAT), format))
+        return InitError(strprintf(_("Unknown wallet format: '%s'"), gArgs.GetArg("-walletformat", "")));
+
     if (gArgs.GetBoolArg("-sysperms", false))
         return InitError("-sysperms is not allowed in combination with enabled wallet functionality");
     if (gArgs.GetArg("-prune", 0) && gArgs.GetBoolArg("-rescan", false))
@@ -224,6 +230,9 @@ bool VerifyWallets()
 
     uiInterface.InitMessage(_("Verifying wallet(s)..."));
 
+    WalletDBFormat format = WALLETDB_BDB;
+    ParseWalletDBFormat(gArgs.GetArg("-walletformat", DEFAULT_WALLET_FORMAT), format);
+
     // Keep track of each wallet absolute path to detect duplicates.
     std::set<fs::path> wallet_paths;
 
@@ -252,6 +261,9 @@ bool VerifyWallets()
         }
 
         if (gArgs.GetBoolArg("-salvagewallet", false)) {
+            if (CWalletLogDB::IsLogFile(wallet_path)) {
+                return InitError(strprintf(_("Error loading wallet %s. A wallet log can't be salvaged."), walletFile));
+            }
             // Recover readable keypairs:
             CWallet dummyWallet;
             std::string backup_filename;
@@ -269,6 +281,13 @@ bool VerifyWallets()
             InitError(strError);
             return false;
         }
+
+        if (gArgs.GetBoolArg("-migratewallet", false) && fs::exists(wallet_path) && GetWalletDBFormat(walletFile) != format) {
+            uiInterface.InitMessage(_("Migrating wallet..."));
+            if (!CWalletDB::MigrateDatabaseFile(walletFile, format, strError)) {
+                return InitError(strError);
+            }
+        }
     }
 
     return true;
@@ -0,0 +1,348 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/logdb.h>
+
+#include <clientversion.h>
+#include <hash.h>
+#include <streams.h>
+#include <util.h>
+
+#include <string.h>
+
+/** Start of every wallet log file, followed by the version */
+static const char WALLET_LOG_MAGIC[8] = {'w', 'a', 'l', 'l', 'e', 't', 'l', 'g'};
+static const uint64_t WALLET_LOG_HEADER_SIZE = sizeof(WALLET_LOG_MAGIC) + sizeof(uint32_t);
+//! Size of the framing of a batch: its size and checksum
+static const uint64_t WALLET_LOG_BATCH_OVERHEAD = sizeof(uint32_t) + 32;
+
+static bool WriteHeader(FILE* fileOut)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << FLATDATA(WALLET_LOG_MAGIC);
+    ss << WALLET_LOG_VERSION;
+    return fwrite(ss.data(), 1, ss.size(), fileOut) == ss.size();
+}
+
+CWalletLogDB::CWalletLogDB(const fs::path& pathIn) : path(pathIn), file(nullptr), nFileSize(0), nRecordsSize(0)
+{
+}
+
+CWalletLogDB::~CWalletLogDB()
+{
+    if (file) {
+        Flush(true);
+        fclose(file);
+    }
+}
+
+bool CWalletLogDB::IsLogFile(const fs::path& pathIn)
+{
+    FILE* fileIn = fsbridge::fopen(pathIn, "rb");
+    if (!fileIn)
+        return false;
+    char magic[sizeof(WALLET_LOG_MAGIC)];
+    bool fLog = fread(magic, 1, sizeof(magic), fileIn) == sizeof(magic) && memcmp(magic, WALLET_LOG_MAGIC, sizeof(magic)) == 0;
+    fclose(fileIn);
+    return fLog;
+}
+
+bool CWalletLogDB::Open(bool fCreate, std::string& strError)
+{
+    LOCK(cs);
+    if (file)
+        return true;
+
+    if (!fs::exists(path)) {
+        if (!fCreate) {
+            strError = strprintf("Wallet log %s does not exist", path.string());
+            return false;
+        }
+        FILE* fileNew = fsbridge::fopen(path, "wb+");
+        if (!fileNew || !WriteHeader(fileNew)) {
+            if (fileNew)
+                fclose(fileNew);
+            strError = strprintf("Can't create wallet log %s", path.string());
+            return false;
+        }
+        FileCommit(fileNew);
+        file = fileNew;
+        nFileSize = WALLET_LOG_HEADER_SIZE;
+        return true;
+    }
+
+    uint64_t nSize = fs::file_size(path);
+    CAutoFile filein(fsbridge::fopen(path, "rb+"), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        strError = strprintf("Can't open wallet log %s", path.string());
+        return false;
+    }
+
+    mapRecords.clear();
+    nRecordsSize = 0;
+    uint64_t nPos = 0;
+    try {
+        char magic[sizeof(WALLET_LOG_MAGIC)];
+        uint32_t nVersion;
+        filein >> FLATDATA(magic);
+        filein >> nVersion;
+        if (memcmp(magic, WALLET_LOG_MAGIC, sizeof(magic)) != 0) {
+            strError = strprintf("%s is not a wallet log", path.string());
+            return false;
+        }
+        if (nVersion > WALLET_LOG_VERSION) {
+            strError = strprintf("Wallet log %s requires a newer version", path.string());
+            return false;
+        }
+        nPos = WALLET_LOG_HEADER_SIZE;
+
+        while (nPos < nSize) {
+            // A batch that doesn't fit in the file was cut short
+            if (nSize - nPos < WALLET_LOG_BATCH_OVERHEAD)
+                break;
+            uint32_t nBatchSize;
+            filein >> nBatchSize;
+            if (nSize - nPos < WALLET_LOG_BATCH_OVERHEAD + nBatchSize)
+                break;
+
+            CDataStream ssBatch(SER_DISK, CLIENT_VERSION);
+            ssBatch.resize(nBatchSize);
+            filein.read(ssBatch.data(), nBatchSize);
+            uint256 hash;
+            filein >> hash;
+            if (hash != Hash(ssBatch.begin(), ssBatch.end())) {
+                // Only the last batch can have been left half written
+                if (nPos + WALLET_LOG_BATCH_OVERHEAD + nBatchSize == nSize)
+                    break;
+                strError = strprintf("Wallet log %s is corrupt at position %u", path.string(), nPos);
+                return false;
+            }
+
+            std::vector<Op> vOps;
+            ssBatch >> vOps;
+            for (const Op& op : vOps)
+                ApplyToMemory(op);
+            nPos += WALLET_LOG_BATCH_OVERHEAD + nBatchSize;
+        }
+    } catch (const std::exception& e) {
+        strError = strprintf("Wallet log %s is corrupt at position %u: %s", path.string(), nPos, e.what());
+        return false;
+    }
+
+    if (nPos < nSize) {
+        LogPrintf("%s: Dropping an incomplete batch of %u bytes at the end of %s\n", __func__, nSize - nPos, path.string());
+        if (!TruncateFile(filein.Get(), nPos)) {
+            strError = strprintf("Can't truncate wallet log %s", path.string());
+            return false;
+        }
+    }
+    if (fseek(filein.Get(), nPos, SEEK_SET)) {
+        strError = strprintf("Can't seek in wallet log %s", path.string());
+        return false;
+    }
+
+    file = filein.release();
+    nFileSize = nPos;
+    LogPrint(BCLog::DB, "%s: Read %u records from %s\n", __func__, mapRecords.size(), path.string());
+    return true;
+}
+
+bool CWalletLogDB::IsOpen() const
+{
+    LOCK(cs);
+    return file != nullptr;
+}
+
+bool CWalletLogDB::Read(const Data& key, Data& value) const
+{
+    LOCK(cs);
+    std::map<Data, Data>::const_iterator it = mapRecords.find(key);
+    if (it == mapRecords.end())
+        return false;
+    value = it->second;
+    return true;
+}
+
+bool CWalletLogDB::Exists(const Data& key) const
+{
+    LOCK(cs);
+    return mapRecords.count(key);
+}
+
+void CWalletLogDB::ApplyToMemory(const Op& op)
+{
+    std::map<Data, Data>::iterator it = mapRecords.find(op.key);
+    if (it != mapRecords.end()) {
+        nRecordsSize -= it->first.size() + it->second.size();
+        if (op.fErase) {
+            mapRecords.erase(it);
+            return;
+        }
+        it->second = op.value;
+        nRecordsSize += it->first.size() + it->second.size();
+    } else if (!op.fErase) {
+        mapRecords.emplace(op.key, op.value);
+        nRecordsSize += op.key.size() + op.value.size();
+    }
+}
+
+bool CWalletLogDB::Apply(const std::vector<Op>& vOps, bool fBatch)
+{
+    LOCK(cs);
+    if (!file)
+        return false;
+
+    for (const Op& op : vOps)
+        ApplyToMemory(op);
+
+    // Waiting writes go first to keep the order of the log, and become part
+    // of the same batch
+    vPending.insert(vPending.end(), vOps.begin(), vOps.end());
+    if (fBatch || vPending.size() >= WALLET_LOG_MAX_PENDING)
+        return WritePending();
+    return true;
+}
+
+bool CWalletLogDB::Seek(const Data& key, bool fInclusive, Data& keyOut, Data& valueOut) const
+{
+    LOCK(cs);
+    std::map<Data, Data>::const_iterator it = fInclusive ? mapRecords.lower_bound(key) : mapRecords.upper_bound(key);
+    if (it == mapRecords.end())
+        return false;
+    keyOut = it->first;
+    valueOut = it->second;
+    return true;
+}
+
+bool CWalletLogDB::WriteBatch(FILE* fileOut, const std::vector<Op>& vOps) const
+{
+    CDataStream ssBatch(SER_DISK, CLIENT_VERSION);
+    ssBatch << vOps;
+
+    CDataStream ssRecord(SER_DISK, CLIENT_VERSION);
+    ssRecord.reserve(WALLET_LOG_BATCH_OVERHEAD + ssBatch.size());
+    ssRecord << (uint32_t)ssBatch.size();
+    ssRecord << ssBatch;
+    ssRecord << Hash(ssBatch.begin(), ssBatch.end());
+
+    if (fwrite(ssRecord.data(), 1, ssRecord.size(), fileOut) != ssRecord.size() || fflush(fileOut) != 0)
+        return error("%s: Failed to write to %s", __func__, path.string());
+    return true;
+}
+
+bool CWalletLogDB::WritePending()
+{
+    AssertLockHeld(cs);
+    if (vPending.empty())
+        return true;
+
+    long nPos = ftell(file);
+    if (!WriteBatch(file, vPending)) {
+        // Don't leave part of the batch in front of the next one
+        TruncateFile(file, nFileSize);
+        fseek(file, nFileSize, SEEK_SET);
+        return false;
+    }
+    nFileSize = ftell(file);
+    LogPrint(BCLog::DB, "%s: Wrote %u changes to %s in %u bytes\n", __func__, vPending.size(), path.string(), nFileSize - nPos);
+    vPending.clear();
+    return true;
+}
+
+bool CWalletLogDB::Flush(bool fSync)
+{
+    LOCK(cs);
+    if (!file)
+        return true;
+    if (!WritePending())
+        return false;
+    if (fSync)
+        FileCommit(file);
+    return true;
+}
+
+bool CWalletLogDB::WriteSnapshot(const fs::path& pathOut) const
+{
+    AssertLockHeld(cs);
+
+    FILE* fileOut = fsbridge::fopen(pathOut, "wb");
+    if (!fileOut)
+        return error("%s: Can't create %s", __func__, pathOut.string());
+
+    std::vector<Op> vOps;
+    vOps.reserve(mapRecords.size());
+    for (const std::pair<const Data, Data>& record : mapRecords)
+        vOps.emplace_back(false, record.first, record.second);
+
+    bool fSuccess = WriteHeader(fileOut) && WriteBatch(fileOut, vOps);
+    if (fSuccess)
+        FileCommit(fileOut);
+    fclose(fileOut);
+    return fSuccess;
+}
+
+bool CWalletLogDB::Compact(const char* pszSkip)
+{
+    LOCK(cs);
+    if (!file)
+        return false;
+
+    if (pszSkip) {
+        size_t nSkip = strlen(pszSkip);
+        std::vector<Op> vErase;
+        for (const std::pair<const Data, Data>& record : mapRecords) {
+            if (record.first.size() >= nSkip && memcmp(record.first.data(), pszSkip, nSkip) == 0)
+                vErase.emplace_back(true, record.first, Data());
+        }
+        for (const Op& op : vErase)
+            ApplyToMemory(op);
+        vPending.insert(vPending.end(), vErase.begin(), vErase.end());
+    }
+
+    int64_t nStart = GetTimeMillis();
+    uint64_t nSizeBefore = nFileSize;
+    fs::path pathNew = path.string() + ".compact";
+    if (!WriteSnapshot(pathNew)) {
+        fs::remove(pathNew);
+        return false;
+    }
+
+    fclose(file);
+    file = nullptr;
+    bool fRenamed = RenameOver(pathNew, path);
+    if (!fRenamed)
+        LogPrintf("%s: Failed to replace %s\n", __func__, path.string());
+    file = fsbridge::fopen(path, "rb+");
+    if (!file || fseek(file, 0, SEEK_END))
+        return error("%s: Can't reopen %s", __func__, path.string());
+    if (!fRenamed)
+        return false;
+
+    vPending.clear();
+    nFileSize = ftell(file);
+    LogPrint(BCLog::DB, "%s: Compacted %s from %u to %u bytes in %dms\n", __func__, path.string(), nSizeBefore, nFileSize, GetTimeMillis() - nStart);
+    return true;
+}
+
+bool CWalletLogDB::MaybeCompact()
+{
+    LOCK(cs);
+    if (!file || nFileSize < WALLET_LOG_MIN_COMPACT_SIZE || nFileSize < WALLET_LOG_COMPACT_RATIO * nRecordsSize)
+        return true;
+    return Compact();
+}
+
+bool CWalletLogDB::Backup(const fs::path& pathDest) const
+{
+    LOCK(cs);
+    if (!file)
+        return false;
+    return WriteSnapshot(pathDest);
+}
+
+uint64_t CWalletLogDB::GetFileSize() const
+{
+    LOCK(cs);
+    return nFileSize;
+}
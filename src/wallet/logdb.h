@@ -0,0 +1,124 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_WALLET_LOGDB_H
+#define BITCOIN_WALLET_LOGDB_H
+
+#include <fs.h>
+#include <serialize.h>
+#include <support/allocators/zeroafterfree.h>
+#include <sync.h>
+
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+//! Version of the wallet log file format
+static const uint32_t WALLET_LOG_VERSION = 1;
+//! Non-transactional writes are appended to the log once this many are waiting
+static const size_t WALLET_LOG_MAX_PENDING = 1000;
+//! The log is compacted when it is this many times the size of the records in it
+static const uint64_t WALLET_LOG_COMPACT_RATIO = 4;
+//! Logs smaller than this are never compacted
+static const uint64_t WALLET_LOG_MIN_COMPACT_SIZE = 1 << 20;
+
+/**
+ * A key/value database stored as an append-only log, the alternative to
+ * BerkeleyDB for wallets that write a lot. Every record is kept in memory.
+ * Changes are appended to the file as batches with a checksum, a batch is
+ * either read back completely or not at all. The batch at the end of the
+ * file that was being written when the process died is dropped when the
+ * file is opened.
+ *
+ * Writes that aren't part of a transaction are applied in memory right away
+ * and appended to the log as one batch by Flush(), or once
+ * WALLET_LOG_MAX_PENDING of them are waiting. The file is only synced by
+ * Flush(true) and compaction, which rewrites the log with just the current
+ * records.
+ */
+class CWalletLogDB
+{
+public:
+    typedef std::vector<unsigned char, zero_after_free_allocator<unsigned char>> Data;
+
+    /** A write or erase of a record */
+    struct Op
+    {
+        bool fErase;
+        Data key;
+        Data value;
+
+        Op() : fErase(false) {}
+        Op(bool fEraseIn, const Data& keyIn, const Data& valueIn) : fErase(fEraseIn), key(keyIn), value(valueIn) {}
+
+        ADD_SERIALIZE_METHODS;
+
+        template <typename Stream, typename Operation>
+        inline void SerializationOp(Stream& s, Operation ser_action) {
+            READWRITE(fErase);
+            READWRITE(key);
+            if (!fErase)
+                READWRITE(value);
+        }
+    };
+
+    explicit CWalletLogDB(const fs::path& path);
+    ~CWalletLogDB();
+
+    CWalletLogDB(const CWalletLogDB&) = delete;
+    CWalletLogDB& operator=(const CWalletLogDB&) = delete;
+
+    /** Whether the file at path is a wallet log */
+    static bool IsLogFile(const fs::path& path);
+
+    /** Read the log into memory, creating it first if it doesn't exist and fCreate is set */
+    bool Open(bool fCreate, std::string& strError);
+    bool IsOpen() const;
+
+    bool Read(const Data& key, Data& value) const;
+    bool Exists(const Data& key) const;
+
+    /** Apply the changes, appending them to the log right away as one batch if fBatch is set */
+    bool Apply(const std::vector<Op>& vOps, bool fBatch);
+
+    /**
+     * Get the first record with a key not before key, or after it if
+     * fInclusive is false. Records written while iterating are seen by the
+     * following calls.
+     */
+    bool Seek(const Data& key, bool fInclusive, Data& keyOut, Data& valueOut) const;
+
+    /** Append the waiting writes to the log, and sync it to disk if fSync is set */
+    bool Flush(bool fSync);
+
+    /** Rewrite the log with the current records, erasing the ones with a key starting with pszSkip */
+    bool Compact(const char* pszSkip = nullptr);
+    /** Compact the log if it has grown to WALLET_LOG_COMPACT_RATIO times the size of the records */
+    bool MaybeCompact();
+
+    /** Write the current records to a new log at pathDest */
+    bool Backup(const fs::path& pathDest) const;
+
+    uint64_t GetFileSize() const;
+
+private:
+    bool WriteBatch(FILE* fileOut, const std::vector<Op>& vOps) const;
+    bool WritePending();
+    bool WriteSnapshot(const fs::path& pathOut) const;
+    void ApplyToMemory(const Op& op);
+
+    const fs::path path;
+
+    mutable CCriticalSection cs;
+    FILE* file;
+    std::map<Data, Data> mapRecords;
+    std::vector<Op> vPending;
+    //! Size of the log file
+    uint64_t nFileSize;
+    //! Size of the keys and values in mapRecords
+    uint64_t nRecordsSize;
+};
+
+#endif // BITCOIN_WALLET_LOGDB_H
@@ -16,6 +16,7 @@
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <policy/rbf.h>
+#include <replaycheck.h>
 #include <rpc/mining.h>
 #include <rpc/safemode.h>
 #include <rpc/server.h>
@@ -26,6 +27,7 @@
 #include <util.h>
 #include <utilmoneystr.h>
 #include <wallet/coincontrol.h>
+#include <wallet/coinsplit.h>
 #include <wallet/feebumper.h>
 #include <wallet/wallet.h>
 #include <wallet/walletdb.h>
@@ -3609,46 +3611,17 @@ UniValue generate(const JSONRPCRequest& request)
     return blocks;
 }
 
-UniValue createsidechaindeposit(const JSONRPCRequest& request)
+/** Parse the sidechain number, deposit address, amount and fee parameters of a sidechain deposit */
+static void ParseSidechainDeposit(const JSONRPCRequest& request, unsigned int& nSidechain, std::string& strDest, CAmount& nAmount, CAmount& nFee, CScript& sidechainScriptPubKey)
 {
-    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
-    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
-        return NullUniValue;
-    }
-
-    if (request.fHelp || request.params.size() != 4)
-        throw std::runtime_error(
-            "createsidechaindeposit \"nsidechain\" \"depositaddress\" \"amount\"\n"
-            "\nCreate a sidechain deposit of an amount to a given address.\n"
-            + HelpRequiringPassphrase(pwallet) +
-            "\nArguments:\n"
-            "1. \"nsidechain\"         (numeric, required) The sidechain to send to.\n"
-            "2. \"depositaddress\"     (string, required) The sidechain deposit address to send to.\n"
-            "3. \"amount\"             (numeric or string, required) The amount in " + CURRENCY_UNIT + " to send. eg 0.1\n"
-            "4. \"fee\"                (numeric or string, required) The fee in " + CURRENCY_UNIT + "\n"
-            "\nResult:\n"
-            "\"txid\"                  (string) The transaction id.\n"
-            "\nExamples:\n"
-            + HelpExampleCli("createsidechaindeposit", "0 \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\" 0.1, 0.01")
-            + HelpExampleRpc("createsidechaindeposit", "0, \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\", 0.1, 0.01")
-        );
-
-    ObserveSafeMode();
-
     // Check sidechain number we are depositing to
-    unsigned int nSidechain = request.params[0].get_int();
+    nSidechain = request.params[0].get_int();
     if (!scdb.IsSidechainActive(nSidechain)) {
         std::string strError = "Invalid sidechain number";
         LogPrintf("%s: %s\n", __func__, strError);
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
 
-    // Make sure the results are valid at least up to the most recent block
-    // the user could have gotten from another RPC command prior to now
-    pwallet->BlockUntilSyncedToCurrentChain();
-
-    LOCK2(cs_main, pwallet->cs_wallet);
-
     // strDepositAddress
     std::string strDepositAddress = request.params[1].get_str();
     if (strDepositAddress.empty()) {
@@ -3658,7 +3631,7 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     }
 
     // Get strDest from deposit address
-    std::string strDest = "";
+    strDest = "";
     unsigned int nSidechainFromAddress;
     if (!ParseDepositAddress(strDepositAddress, strDest, nSidechainFromAddress)) {
         std::string strError = "Invalid sidechain deposit address - failed to parse";
@@ -3681,7 +3654,7 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     }
 
     // Amount
-    CAmount nAmount = AmountFromValue(request.params[2]);
+    nAmount = AmountFromValue(request.params[2]);
     if (nAmount <= 0) {
         std::string strError = "Invalid amount for send";
         LogPrintf("%s: %s\n", __func__, strError);
@@ -3689,7 +3662,7 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     }
 
     // Fee
-    CAmount nFee = AmountFromValue(request.params[3]);
+    nFee = AmountFromValue(request.params[3]);
     if (nFee <= 0) {
         std::string strError = "Invalid fee amount";
         LogPrintf("%s: %s\n", __func__, strError);
@@ -3697,13 +3670,52 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     }
 
     // Get sidechain script
-    CScript sidechainScriptPubKey;
     if (!scdb.GetSidechainScript(nSidechain, sidechainScriptPubKey))
     {
         std::string strError = "Failed to lookup sidechain script";
         LogPrintf("%s: %s\n", __func__, strError);
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
+}
+
+UniValue createsidechaindeposit(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 4)
+        throw std::runtime_error(
+            "createsidechaindeposit \"nsidechain\" \"depositaddress\" \"amount\"\n"
+            "\nCreate a sidechain deposit of an amount to a given address.\n"
+            + HelpRequiringPassphrase(pwallet) +
+            "\nArguments:\n"
+            "1. \"nsidechain\"         (numeric, required) The sidechain to send to.\n"
+            "2. \"depositaddress\"     (string, required) The sidechain deposit address to send to.\n"
+            "3. \"amount\"             (numeric or string, required) The amount in " + CURRENCY_UNIT + " to send. eg 0.1\n"
+            "4. \"fee\"                (numeric or string, required) The fee in " + CURRENCY_UNIT + "\n"
+            "\nResult:\n"
+            "\"txid\"                  (string) The transaction id.\n"
+            "\nExamples:\n"
+            + HelpExampleCli("createsidechaindeposit", "0 \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\" 0.1, 0.01")
+            + HelpExampleRpc("createsidechaindeposit", "0, \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\", 0.1, 0.01")
+        );
+
+    ObserveSafeMode();
+
+    unsigned int nSidechain;
+    std::string strDest;
+    CAmount nAmount;
+    CAmount nFee;
+    CScript sidechainScriptPubKey;
+    ParseSidechainDeposit(request, nSidechain, strDest, nAmount, nFee, sidechainScriptPubKey);
+
+    // Make sure the results are valid at least up to the most recent block
+    // the user could have gotten from another RPC command prior to now
+    pwallet->BlockUntilSyncedToCurrentChain();
+
+    LOCK2(cs_main, pwallet->cs_wallet);
 
     EnsureWalletIsUnlocked(pwallet);
 
@@ -3718,6 +3730,150 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     return tx->GetHash().GetHex();
 }
 
+static UniValue QueuedDepositToJSON(const QueuedDeposit& deposit)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("id", deposit.id.GetHex());
+    obj.pushKV("nsidechain", deposit.nSidechain);
+    obj.pushKV("destination", deposit.strDest);
+    obj.pushKV("amount", ValueFromAmount(deposit.nAmount));
+    obj.pushKV("fee", ValueFromAmount(deposit.nFee));
+    obj.pushKV("time", deposit.nTimeQueued);
+    if (!deposit.txid.IsNull()) {
+        obj.pushKV("status", "submitted");
+        obj.pushKV("txid", deposit.txid.GetHex());
+    } else if (deposit.tx) {
+        obj.pushKV("status", "built");
+        obj.pushKV("txid", deposit.tx->GetHash().GetHex());
+    } else {
+        obj.pushKV("status", "waiting");
+    }
+    if (!deposit.strError.empty())
+        obj.pushKV("error", deposit.strError);
+    return obj;
+}
+
+UniValue queuesidechaindeposit(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 4)
+        throw std::runtime_error(
+            "queuesidechaindeposit \"nsidechain\" \"depositaddress\" \"amount\" \"fee\"\n"
+            "\nQueue a sidechain deposit of an amount to a given address.\n"
+            "The deposits queued for a sidechain spend each other's deposit output as the CTIP,\n"
+            "so that several of them can wait in the mempool at once. A deposit that can't be\n"
+            "submitted yet, for example because of the mempool ancestor limits, is kept built and\n"
+            "submitted once the deposits before it confirm.\n"
+            + HelpRequiringPassphrase(pwallet) +
+            "\nArguments:\n"
+            "1. \"nsidechain\"         (numeric, required) The sidechain to send to.\n"
+            "2. \"depositaddress\"     (string, required) The sidechain deposit address to send to.\n"
+            "3. \"amount\"             (numeric or string, required) The amount in " + CURRENCY_UNIT + " to send. eg 0.1\n"
+            "4. \"fee\"                (numeric or string, required) The fee in " + CURRENCY_UNIT + "\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"id\" : \"id\",              (string) The id of the queued deposit\n"
+            "  \"nsidechain\" : n,         (numeric) The sidechain\n"
+            "  \"destination\" : \"dest\",   (string) The sidechain destination\n"
+            "  \"amount\" : x.xxx,         (numeric) The amount in " + CURRENCY_UNIT + "\n"
+            "  \"fee\" : x.xxx,            (numeric) The fee in " + CURRENCY_UNIT + "\n"
+            "  \"time\" : n,               (numeric) The time the deposit was queued\n"
+            "  \"status\" : \"status\",      (string) \"submitted\", \"built\" or \"waiting\"\n"
+            "  \"txid\" : \"txid\",          (string, optional) The deposit transaction\n"
+            "  \"error\" : \"error\"         (string, optional) Why the deposit wasn't built or submitted\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("queuesidechaindeposit", "0 \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\" 0.1, 0.01")
+            + HelpExampleRpc("queuesidechaindeposit", "0, \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\", 0.1, 0.01")
+        );
+
+    ObserveSafeMode();
+
+    unsigned int nSidechain;
+    std::string strDest;
+    CAmount nAmount;
+    CAmount nFee;
+    CScript sidechainScriptPubKey;
+    ParseSidechainDeposit(request, nSidechain, strDest, nAmount, nFee, sidechainScriptPubKey);
+
+    EnsureWalletIsUnlocked(pwallet);
+
+    QueuedDeposit deposit;
+    std::string strFail = "";
+    if (!pwallet->QueueSidechainDeposit(deposit, strFail, sidechainScriptPubKey, nSidechain, nAmount, nFee, strDest))
+    {
+        LogPrintf("%s: %s\n", __func__, strFail);
+        throw JSONRPCError(RPC_MISC_ERROR, strFail);
+    }
+
+    return QueuedDepositToJSON(deposit);
+}
+
+UniValue listqueueddeposits(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "listqueueddeposits\n"
+            "\nList the sidechain deposits waiting in the deposit queue, by sidechain in queue order.\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"id\" : \"id\",              (string) The id of the queued deposit\n"
+            "    ...                       See queuesidechaindeposit\n"
+            "  }\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("listqueueddeposits", "")
+            + HelpExampleRpc("listqueueddeposits", "")
+        );
+
+    UniValue result(UniValue::VARR);
+    for (const QueuedDeposit& deposit : pwallet->GetQueuedDeposits())
+        result.push_back(QueuedDepositToJSON(deposit));
+
+    return result;
+}
+
+UniValue removequeueddeposit(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "removequeueddeposit \"id\"\n"
+            "\nRemove a queued sidechain deposit that wasn't submitted yet.\n"
+            "The deposits queued after it are built again.\n"
+            + HelpRequiringPassphrase(pwallet) +
+            "\nArguments:\n"
+            "1. \"id\"                 (string, required) The id of the queued deposit\n"
+            "\nExamples:\n"
+            + HelpExampleCli("removequeueddeposit", "\"id\"")
+            + HelpExampleRpc("removequeueddeposit", "\"id\"")
+        );
+
+    EnsureWalletIsUnlocked(pwallet);
+
+    uint256 id = ParseHashV(request.params[0], "id");
+
+    std::string strFail = "";
+    if (!pwallet->RemoveQueuedDeposit(id, strFail))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strFail);
+
+    return NullUniValue;
+}
+
 UniValue createopreturntransaction(const JSONRPCRequest& request)
 {
     CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
@@ -3936,54 +4092,22 @@ UniValue createbmmcriticaldatatx(const JSONRPCRequest& request)
     }
 
     // Check prev bytes size
-    std::vector<unsigned char> vPrevBytes = ParseHex(strPrevBlock);
-    if (vPrevBytes.size() != 4) {
+    if (ParseHex(strPrevBlock).size() != 4) {
         std::string strError = "Invalid prevBlockHash bytes size";
         LogPrintf("%s: %s.\n", __func__, strError);
         throw (JSONRPCError(RPC_TYPE_ERROR, strError));
     }
 
-    // Create critical data bytes
-    CScript vBytes;
-    vBytes.resize(8);
-
-    // Add header to identify BMM data
-    vBytes[0] = 0x00;
-    vBytes[1] = 0xbf;
-    vBytes[2] = 0x00;
-
-    // Add sidechain number
-    vBytes[3] = nSidechain;
-
-    // Add prev block bytes
-    memcpy(&vBytes[4], vPrevBytes.data(), vPrevBytes.size());
-
-    CCriticalData criticalData;
-    criticalData.vBytes = std::vector<unsigned char>(vBytes.begin(), vBytes.end());
-    criticalData.hashCritical = hashCritical;
-
 #ifdef ENABLE_WALLET
     LOCK2(cs_main, pwallet->cs_wallet);
 
     // Create and send the transaction
     std::string strError;
 
-    // Create transaction with critical data
-    std::vector<CRecipient> vecSend;
-    CRecipient recipient = {CScript() << OP_TRUE, nAmount, false};
-    vecSend.push_back(recipient);
-
     CWalletTx wtx;
-    wtx.fFromMe = true;
-    wtx.fTimeReceivedIsTxTime = true;
-    wtx.BindWallet(pwallet);
-
     CReserveKey reservekey(pwallet);
-    CAmount nFeeRequired;
-    int nChangePosRet = -1;
-    CCoinControl cc;  // TODO Allow user to set coin control
-    cc.signalRbf = false;
-    if (!pwallet->CreateTransaction(vecSend, wtx, reservekey, nFeeRequired, nChangePosRet, strError, cc, true, 3, nHeight, criticalData)) {
+    CAmount nFeeRequired = 0;
+    if (!pwallet->CreateBMMRequest(wtx, reservekey, nFeeRequired, strError, nSidechain, hashCritical, nAmount, nHeight, strPrevBlock)) {
         if (nAmount + nFeeRequired > pwallet->GetBalance() || nAmount < nFeeRequired)
             strError = strprintf("Error: This transaction requires a transaction fee of at least %s", FormatMoney(nFeeRequired));
         LogPrintf("%s: %s\n", __func__, strError);
@@ -4007,6 +4131,147 @@ UniValue createbmmcriticaldatatx(const JSONRPCRequest& request)
     return ret;
 }
 
+static UniValue BMMBidderToJSON(const BMMBidder& bidder)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("nsidechain", bidder.nSidechain);
+    if (!bidder.hashCritical.IsNull())
+        obj.pushKV("criticalhash", bidder.hashCritical.GetHex());
+    obj.pushKV("amount", ValueFromAmount(bidder.nAmount));
+    obj.pushKV("maxbid", ValueFromAmount(bidder.nMaxBid));
+    if (!bidder.vBidTxid.empty()) {
+        obj.pushKV("bidblock", bidder.hashBidBlock.GetHex());
+        obj.pushKV("bid", ValueFromAmount(bidder.nBid));
+        obj.pushKV("txid", bidder.vBidTxid.back().GetHex());
+    }
+    obj.pushKV("won", bidder.nWon);
+    obj.pushKV("spent", ValueFromAmount(bidder.nSpent));
+    if (!bidder.strError.empty())
+        obj.pushKV("error", bidder.strError);
+    return obj;
+}
+
+UniValue setbmmbidder(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 4)
+        throw std::runtime_error(
+            "setbmmbidder nsidechain \"criticalhash\" amount maxbid\n"
+            "\nBid for BMM of a sidechain block on every new tip, until the block is BMMed.\n"
+            "The bid is a BMM request paying the amount to the miner, which is replaced with\n"
+            "a higher fee when another BMM request for the sidechain outbids it in the mempool,\n"
+            "as long as the amount and the fee add up to at most maxbid. The bid on the last tip\n"
+            "is abandoned. Call again with the h* of the next sidechain block once the block was\n"
+            "BMMed, or to change the bidder. Bidders aren't saved in the wallet.\n"
+            + HelpRequiringPassphrase(pwallet) +
+            "\nArguments:\n"
+            "1. nsidechain             (numeric, required) Sidechain requesting BMM\n"
+            "2. \"criticalhash\"         (string, required) h* you want added to a coinbase\n"
+            "3. amount                 (numeric or string, required) The amount in " + CURRENCY_UNIT + " to pay the miner\n"
+            "4. maxbid                 (numeric or string, required) The most in " + CURRENCY_UNIT + " the amount and the fee of a bid may add up to\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"nsidechain\" : n,         (numeric) The sidechain\n"
+            "  \"criticalhash\" : \"hash\",  (string, optional) The h* to BMM, none once it was BMMed\n"
+            "  \"amount\" : x.xxx,         (numeric) The amount in " + CURRENCY_UNIT + "\n"
+            "  \"maxbid\" : x.xxx,         (numeric) The budget per block in " + CURRENCY_UNIT + "\n"
+            "  \"bidblock\" : \"hash\",      (string, optional) The tip of the current bid\n"
+            "  \"bid\" : x.xxx,            (numeric, optional) What the current bid pays the miner in " + CURRENCY_UNIT + "\n"
+            "  \"txid\" : \"txid\",          (string, optional) The BMM request of the current bid\n"
+            "  \"won\" : n,                (numeric) The number of h* that were BMMed\n"
+            "  \"spent\" : x.xxx,          (numeric) What the bids that won paid in " + CURRENCY_UNIT + "\n"
+            "  \"error\" : \"error\"         (string, optional) Why the last bid failed\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("setbmmbidder", "0 \"criticalhash\" 0.001 0.002")
+            + HelpExampleRpc("setbmmbidder", "0, \"criticalhash\", 0.001, 0.002")
+        );
+
+    ObserveSafeMode();
+
+    int nSidechain = request.params[0].get_int();
+    if (nSidechain < 0 || nSidechain > 255)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid Sidechain number");
+
+    uint256 hashCritical = ParseHashV(request.params[1], "criticalhash");
+    CAmount nAmount = AmountFromValue(request.params[2]);
+    CAmount nMaxBid = AmountFromValue(request.params[3]);
+
+    pwallet->BlockUntilSyncedToCurrentChain();
+
+    EnsureWalletIsUnlocked(pwallet);
+
+    BMMBidder bidder;
+    std::string strFail = "";
+    if (!pwallet->SetBMMBidder(bidder, strFail, nSidechain, hashCritical, nAmount, nMaxBid))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strFail);
+
+    return BMMBidderToJSON(bidder);
+}
+
+UniValue listbmmbidders(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "listbmmbidders\n"
+            "\nList the BMM bidders and their current bids, by sidechain.\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"nsidechain\" : n,       (numeric) The sidechain\n"
+            "    ...                     See setbmmbidder\n"
+            "  }\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("listbmmbidders", "")
+            + HelpExampleRpc("listbmmbidders", "")
+        );
+
+    UniValue result(UniValue::VARR);
+    for (const BMMBidder& bidder : pwallet->GetBMMBidders())
+        result.push_back(BMMBidderToJSON(bidder));
+
+    return result;
+}
+
+UniValue removebmmbidder(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "removebmmbidder nsidechain\n"
+            "\nStop bidding for BMM of a sidechain, the current bid is abandoned.\n"
+            "\nArguments:\n"
+            "1. nsidechain             (numeric, required) The sidechain of the bidder\n"
+            "\nExamples:\n"
+            + HelpExampleCli("removebmmbidder", "0")
+            + HelpExampleRpc("removebmmbidder", "0")
+        );
+
+    int nSidechain = request.params[0].get_int();
+    if (nSidechain < 0 || nSidechain > 255)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid Sidechain number");
+
+    std::string strFail = "";
+    if (!pwallet->RemoveBMMBidder(nSidechain, strFail))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strFail);
+
+    return NullUniValue;
+}
+
 UniValue rescanblockchain(const JSONRPCRequest& request)
 {
     CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
@@ -4092,6 +4357,411 @@ UniValue rescanblockchain(const JSONRPCRequest& request)
     return response;
 }
 
+UniValue scheduletransaction(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 2) {
+        throw std::runtime_error(
+            "scheduletransaction \"txid\" time\n"
+            "\nBroadcast an in-wallet transaction that hasn't been broadcast yet at a later time.\n"
+            "The wallet checks for scheduled transactions to broadcast every " + std::to_string(SCHEDULED_TX_BROADCAST_INTERVAL / 1000) + " seconds.\n"
+            "\nArguments:\n"
+            "1. \"txid\"    (string, required) The transaction id\n"
+            "2. time      (numeric, required) The UNIX epoch time to broadcast the transaction at\n"
+            "\nResult:\n"
+            "\nExamples:\n"
+            + HelpExampleCli("scheduletransaction", "\"1075db55d416d3ca199f55b6084e2115b9345e16c5cf302fc80e9d5fbf5d48d\" 1700000000")
+            + HelpExampleRpc("scheduletransaction", "\"1075db55d416d3ca199f55b6084e2115b9345e16c5cf302fc80e9d5fbf5d48d\", 1700000000")
+        );
+    }
+
+    ObserveSafeMode();
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    uint256 hash = ParseHashV(request.params[0], "txid");
+    int64_t nTime = request.params[1].get_int64();
+
+    auto it = pwallet->mapWallet.find(hash);
+    if (it == pwallet->mapWallet.end()) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid or non-wallet transaction id");
+    }
+    const CWalletTx& wtx = it->second;
+    if (wtx.GetDepthInMainChain() != 0 || wtx.InMempool() || wtx.isAbandoned()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Transaction was already broadcast or abandoned");
+    }
+    if (!pwallet->ScheduleTransaction(hash, nTime)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Transaction is already scheduled");
+    }
+
+    return NullUniValue;
+}
+
+UniValue listscheduledtransactions(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 0) {
+        throw std::runtime_error(
+            "listscheduledtransactions\n"
+            "\nList the transactions the wallet will broadcast later, earliest first.\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\" : \"txid\",   (string) The transaction id\n"
+            "    \"time\" : n,        (numeric) The UNIX epoch time the transaction will be broadcast at\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("listscheduledtransactions", "")
+            + HelpExampleRpc("listscheduledtransactions", "")
+        );
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (const ScheduledTransaction& scheduled : pwallet->GetScheduled()) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("txid", scheduled.wtxid.GetHex()));
+        obj.push_back(Pair("time", scheduled.nTime));
+        ret.push_back(obj);
+    }
+    return ret;
+}
+
+UniValue cancelscheduledtransaction(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            "cancelscheduledtransaction \"txid\"\n"
+            "\nCancel a scheduled transaction. The transaction is abandoned, which allows for its inputs to be respent.\n"
+            "\nArguments:\n"
+            "1. \"txid\"    (string, required) The transaction id\n"
+            "\nResult:\n"
+            "\nExamples:\n"
+            + HelpExampleCli("cancelscheduledtransaction", "\"1075db55d416d3ca199f55b6084e2115b9345e16c5cf302fc80e9d5fbf5d48d\"")
+            + HelpExampleRpc("cancelscheduledtransaction", "\"1075db55d416d3ca199f55b6084e2115b9345e16c5cf302fc80e9d5fbf5d48d\"")
+        );
+    }
+
+    ObserveSafeMode();
+
+    uint256 hash = ParseHashV(request.params[0], "txid");
+    if (!pwallet->CancelScheduledTransaction(hash)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Transaction is not scheduled");
+    }
+
+    return NullUniValue;
+}
+
+UniValue denycoins(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 4) {
+        throw std::runtime_error(
+            "denycoins goal ( window [{\"txid\":\"txid\",\"vout\":n},...] maxtxs )\n"
+            "\nDeny coins by sending them to new addresses of this wallet until they reach a denial score of goal.\n"
+            "The outputs of each denial transaction are denied again until the goal is reached. The transactions\n"
+            "are scheduled for broadcast at random times over the window, each after the transaction it spends.\n"
+            "\nArguments:\n"
+            "1. goal         (numeric, required) The denial score (number of times sent to self) to reach\n"
+            "2. window       (numeric, optional, default=3600) Number of seconds to spread the broadcasts over\n"
+            "3. \"coins\"      (string, optional) A json array of objects with the txid (string) and vout (numeric)\n"
+            "                 of the coins to deny, default is every available coin\n"
+            "4. maxtxs       (numeric, optional, default=" + std::to_string(DEFAULT_MAX_DENIAL_TXS) + ") Maximum number of transactions to create\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\" : \"txid\",   (string) The denial transaction id\n"
+            "    \"time\" : n,        (numeric) The UNIX epoch time the transaction will be broadcast at\n"
+            "    \"denial\" : n,      (numeric) The denial score of the outputs of the transaction\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("denycoins", "3")
+            + HelpExampleCli("denycoins", "3 86400 \"[{\\\"txid\\\":\\\"a08e6907dbbd3d809776dbfc5d82e371b764ed838b5655e72f463568df1aadf0\\\",\\\"vout\\\":1}]\"")
+            + HelpExampleRpc("denycoins", "3, 86400")
+        );
+    }
+
+    ObserveSafeMode();
+
+    // Make sure the results are valid at least up to the most recent block
+    // the user could have gotten from another RPC command prior to now
+    pwallet->BlockUntilSyncedToCurrentChain();
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    EnsureWalletIsUnlocked(pwallet);
+
+    int nGoal = request.params[0].get_int();
+    if (nGoal < 1) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, goal must be positive");
+    }
+
+    int64_t nWindow = 3600;
+    if (!request.params[1].isNull()) {
+        nWindow = request.params[1].get_int64();
+        if (nWindow < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, window can't be negative");
+        }
+    }
+
+    std::set<COutPoint> setRequested;
+    if (!request.params[2].isNull()) {
+        const UniValue& coins = request.params[2].get_array();
+        for (unsigned int idx = 0; idx < coins.size(); idx++) {
+            const UniValue& o = coins[idx].get_obj();
+
+            RPCTypeCheckObj(o,
+                {
+                    {"txid", UniValueType(UniValue::VSTR)},
+                    {"vout", UniValueType(UniValue::VNUM)},
+                });
+
+            uint256 hash = ParseHashO(o, "txid");
+            const int nOutput = find_value(o, "vout").get_int();
+            if (nOutput < 0) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, vout must be positive");
+            }
+            setRequested.insert(COutPoint(hash, nOutput));
+        }
+    }
+
+    int nMaxTx = DEFAULT_MAX_DENIAL_TXS;
+    if (!request.params[3].isNull()) {
+        nMaxTx = request.params[3].get_int();
+        if (nMaxTx < 1) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, maxtxs must be positive");
+        }
+    }
+
+    // Only coins the wallet could spend now can be denied
+    std::vector<COutput> vAvailable;
+    pwallet->AvailableCoins(vAvailable);
+
+    std::vector<COutput> vCoins;
+    const bool fAll = setRequested.empty();
+    for (const COutput& coin : vAvailable) {
+        if (fAll || setRequested.erase(COutPoint(coin.tx->GetHash(), coin.i)))
+            vCoins.push_back(coin);
+    }
+    if (!setRequested.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, coin not available: " + setRequested.begin()->ToString());
+    }
+
+    std::vector<ScheduledTransaction> vScheduled;
+    std::string strFail;
+    if (!pwallet->DenyCoins(vCoins, nGoal, nWindow, vScheduled, strFail, nMaxTx)) {
+        throw JSONRPCError(RPC_WALLET_ERROR, strFail);
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (const ScheduledTransaction& scheduled : vScheduled) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("txid", scheduled.wtxid.GetHex()));
+        obj.push_back(Pair("time", scheduled.nTime));
+        obj.push_back(Pair("denial", (int)pwallet->mapWallet.at(scheduled.wtxid).nDenial));
+        ret.push_back(obj);
+    }
+    return ret;
+}
+
+UniValue splitcoins(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() < 2 || request.params.size() > 4) {
+        throw std::runtime_error(
+            "splitcoins noutputs amount ( maxoutputspertx dryrun )\n"
+            "\nSplit confirmed coins into noutputs outputs of amount, each to a new address of this wallet.\n"
+            "Every coin split is the root of a tree of replay protected transactions that stays within the mempool\n"
+            "ancestor and descendant limits, the largest coins are split first. The transactions are signed in\n"
+            "parallel and submitted parents first.\n"
+            + HelpRequiringPassphrase(pwallet) +
+            "\nArguments:\n"
+            "1. noutputs         (numeric, required) The number of outputs to create\n"
+            "2. amount           (numeric or string, required) The amount in " + CURRENCY_UNIT + " of each output\n"
+            "3. maxoutputspertx  (numeric, optional, default=" + std::to_string(DEFAULT_SPLIT_TX_OUTPUTS) + ") Maximum number of outputs of one transaction\n"
+            "4. dryrun           (boolean, optional, default=false) Only plan the split\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"transactions\" : n,   (numeric) The number of transactions of the split\n"
+            "  \"coins\" : n,          (numeric) The number of coins split\n"
+            "  \"depth\" : n,          (numeric) The length of the longest chain of split transactions\n"
+            "  \"fee\" : x.xxx,        (numeric) The fee of the transactions in " + CURRENCY_UNIT + ", not for a dry run\n"
+            "  \"txids\" : [           (array) The transactions accepted to the mempool, not for a dry run\n"
+            "    \"txid\", ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("splitcoins", "2000 0.01")
+            + HelpExampleCli("splitcoins", "2000 0.01 500 true")
+            + HelpExampleRpc("splitcoins", "2000, 0.01")
+        );
+    }
+
+    ObserveSafeMode();
+
+    // Make sure the results are valid at least up to the most recent block
+    // the user could have gotten from another RPC command prior to now
+    pwallet->BlockUntilSyncedToCurrentChain();
+
+    int nOutputs = request.params[0].get_int();
+    if (nOutputs < 1) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, noutputs must be positive");
+    }
+
+    CAmount nAmount = AmountFromValue(request.params[1]);
+    if (nAmount <= 0) {
+        throw JSONRPCError(RPC_TYPE_ERROR, "Invalid amount");
+    }
+
+    int nMaxTxOutputs = DEFAULT_SPLIT_TX_OUTPUTS;
+    if (!request.params[2].isNull()) {
+        nMaxTxOutputs = request.params[2].get_int();
+        if (nMaxTxOutputs < 2) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, maxoutputspertx must be at least 2");
+        }
+    }
+
+    bool fDryRun = !request.params[3].isNull() && request.params[3].get_bool();
+
+    if (!fDryRun) {
+        EnsureWalletIsUnlocked(pwallet);
+    }
+
+    std::vector<COutput> vCoins;
+    {
+        LOCK2(cs_main, pwallet->cs_wallet);
+        pwallet->AvailableCoins(vCoins, true, nullptr, 1, MAX_MONEY, MAX_MONEY, 0, 1 /* nMinDepth */);
+    }
+
+    std::vector<PlannedSplitTx> vPlan;
+    std::vector<CTransactionRef> vtx;
+    CAmount nFee = 0;
+    std::string strFail;
+    bool fSplit = pwallet->SplitCoins(vCoins, nOutputs, nAmount, nMaxTxOutputs, vPlan, vtx, nFee, strFail, fDryRun);
+    if (!fSplit && vtx.empty()) {
+        throw JSONRPCError(RPC_WALLET_ERROR, strFail);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    unsigned int nCoins = 0;
+    unsigned int nDepth = 0;
+    for (const PlannedSplitTx& planned : vPlan) {
+        nCoins += planned.nParent < 0;
+        nDepth = std::max(nDepth, planned.nDepth + 1);
+    }
+    ret.push_back(Pair("transactions", (uint64_t)vPlan.size()));
+    ret.push_back(Pair("coins", (uint64_t)nCoins));
+    ret.push_back(Pair("depth", (uint64_t)nDepth));
+    if (!fDryRun) {
+        ret.push_back(Pair("fee", ValueFromAmount(nFee)));
+        UniValue txids(UniValue::VARR);
+        for (const CTransactionRef& tx : vtx)
+            txids.push_back(tx->GetHash().GetHex());
+        ret.push_back(Pair("txids", txids));
+        if (!fSplit)
+            ret.push_back(Pair("error", strFail));
+    }
+    return ret;
+}
+
+UniValue checkreplaystatus(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() > 1) {
+        throw std::runtime_error(
+            "checkreplaystatus ( [\"txid\",...] )\n"
+            "\nCheck whether wallet transactions were replayed on the chain this one split from, and store\n"
+            "their replay status in the wallet. Transactions are checked with -replayblocksdir or\n"
+            "-replayendpoint, many at a time, and the results are cached for -replaycachettl seconds.\n"
+            "\nArguments:\n"
+            "1. \"txids\"      (string, optional) A json array of the txids to check, default is every wallet\n"
+            "                 transaction without replay protection\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"txid\" : true|false,   (boolean) Whether the transaction was replayed, transactions that\n"
+            "                          couldn't be checked are left out\n"
+            "  ,...\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("checkreplaystatus", "")
+            + HelpExampleCli("checkreplaystatus", "\"[\\\"a08e6907dbbd3d809776dbfc5d82e371b764ed838b5655e72f463568df1aadf0\\\"]\"")
+            + HelpExampleRpc("checkreplaystatus", "")
+        );
+    }
+
+    if (!g_replay_checker) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Replay checking is not available");
+    }
+
+    std::vector<uint256> vTxid;
+    {
+        LOCK(pwallet->cs_wallet);
+        if (!request.params[0].isNull()) {
+            const UniValue& txids = request.params[0].get_array();
+            for (unsigned int idx = 0; idx < txids.size(); idx++) {
+                uint256 txid = ParseHashV(txids[idx], "txid");
+                if (!pwallet->mapWallet.count(txid)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid or non-wallet transaction id");
+                }
+                vTxid.push_back(txid);
+            }
+        } else {
+            for (const std::pair<const uint256, CWalletTx>& item : pwallet->mapWallet) {
+                if (pwallet->GetReplayStatus(item.first) != REPLAY_SPLIT)
+                    vTxid.push_back(item.first);
+            }
+        }
+    }
+
+    // The wallet isn't locked while the transactions are checked
+    std::map<uint256, bool> mapReplayed;
+    g_replay_checker->Check(vTxid, mapReplayed);
+
+    std::map<uint256, int> mapReplayStatus;
+    UniValue ret(UniValue::VOBJ);
+    for (const std::pair<const uint256, bool>& replayed : mapReplayed) {
+        mapReplayStatus[replayed.first] = replayed.second ? REPLAY_TRUE : REPLAY_FALSE;
+        ret.push_back(Pair(replayed.first.GetHex(), replayed.second));
+    }
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+    // A transaction split in the meantime keeps that status
+    for (std::map<uint256, int>::iterator it = mapReplayStatus.begin(); it != mapReplayStatus.end(); ) {
+        if (pwallet->GetReplayStatus(it->first) == REPLAY_SPLIT)
+            it = mapReplayStatus.erase(it);
+        else
+            ++it;
+    }
+    pwallet->UpdateReplayStatus(mapReplayStatus);
+    return ret;
+}
+
 extern UniValue abortrescan(const JSONRPCRequest& request); // in rpcdump.cpp
 extern UniValue dumpprivkey(const JSONRPCRequest& request); // in rpcdump.cpp
 extern UniValue importprivkey(const JSONRPCRequest& request);
@@ -4160,11 +4830,23 @@ static const CRPCCommand commands[] =
     { "wallet",             "walletpassphrase",           &walletpassphrase,           {"passphrase","timeout"} },
     { "wallet",             "removeprunedfunds",          &removeprunedfunds,          {"txid"} },
     { "wallet",             "rescanblockchain",           &rescanblockchain,           {"start_height", "stop_height"} },
+    { "wallet",             "scheduletransaction",        &scheduletransaction,        {"txid", "time"} },
+    { "wallet",             "listscheduledtransactions",  &listscheduledtransactions,  {} },
+    { "wallet",             "cancelscheduledtransaction", &cancelscheduledtransaction, {"txid"} },
+    { "wallet",             "denycoins",                  &denycoins,                  {"goal", "window", "coins", "maxtxs"} },
+    { "wallet",             "splitcoins",                 &splitcoins,                 {"noutputs", "amount", "maxoutputspertx", "dryrun"} },
+    { "wallet",             "checkreplaystatus",          &checkreplaystatus,          {"txids"} },
 
     { "generating",         "generate",                   &generate,                   {"nblocks","maxtries"} },
 
     { "Drivechain",         "createsidechaindeposit",     &createsidechaindeposit,     {"nSidechain", "depositaddress", "amount", "fee"} },
+    { "Drivechain",         "queuesidechaindeposit",      &queuesidechaindeposit,      {"nsidechain", "depositaddress", "amount", "fee"} },
+    { "Drivechain",         "listqueueddeposits",         &listqueueddeposits,         {} },
+    { "Drivechain",         "removequeueddeposit",        &removequeueddeposit,        {"id"} },
     { "Drivechain",         "createbmmcriticaldatatx",    &createbmmcriticaldatatx,    {"amount", "height", "criticalhash", "nsidechain"}},
+    { "Drivechain",         "setbmmbidder",               &setbmmbidder,               {"nsidechain", "criticalhash", "amount", "maxbid"} },
+    { "Drivechain",         "listbmmbidders",             &listbmmbidders,             {} },
+    { "Drivechain",         "removebmmbidder",            &removebmmbidder,            {"nsidechain"} },
 
     { "CoinNews",           "createopreturntransaction",  &createopreturntransaction,  {"text", "fee"} },
     { "CoinNews",           "broadcastnews",              &broadcastnews,              {"header", "text", "fee"} },
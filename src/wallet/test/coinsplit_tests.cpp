@@ -0,0 +1,109 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/coinsplit.h>
+
+#include <test/test_drivechain.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(coinsplit_tests, BasicTestingSetup)
+
+static CoinSplitLimits DefaultLimits(unsigned int nMaxTxOutputs)
+{
+    return CoinSplitLimits{nMaxTxOutputs, 100000, 25, 101000, 25, 101000};
+}
+
+/** Check the shape of a plan and return the number of outputs it creates */
+static unsigned int CheckPlan(const std::vector<PlannedSplitTx>& vPlan, const CoinSplitLimits& limits)
+{
+    unsigned int nOutputs = 0;
+    std::map<size_t, unsigned int> mapTreeTx;
+    for (size_t i = 0; i < vPlan.size(); i++) {
+        const PlannedSplitTx& planned = vPlan[i];
+        if (planned.nParent < 0) {
+            BOOST_CHECK_EQUAL(planned.nDepth, 0U);
+            BOOST_CHECK(planned.nSplitOutputs + planned.vChildren.size() < limits.nMaxTxOutputs);
+        } else {
+            // Parents come first
+            BOOST_CHECK((size_t)planned.nParent < i);
+            BOOST_CHECK_EQUAL(planned.nDepth, vPlan[planned.nParent].nDepth + 1);
+            BOOST_CHECK_EQUAL(planned.nCoin, vPlan[planned.nParent].nCoin);
+            BOOST_CHECK(planned.nSplitOutputs + planned.vChildren.size() <= limits.nMaxTxOutputs);
+        }
+        BOOST_CHECK(planned.nDepth < limits.nMaxAncestors);
+        for (size_t nChild : planned.vChildren)
+            BOOST_CHECK_EQUAL(vPlan[nChild].nParent, (int)i);
+        nOutputs += planned.nSplitOutputs;
+        mapTreeTx[planned.nCoin]++;
+    }
+    for (const std::pair<const size_t, unsigned int>& tree : mapTreeTx)
+        BOOST_CHECK(tree.second <= limits.nMaxDescendants);
+    return nOutputs;
+}
+
+BOOST_AUTO_TEST_CASE(plan_single_tx)
+{
+    const CoinSplitLimits limits = DefaultLimits(DEFAULT_SPLIT_TX_OUTPUTS);
+    std::vector<PlannedSplitTx> vPlan;
+    std::string strFail;
+
+    // Few outputs are split by one transaction of the largest coin
+    BOOST_CHECK(PlanCoinSplit({COIN, 100 * COIN}, 50, COIN / 100, CFeeRate(1000), limits, vPlan, strFail));
+    BOOST_REQUIRE_EQUAL(vPlan.size(), 1U);
+    BOOST_CHECK_EQUAL(vPlan[0].nCoin, 1U);
+    BOOST_CHECK_EQUAL(vPlan[0].nSplitOutputs, 50U);
+    BOOST_CHECK(vPlan[0].vChildren.empty());
+}
+
+BOOST_AUTO_TEST_CASE(plan_tree)
+{
+    // Small transactions make a tree of a root funding leaves
+    const CoinSplitLimits limits = DefaultLimits(100);
+    std::vector<PlannedSplitTx> vPlan;
+    std::string strFail;
+    BOOST_CHECK(PlanCoinSplit({100 * COIN}, 1000, COIN / 100, CFeeRate(1000), limits, vPlan, strFail));
+    BOOST_CHECK_EQUAL(CheckPlan(vPlan, limits), 1000U);
+    BOOST_CHECK_EQUAL(vPlan.size(), 11U);
+    BOOST_CHECK_EQUAL(vPlan[0].vChildren.size(), 10U);
+    BOOST_CHECK_EQUAL(vPlan[0].nSplitOutputs, 0U);
+    for (size_t i = 1; i < vPlan.size(); i++)
+        BOOST_CHECK_EQUAL(vPlan[i].nSplitOutputs, 100U);
+
+    // The descendant limit ends a tree, the rest of the outputs go to the
+    // next coin
+    vPlan.clear();
+    BOOST_CHECK(PlanCoinSplit({100 * COIN, 100 * COIN}, 3000, COIN / 100, CFeeRate(1000), limits, vPlan, strFail));
+    BOOST_CHECK_EQUAL(CheckPlan(vPlan, limits), 3000U);
+    BOOST_CHECK(vPlan.back().nCoin == 1U);
+
+    // Deeper trees with tiny transactions
+    const CoinSplitLimits limitsTiny = DefaultLimits(3);
+    vPlan.clear();
+    BOOST_CHECK(PlanCoinSplit({100 * COIN}, 20, COIN / 100, CFeeRate(1000), limitsTiny, vPlan, strFail));
+    BOOST_CHECK_EQUAL(CheckPlan(vPlan, limitsTiny), 20U);
+}
+
+BOOST_AUTO_TEST_CASE(plan_limits)
+{
+    const CoinSplitLimits limits = DefaultLimits(DEFAULT_SPLIT_TX_OUTPUTS);
+    std::vector<PlannedSplitTx> vPlan;
+    std::string strFail;
+
+    // The descendant size limit holds less than 3000 outputs per coin
+    BOOST_CHECK(!PlanCoinSplit({1000 * COIN}, 3000, COIN / 100, CFeeRate(1000), limits, vPlan, strFail));
+    BOOST_CHECK(vPlan.empty());
+    BOOST_CHECK(PlanCoinSplit({1000 * COIN, 1000 * COIN}, 3000, COIN / 100, CFeeRate(1000), limits, vPlan, strFail));
+    BOOST_CHECK_EQUAL(CheckPlan(vPlan, limits), 3000U);
+
+    // A coin only holds the outputs it can pay for, with the fees
+    vPlan.clear();
+    BOOST_CHECK(!PlanCoinSplit({COIN}, 100, COIN / 100, CFeeRate(1000), limits, vPlan, strFail));
+    BOOST_CHECK(PlanCoinSplit({COIN}, 99, COIN / 100, CFeeRate(1000), limits, vPlan, strFail));
+    BOOST_CHECK(PlanCoinSplit({COIN, COIN / 2}, 120, COIN / 100, CFeeRate(1000), limits, vPlan, strFail));
+    BOOST_CHECK_EQUAL(CheckPlan(vPlan, limits), 120U);
+    BOOST_CHECK_EQUAL(vPlan[0].nSplitOutputs, 99U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,349 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/depositqueue.h>
+
+#include <consensus/validation.h>
+#include <sidechain.h>
+#include <test/test_drivechain.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(depositqueue_tests, BasicTestingSetup)
+
+/**
+ * Deposit queue handler with a mempool of submitted deposits. Deposits are
+ * built on a new coin, or on the coins given to reuse, and the CTIP.
+ */
+class TestDepositQueueHandler : public DepositQueueHandler
+{
+public:
+    std::set<uint256> setConfirmed;
+    std::set<uint256> setMempool;
+    //! Reject reasons of the deposits the mempool doesn't accept, by id
+    std::map<uint256, std::string> mapReject;
+
+    std::vector<uint256> vBuilt;
+    std::vector<uint256> vSubmitted;
+    std::vector<uint256> vErased;
+    //! The coins of the last build of each deposit, by id
+    std::map<uint256, std::vector<COutPoint>> mapCoins;
+
+    bool IsConfirmed(const QueuedDeposit& deposit) override
+    {
+        return setConfirmed.count(deposit.txid);
+    }
+
+    bool InMempool(const QueuedDeposit& deposit) override
+    {
+        return setMempool.count(deposit.txid);
+    }
+
+    bool Build(QueuedDeposit& deposit, const SidechainCTIP* pctip, const QueuedDeposit* pprev, const std::vector<COutPoint>& vReuse) override
+    {
+        std::vector<COutPoint> vCoin = vReuse;
+        if (vCoin.empty())
+            vCoin.push_back(COutPoint(InsecureRand256(), 0));
+
+        CMutableTransaction mtx;
+        for (const COutPoint& out : vCoin)
+            mtx.vin.push_back(CTxIn(out));
+        if (pctip)
+            mtx.vin.push_back(CTxIn(pctip->out));
+        mtx.vout.push_back(CTxOut(deposit.nAmount + (pctip ? pctip->amount : 0), deposit.sidechainScriptPubKey));
+
+        deposit.tx = MakeTransactionRef(std::move(mtx));
+        deposit.outCTIP = pctip ? pctip->out : COutPoint();
+        deposit.strError.clear();
+        vBuilt.push_back(deposit.id);
+        mapCoins[deposit.id] = vCoin;
+        return true;
+    }
+
+    bool Submit(QueuedDeposit& deposit, CValidationState& state) override
+    {
+        auto it = mapReject.find(deposit.id);
+        if (it != mapReject.end())
+            return state.DoS(0, false, REJECT_NONSTANDARD, it->second);
+
+        deposit.txid = deposit.tx->GetHash();
+        setMempool.insert(deposit.txid);
+        vSubmitted.push_back(deposit.id);
+        return true;
+    }
+
+    void Discard(QueuedDeposit& deposit, std::vector<COutPoint>& vReuse) override
+    {
+        if (!deposit.tx)
+            return;
+        if (!deposit.txid.IsNull()) {
+            const std::vector<COutPoint>& vCoin = mapCoins[deposit.id];
+            vReuse.insert(vReuse.end(), vCoin.begin(), vCoin.end());
+            setMempool.erase(deposit.txid);
+            deposit.txid.SetNull();
+        }
+        deposit.tx.reset();
+        deposit.outCTIP.SetNull();
+    }
+
+    void Erase(const QueuedDeposit& deposit) override
+    {
+        vErased.push_back(deposit.id);
+    }
+};
+
+static QueuedDeposit NewDeposit(int64_t nOrderPos)
+{
+    QueuedDeposit deposit;
+    deposit.id = InsecureRand256();
+    deposit.sidechainScriptPubKey = CScript() << OP_TRUE;
+    deposit.nAmount = (nOrderPos + 1) * COIN;
+    deposit.nFee = 1000;
+    deposit.nOrderPos = nOrderPos;
+    return deposit;
+}
+
+static std::vector<QueuedDeposit> NewQueue(size_t nDeposits)
+{
+    std::vector<QueuedDeposit> vQueue;
+    for (size_t i = 0; i < nDeposits; i++)
+        vQueue.push_back(NewDeposit(i));
+    return vQueue;
+}
+
+static std::vector<uint256> Ids(const std::vector<QueuedDeposit>& vQueue)
+{
+    std::vector<uint256> vId;
+    for (const QueuedDeposit& deposit : vQueue)
+        vId.push_back(deposit.id);
+    return vId;
+}
+
+static bool Spends(const QueuedDeposit& deposit, const COutPoint& out)
+{
+    for (const CTxIn& txin : deposit.tx->vin) {
+        if (txin.prevout == out)
+            return true;
+    }
+    return false;
+}
+
+static COutPoint DepositOutput(const QueuedDeposit& deposit)
+{
+    return COutPoint(deposit.tx->GetHash(), deposit.tx->vout.size() - 1);
+}
+
+static SidechainCTIP NewCTIP()
+{
+    SidechainCTIP ctip;
+    ctip.out = COutPoint(InsecureRand256(), 0);
+    ctip.amount = 10 * COIN;
+    return ctip;
+}
+
+BOOST_AUTO_TEST_CASE(queue_order)
+{
+    std::vector<QueuedDeposit> vQueue;
+    QueuedDeposit deposit3 = NewDeposit(3);
+    QueuedDeposit deposit1 = NewDeposit(1);
+    QueuedDeposit deposit2a = NewDeposit(2);
+    QueuedDeposit deposit2b = NewDeposit(2);
+    InsertQueuedDeposit(vQueue, deposit3);
+    InsertQueuedDeposit(vQueue, deposit1);
+    InsertQueuedDeposit(vQueue, deposit2a);
+    InsertQueuedDeposit(vQueue, deposit2b);
+
+    // Deposits loaded with the same position keep the order they are loaded in
+    std::vector<uint256> vExpected{deposit1.id, deposit2a.id, deposit2b.id, deposit3.id};
+    std::vector<uint256> vId = Ids(vQueue);
+    BOOST_CHECK(vId == vExpected);
+}
+
+BOOST_AUTO_TEST_CASE(chain_on_ctip)
+{
+    TestDepositQueueHandler handler;
+    std::vector<QueuedDeposit> vQueue = NewQueue(3);
+    const SidechainCTIP ctip = NewCTIP();
+
+    ProcessDepositQueue(vQueue, &ctip, true, handler);
+
+    // Every deposit is submitted in queue order and spends the deposit output of the one before it
+    std::vector<uint256> vId = Ids(vQueue);
+    BOOST_CHECK(handler.vSubmitted == vId);
+    BOOST_CHECK(vQueue[0].outCTIP == ctip.out);
+    BOOST_CHECK(Spends(vQueue[0], ctip.out));
+    for (size_t i = 1; i < vQueue.size(); i++) {
+        BOOST_CHECK(vQueue[i].outCTIP == DepositOutput(vQueue[i - 1]));
+        BOOST_CHECK(Spends(vQueue[i], DepositOutput(vQueue[i - 1])));
+    }
+    BOOST_CHECK_EQUAL(vQueue.back().tx->vout.back().nValue, ctip.amount + 6 * COIN);
+
+    // Without a CTIP the first deposit creates one
+    TestDepositQueueHandler handlerNew;
+    std::vector<QueuedDeposit> vQueueNew = NewQueue(2);
+    ProcessDepositQueue(vQueueNew, nullptr, true, handlerNew);
+    BOOST_CHECK(vQueueNew[0].outCTIP.IsNull());
+    BOOST_CHECK_EQUAL(vQueueNew[0].tx->vin.size(), 1U);
+    BOOST_CHECK(Spends(vQueueNew[1], DepositOutput(vQueueNew[0])));
+    BOOST_CHECK_EQUAL(handlerNew.vSubmitted.size(), 2U);
+
+    // Processing again with the deposits in the mempool changes nothing
+    ProcessDepositQueue(vQueue, &ctip, true, handler);
+    BOOST_CHECK_EQUAL(handler.vBuilt.size(), 3U);
+    BOOST_CHECK_EQUAL(handler.vSubmitted.size(), 3U);
+}
+
+BOOST_AUTO_TEST_CASE(stop_at_first_reject)
+{
+    const SidechainCTIP ctip = NewCTIP();
+
+    // A deposit rejected for a reason other than the chain limits is dropped
+    // and the deposits after it aren't built
+    TestDepositQueueHandler handler;
+    std::vector<QueuedDeposit> vQueue = NewQueue(4);
+    handler.mapReject[vQueue[1].id] = "insufficient fee";
+    ProcessDepositQueue(vQueue, &ctip, true, handler);
+
+    BOOST_CHECK_EQUAL(handler.vSubmitted.size(), 1U);
+    BOOST_CHECK(handler.vSubmitted[0] == vQueue[0].id);
+    BOOST_CHECK(!vQueue[1].tx);
+    BOOST_CHECK(vQueue[1].txid.IsNull());
+    BOOST_CHECK(vQueue[1].strError.find("insufficient fee") != std::string::npos);
+    BOOST_CHECK(!vQueue[2].tx);
+    BOOST_CHECK(!vQueue[3].tx);
+    BOOST_CHECK_EQUAL(handler.vBuilt.size(), 2U);
+
+    // Once it is accepted, the rest of the queue follows on the first deposit
+    handler.mapReject.clear();
+    const SidechainCTIP ctipMempool{DepositOutput(vQueue[0]), vQueue[0].tx->vout.back().nValue};
+    ProcessDepositQueue(vQueue, &ctipMempool, true, handler);
+    BOOST_CHECK_EQUAL(handler.vSubmitted.size(), 4U);
+    BOOST_CHECK(Spends(vQueue[1], DepositOutput(vQueue[0])));
+    BOOST_CHECK(Spends(vQueue[3], DepositOutput(vQueue[2])));
+
+    // A deposit rejected for the chain limits stays built, and so do the
+    // deposits after it, without being submitted
+    TestDepositQueueHandler handlerLimit;
+    std::vector<QueuedDeposit> vQueueLimit = NewQueue(4);
+    handlerLimit.mapReject[vQueueLimit[1].id] = "too-long-mempool-chain";
+    ProcessDepositQueue(vQueueLimit, &ctip, true, handlerLimit);
+
+    BOOST_CHECK_EQUAL(handlerLimit.vSubmitted.size(), 1U);
+    BOOST_CHECK(vQueueLimit[1].tx);
+    BOOST_CHECK(vQueueLimit[1].txid.IsNull());
+    BOOST_CHECK(vQueueLimit[3].tx);
+    BOOST_CHECK(vQueueLimit[3].txid.IsNull());
+    BOOST_CHECK(Spends(vQueueLimit[3], DepositOutput(vQueueLimit[2])));
+    BOOST_CHECK_EQUAL(handlerLimit.vBuilt.size(), 4U);
+
+    // When there is room they are submitted as they were built
+    handlerLimit.mapReject.clear();
+    const CTransactionRef txLast = vQueueLimit[3].tx;
+    const SidechainCTIP ctipLimit{DepositOutput(vQueueLimit[0]), vQueueLimit[0].tx->vout.back().nValue};
+    ProcessDepositQueue(vQueueLimit, &ctipLimit, true, handlerLimit);
+    BOOST_CHECK_EQUAL(handlerLimit.vSubmitted.size(), 4U);
+    BOOST_CHECK_EQUAL(handlerLimit.vBuilt.size(), 4U);
+    BOOST_CHECK(vQueueLimit[3].tx == txLast);
+}
+
+BOOST_AUTO_TEST_CASE(drop_confirmed)
+{
+    TestDepositQueueHandler handler;
+    std::vector<QueuedDeposit> vQueue = NewQueue(3);
+    const SidechainCTIP ctip = NewCTIP();
+    ProcessDepositQueue(vQueue, &ctip, true, handler);
+
+    const uint256 idConfirmed = vQueue[0].id;
+    handler.setConfirmed.insert(vQueue[0].txid);
+    handler.setMempool.erase(vQueue[0].txid);
+    const SidechainCTIP ctipMempool{DepositOutput(vQueue.back()), vQueue.back().tx->vout.back().nValue};
+    ProcessDepositQueue(vQueue, &ctipMempool, true, handler);
+
+    BOOST_CHECK_EQUAL(vQueue.size(), 2U);
+    BOOST_CHECK_EQUAL(handler.vErased.size(), 1U);
+    BOOST_CHECK(handler.vErased[0] == idConfirmed);
+    BOOST_CHECK_EQUAL(handler.vBuilt.size(), 3U);
+    BOOST_CHECK_EQUAL(handler.vSubmitted.size(), 3U);
+}
+
+BOOST_AUTO_TEST_CASE(rebuild_with_same_coins)
+{
+    TestDepositQueueHandler handler;
+    std::vector<QueuedDeposit> vQueue = NewQueue(3);
+    const SidechainCTIP ctip = NewCTIP();
+    ProcessDepositQueue(vQueue, &ctip, true, handler);
+
+    // The last two deposits leave the mempool and another deposit to the
+    // sidechain takes the deposit output of the first one
+    const std::vector<COutPoint> vCoin1 = handler.mapCoins[vQueue[1].id];
+    const std::vector<COutPoint> vCoin2 = handler.mapCoins[vQueue[2].id];
+    handler.setMempool.erase(vQueue[1].txid);
+    handler.setMempool.erase(vQueue[2].txid);
+    SidechainCTIP ctipOther = NewCTIP();
+    ProcessDepositQueue(vQueue, &ctipOther, true, handler);
+
+    // The first deposit stays, the others are rebuilt on the new CTIP with the same coins
+    BOOST_CHECK_EQUAL(handler.vBuilt.size(), 5U);
+    BOOST_CHECK_EQUAL(handler.vSubmitted.size(), 5U);
+    BOOST_CHECK(vQueue[1].outCTIP == ctipOther.out);
+    BOOST_CHECK(Spends(vQueue[1], ctipOther.out));
+    BOOST_CHECK(Spends(vQueue[2], DepositOutput(vQueue[1])));
+    const std::vector<COutPoint>& vRebuilt1 = handler.mapCoins[vQueue[1].id];
+    const std::vector<COutPoint>& vRebuilt2 = handler.mapCoins[vQueue[2].id];
+    BOOST_CHECK(vRebuilt1 == vCoin1);
+    BOOST_CHECK(vRebuilt2 == vCoin2);
+    for (const COutPoint& out : vCoin1)
+        BOOST_CHECK(Spends(vQueue[1], out));
+}
+
+BOOST_AUTO_TEST_CASE(choose_coins)
+{
+    const CInputCoin coinA(COutPoint(InsecureRand256(), 0), CTxOut(2 * COIN, CScript()));
+    const CInputCoin coinB(COutPoint(InsecureRand256(), 1), CTxOut(3 * COIN, CScript()));
+    const CInputCoin change(COutPoint(InsecureRand256(), 0), CTxOut(1 * COIN, CScript()));
+    const CInputCoin confirmed(COutPoint(InsecureRand256(), 0), CTxOut(10 * COIN, CScript()));
+
+    int nSelectCalls = 0;
+    CAmount nSelectTarget = 0;
+    std::set<CInputCoin> setExcluded;
+    auto selectConfirmed = [&](const CAmount& nTarget, const std::set<CInputCoin>& setCoins, std::set<CInputCoin>& setSelected, CAmount& nSelected) {
+        nSelectCalls++;
+        nSelectTarget = nTarget;
+        setExcluded = setCoins;
+        if (nTarget > confirmed.txout.nValue)
+            return false;
+        setSelected.insert(confirmed);
+        nSelected = confirmed.txout.nValue;
+        return true;
+    };
+
+    // The coins to reuse and the change cover the deposit, no confirmed coins are added
+    std::set<CInputCoin> setCoins;
+    CAmount nValueIn = 0;
+    BOOST_CHECK(ChooseQueuedDepositCoins({coinA, coinB}, &change, 5 * COIN, selectConfirmed, setCoins, nValueIn));
+    BOOST_CHECK_EQUAL(nSelectCalls, 0);
+    BOOST_CHECK_EQUAL(setCoins.size(), 3U);
+    BOOST_CHECK_EQUAL(nValueIn, 6 * COIN);
+
+    // A coin given twice counts once
+    BOOST_CHECK(ChooseQueuedDepositCoins({coinA, coinA}, &coinA, 2 * COIN, selectConfirmed, setCoins, nValueIn));
+    BOOST_CHECK_EQUAL(setCoins.size(), 1U);
+    BOOST_CHECK_EQUAL(nValueIn, 2 * COIN);
+    BOOST_CHECK_EQUAL(nSelectCalls, 0);
+
+    // Confirmed coins cover the rest, other than the coins already chosen
+    BOOST_CHECK(ChooseQueuedDepositCoins({coinA}, &change, 8 * COIN, selectConfirmed, setCoins, nValueIn));
+    BOOST_CHECK_EQUAL(nSelectCalls, 1);
+    BOOST_CHECK_EQUAL(nSelectTarget, 5 * COIN);
+    BOOST_CHECK(setExcluded == std::set<CInputCoin>({coinA, change}));
+    BOOST_CHECK(setCoins == std::set<CInputCoin>({coinA, change, confirmed}));
+    BOOST_CHECK_EQUAL(nValueIn, 13 * COIN);
+
+    // Not enough confirmed coins
+    BOOST_CHECK(!ChooseQueuedDepositCoins({}, nullptr, 11 * COIN, selectConfirmed, setCoins, nValueIn));
+    BOOST_CHECK_EQUAL(nSelectCalls, 2);
+    BOOST_CHECK_EQUAL(nSelectTarget, 11 * COIN);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
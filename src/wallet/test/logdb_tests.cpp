@@ -0,0 +1,233 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/db.h>
+#include <wallet/logdb.h>
+#include <wallet/test/wallet_test_fixture.h>
+#include <wallet/walletdb.h>
+#include <wallet/walletutil.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(logdb_tests, WalletTestingSetup)
+
+static CWalletLogDB::Data Bytes(const std::string& str)
+{
+    return CWalletLogDB::Data(str.begin(), str.end());
+}
+
+static std::string String(const CWalletLogDB::Data& data)
+{
+    return std::string(data.begin(), data.end());
+}
+
+BOOST_AUTO_TEST_CASE(log_records)
+{
+    fs::path path = GetDataDir() / "test.log";
+    std::string strError;
+    CWalletLogDB::Data value;
+    {
+        CWalletLogDB logdb(path);
+        BOOST_CHECK(!logdb.Open(false, strError));
+        BOOST_REQUIRE_MESSAGE(logdb.Open(true, strError), strError);
+        BOOST_CHECK(CWalletLogDB::IsLogFile(path));
+
+        BOOST_CHECK(logdb.Apply({{false, Bytes("a"), Bytes("1")}, {false, Bytes("b"), Bytes("2")}}, true));
+        BOOST_CHECK(logdb.Apply({{true, Bytes("a"), {}}, {false, Bytes("c"), Bytes("3")}}, true));
+        uint64_t nSize = logdb.GetFileSize();
+
+        // Writes outside of a batch wait for a flush
+        BOOST_CHECK(logdb.Apply({{false, Bytes("b"), Bytes("4")}}, false));
+        BOOST_CHECK(logdb.Read(Bytes("b"), value));
+        BOOST_CHECK_EQUAL(String(value), "4");
+        BOOST_CHECK_EQUAL(logdb.GetFileSize(), nSize);
+        BOOST_CHECK(logdb.Flush(false));
+        BOOST_CHECK(logdb.GetFileSize() > nSize);
+
+        // Records are in key order
+        CWalletLogDB::Data key;
+        BOOST_CHECK(logdb.Seek(Bytes(""), true, key, value));
+        BOOST_CHECK_EQUAL(String(key), "b");
+        BOOST_CHECK(logdb.Seek(key, false, key, value));
+        BOOST_CHECK_EQUAL(String(key), "c");
+        BOOST_CHECK(!logdb.Seek(key, false, key, value));
+    }
+
+    {
+        CWalletLogDB logdb(path);
+        BOOST_REQUIRE_MESSAGE(logdb.Open(false, strError), strError);
+        BOOST_CHECK(!logdb.Exists(Bytes("a")));
+        BOOST_CHECK(logdb.Read(Bytes("b"), value));
+        BOOST_CHECK_EQUAL(String(value), "4");
+        BOOST_CHECK(logdb.Read(Bytes("c"), value));
+        BOOST_CHECK_EQUAL(String(value), "3");
+        BOOST_CHECK(logdb.Apply({{false, Bytes("d"), Bytes("5")}}, true));
+    }
+
+    // A batch cut short at the end of the file is dropped
+    uint64_t nSize = fs::file_size(path);
+    fs::resize_file(path, nSize - 1);
+    {
+        CWalletLogDB logdb(path);
+        BOOST_REQUIRE_MESSAGE(logdb.Open(false, strError), strError);
+        BOOST_CHECK(!logdb.Exists(Bytes("d")));
+        BOOST_CHECK(logdb.Exists(Bytes("c")));
+        BOOST_CHECK(logdb.GetFileSize() < nSize - 1);
+        BOOST_CHECK_EQUAL(fs::file_size(path), logdb.GetFileSize());
+    }
+
+    // A batch that doesn't match its checksum in the middle of the file is an error
+    {
+        FILE* file = fsbridge::fopen(path, "rb+");
+        BOOST_REQUIRE(file);
+        BOOST_REQUIRE_EQUAL(fseek(file, 20, SEEK_SET), 0);
+        int ch = fgetc(file);
+        BOOST_REQUIRE_EQUAL(fseek(file, -1, SEEK_CUR), 0);
+        fputc(ch ^ 1, file);
+        fclose(file);
+    }
+    {
+        CWalletLogDB logdb(path);
+        BOOST_CHECK(!logdb.Open(false, strError));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(log_compact)
+{
+    fs::path path = GetDataDir() / "test.log";
+    std::string strError;
+    CWalletLogDB logdb(path);
+    BOOST_REQUIRE_MESSAGE(logdb.Open(true, strError), strError);
+
+    for (int i = 0; i < 100; i++) {
+        std::vector<CWalletLogDB::Op> vOps;
+        for (int n = 0; n < 10; n++)
+            vOps.emplace_back(false, Bytes(strprintf("key%d", n)), Bytes(strprintf("value%d", i)));
+        vOps.emplace_back(false, Bytes("\x04pool"), Bytes("pool"));
+        BOOST_CHECK(logdb.Apply(vOps, true));
+    }
+    uint64_t nSize = logdb.GetFileSize();
+    BOOST_CHECK(logdb.Compact("\x04pool"));
+    BOOST_CHECK(logdb.GetFileSize() < nSize / 50);
+    BOOST_CHECK(!logdb.Exists(Bytes("\x04pool")));
+
+    // The compacted log is read back the same
+    BOOST_CHECK(logdb.Apply({{false, Bytes("key0"), Bytes("new")}}, true));
+    CWalletLogDB logdbCopy(path);
+    BOOST_REQUIRE_MESSAGE(logdbCopy.Open(false, strError), strError);
+    CWalletLogDB::Data value;
+    BOOST_CHECK(logdbCopy.Read(Bytes("key0"), value));
+    BOOST_CHECK_EQUAL(String(value), "new");
+    BOOST_CHECK(logdbCopy.Read(Bytes("key9"), value));
+    BOOST_CHECK_EQUAL(String(value), "value99");
+    BOOST_CHECK(!logdbCopy.Exists(Bytes("\x04pool")));
+
+    // So is a backup
+    BOOST_CHECK(logdb.Backup(GetDataDir() / "backup.log"));
+    CWalletLogDB logdbBackup(GetDataDir() / "backup.log");
+    BOOST_REQUIRE_MESSAGE(logdbBackup.Open(false, strError), strError);
+    BOOST_CHECK(logdbBackup.Read(Bytes("key0"), value));
+    BOOST_CHECK_EQUAL(String(value), "new");
+}
+
+BOOST_AUTO_TEST_CASE(log_walletdb)
+{
+    CWalletDBWrapper dbw(&bitdb, "wallet_test.log", WALLETDB_LOG);
+    BOOST_CHECK(dbw.GetFormat() == WALLETDB_LOG);
+    {
+        CWalletDB walletdb(dbw, "cr+");
+        BOOST_CHECK(walletdb.WriteName("address1", "name1"));
+        BOOST_CHECK(walletdb.WriteOrderPosNext(7));
+
+        // The changes of a transaction are seen by it, and only written when
+        // it is committed
+        BOOST_CHECK(walletdb.TxnBegin());
+        BOOST_CHECK(walletdb.WriteName("address2", "name2"));
+        BOOST_CHECK(walletdb.WriteMinVersion(FEATURE_HD));
+        BOOST_CHECK(walletdb.EraseName("address1"));
+        BOOST_CHECK(walletdb.TxnAbort());
+
+        BOOST_CHECK(walletdb.TxnBegin());
+        CAccountingEntry entry;
+        entry.strAccount = "account";
+        entry.nCreditDebit = 5 * COIN;
+        entry.nOrderPos = 4;
+        BOOST_CHECK(walletdb.WriteAccountingEntry(1, entry));
+        entry.nCreditDebit = -2 * COIN;
+        entry.nOrderPos = 5;
+        BOOST_CHECK(walletdb.WriteAccountingEntry(2, entry));
+        entry.strAccount = "other";
+        entry.nOrderPos = 6;
+        BOOST_CHECK(walletdb.WriteAccountingEntry(3, entry));
+        BOOST_CHECK(walletdb.TxnCommit());
+
+        BOOST_CHECK_EQUAL(walletdb.GetAccountCreditDebit("account"), 3 * COIN);
+        BOOST_CHECK_EQUAL(walletdb.GetAccountCreditDebit("*"), 1 * COIN);
+    }
+    dbw.Flush(false);
+    BOOST_CHECK(CWalletLogDB::IsLogFile(GetWalletDir() / "wallet_test.log"));
+    BOOST_CHECK(GetWalletDBFormat("wallet_test.log") == WALLETDB_LOG);
+
+    // The wallet loads from the log
+    CWallet wallet(std::unique_ptr<CWalletDBWrapper>(new CWalletDBWrapper(&bitdb, "wallet_test.log", WALLETDB_LOG)));
+    bool fFirstRun;
+    BOOST_CHECK_EQUAL(wallet.LoadWallet(fFirstRun), DB_LOAD_OK);
+    {
+        LOCK(wallet.cs_wallet);
+        BOOST_CHECK_EQUAL(wallet.mapAddressBook.size(), 1U);
+        BOOST_CHECK_EQUAL(wallet.nOrderPosNext, 7);
+        BOOST_CHECK(wallet.GetVersion() != FEATURE_HD);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(log_migrate)
+{
+    // Migrations replace wallet files, which the mock environment doesn't have
+    bitdb.Flush(true);
+    bitdb.Reset();
+
+    {
+        CWalletDBWrapper dbw(&bitdb, "wallet_migrate.dat", WALLETDB_BDB);
+        CWalletDB walletdb(dbw, "cr+");
+        BOOST_CHECK(walletdb.WriteName("address1", "name1"));
+        BOOST_CHECK(walletdb.WriteName("address2", "name2"));
+        BOOST_CHECK(walletdb.WriteOrderPosNext(9));
+    }
+    bitdb.Flush(false);
+    BOOST_CHECK(GetWalletDBFormat("wallet_migrate.dat") == WALLETDB_BDB);
+
+    // The records are copied to a log, the original is kept as a backup
+    std::string strError;
+    BOOST_CHECK_MESSAGE(CWalletDB::MigrateDatabaseFile("wallet_migrate.dat", WALLETDB_LOG, strError), strError);
+    BOOST_CHECK(GetWalletDBFormat("wallet_migrate.dat") == WALLETDB_LOG);
+    BOOST_CHECK(fs::exists(GetWalletDir() / "wallet_migrate.dat.bdb.bak"));
+    BOOST_CHECK(!fs::exists(GetWalletDir() / "wallet_migrate.dat.migrate"));
+    {
+        CWallet wallet(std::unique_ptr<CWalletDBWrapper>(new CWalletDBWrapper(&bitdb, "wallet_migrate.dat", WALLETDB_LOG)));
+        bool fFirstRun;
+        BOOST_CHECK_EQUAL(wallet.LoadWallet(fFirstRun), DB_LOAD_OK);
+        LOCK(wallet.cs_wallet);
+        BOOST_CHECK_EQUAL(wallet.mapAddressBook.size(), 2U);
+        BOOST_CHECK_EQUAL(wallet.nOrderPosNext, 9);
+    }
+
+    // Another migration to the same format doesn't overwrite the backup
+    BOOST_CHECK(CWalletDB::MigrateDatabaseFile("wallet_migrate.dat", WALLETDB_LOG, strError));
+    BOOST_CHECK(GetWalletDBFormat("wallet_migrate.dat") == WALLETDB_LOG);
+
+    // And back to Berkeley DB
+    BOOST_CHECK_MESSAGE(CWalletDB::MigrateDatabaseFile("wallet_migrate.dat", WALLETDB_BDB, strError), strError);
+    BOOST_CHECK(GetWalletDBFormat("wallet_migrate.dat") == WALLETDB_BDB);
+    BOOST_CHECK(fs::exists(GetWalletDir() / "wallet_migrate.dat.log.bak"));
+    {
+        CWallet wallet(std::unique_ptr<CWalletDBWrapper>(new CWalletDBWrapper(&bitdb, "wallet_migrate.dat", WALLETDB_BDB)));
+        bool fFirstRun;
+        BOOST_CHECK_EQUAL(wallet.LoadWallet(fFirstRun), DB_LOAD_OK);
+        LOCK(wallet.cs_wallet);
+        BOOST_CHECK_EQUAL(wallet.mapAddressBook.size(), 2U);
+        BOOST_CHECK_EQUAL(wallet.nOrderPosNext, 9);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,16 +4,22 @@
 
 #include <wallet/wallet.h>
 
+#include <algorithm>
 #include <set>
 #include <stdint.h>
 #include <utility>
 #include <vector>
 
+#include <base58.h>
 #include <consensus/validation.h>
+#include <policy/policy.h>
 #include <rpc/server.h>
+#include <sidechain.h>
+#include <sidechaindb.h>
 #include <test/test_drivechain.h>
 #include <validation.h>
 #include <wallet/coincontrol.h>
+#include <wallet/coinsplit.h>
 #include <wallet/test/wallet_test_fixture.h>
 
 #include <boost/test/unit_test.hpp>
@@ -22,6 +28,7 @@
 extern UniValue importmulti(const JSONRPCRequest& request);
 extern UniValue dumpwallet(const JSONRPCRequest& request);
 extern UniValue importwallet(const JSONRPCRequest& request);
+extern UniValue importprivkey(const JSONRPCRequest& request);
 
 // how many times to run all the tests to have a chance to catch errors that only show up with particular random shuffles
 #define RUN_TESTS 100
@@ -585,6 +592,503 @@ BOOST_AUTO_TEST_CASE(ComputeTimeSmart)
     SetMockTime(0);
 }
 
+BOOST_AUTO_TEST_CASE(ScheduledTransactions)
+{
+    CWallet wallet;
+    wallet.SetBroadcastTransactions(true);
+
+    std::vector<uint256> vHash;
+    for (uint32_t i = 0; i < 3; i++) {
+        CMutableTransaction tx;
+        tx.nLockTime = i;
+        CWalletTx wtx(&wallet, MakeTransactionRef(tx));
+        wallet.AddToWallet(wtx);
+        vHash.push_back(wtx.GetHash());
+    }
+
+    BOOST_CHECK(wallet.ScheduleTransaction(vHash[0], 300));
+    BOOST_CHECK(wallet.ScheduleTransaction(vHash[1], 100));
+    BOOST_CHECK(wallet.ScheduleTransaction(vHash[2], 200));
+
+    // Transactions already scheduled or not in the wallet can't be scheduled
+    BOOST_CHECK(!wallet.ScheduleTransaction(vHash[0], 400));
+    BOOST_CHECK(!wallet.ScheduleTransaction(GetRandHash(), 400));
+
+    std::vector<ScheduledTransaction> vScheduled = wallet.GetScheduled();
+    BOOST_REQUIRE_EQUAL(vScheduled.size(), 3U);
+    BOOST_CHECK(vScheduled[0].wtxid == vHash[1]);
+    BOOST_CHECK(vScheduled[1].wtxid == vHash[2]);
+    BOOST_CHECK(vScheduled[2].wtxid == vHash[0]);
+
+    BOOST_CHECK(wallet.CancelScheduledTransaction(vHash[2]));
+    BOOST_CHECK(!wallet.CancelScheduledTransaction(vHash[2]));
+    {
+        LOCK(wallet.cs_wallet);
+        BOOST_CHECK(!wallet.IsScheduled(vHash[2]));
+        BOOST_CHECK(wallet.mapWallet.at(vHash[2]).isAbandoned());
+    }
+
+    // Only transactions that are due leave the schedule, including the ones
+    // rejected by the mempool
+    SetMockTime(250);
+    wallet.BroadcastScheduledTransactions();
+    {
+        LOCK(wallet.cs_wallet);
+        BOOST_CHECK(!wallet.IsScheduled(vHash[1]));
+        BOOST_CHECK(wallet.IsScheduled(vHash[0]));
+    }
+    BOOST_CHECK_EQUAL(wallet.GetScheduled().size(), 1U);
+
+    SetMockTime(0);
+}
+
+BOOST_AUTO_TEST_CASE(DenyCoins)
+{
+    // An unconfirmed coin paying to the wallet
+    CKey key;
+    key.MakeNewKey(true);
+    pwalletMain->AddKeyPubKey(key, key.GetPubKey());
+    CMutableTransaction tx;
+    tx.vout.push_back(CTxOut(10 * COIN, GetScriptForDestination(key.GetPubKey().GetID())));
+    CWalletTx wtxFund(pwalletMain.get(), MakeTransactionRef(tx));
+    pwalletMain->AddToWallet(wtxFund);
+
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+    const CWalletTx& wtxCoin = pwalletMain->mapWallet.at(wtxFund.GetHash());
+    std::vector<COutput> vCoins{COutput(&wtxCoin, 0, 0, true, true, true)};
+
+    // Coins at the goal aren't denied
+    std::vector<ScheduledTransaction> vScheduled;
+    std::string strFail;
+    BOOST_CHECK(!pwalletMain->DenyCoins(vCoins, 0, 1000, vScheduled, strFail));
+    BOOST_CHECK(vScheduled.empty());
+
+    // The coin is denied once, then both outputs of its denial are denied
+    BOOST_REQUIRE_MESSAGE(pwalletMain->DenyCoins(vCoins, 2, 1000, vScheduled, strFail), strFail);
+    BOOST_REQUIRE_EQUAL(vScheduled.size(), 3U);
+    BOOST_CHECK(pwalletMain->IsSpent(wtxCoin.GetHash(), 0));
+    BOOST_CHECK_EQUAL(pwalletMain->GetScheduled().size(), 3U);
+
+    std::map<uint256, int64_t> mapTime;
+    for (const ScheduledTransaction& scheduled : vScheduled)
+        mapTime[scheduled.wtxid] = scheduled.nTime;
+
+    for (const ScheduledTransaction& scheduled : vScheduled) {
+        BOOST_CHECK(pwalletMain->IsScheduled(scheduled.wtxid));
+        const CWalletTx& wtx = pwalletMain->mapWallet.at(scheduled.wtxid);
+        BOOST_REQUIRE_EQUAL(wtx.tx->vin.size(), 1U);
+        const COutPoint& prevout = wtx.tx->vin[0].prevout;
+        if (prevout.hash == wtxCoin.GetHash()) {
+            BOOST_CHECK_EQUAL(wtx.nDenial, 1U);
+        } else {
+            // Broadcast after the transaction it spends
+            BOOST_CHECK_EQUAL(wtx.nDenial, 2U);
+            BOOST_REQUIRE(mapTime.count(prevout.hash));
+            BOOST_CHECK(mapTime[prevout.hash] < scheduled.nTime);
+        }
+
+        const CTxOut& txout = pwalletMain->mapWallet.at(prevout.hash).tx->vout[prevout.n];
+        ScriptError serror;
+        BOOST_CHECK(VerifyScript(wtx.tx->vin[0].scriptSig, txout.scriptPubKey, &wtx.tx->vin[0].scriptWitness, STANDARD_SCRIPT_VERIFY_FLAGS, TransactionSignatureChecker(wtx.tx.get(), 0, txout.nValue), &serror));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(AvailableCoinsIndex)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    pwalletMain->AddKeyPubKey(key, key.GetPubKey());
+    const CScript script = GetScriptForDestination(key.GetPubKey().GetID());
+
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+
+    // An unconfirmed coin in the mempool
+    CMutableTransaction tx;
+    tx.vout.push_back(CTxOut(COIN, script));
+    CWalletTx wtxCoin(pwalletMain.get(), MakeTransactionRef(tx));
+    wtxCoin.fInMempool = true;
+    pwalletMain->AddToWallet(wtxCoin);
+
+    std::vector<COutput> vCoins;
+    pwalletMain->AvailableCoins(vCoins, false /* fOnlySafe */);
+    BOOST_REQUIRE_EQUAL(vCoins.size(), 1U);
+    BOOST_CHECK(vCoins[0].tx->GetHash() == wtxCoin.GetHash());
+
+    // The coin is spent by a transaction that was never broadcast
+    CMutableTransaction txSpend;
+    txSpend.vin.push_back(CTxIn(wtxCoin.GetHash(), 0));
+    txSpend.vout.push_back(CTxOut(COIN / 2, script));
+    CWalletTx wtxSpend(pwalletMain.get(), MakeTransactionRef(txSpend));
+    pwalletMain->AddToWallet(wtxSpend);
+    pwalletMain->AvailableCoins(vCoins, false /* fOnlySafe */);
+    BOOST_CHECK(vCoins.empty());
+
+    // Abandoning the spend makes the coin available again
+    BOOST_REQUIRE(pwalletMain->AbandonTransaction(wtxSpend.GetHash()));
+    pwalletMain->AvailableCoins(vCoins, false /* fOnlySafe */);
+    BOOST_REQUIRE_EQUAL(vCoins.size(), 1U);
+    BOOST_CHECK(vCoins[0].tx->GetHash() == wtxCoin.GetHash());
+
+    // A rebuilt index has the same coins
+    pwalletMain->MarkDirty();
+    pwalletMain->AvailableCoins(vCoins, false /* fOnlySafe */);
+    BOOST_CHECK_EQUAL(vCoins.size(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(AvailableCoinsIndexConflicted)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    pwalletMain->AddKeyPubKey(key, key.GetPubKey());
+    const CScript script = GetScriptForDestination(key.GetPubKey().GetID());
+
+    // A coin in the mempool and a spend of it that also spends an output of someone else
+    CMutableTransaction tx;
+    tx.vout.push_back(CTxOut(COIN, script));
+    CWalletTx wtxCoin(pwalletMain.get(), MakeTransactionRef(tx));
+    wtxCoin.fInMempool = true;
+    const COutPoint outOther(GetRandHash(), 0);
+    CMutableTransaction txSpend;
+    txSpend.vin.push_back(CTxIn(wtxCoin.GetHash(), 0));
+    txSpend.vin.push_back(CTxIn(outOther));
+    txSpend.vout.push_back(CTxOut(COIN / 2, CScript() << OP_TRUE));
+    CWalletTx wtxSpend(pwalletMain.get(), MakeTransactionRef(txSpend));
+    {
+        LOCK2(cs_main, pwalletMain->cs_wallet);
+        pwalletMain->AddToWallet(wtxCoin);
+        pwalletMain->AddToWallet(wtxSpend);
+
+        std::vector<COutput> vCoins;
+        pwalletMain->AvailableCoins(vCoins, false /* fOnlySafe */);
+        BOOST_CHECK(vCoins.empty());
+    }
+
+    // A block spending the other output conflicts the spend, which makes the coin available again
+    CMutableTransaction txConflict;
+    txConflict.vin.push_back(CTxIn(outOther));
+    txConflict.vout.push_back(CTxOut(COIN / 2, CScript() << OP_TRUE));
+    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+    pblock->vtx.push_back(MakeTransactionRef(txConflict));
+    pwalletMain->BlockConnected(pblock, chainActive.Tip(), {});
+
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+    BOOST_CHECK(pwalletMain->mapWallet.at(wtxSpend.GetHash()).GetDepthInMainChain() < 0);
+    std::vector<COutput> vCoins;
+    pwalletMain->AvailableCoins(vCoins, false /* fOnlySafe */);
+    BOOST_REQUIRE_EQUAL(vCoins.size(), 1U);
+    BOOST_CHECK(vCoins[0].tx->GetHash() == wtxCoin.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(AvailableCoinsIndexImport)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript script = GetScriptForDestination(key.GetPubKey().GetID());
+
+    // A transaction in the wallet paying to a key it doesn't have yet
+    CMutableTransaction tx;
+    tx.vout.push_back(CTxOut(COIN, script));
+    CWalletTx wtxCoin(pwalletMain.get(), MakeTransactionRef(tx));
+    wtxCoin.fInMempool = true;
+    {
+        LOCK2(cs_main, pwalletMain->cs_wallet);
+        pwalletMain->AddToWallet(wtxCoin);
+
+        std::vector<COutput> vCoins;
+        pwalletMain->AvailableCoins(vCoins, false /* fOnlySafe */);
+        BOOST_CHECK(vCoins.empty());
+    }
+
+    // Importing the key marks the wallet dirty, the coin is found without a rescan
+    JSONRPCRequest request;
+    request.params.setArray();
+    request.params.push_back(CBitcoinSecret(key).ToString());
+    request.params.push_back("");
+    request.params.push_back(UniValue(false));
+    vpwallets.insert(vpwallets.begin(), pwalletMain.get());
+    importprivkey(request);
+    vpwallets.erase(vpwallets.begin());
+
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+    std::vector<COutput> vCoins;
+    pwalletMain->AvailableCoins(vCoins, false /* fOnlySafe */);
+    BOOST_REQUIRE_EQUAL(vCoins.size(), 1U);
+    BOOST_CHECK(vCoins[0].tx->GetHash() == wtxCoin.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(QueuedDepositRecords)
+{
+    std::vector<QueuedDeposit> vDeposit;
+    for (int64_t nOrderPos : {5, 2, 9, 7}) {
+        QueuedDeposit deposit;
+        deposit.nSidechain = nOrderPos == 7 ? 1 : 0;
+        deposit.sidechainScriptPubKey = CScript() << OP_TRUE;
+        deposit.nAmount = nOrderPos * COIN;
+        deposit.nFee = 1000;
+        deposit.strDest = "dest" + std::to_string(nOrderPos);
+        deposit.nOrderPos = nOrderPos;
+        deposit.nTimeQueued = 100 + nOrderPos;
+        deposit.id = SerializeHash(deposit);
+        vDeposit.push_back(deposit);
+    }
+    // Only the txid of a submitted deposit is written
+    vDeposit[1].txid = GetRandHash();
+    vDeposit[1].tx = MakeTransactionRef(CMutableTransaction());
+
+    {
+        CWalletDB walletdb(pwalletMain->GetDBHandle());
+        for (const QueuedDeposit& deposit : vDeposit)
+            BOOST_CHECK(walletdb.WriteQueuedDeposit(deposit));
+        BOOST_CHECK(walletdb.EraseQueuedDeposit(vDeposit[2].id));
+    }
+
+    // The deposits are loaded in queue order by sidechain, without the erased one
+    CWallet wallet(std::unique_ptr<CWalletDBWrapper>(new CWalletDBWrapper(&bitdb, "wallet_test.dat")));
+    bool fFirstRun;
+    BOOST_CHECK_EQUAL(wallet.LoadWallet(fFirstRun), DB_LOAD_OK);
+    std::vector<QueuedDeposit> vLoaded = wallet.GetQueuedDeposits();
+    BOOST_REQUIRE_EQUAL(vLoaded.size(), 3U);
+    BOOST_CHECK(vLoaded[0].id == vDeposit[1].id);
+    BOOST_CHECK(vLoaded[1].id == vDeposit[0].id);
+    BOOST_CHECK(vLoaded[2].id == vDeposit[3].id);
+
+    const QueuedDeposit& loaded = vLoaded[0];
+    BOOST_CHECK(loaded.nSidechain == 0);
+    BOOST_CHECK(loaded.sidechainScriptPubKey == vDeposit[1].sidechainScriptPubKey);
+    BOOST_CHECK_EQUAL(loaded.nAmount, vDeposit[1].nAmount);
+    BOOST_CHECK_EQUAL(loaded.nFee, vDeposit[1].nFee);
+    BOOST_CHECK_EQUAL(loaded.strDest, vDeposit[1].strDest);
+    BOOST_CHECK_EQUAL(loaded.nOrderPos, vDeposit[1].nOrderPos);
+    BOOST_CHECK_EQUAL(loaded.nTimeQueued, vDeposit[1].nTimeQueued);
+    BOOST_CHECK(loaded.txid == vDeposit[1].txid);
+    BOOST_CHECK(!loaded.tx);
+    BOOST_CHECK(vLoaded[1].txid.IsNull());
+    BOOST_CHECK(vLoaded[2].nSidechain == 1);
+}
+
+/** Add a coin of nValue paying to a new key of the wallet, confirmed in the genesis block, to the wallet and to the UTXO set if fUTXO */
+static uint256 AddConfirmedCoin(CWallet& wallet, const CAmount& nValue, bool fUTXO = true)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    wallet.AddKeyPubKey(key, key.GetPubKey());
+
+    CMutableTransaction tx;
+    tx.nLockTime = InsecureRand32();
+    tx.vout.push_back(CTxOut(nValue, GetScriptForDestination(key.GetPubKey().GetID())));
+    CWalletTx wtx(&wallet, MakeTransactionRef(tx));
+
+    LOCK2(cs_main, wallet.cs_wallet);
+    wtx.SetMerkleBranch(chainActive.Genesis(), 0);
+    wallet.AddToWallet(wtx);
+    if (fUTXO)
+        pcoinsTip->AddCoin(COutPoint(wtx.GetHash(), 0), Coin(tx.vout[0], 0, false), false);
+    return wtx.GetHash();
+}
+
+BOOST_AUTO_TEST_CASE(SplitCoins)
+{
+    // Split transactions are replay protected, which isn't standard
+    const bool fRequireStandardPrev = fRequireStandard;
+    fRequireStandard = false;
+    pwalletMain->SetBroadcastTransactions(true);
+
+    // The larger coin isn't in the UTXO set, so the root of its split is rejected
+    const uint256 hashMissing = AddConfirmedCoin(*pwalletMain, 20 * COIN, false);
+    const uint256 hashCoin = AddConfirmedCoin(*pwalletMain, 10 * COIN);
+    std::vector<COutput> vCoins;
+    {
+        LOCK2(cs_main, pwalletMain->cs_wallet);
+        vCoins.emplace_back(&pwalletMain->mapWallet.at(hashMissing), 0, 1, true, true, true);
+        vCoins.emplace_back(&pwalletMain->mapWallet.at(hashCoin), 0, 1, true, true, true);
+    }
+
+    // At most 2 outputs per transaction, so the split of the larger coin takes a tree
+    const CAmount nAmount = 6 * COIN;
+    std::vector<PlannedSplitTx> vPlan;
+    std::vector<CTransactionRef> vtx;
+    CAmount nFee = 0;
+    std::string strFail;
+    // Dust outputs aren't planned
+    BOOST_CHECK(!pwalletMain->SplitCoins(vCoins, 4, 100, 2, vPlan, vtx, nFee, strFail, true));
+    BOOST_CHECK_EQUAL(strFail, "Split amount is too small!\n");
+    BOOST_CHECK(vPlan.empty());
+
+    BOOST_CHECK(!pwalletMain->SplitCoins(vCoins, 4, nAmount, 2, vPlan, vtx, nFee, strFail));
+    BOOST_CHECK(strFail.find("rejected") != std::string::npos);
+    BOOST_CHECK(nFee > 0);
+    BOOST_REQUIRE(std::any_of(vPlan.begin(), vPlan.end(), [](const PlannedSplitTx& planned) {
+        return planned.nParent >= 0 && planned.nCoin == 0;
+    }));
+
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+    std::map<COutPoint, const CWalletTx*> mapSpender;
+    for (const std::pair<const uint256, CWalletTx>& item : pwalletMain->mapWallet) {
+        for (const CTxIn& txin : item.second.tx->vin)
+            mapSpender[txin.prevout] = &item.second;
+    }
+
+    // Every planned transaction was created, spending its coin or the output of its parent
+    std::vector<const CWalletTx*> vPlanned(vPlan.size());
+    unsigned int nSplitOutputs = 0;
+    size_t nAccepted = 0;
+    for (size_t i = 0; i < vPlan.size(); i++) {
+        const PlannedSplitTx& planned = vPlan[i];
+        COutPoint prevout(vCoins[planned.nCoin].tx->GetHash(), 0);
+        if (planned.nParent >= 0) {
+            const PlannedSplitTx& parent = vPlan[planned.nParent];
+            const size_t nChild = std::find(parent.vChildren.begin(), parent.vChildren.end(), i) - parent.vChildren.begin();
+            BOOST_REQUIRE(nChild < parent.vChildren.size());
+            prevout = COutPoint(vPlanned[planned.nParent]->GetHash(), parent.nSplitOutputs + nChild);
+        }
+        BOOST_REQUIRE(mapSpender.count(prevout));
+        const CWalletTx& wtx = *(vPlanned[i] = mapSpender[prevout]);
+
+        BOOST_CHECK_EQUAL(wtx.tx->nVersion, TX_REPLAY_VERSION);
+        BOOST_CHECK_EQUAL(wtx.tx->vin.size(), 1U);
+        BOOST_CHECK_EQUAL(wtx.tx->vout.size(), planned.nSplitOutputs + planned.vChildren.size() + (planned.nParent < 0 ? 1 : 0));
+        for (unsigned int n = 0; n < planned.nSplitOutputs; n++) {
+            BOOST_CHECK_EQUAL(wtx.tx->vout[n].nValue, nAmount);
+            BOOST_CHECK(pwalletMain->IsMine(wtx.tx->vout[n]) & ISMINE_SPENDABLE);
+        }
+        nSplitOutputs += planned.nSplitOutputs;
+
+        // The split of the missing coin is abandoned without submitting the
+        // children of the rejected root, the other split is accepted
+        if (planned.nCoin == 0) {
+            BOOST_CHECK(wtx.isAbandoned());
+            BOOST_CHECK(!mempool.exists(wtx.GetHash()));
+        } else {
+            BOOST_CHECK(!wtx.isAbandoned());
+            BOOST_CHECK(mempool.exists(wtx.GetHash()));
+            BOOST_CHECK(std::find_if(vtx.begin(), vtx.end(), [&wtx](const CTransactionRef& tx) {
+                return tx->GetHash() == wtx.GetHash();
+            }) != vtx.end());
+            nAccepted++;
+        }
+    }
+    BOOST_CHECK_EQUAL(nSplitOutputs, 4U);
+    BOOST_CHECK_EQUAL(vtx.size(), nAccepted);
+
+    mempool.clear();
+    fRequireStandard = fRequireStandardPrev;
+}
+
+/** Add a BMM request for sidechain 0 on the tip to the mempool that bids nBid, half with its fee */
+static CTransactionRef AddCompetingBMMRequest(const CAmount& nBid)
+{
+    CScript bytes;
+    bytes.resize(4);
+    bytes[0] = 0x00;
+    bytes[1] = 0xbf;
+    bytes[2] = 0x00;
+    bytes[3] = uint8_t(0);
+    std::string strPrevBlock = chainActive.Tip()->GetBlockHash().ToString();
+    std::vector<unsigned char> vPrevBytes = ParseHex(strPrevBlock.substr(strPrevBlock.size() - 8));
+    bytes.insert(bytes.end(), vPrevBytes.begin(), vPrevBytes.end());
+
+    CMutableTransaction mtx;
+    mtx.nVersion = 3;
+    mtx.vin.push_back(CTxIn(COutPoint(GetRandHash(), 0)));
+    mtx.vout.push_back(CTxOut(nBid - nBid / 2, CScript() << OP_TRUE));
+    mtx.nLockTime = chainActive.Height() + 1;
+    mtx.criticalData.vBytes = ToByteVector(bytes);
+    mtx.criticalData.hashCritical = GetRandHash();
+    CTransactionRef tx = MakeTransactionRef(mtx);
+
+    TestMemPoolEntryHelper entry;
+    LOCK(mempool.cs);
+    mempool.addUnchecked(tx->GetHash(), entry.Fee(nBid / 2).FromTx(*tx));
+    return tx;
+}
+
+BOOST_AUTO_TEST_CASE(BMMBidderRebid)
+{
+    Sidechain proposal;
+    proposal.nSidechain = 0;
+    proposal.nVersion = 0;
+    proposal.title = "test";
+    proposal.description = "description";
+    proposal.hashID1 = GetRandHash();
+    proposal.hashID2 = uint160S("31d98584f3c570961359c308619f5cf2e9178482");
+    BOOST_REQUIRE(ActivateSidechain(scdb, proposal, 0));
+
+    pwalletMain->SetBroadcastTransactions(true);
+    AddConfirmedCoin(*pwalletMain, 10 * COIN);
+
+    auto GetBidder = [this]() {
+        std::vector<BMMBidder> vBidder = pwalletMain->GetBMMBidders();
+        BOOST_REQUIRE_EQUAL(vBidder.size(), 1U);
+        return vBidder[0];
+    };
+
+    // The bidder bids on the tip once
+    const CAmount nAmount = 10 * CENT;
+    const CAmount nMaxBid = 20 * CENT;
+    BMMBidder bidder;
+    std::string strFail;
+    BOOST_REQUIRE_MESSAGE(pwalletMain->SetBMMBidder(bidder, strFail, 0, GetRandHash(), nAmount, nMaxBid), strFail);
+    pwalletMain->UpdatedBlockTip(chainActive.Tip(), nullptr, false);
+    pwalletMain->UpdatedBlockTip(chainActive.Tip(), nullptr, false);
+    bidder = GetBidder();
+    BOOST_REQUIRE_MESSAGE(bidder.vBidTxid.size() == 1, bidder.strError);
+    BOOST_CHECK(bidder.hashBidBlock == chainActive.Tip()->GetBlockHash());
+    BOOST_CHECK(mempool.exists(bidder.vBidTxid[0]));
+    BOOST_CHECK(bidder.nBid > nAmount);
+    BOOST_CHECK(bidder.nBid < nMaxBid);
+
+    // Outbid within the budget, the fee of the bid is bumped over the competing bid
+    const CAmount nCompetingBid = bidder.nBid + 1000;
+    pwalletMain->TransactionAddedToMempool(AddCompetingBMMRequest(nCompetingBid));
+    bidder = GetBidder();
+    BOOST_REQUIRE_MESSAGE(bidder.vBidTxid.size() == 2, bidder.strError);
+    BOOST_CHECK(!mempool.exists(bidder.vBidTxid[0]));
+    BOOST_CHECK(mempool.exists(bidder.vBidTxid[1]));
+    BOOST_CHECK(bidder.nBid > nCompetingBid);
+    BOOST_CHECK(bidder.nBid <= nMaxBid);
+
+    // Outbid over the budget, the bid stays
+    const CAmount nBid = bidder.nBid;
+    pwalletMain->TransactionAddedToMempool(AddCompetingBMMRequest(nMaxBid));
+    bidder = GetBidder();
+    BOOST_CHECK_EQUAL(bidder.vBidTxid.size(), 2U);
+    BOOST_CHECK_EQUAL(bidder.nBid, nBid);
+    BOOST_CHECK(bidder.strError.find("over the budget") != std::string::npos);
+
+    // The bid is mined, the bidder waits for the next h*
+    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+    {
+        LOCK(pwalletMain->cs_wallet);
+        pblock->vtx.push_back(pwalletMain->mapWallet.at(bidder.vBidTxid[1]).tx);
+    }
+    pwalletMain->BlockConnected(pblock, chainActive.Tip(), {});
+    bidder = GetBidder();
+    BOOST_CHECK_EQUAL(bidder.nWon, 1);
+    BOOST_CHECK_EQUAL(bidder.nSpent, nBid);
+    BOOST_CHECK(bidder.hashCritical.IsNull());
+    BOOST_CHECK(bidder.vBidTxid.empty());
+
+    const size_t nWalletTx = pwalletMain->mapWallet.size();
+    pwalletMain->UpdatedBlockTip(chainActive.Tip(), nullptr, false);
+    BOOST_CHECK(GetBidder().vBidTxid.empty());
+    BOOST_CHECK_EQUAL(pwalletMain->mapWallet.size(), nWalletTx);
+
+    // A bid on the tip stays in the mempool when the bidder is removed
+    BOOST_REQUIRE_MESSAGE(pwalletMain->SetBMMBidder(bidder, strFail, 0, GetRandHash(), nAmount, 2 * nMaxBid), strFail);
+    pwalletMain->UpdatedBlockTip(chainActive.Tip(), nullptr, false);
+    bidder = GetBidder();
+    BOOST_REQUIRE_MESSAGE(!bidder.vBidTxid.empty(), bidder.strError);
+    BOOST_REQUIRE(pwalletMain->RemoveBMMBidder(0, strFail));
+    BOOST_CHECK(mempool.exists(bidder.vBidTxid.back()));
+    {
+        LOCK(pwalletMain->cs_wallet);
+        BOOST_CHECK(!pwalletMain->mapWallet.at(bidder.vBidTxid.back()).isAbandoned());
+    }
+
+    mempool.clear();
+    scdb.Reset();
+}
+
 BOOST_AUTO_TEST_CASE(LoadReceiveRequests)
 {
     CTxDestination dest = CKeyID();
@@ -6,9 +6,13 @@
 #include <wallet/wallet.h>
 
 #include <base58.h>
+#include <blockimport.h>
 #include <checkpoints.h>
 #include <chain.h>
 #include <wallet/coincontrol.h>
+#include <wallet/coinsplit.h>
+#include <wallet/depositqueue.h>
+#include <wallet/feebumper.h>
 #include <consensus/consensus.h>
 #include <consensus/validation.h>
 #include <coins.h>
@@ -33,7 +37,12 @@
 #include <wallet/fees.h>
 
 #include <assert.h>
+#include <ctime>
+#include <deque>
 #include <future>
+#include <iomanip>
+#include <locale>
+#include <sstream>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/thread.hpp>
@@ -523,6 +532,60 @@ bool CWallet::HasWalletSpend(const uint256& txid) const
     return (iter != mapTxSpends.end() && iter->first.hash == txid);
 }
 
+/**
+ * Parse the time of a transaction scheduled by an earlier version, which was
+ * written in SCHEDULED_TX_TIME_FORMAT and local time
+ */
+static bool ParseScheduledTime(const std::string& strTime, int64_t& nTime)
+{
+    std::tm tm = {};
+    std::istringstream ss(strTime);
+    ss.imbue(std::locale::classic());
+    ss >> std::get_time(&tm, "%a %B %d %Y %I:%M %p");
+    if (ss.fail())
+        return false;
+
+    tm.tm_isdst = -1;
+    std::time_t t = std::mktime(&tm);
+    if (t == -1)
+        return false;
+
+    nTime = t;
+    return true;
+}
+
+/** Write the scheduled transactions that weren't imported by a wallet back to the file they were kept in before */
+static void WriteScheduledTransactionsFile(const std::vector<ScheduledTransaction>& vScheduled)
+{
+    fs::path path = GetDataDir() / "drivechain" / "scheduledtx.dat";
+    if (vScheduled.empty()) {
+        fs::remove(path);
+        return;
+    }
+
+    // Write
+    CAutoFile fileout(fsbridge::fopen(path.string() + ".new", "w"), SER_DISK, CLIENT_VERSION);
+    if (fileout.IsNull()) {
+        return;
+    }
+
+    try {
+        fileout << SCHEDULED_TX_DUMP_VERSION; // version required to read
+        fileout << (int)vScheduled.size(); // Number of tx in file
+
+        for (const ScheduledTransaction& tx : vScheduled) {
+            fileout << tx;
+        }
+    }
+    catch (const std::exception& e) {
+        LogPrintf("%s: Exception: %s\n", __func__, e.what());
+    }
+
+    FileCommit(fileout.Get());
+    fileout.fclose();
+    RenameOver(path.string() + ".new", path);
+}
+
 bool CWallet::LoadScheduledTransactions()
 {
     LOCK(cs_wallet);
@@ -536,7 +599,7 @@ bool CWallet::LoadScheduledTransactions()
     try {
         uint64_t nVersion;
         filein >> nVersion;
-        if (nVersion != SCHEDULED_TX_DUMP_VERSION) {
+        if (nVersion > SCHEDULED_TX_DUMP_VERSION) {
             return false;
         }
 
@@ -544,7 +607,16 @@ bool CWallet::LoadScheduledTransactions()
         filein >> count;
         for (int i = 0; i < count; i++) {
             ScheduledTransaction tx;
-            filein >> tx;
+            if (nVersion == 0) {
+                std::string strTime;
+                filein >> strTime;
+                filein >> tx.wtxid;
+                // Broadcast right away if the time can't be read
+                if (!ParseScheduledTime(strTime, tx.nTime))
+                    LogPrintf("%s: Invalid time %s of scheduled transaction %s\n", __func__, strTime, tx.wtxid.ToString());
+            } else {
+                filein >> tx;
+            }
             vScheduledIn.push_back(tx);
         }
     }
@@ -552,114 +624,167 @@ bool CWallet::LoadScheduledTransactions()
         LogPrintf("%s: Exception: %s\n", __func__, e.what());
         return false;
     }
+    filein.fclose();
+
+    // The file is shared by every wallet, each one takes its own
+    // transactions and the rest stay in the file
+    std::vector<ScheduledTransaction> vImport;
+    std::vector<ScheduledTransaction> vKeep;
+    for (const ScheduledTransaction& tx : vScheduledIn) {
+        if (!mapWallet.count(tx.wtxid))
+            vKeep.push_back(tx);
+        else if (!mapScheduled.count(tx.wtxid))
+            vImport.push_back(tx);
+    }
+    if (vImport.empty() && vKeep.size() == vScheduledIn.size())
+        return true;
 
-    vScheduled = vScheduledIn;
+    CWalletDB walletdb(*dbw);
+    for (const ScheduledTransaction& tx : vImport) {
+        if (!walletdb.WriteScheduledTransaction(tx))
+            return false;
+        LoadScheduledTransaction(tx);
+    }
+    WriteScheduledTransactionsFile(vKeep);
 
+    LogPrintf("%s: Imported %u\n", __func__, vImport.size());
     return true;
 }
 
-void CWallet::WriteScheduledTransactions()
+void CWallet::LoadScheduledTransaction(const ScheduledTransaction& scheduled)
 {
-    int count = vScheduled.size();
+    LOCK(cs_wallet);
+    if (mapScheduled.emplace(scheduled.wtxid, scheduled.nTime).second)
+        queueScheduled.emplace(scheduled.nTime, scheduled.wtxid);
+}
 
-    // Write
-    fs::path path = GetDataDir() / "drivechain" / "scheduledtx.dat.new";
-    CAutoFile fileout(fsbridge::fopen(path, "w"), SER_DISK, CLIENT_VERSION);
-    if (fileout.IsNull()) {
-        return;
-    }
+bool CWallet::ScheduleTransaction(const uint256& wtxid, int64_t nTime)
+{
+    return ScheduleTransactions({ScheduledTransaction(wtxid, nTime)});
+}
 
-    try {
-        fileout << SCHEDULED_TX_DUMP_VERSION; // version required to read
-        fileout << count; // Number of tx in file
+bool CWallet::ScheduleTransactions(const std::vector<ScheduledTransaction>& vSchedule)
+{
+    LOCK2(cs_main, cs_wallet);
 
-        for (const ScheduledTransaction& tx : vScheduled) {
-            fileout << tx;
-        }
+    // Check for unknown and duplicate transactions before scheduling any
+    std::set<uint256> setNew;
+    for (const ScheduledTransaction& scheduled : vSchedule) {
+        if (!mapWallet.count(scheduled.wtxid))
+            return false;
+        if (mapScheduled.count(scheduled.wtxid) || !setNew.insert(scheduled.wtxid).second)
+            return false;
     }
-    catch (const std::exception& e) {
-        LogPrintf("%s: Exception: %s\n", __func__, e.what());
+
+    // Write the schedule in one batch, a wallet without a database has
+    // nothing to begin a transaction on
+    CWalletDB walletdb(*dbw);
+    bool fTxn = walletdb.TxnBegin();
+    for (const ScheduledTransaction& scheduled : vSchedule) {
+        if (!walletdb.WriteScheduledTransaction(scheduled)) {
+            if (fTxn)
+                walletdb.TxnAbort();
+            return false;
+        }
     }
+    if (fTxn && !walletdb.TxnCommit())
+        return false;
 
-    FileCommit(fileout.Get());
-    fileout.fclose();
-    RenameOver(GetDataDir() / "drivechain" / "scheduledtx.dat.new", GetDataDir() /  "drivechain" / "scheduledtx.dat");
+    for (const ScheduledTransaction& scheduled : vSchedule) {
+        mapScheduled.emplace(scheduled.wtxid, scheduled.nTime);
+        queueScheduled.emplace(scheduled.nTime, scheduled.wtxid);
+    }
 
-    LogPrintf("%s: Wrote %u\n", __func__, count);
+    return true;
 }
 
-bool CWallet::ScheduleTransaction(const uint256& wtxid, const std::string& strTime)
+bool CWallet::CancelScheduledTransaction(const uint256& wtxid)
 {
     LOCK2(cs_main, cs_wallet);
 
-    if (!mapWallet.count(wtxid))
+    if (!mapScheduled.erase(wtxid))
         return false;
 
-    // Check for duplicate
-    for (const ScheduledTransaction& s : vScheduled) {
-        if (s.wtxid == wtxid)
-            return false;
-    }
-
-    ScheduledTransaction schedule;
-    schedule.wtxid = wtxid;
-    schedule.strTime = strTime;
+    CWalletDB(*dbw).EraseScheduledTransaction(wtxid);
 
-    vScheduled.push_back(schedule);
+    // The transaction was never broadcast, release its inputs
+    if (!AbandonTransaction(wtxid))
+        LogPrintf("%s: Failed to abandon scheduled transaction %s\n", __func__, wtxid.ToString());
 
     return true;
 }
 
-void CWallet::RemoveScheduledTransaction(const ScheduledTransaction& scheduled)
+std::vector<ScheduledTransaction> CWallet::GetScheduled() const
 {
-    LOCK2(cs_main, cs_wallet);
+    LOCK(cs_wallet);
 
-    for (size_t i = 0; i < vScheduled.size(); i++) {
-        if (vScheduled[i].wtxid == scheduled.wtxid) {
-            vScheduled[i] = vScheduled.back();
-            vScheduled.pop_back();
-            break;
-        }
-    }
-}
+    std::vector<ScheduledTransaction> vScheduled;
+    vScheduled.reserve(mapScheduled.size());
+    for (const std::pair<const uint256, int64_t>& item : mapScheduled)
+        vScheduled.emplace_back(item.first, item.second);
 
-std::vector<ScheduledTransaction> CWallet::GetScheduled() const
-{
+    std::sort(vScheduled.begin(), vScheduled.end(), [](const ScheduledTransaction& a, const ScheduledTransaction& b) {
+        return a.nTime < b.nTime || (a.nTime == b.nTime && a.wtxid < b.wtxid);
+    });
     return vScheduled;
 }
 
 bool CWallet::IsScheduled(const uint256& wtxid) const
 {
-    for (const ScheduledTransaction& s : vScheduled) {
-        if (s.wtxid == wtxid)
-            return true;
-    }
-    return false;
+    AssertLockHeld(cs_wallet);
+    return mapScheduled.count(wtxid);
 }
 
-bool CWallet::BroadcastScheduled(const uint256& wtxid)
+void CWallet::BroadcastScheduledTransactions()
 {
-    if (!IsScheduled(wtxid))
-        return false;
+    // Keep the transactions scheduled until broadcasting is enabled
+    if (!fBroadcastTransactions)
+        return;
 
-    if (!mapWallet.count(wtxid))
-        return false;
+    LOCK2(cs_main, cs_wallet);
 
-    CWalletTx& wtx = mapWallet[wtxid];
+    int64_t nNow = GetTime();
+    std::vector<uint256> vBroadcast;
+    while (!queueScheduled.empty() && queueScheduled.top().first <= nNow) {
+        std::pair<int64_t, uint256> next = queueScheduled.top();
+        queueScheduled.pop();
+
+        // Skip cancelled transactions
+        auto it = mapScheduled.find(next.second);
+        if (it == mapScheduled.end() || it->second != next.first)
+            continue;
+        mapScheduled.erase(it);
+        vBroadcast.push_back(next.second);
 
-    CValidationState state;
-    if (!wtx.AcceptToMemoryPool(1 * CENT, state))
-        return false;
+        // A transaction that is rejected is handled like any other
+        // unconfirmed wallet transaction from now on
+        auto itWallet = mapWallet.find(next.second);
+        if (itWallet == mapWallet.end())
+            continue;
+        CWalletTx& wtx = itWallet->second;
 
-    wtx.RelayWalletTransaction(g_connman.get());
+        CValidationState state;
+        if (!wtx.AcceptToMemoryPool(1 * CENT, state)) {
+            LogPrintf("%s: Scheduled transaction %s rejected: %s\n", __func__, next.second.ToString(), FormatStateMessage(state));
+            continue;
+        }
+        wtx.RelayWalletTransaction(g_connman.get());
+        LogPrintf("%s: Broadcast scheduled transaction %s\n", __func__, next.second.ToString());
+    }
 
-    return true;
+    if (!vBroadcast.empty()) {
+        CWalletDB walletdb(*dbw);
+        bool fTxn = walletdb.TxnBegin();
+        for (const uint256& wtxid : vBroadcast)
+            walletdb.EraseScheduledTransaction(wtxid);
+        if (fTxn)
+            walletdb.TxnCommit();
+    }
 }
 
 void CWallet::Flush(bool shutdown)
 {
     dbw->Flush(shutdown);
-    WriteScheduledTransactions();
 }
 
 void CWallet::SyncMetaData(std::pair<TxSpends::iterator, TxSpends::iterator> range)
@@ -747,6 +872,45 @@ void CWallet::AddToSpends(const uint256& wtxid)
         AddToSpends(txin.prevout, wtxid);
 }
 
+void CWallet::RemoveUncommittedTxs(const std::vector<uint256>& vHash)
+{
+    AssertLockHeld(cs_wallet);
+
+    for (const uint256& hash : vHash) {
+        auto it = mapWallet.find(hash);
+        if (it == mapWallet.end())
+            continue;
+        CWalletTx& wtx = it->second;
+
+        for (const CTxIn& txin : wtx.tx->vin) {
+            std::pair<TxSpends::iterator, TxSpends::iterator> range = mapTxSpends.equal_range(txin.prevout);
+            for (TxSpends::iterator itSpend = range.first; itSpend != range.second; ++itSpend) {
+                if (itSpend->second == hash) {
+                    mapTxSpends.erase(itSpend);
+                    break;
+                }
+            }
+            auto itPrev = mapWallet.find(txin.prevout.hash);
+            if (itPrev != mapWallet.end())
+                itPrev->second.MarkDirty();
+        }
+
+        std::pair<TxItems::iterator, TxItems::iterator> range = wtxOrdered.equal_range(wtx.nOrderPos);
+        for (TxItems::iterator itOrdered = range.first; itOrdered != range.second; ++itOrdered) {
+            if (itOrdered->second.first == &wtx) {
+                wtxOrdered.erase(itOrdered);
+                break;
+            }
+        }
+
+        mapWallet.erase(it);
+        NotifyTransactionChanged(this, hash, CT_DELETED);
+    }
+
+    // The outputs they spent are unspent again
+    fUnspentIndexValid = false;
+}
+
 bool CWallet::EncryptWallet(const SecureString& strWalletPassphrase)
 {
     if (IsCrypted())
@@ -1007,6 +1171,9 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         for (std::pair<const uint256, CWalletTx>& item : mapWallet)
             item.second.MarkDirty();
+
+        // Outputs may have become ours
+        fUnspentIndexValid = false;
     }
 }
 
@@ -1044,6 +1211,12 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
     LOCK(cs_wallet);
 
     CWalletDB walletdb(*dbw, "r+", fFlushOnClose);
+    return AddToWallet(wtxIn, walletdb);
+}
+
+bool CWallet::AddToWallet(const CWalletTx& wtxIn, CWalletDB& walletdb)
+{
+    LOCK(cs_wallet);
 
     uint256 hash = wtxIn.GetHash();
 
@@ -1061,6 +1234,8 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
         wtxOrdered.insert(std::make_pair(wtx.nOrderPos, TxPair(&wtx, nullptr)));
         wtx.nTimeSmart = ComputeTimeSmart(wtx);
         AddToSpends(hash);
+        if (fUnspentIndexValid)
+            AddToUnspentIndex(hash, wtx);
     }
 
     bool fUpdated = false;
@@ -1140,6 +1315,7 @@ bool CWallet::LoadToWallet(const CWalletTx& wtxIn)
     wtx.BindWallet(this);
     wtxOrdered.insert(std::make_pair(wtx.nOrderPos, TxPair(&wtx, nullptr)));
     AddToSpends(hash);
+    fUnspentIndexValid = false;
     for (const CTxIn& txin : wtx.tx->vin) {
         auto it = mapWallet.find(txin.prevout.hash);
         if (it != mapWallet.end()) {
@@ -1278,7 +1454,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx, std::string* pstrReason)
             walletdb.WriteTx(wtx);
             NotifyTransactionChanged(this, wtx.GetHash(), CT_UPDATED);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them abandoned too
-            TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(hashTx, 0));
+            TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
             while (iter != mapTxSpends.end() && iter->first.hash == now) {
                 if (!done.count(iter->second)) {
                     todo.insert(iter->second);
@@ -1293,6 +1469,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx, std::string* pstrReason)
                 if (it != mapWallet.end()) {
                     it->second.MarkDirty();
                 }
+                AddToUnspentIndex(txin.prevout);
             }
         }
     }
@@ -1356,6 +1533,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, const uint256& hashTx)
                 if (it != mapWallet.end()) {
                     it->second.MarkDirty();
                 }
+                AddToUnspentIndex(txin.prevout);
             }
         }
     }
@@ -1378,6 +1556,13 @@ void CWallet::SyncTransaction(const CTransactionRef& ptx, const CBlockIndex *pin
     }
 }
 
+/** The bytes of a block hash BMM requests for the block after it commit to */
+static std::string GetBMMPrevBlock(const uint256& hashBlock)
+{
+    std::string strPrevBlock = hashBlock.ToString();
+    return strPrevBlock.substr(strPrevBlock.size() - 8);
+}
+
 void CWallet::TransactionAddedToMempool(const CTransactionRef& ptx) {
     LOCK2(cs_main, cs_wallet);
     SyncTransaction(ptx);
@@ -1386,6 +1571,36 @@ void CWallet::TransactionAddedToMempool(const CTransactionRef& ptx) {
     if (it != mapWallet.end()) {
         it->second.fInMempool = true;
     }
+
+    // Deposits that left the mempool are submitted again, most likely on
+    // the deposit that took their place
+    for (uint8_t nSidechain : std::vector<uint8_t>(setDepositQueueDirty.begin(), setDepositQueueDirty.end()))
+        ProcessDepositQueue(nSidechain);
+
+    // Raise our bid when another BMM request for the block outbids it
+    uint8_t nSidechain;
+    std::string strPrevBlock = "";
+    if (!mapBMMBidders.empty() && ptx->criticalData.IsBMMRequest(nSidechain, strPrevBlock)) {
+        auto itBidder = mapBMMBidders.find(nSidechain);
+        if (itBidder == mapBMMBidders.end())
+            return;
+        BMMBidder& bidder = itBidder->second;
+        if (bidder.vBidTxid.empty() || GetBMMPrevBlock(bidder.hashBidBlock) != strPrevBlock)
+            return;
+        if (std::find(bidder.vBidTxid.begin(), bidder.vBidTxid.end(), ptx->GetHash()) != bidder.vBidTxid.end())
+            return;
+
+        CAmount nCompetingBid = 0;
+        {
+            LOCK(mempool.cs);
+            auto itEntry = mempool.mapTx.find(ptx->GetHash());
+            if (itEntry == mempool.mapTx.end())
+                return;
+            nCompetingBid = GetBMMRequestBid(*itEntry);
+        }
+        if (nCompetingBid >= bidder.nBid)
+            RaiseBMMBid(bidder, nCompetingBid);
+    }
 }
 
 void CWallet::TransactionRemovedFromMempool(const CTransactionRef &ptx) {
@@ -1394,6 +1609,13 @@ void CWallet::TransactionRemovedFromMempool(const CTransactionRef &ptx) {
     if (it != mapWallet.end()) {
         it->second.fInMempool = false;
     }
+
+    for (const std::pair<const uint8_t, std::vector<QueuedDeposit>>& queue : mapDepositQueue) {
+        for (const QueuedDeposit& deposit : queue.second) {
+            if (deposit.txid == ptx->GetHash())
+                setDepositQueueDirty.insert(queue.first);
+        }
+    }
 }
 
 void CWallet::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex *pindex, const std::vector<CTransactionRef>& vtxConflicted) {
@@ -1416,6 +1638,27 @@ void CWallet::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const
     }
 
     m_last_block_processed = pindex;
+
+    // An h* we bid for was BMMed, the bidder waits for the next one
+    for (std::pair<const uint8_t, BMMBidder>& item : mapBMMBidders) {
+        BMMBidder& bidder = item.second;
+        for (const CTransactionRef& ptx : pblock->vtx) {
+            if (std::find(bidder.vBidTxid.begin(), bidder.vBidTxid.end(), ptx->GetHash()) == bidder.vBidTxid.end())
+                continue;
+            LogPrintf("%s: BMM request for sidechain %u with h* %s was mined in block %u\n", __func__, bidder.nSidechain, bidder.hashCritical.ToString(), pindex->nHeight);
+            bidder.nWon++;
+            bidder.nSpent += bidder.nBid;
+            bidder.hashCritical.SetNull();
+            bidder.hashBidBlock.SetNull();
+            bidder.vBidTxid.clear();
+            bidder.nBid = 0;
+            break;
+        }
+    }
+
+    // Blocks move the CTIP of the sidechains and confirm queued deposits
+    if (!IsInitialBlockDownload())
+        ProcessDepositQueues();
 }
 
 void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
@@ -1424,6 +1667,19 @@ void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
     for (const CTransactionRef& ptx : pblock->vtx) {
         SyncTransaction(ptx);
     }
+
+    ProcessDepositQueues();
+}
+
+void CWallet::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) {
+    if (fInitialDownload)
+        return;
+
+    LOCK2(cs_main, cs_wallet);
+
+    // Every tip is a new BMM auction
+    for (std::pair<const uint8_t, BMMBidder>& bidder : mapBMMBidders)
+        PlaceBMMBid(bidder.second);
 }
 
 
@@ -1767,6 +2023,7 @@ int64_t CWallet::RescanFromTime(int64_t startTime, const WalletRescanReserver& r
 CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlockIndex* pindexStop, const WalletRescanReserver &reserver, bool fUpdate)
 {
     int64_t nNow = GetTime();
+    int64_t nTimeStart = GetTimeMillis();
     const CChainParams& chainParams = Params();
 
     assert(reserver.isReserved());
@@ -1774,8 +2031,24 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
         assert(pindexStop->nHeight >= pindexStart->nHeight);
     }
 
+    // Outputs are matched against the keys of the wallet while the blocks are
+    // read, everything else needs the wallet lock and is checked when the
+    // block is scanned
+    const int nThreads = std::max(1, std::min(GetNumCores(), MAX_RESCAN_THREADS));
+    auto filter = [this](const CBlock& block, std::vector<bool>& vMatch) {
+        for (size_t i = 0; i < block.vtx.size(); i++)
+            vMatch[i] = IsMine(*block.vtx[i]);
+    };
+    int64_t nKeyPoolIndex;
+    {
+        LOCK(cs_wallet);
+        nKeyPoolIndex = m_max_keypool_index;
+    }
+    std::unique_ptr<CChainBlockReader> reader(new CChainBlockReader(pindexStart->nHeight, chainParams.GetConsensus(), nThreads, filter));
+
     CBlockIndex* pindex = pindexStart;
     CBlockIndex* ret = nullptr;
+    int nBlocks = 0;
     {
         fAbortRescan = false;
         ShowProgress(_("Rescanning..."), 0); // show rescan progress in GUI as dialog or on splashscreen, if -rescan on startup
@@ -1790,6 +2063,19 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
         }
         while (pindex && !fAbortRescan)
         {
+            CChainBlockReader::Record record;
+            reader->Next(record);
+            if (!record.pindex) {
+                // The active chain grew past the tip the reader started with
+                reader.reset(new CChainBlockReader(pindex->nHeight, chainParams.GetConsensus(), nThreads, filter));
+                reader->Next(record);
+            }
+            if (record.pindex != pindex) {
+                // The active chain changed since the block was read
+                ret = pindex;
+                break;
+            }
+
             if (pindex->nHeight % 100 == 0 && dProgressTip - dProgressStart > 0.0) {
                 double gvp = 0;
                 {
@@ -1804,8 +2090,9 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
                 LogPrintf("Still rescanning. At block %d. Progress=%f\n", pindex->nHeight, GuessVerificationProgress(chainParams.TxData(), pindex));
             }
 
-            CBlock block;
-            if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            bool fKeysAdded = false;
+            if (record.pblock) {
+                const CBlock& block = *record.pblock;
                 LOCK2(cs_main, cs_wallet);
                 if (pindex && !chainActive.Contains(pindex)) {
                     // Abort scan if current block is no longer active, to prevent
@@ -1814,14 +2101,34 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
                     break;
                 }
                 for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
+                    // Skip transactions that can't involve the wallet
+                    const CTransaction& tx = *block.vtx[posInBlock];
+                    bool fMatch = record.vMatch[posInBlock] || mapWallet.count(tx.GetHash()) || (fKeysAdded && IsMine(tx));
+                    for (size_t i = 0; i < tx.vin.size() && !fMatch; i++) {
+                        fMatch = mapWallet.count(tx.vin[i].prevout.hash) || mapTxSpends.count(tx.vin[i].prevout);
+                    }
+                    if (!fMatch)
+                        continue;
+
                     AddToWalletIfInvolvingMe(block.vtx[posInBlock], pindex, posInBlock, fUpdate);
+
+                    // Keys added to the keypool weren't known to the filter
+                    if (m_max_keypool_index != nKeyPoolIndex) {
+                        nKeyPoolIndex = m_max_keypool_index;
+                        fKeysAdded = true;
+                    }
                 }
             } else {
                 ret = pindex;
             }
+            nBlocks++;
             if (pindex == pindexStop) {
                 break;
             }
+            if (fKeysAdded) {
+                // Read the following blocks again with the new keys
+                reader.reset(new CChainBlockReader(pindex->nHeight + 1, chainParams.GetConsensus(), nThreads, filter));
+            }
             {
                 LOCK(cs_main);
                 pindex = chainActive.Next(pindex);
@@ -1837,6 +2144,7 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
         }
         ShowProgress(_("Rescanning..."), 100); // hide progress dialog in GUI
     }
+    LogPrintf("%s: Scanned %d blocks on %d threads in %dms\n", __func__, nBlocks, nThreads, GetTimeMillis() - nTimeStart);
     return ret;
 }
 
@@ -2324,6 +2632,52 @@ CAmount CWallet::GetAvailableBalance(const CCoinControl* coinControl) const
     return balance;
 }
 
+void CWallet::BuildUnspentIndex() const
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    int64_t nTimeStart = GetTimeMicros();
+
+    mapUnspentIndex.clear();
+    for (const auto& entry : mapWallet) {
+        for (unsigned int i = 0; i < entry.second.tx->vout.size(); i++) {
+            if (IsSpent(entry.first, i))
+                continue;
+
+            isminetype mine = IsMine(entry.second.tx->vout[i]);
+            if (mine != ISMINE_NO)
+                mapUnspentIndex[entry.first][i] = mine;
+        }
+    }
+    fUnspentIndexValid = true;
+
+    LogPrint(BCLog::BENCH, "%s: %u transactions with unspent outputs of %u, %.2fms\n", __func__, mapUnspentIndex.size(), mapWallet.size(), (GetTimeMicros() - nTimeStart) * 0.001);
+}
+
+void CWallet::AddToUnspentIndex(const uint256& hash, const CWalletTx& wtx) const
+{
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        isminetype mine = IsMine(wtx.tx->vout[i]);
+        if (mine != ISMINE_NO)
+            mapUnspentIndex[hash][i] = mine;
+    }
+}
+
+void CWallet::AddToUnspentIndex(const COutPoint& outpoint) const
+{
+    if (!fUnspentIndexValid)
+        return;
+
+    auto it = mapWallet.find(outpoint.hash);
+    if (it == mapWallet.end() || outpoint.n >= it->second.tx->vout.size())
+        return;
+
+    isminetype mine = IsMine(it->second.tx->vout[outpoint.n]);
+    if (mine != ISMINE_NO)
+        mapUnspentIndex[outpoint.hash][outpoint.n] = mine;
+}
+
 void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const CCoinControl *coinControl, const CAmount &nMinimumAmount, const CAmount &nMaximumAmount, const CAmount &nMinimumSumAmount, const uint64_t nMaximumCount, const int nMinDepth, const int nMaxDepth) const
 {
     AssertLockHeld(cs_main);
@@ -2332,10 +2686,20 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
     vCoins.clear();
     CAmount nTotal = 0;
 
-    for (const auto& entry : mapWallet)
+    if (!fUnspentIndexValid)
+        BuildUnspentIndex();
+
+    auto itIndex = mapUnspentIndex.begin();
+    while (itIndex != mapUnspentIndex.end())
     {
-        const uint256& wtxid = entry.first;
-        const CWalletTx* pcoin = &entry.second;
+        auto entry = itIndex++;
+        const uint256& wtxid = entry->first;
+        const auto it = mapWallet.find(wtxid);
+        if (it == mapWallet.end()) {
+            mapUnspentIndex.erase(entry);
+            continue;
+        }
+        const CWalletTx* pcoin = &it->second;
 
         if (IsScheduled(wtxid))
             continue;
@@ -2395,24 +2759,26 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
         if (nDepth < nMinDepth || nDepth > nMaxDepth)
             continue;
 
-        for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-            if (pcoin->tx->vout[i].nValue < nMinimumAmount || pcoin->tx->vout[i].nValue > nMaximumAmount)
-                continue;
+        std::map<unsigned int, isminetype>& mapOutputs = entry->second;
+        for (auto itOutput = mapOutputs.begin(); itOutput != mapOutputs.end();) {
+            const unsigned int i = itOutput->first;
+            const isminetype mine = itOutput->second;
 
-            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(entry.first, i)))
+            // Spent outputs are only added back if their spender is abandoned or conflicted
+            if (IsSpent(wtxid, i)) {
+                itOutput = mapOutputs.erase(itOutput);
                 continue;
+            }
+            ++itOutput;
 
-            if (IsLockedCoin(entry.first, i))
+            if (pcoin->tx->vout[i].nValue < nMinimumAmount || pcoin->tx->vout[i].nValue > nMaximumAmount)
                 continue;
 
-            if (IsSpent(wtxid, i))
+            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(wtxid, i)))
                 continue;
 
-            isminetype mine = IsMine(pcoin->tx->vout[i]);
-
-            if (mine == ISMINE_NO) {
+            if (IsLockedCoin(wtxid, i))
                 continue;
-            }
 
             bool fSpendableIn = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) || (coinControl && coinControl->fAllowWatchOnly && (mine & ISMINE_WATCH_SOLVABLE) != ISMINE_NO);
             bool fSolvableIn = (mine & (ISMINE_SPENDABLE | ISMINE_WATCH_SOLVABLE)) != ISMINE_NO;
@@ -2433,6 +2799,9 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
                 return;
             }
         }
+
+        if (mapOutputs.empty())
+            mapUnspentIndex.erase(entry);
     }
 }
 
@@ -2720,28 +3089,26 @@ bool CWallet::SelectCoins(const std::vector<COutput>& vAvailableCoins, const CAm
     return res;
 }
 
+/** Number of threads to sign the inputs of a transaction with */
+static int GetInputSigningThreads(size_t nInputs)
+{
+    return nInputs < MIN_PARALLEL_SIGNING_INPUTS ? 1 : MAX_INPUT_SIGNING_THREADS;
+}
+
 bool CWallet::SignTransaction(CMutableTransaction &tx)
 {
     AssertLockHeld(cs_wallet); // mapWallet
 
     // sign the new tx
-    CTransaction txNewConst(tx);
-    int nIn = 0;
+    std::vector<CTxOut> vSpent;
     for (const auto& input : tx.vin) {
         std::map<uint256, CWalletTx>::const_iterator mi = mapWallet.find(input.prevout.hash);
         if(mi == mapWallet.end() || input.prevout.n >= mi->second.tx->vout.size()) {
             return false;
         }
-        const CScript& scriptPubKey = mi->second.tx->vout[input.prevout.n].scriptPubKey;
-        const CAmount& amount = mi->second.tx->vout[input.prevout.n].nValue;
-        SignatureData sigdata;
-        if (!ProduceSignature(TransactionSignatureCreator(this, &txNewConst, nIn, amount, SIGHASH_ALL), scriptPubKey, sigdata)) {
-            return false;
-        }
-        UpdateTransaction(tx, nIn, sigdata);
-        nIn++;
+        vSpent.push_back(mi->second.tx->vout[input.prevout.n]);
     }
-    return true;
+    return SignTransactionInputs(*this, tx, vSpent, GetInputSigningThreads(vSpent.size()));
 }
 
 bool CWallet::FundTransaction(CMutableTransaction& tx, CAmount& nFeeRet, int& nChangePosInOut, std::string& strFailReason, bool lockUnspents, const std::set<int>& setSubtractFeeFromOutputs, CCoinControl coinControl)
@@ -3139,22 +3506,14 @@ bool CWallet::CreateTransaction(const std::vector<CRecipient>& vecSend, CWalletT
 
         if (sign)
         {
-            CTransaction txNewConst(txNew);
-            int nIn = 0;
+            std::vector<CTxOut> vSpent;
             for (const auto& coin : setCoins)
-            {
-                const CScript& scriptPubKey = coin.txout.scriptPubKey;
-                SignatureData sigdata;
-
-                if (!ProduceSignature(TransactionSignatureCreator(this, &txNewConst, nIn, coin.txout.nValue, SIGHASH_ALL), scriptPubKey, sigdata))
-                {
-                    strFailReason = _("Signing transaction failed");
-                    return false;
-                } else {
-                    UpdateTransaction(txNew, nIn, sigdata);
-                }
+                vSpent.push_back(coin.txout);
 
-                nIn++;
+            if (!SignTransactionInputs(*this, txNew, vSpent, GetInputSigningThreads(vSpent.size())))
+            {
+                strFailReason = _("Signing transaction failed");
+                return false;
             }
         }
 
@@ -3196,10 +3555,8 @@ bool CWallet::CreateTransaction(const std::vector<CRecipient>& vecSend, CWalletT
     return true;
 }
 
-bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest)
+bool CWallet::CheckSidechainDeposit(std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const std::string& strDest, CScript& dataScript)
 {
-    strFail = "Unknown error!";
-
     if (!scdb.IsSidechainActive(nSidechain)) {
         strFail = "Invalid Sidechain number!\n";
         return false;
@@ -3211,7 +3568,7 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
     }
 
     // User deposit data script
-    CScript dataScript = CScript() << OP_RETURN << ParseHex(HexStr(strDest));
+    dataScript = CScript() << OP_RETURN << ParseHex(HexStr(strDest));
 
     if (dataScript.size() > MAX_DEPOSIT_DESTINATION_BYTES) {
         strFail = "Invalid sidechain deposit script - destination too large!";
@@ -3229,26 +3586,13 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
         return false;
     }
 
-    // The deposit transaction
-    CMutableTransaction mtx;
-
-    BlockUntilSyncedToCurrentChain();
-
-    LOCK2(cs_main, vpwallets[0]->cs_wallet);
-
-    // Select coins to cover sidechain deposit
-    std::vector<COutput> vCoins;
-    AvailableCoins(vCoins, true /* fOnlySafe */);
-    std::set<CInputCoin> setCoins;
-    CAmount nAmountRet = CAmount(0);
-    if (!SelectCoins(vCoins, nAmount + nFee, setCoins, nAmountRet)) {
-        strFail = "Could not collect enough coins to cover deposit + fee!\n";
-        return false;
-    }
+    return true;
+}
 
+bool CWallet::SignSidechainDeposit(CMutableTransaction& mtx, std::string& strFail, const std::set<CInputCoin>& setCoins, CAmount nValueIn, const SidechainCTIP* pctip, const CScript& sidechainScriptPubKey, const CScript& dataScript, const CAmount& nAmount, const CAmount& nFee, CReserveKey& reserveKey)
+{
     // Handle change if there is any
-    const CAmount nChange = nAmountRet - (nAmount + nFee);
-    CReserveKey reserveKey(vpwallets[0]);
+    const CAmount nChange = nValueIn - (nAmount + nFee);
     if (nChange > 0) {
         CScript scriptChange;
 
@@ -3277,17 +3621,12 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
     // Add deposit output
     mtx.vout.push_back(CTxOut(nAmount, sidechainScriptPubKey));
 
-    // Handle existing sidechain utxo. We will look at our local mempool, and
-    // create a deposit based on the latest CTIP for the sidechain.
-    // Note: It will be rejected if other nodes have seen a newer CTIP.
-    SidechainCTIP ctip;
-    CAmount returnAmount = CAmount(0);
-    if (::mempool.GetMemPoolCTIP(nSidechain, ctip)) {
-        returnAmount = ctip.amount;
+    // Handle existing sidechain utxo
+    if (pctip) {
         // Amount returning to sidechain
-        mtx.vout.back().nValue += returnAmount;
+        mtx.vout.back().nValue += pctip->amount;
         // Spend the existing CTIP
-        mtx.vin.push_back(CTxIn(ctip.out));
+        mtx.vin.push_back(CTxIn(pctip->out));
     }
 
     // Dummy sign the transaction to calculate fee
@@ -3323,28 +3662,55 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
         vin.scriptWitness.SetNull();
     }
 
-    Sidechain sidechain;
-    if (!scdb.GetSidechain(nSidechain, sidechain))
+    // Sign the non sidechain inputs, the CTIP comes after them
+    std::vector<CTxOut> vSpent;
+    for (const auto& coin : setCoins)
+        vSpent.push_back(coin.txout);
+
+    if (!SignTransactionInputs(*this, mtx, vSpent, GetInputSigningThreads(vSpent.size())))
+    {
+        strFail = "Signing non-sidechain inputs failed!\n";
         return false;
+    }
 
-    // Sign the non sidechain inputs
-    const CTransaction txToSign = mtx;
-    int nIn = 0;
-    for (const auto& coin : setCoins) {
-        const CScript& scriptPubKey = coin.txout.scriptPubKey;
-        SignatureData sigdata;
+    return true;
+}
 
-        if (!ProduceSignature(TransactionSignatureCreator(this, &txToSign, nIn, coin.txout.nValue, SIGHASH_ALL), scriptPubKey, sigdata))
-        {
-            strFail = "Signing non-sidechain inputs failed!\n";
-            return false;
-        } else {
-            UpdateTransaction(mtx, nIn, sigdata);
-        }
+bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest)
+{
+    strFail = "Unknown error!";
+
+    CScript dataScript;
+    if (!CheckSidechainDeposit(strFail, sidechainScriptPubKey, nSidechain, strDest, dataScript))
+        return false;
+
+    // The deposit transaction
+    CMutableTransaction mtx;
+
+    BlockUntilSyncedToCurrentChain();
+
+    LOCK2(cs_main, vpwallets[0]->cs_wallet);
 
-        nIn++;
+    // Select coins to cover sidechain deposit
+    std::vector<COutput> vCoins;
+    AvailableCoins(vCoins, true /* fOnlySafe */);
+    std::set<CInputCoin> setCoins;
+    CAmount nAmountRet = CAmount(0);
+    if (!SelectCoins(vCoins, nAmount + nFee, setCoins, nAmountRet)) {
+        strFail = "Could not collect enough coins to cover deposit + fee!\n";
+        return false;
     }
 
+    // Handle existing sidechain utxo. We will look at our local mempool, and
+    // create a deposit based on the latest CTIP for the sidechain.
+    // Note: It will be rejected if other nodes have seen a newer CTIP.
+    SidechainCTIP ctip;
+    bool fCTIP = ::mempool.GetMemPoolCTIP(nSidechain, ctip);
+
+    CReserveKey reserveKey(vpwallets[0]);
+    if (!SignSidechainDeposit(mtx, strFail, setCoins, nAmountRet, fCTIP ? &ctip : nullptr, sidechainScriptPubKey, dataScript, nAmount, nFee, reserveKey))
+        return false;
+
     // Broadcast transaction
     CWalletTx wtxNew;
     wtxNew.fTimeReceivedIsTxTime = true;
@@ -3364,6 +3730,294 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
     return true;
 }
 
+void CWallet::LoadQueuedDeposit(const QueuedDeposit& deposit)
+{
+    InsertQueuedDeposit(mapDepositQueue[deposit.nSidechain], deposit);
+}
+
+bool CWallet::QueueSidechainDeposit(QueuedDeposit& deposit, std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest)
+{
+    strFail = "Unknown error!";
+
+    CScript dataScript;
+    if (!CheckSidechainDeposit(strFail, sidechainScriptPubKey, nSidechain, strDest, dataScript))
+        return false;
+
+    BlockUntilSyncedToCurrentChain();
+
+    LOCK2(cs_main, cs_wallet);
+
+    CWalletDB walletdb(*dbw);
+
+    deposit = QueuedDeposit();
+    deposit.nSidechain = nSidechain;
+    deposit.sidechainScriptPubKey = sidechainScriptPubKey;
+    deposit.nAmount = nAmount;
+    deposit.nFee = nFee;
+    deposit.strDest = strDest;
+    deposit.nOrderPos = IncOrderPosNext(&walletdb);
+    deposit.nTimeQueued = GetTime();
+    deposit.id = SerializeHash(deposit);
+
+    if (!walletdb.WriteQueuedDeposit(deposit)) {
+        strFail = "Failed to write queued deposit to the wallet!\n";
+        return false;
+    }
+    mapDepositQueue[nSidechain].push_back(deposit);
+
+    ProcessDepositQueue(nSidechain);
+
+    // Return the deposit as it was built and submitted
+    for (const QueuedDeposit& queued : mapDepositQueue[nSidechain]) {
+        if (queued.id == deposit.id)
+            deposit = queued;
+    }
+
+    return true;
+}
+
+bool CWallet::RemoveQueuedDeposit(const uint256& id, std::string& strFail)
+{
+    LOCK2(cs_main, cs_wallet);
+
+    for (std::pair<const uint8_t, std::vector<QueuedDeposit>>& queue : mapDepositQueue) {
+        std::vector<QueuedDeposit>& vQueue = queue.second;
+        for (std::vector<QueuedDeposit>::iterator it = vQueue.begin(); it != vQueue.end(); it++) {
+            if (it->id != id)
+                continue;
+
+            if (!it->txid.IsNull()) {
+                strFail = "Deposit was already submitted!";
+                return false;
+            }
+
+            CWalletDB walletdb(*dbw);
+            std::vector<COutPoint> vReuse;
+            DiscardQueuedDeposit(*it, walletdb, vReuse);
+            walletdb.EraseQueuedDeposit(id);
+            vQueue.erase(it);
+
+            ProcessDepositQueue(queue.first);
+            return true;
+        }
+    }
+
+    strFail = "Queued deposit not found!";
+    return false;
+}
+
+std::vector<QueuedDeposit> CWallet::GetQueuedDeposits() const
+{
+    LOCK(cs_wallet);
+
+    std::vector<QueuedDeposit> vDeposit;
+    for (const std::pair<const uint8_t, std::vector<QueuedDeposit>>& queue : mapDepositQueue)
+        vDeposit.insert(vDeposit.end(), queue.second.begin(), queue.second.end());
+
+    return vDeposit;
+}
+
+void CWallet::ProcessDepositQueues()
+{
+    std::vector<uint8_t> vSidechain;
+    for (const std::pair<const uint8_t, std::vector<QueuedDeposit>>& queue : mapDepositQueue)
+        vSidechain.push_back(queue.first);
+
+    for (uint8_t nSidechain : vSidechain)
+        ProcessDepositQueue(nSidechain);
+}
+
+/** Processes a deposit queue with the wallet and the mempool */
+class WalletDepositQueueHandler : public DepositQueueHandler
+{
+public:
+    WalletDepositQueueHandler(CWallet& walletIn, CWalletDB& walletdbIn) : wallet(walletIn), walletdb(walletdbIn) {}
+
+    bool IsConfirmed(const QueuedDeposit& deposit) override
+    {
+        auto it = wallet.mapWallet.find(deposit.txid);
+        return it != wallet.mapWallet.end() && it->second.GetDepthInMainChain() > 0;
+    }
+
+    bool InMempool(const QueuedDeposit& deposit) override
+    {
+        return mempool.exists(deposit.txid);
+    }
+
+    bool Build(QueuedDeposit& deposit, const SidechainCTIP* pctip, const QueuedDeposit* pprev, const std::vector<COutPoint>& vReuse) override
+    {
+        return wallet.BuildQueuedDeposit(deposit, pctip, pprev, vReuse);
+    }
+
+    bool Submit(QueuedDeposit& deposit, CValidationState& state) override
+    {
+        return wallet.SubmitQueuedDeposit(deposit, walletdb, state);
+    }
+
+    void Discard(QueuedDeposit& deposit, std::vector<COutPoint>& vReuse) override
+    {
+        wallet.DiscardQueuedDeposit(deposit, walletdb, vReuse);
+    }
+
+    void Erase(const QueuedDeposit& deposit) override
+    {
+        walletdb.EraseQueuedDeposit(deposit.id);
+    }
+
+private:
+    CWallet& wallet;
+    CWalletDB& walletdb;
+};
+
+void CWallet::ProcessDepositQueue(uint8_t nSidechain)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    setDepositQueueDirty.erase(nSidechain);
+
+    auto itQueue = mapDepositQueue.find(nSidechain);
+    if (itQueue == mapDepositQueue.end())
+        return;
+    std::vector<QueuedDeposit>& vQueue = itQueue->second;
+
+    // Deposits read from the database only have the txid
+    for (QueuedDeposit& deposit : vQueue) {
+        auto it = deposit.txid.IsNull() ? mapWallet.end() : mapWallet.find(deposit.txid);
+        if (it != mapWallet.end() && !deposit.tx)
+            deposit.tx = it->second.tx;
+    }
+
+    CWalletDB walletdb(*dbw);
+    WalletDepositQueueHandler handler(*this, walletdb);
+    SidechainCTIP ctip;
+    bool fCTIP = mempool.GetMemPoolCTIP(nSidechain, ctip);
+    ::ProcessDepositQueue(vQueue, fCTIP ? &ctip : nullptr, fBroadcastTransactions, handler);
+
+    if (vQueue.empty())
+        mapDepositQueue.erase(itQueue);
+}
+
+void CWallet::DiscardQueuedDeposit(QueuedDeposit& deposit, CWalletDB& walletdb, std::vector<COutPoint>& vReuse)
+{
+    if (!deposit.tx)
+        return;
+
+    if (deposit.txid.IsNull()) {
+        for (const CTxIn& txin : deposit.tx->vin)
+            UnlockCoin(txin.prevout);
+    } else {
+        // The submitted transaction may still confirm. The deposit built
+        // instead spends the same coins, so that only one of them can.
+        if (mapWallet.count(deposit.txid))
+            AbandonTransaction(deposit.txid);
+        for (const CTxIn& txin : deposit.tx->vin)
+            vReuse.push_back(txin.prevout);
+
+        deposit.txid.SetNull();
+        walletdb.WriteQueuedDeposit(deposit);
+    }
+
+    deposit.tx.reset();
+    deposit.outCTIP.SetNull();
+}
+
+bool CWallet::BuildQueuedDeposit(QueuedDeposit& deposit, const SidechainCTIP* pctip, const QueuedDeposit* pprev, const std::vector<COutPoint>& vReuse)
+{
+    CScript dataScript;
+    if (!CheckSidechainDeposit(deposit.strError, deposit.sidechainScriptPubKey, deposit.nSidechain, deposit.strDest, dataScript))
+        return false;
+
+    std::vector<CInputCoin> vReuseCoins;
+    for (const COutPoint& outpoint : vReuse) {
+        auto it = mapWallet.find(outpoint.hash);
+        if (it == mapWallet.end() || outpoint.n >= it->second.tx->vout.size())
+            continue;
+        const CWalletTx& wtx = it->second;
+        if (!(IsMine(wtx.tx->vout[outpoint.n]) & ISMINE_SPENDABLE) || IsSpent(outpoint.hash, outpoint.n))
+            continue;
+        if (wtx.GetDepthInMainChain() <= 0 && !wtx.InMempool())
+            continue;
+        vReuseCoins.push_back(CInputCoin(&wtx, outpoint.n));
+    }
+
+    std::unique_ptr<CInputCoin> pchange;
+    if (pprev && pprev->tx && pprev->tx->vout.size() == 3) {
+        const COutPoint outpoint(pprev->tx->GetHash(), 0);
+        bool fSpent = !pprev->txid.IsNull() && (IsSpent(outpoint.hash, outpoint.n) || mempool.isSpent(outpoint));
+        if (!fSpent)
+            pchange.reset(new CInputCoin(outpoint, pprev->tx->vout[0]));
+    }
+
+    auto selectConfirmed = [this](const CAmount& nTargetValue, const std::set<CInputCoin>& setCoins, std::set<CInputCoin>& setSelected, CAmount& nSelected) {
+        std::vector<COutput> vCoins;
+        AvailableCoins(vCoins, true /* fOnlySafe */);
+        vCoins.erase(std::remove_if(vCoins.begin(), vCoins.end(), [&setCoins](const COutput& out) {
+            return setCoins.count(CInputCoin(out.tx, out.i));
+        }), vCoins.end());
+
+        return SelectCoinsMinConf(nTargetValue, 1, 6, 0, vCoins, setSelected, nSelected) ||
+                SelectCoinsMinConf(nTargetValue, 1, 1, 0, vCoins, setSelected, nSelected);
+    };
+
+    std::set<CInputCoin> setCoins;
+    CAmount nValueIn = 0;
+    if (!ChooseQueuedDepositCoins(vReuseCoins, pchange.get(), deposit.nAmount + deposit.nFee, selectConfirmed, setCoins, nValueIn)) {
+        deposit.strError = "Could not collect enough confirmed coins to cover deposit + fee!";
+        return false;
+    }
+
+    CMutableTransaction mtx;
+    CReserveKey reserveKey(this);
+    if (!SignSidechainDeposit(mtx, deposit.strError, setCoins, nValueIn, pctip, deposit.sidechainScriptPubKey, dataScript, deposit.nAmount, deposit.nFee, reserveKey))
+        return false;
+    reserveKey.KeepKey();
+
+    for (const CInputCoin& coin : setCoins)
+        LockCoin(coin.outpoint);
+
+    deposit.tx = MakeTransactionRef(std::move(mtx));
+    deposit.outCTIP = pctip ? pctip->out : COutPoint();
+    deposit.strError.clear();
+
+    return true;
+}
+
+bool CWallet::SubmitQueuedDeposit(QueuedDeposit& deposit, CWalletDB& walletdb, CValidationState& state)
+{
+    const uint256 hash = deposit.tx->GetHash();
+    auto it = mapWallet.find(hash);
+    if (it != mapWallet.end()) {
+        if (!it->second.AcceptToMemoryPool(maxTxFee, state))
+            return false;
+    } else {
+        CWalletTx wtx(this, deposit.tx);
+        wtx.fTimeReceivedIsTxTime = true;
+        wtx.fFromMe = true;
+        if (!wtx.AcceptToMemoryPool(maxTxFee, state))
+            return false;
+
+        for (const CTxIn& txin : deposit.tx->vin)
+            UnlockCoin(txin.prevout);
+        AddToWallet(wtx);
+
+        // Notify that old coins are spent
+        for (const CTxIn& txin : deposit.tx->vin) {
+            if (mapWallet.count(txin.prevout.hash))
+                NotifyTransactionChanged(this, txin.prevout.hash, CT_UPDATED);
+        }
+        it = mapWallet.find(hash);
+    }
+    it->second.RelayWalletTransaction(g_connman.get());
+
+    deposit.txid = hash;
+    deposit.strError.clear();
+    walletdb.WriteQueuedDeposit(deposit);
+
+    LogPrintf("%s: Submitted queued deposit %s to sidechain %u: %s\n", __func__, deposit.id.ToString(), deposit.nSidechain, hash.ToString());
+    return true;
+}
+
 bool CWallet::CreateOPReturnTransaction(CTransactionRef& tx, std::string& strFail, const CAmount& nFee, const CScript& script)
 {
     strFail = "Unknown error!";
@@ -3450,21 +4104,14 @@ bool CWallet::CreateOPReturnTransaction(CTransactionRef& tx, std::string& strFai
     }
 
     // Sign the inputs
-    const CTransaction txToSign = mtx;
-    int nIn = 0;
-    for (const auto& coin : setCoins) {
-        const CScript& scriptPubKey = coin.txout.scriptPubKey;
-        SignatureData sigdata;
-
-        if (!ProduceSignature(TransactionSignatureCreator(this, &txToSign, nIn, coin.txout.nValue, SIGHASH_ALL), scriptPubKey, sigdata))
-        {
-            strFail = "Signing non-sidechain inputs failed!\n";
-            return false;
-        } else {
-            UpdateTransaction(mtx, nIn, sigdata);
-        }
+    std::vector<CTxOut> vSpent;
+    for (const auto& coin : setCoins)
+        vSpent.push_back(coin.txout);
 
-        nIn++;
+    if (!SignTransactionInputs(*this, mtx, vSpent, GetInputSigningThreads(vSpent.size())))
+    {
+        strFail = "Signing non-sidechain inputs failed!\n";
+        return false;
     }
 
     // Broadcast transaction
@@ -3486,22 +4133,10 @@ bool CWallet::CreateOPReturnTransaction(CTransactionRef& tx, std::string& strFai
     return true;
 }
 
-bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin, bool fBroadcast, const CAmount& amountRequired, const CTxDestination& destRequired)
+bool CWallet::CreateDenialTransaction(CMutableTransaction& mtx, std::string& strFail, const COutput& coin, const CAmount& amountRequired, const CTxDestination& destRequired)
 {
-    strFail = "Unknown error!";
-    if (!fBroadcastTransactions) {
-        strFail = "Transaction broadcast is disabled!\n";
-        return false;
-    }
-
-    if (vpwallets.empty()) {
-        strFail = "No active wallet!\n";
-        return false;
-    }
-
-    LOCK2(cs_main, vpwallets[0]->cs_wallet);
-
-    CMutableTransaction mtx;
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
 
     // Add the coin we want to spend as an input
     mtx.vin.push_back(CTxIn(coin.tx->GetHash(), coin.i, CScript()));
@@ -3627,17 +4262,39 @@ bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin
         vin.scriptWitness.SetNull();
     }
 
+    return true;
+}
+
+bool CWallet::SignDenialTransaction(CMutableTransaction& mtx, const COutput& coin) const
+{
+    return SignTransactionInputs(*this, mtx, {coin.tx->tx->vout[coin.i]});
+}
+
+bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin, bool fBroadcast, const CAmount& amountRequired, const CTxDestination& destRequired)
+{
+    strFail = "Unknown error!";
+    if (!fBroadcastTransactions) {
+        strFail = "Transaction broadcast is disabled!\n";
+        return false;
+    }
+
+    if (vpwallets.empty()) {
+        strFail = "No active wallet!\n";
+        return false;
+    }
+
+    LOCK2(cs_main, cs_wallet);
+
+    CMutableTransaction mtx;
+    if (!CreateDenialTransaction(mtx, strFail, coin, amountRequired, destRequired))
+        return false;
+
     // Sign the input
-    const CTransaction txToSign = mtx;
-    const CScript& scriptToSign = coin.tx->tx->vout[coin.i].scriptPubKey;
-    SignatureData sigdata;
-    if (!ProduceSignature(TransactionSignatureCreator(this, &txToSign, 0, amountIn, SIGHASH_ALL), scriptToSign, sigdata)) {
+    if (!SignDenialTransaction(mtx, coin)) {
         strFail = "Signing input failed!\n";
         return false;
     }
 
-    UpdateTransaction(mtx, 0, sigdata);
-
     // Create wallet transaction
 
     wtx.fTimeReceivedIsTxTime = true;
@@ -3687,6 +4344,613 @@ bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin
     return true;
 }
 
+bool CWallet::DenyCoins(const std::vector<COutput>& vCoins, unsigned int nGoal, int64_t nWindow, std::vector<ScheduledTransaction>& vScheduled, std::string& strFail, size_t nMaxTx)
+{
+    vScheduled.clear();
+
+    if (IsLocked()) {
+        strFail = "Wallet is locked!\n";
+        return false;
+    }
+
+    LOCK2(cs_main, cs_wallet);
+
+    // Denial transactions of every round and the round they belong to. The
+    // outputs of a round are spent by the next one, so the transactions are
+    // kept in a deque to keep the coins pointing to them valid.
+    std::deque<CWalletTx> dequeWtx;
+    std::vector<unsigned int> vTxRound;
+
+    std::vector<COutput> vRoundCoins;
+    for (const COutput& coin : vCoins) {
+        if (coin.tx->nDenial < nGoal)
+            vRoundCoins.push_back(coin);
+    }
+
+    unsigned int nRounds = 0;
+    while (!vRoundCoins.empty() && dequeWtx.size() < nMaxTx) {
+        // Plan the transactions of this round
+        std::vector<CMutableTransaction> vMtx;
+        std::vector<COutput> vSpent;
+        for (const COutput& coin : vRoundCoins) {
+            if (dequeWtx.size() + vMtx.size() >= nMaxTx)
+                break;
+
+            CMutableTransaction mtx;
+            std::string strError;
+            if (!CreateDenialTransaction(mtx, strError, coin, CAmount(0), CNoDestination())) {
+                // Outputs of earlier rounds that are too small end their chain
+                if (nRounds == 0) {
+                    if (!strError.empty() && strError.back() == '\n')
+                        strError.pop_back();
+                    LogPrintf("%s: Not denying coin %s:%u: %s\n", __func__, coin.tx->GetHash().ToString(), coin.i, strError);
+                }
+                continue;
+            }
+            vMtx.push_back(std::move(mtx));
+            vSpent.push_back(coin);
+        }
+
+        // Sign the transactions of this round in parallel
+        std::vector<char> vSigned(vMtx.size(), false);
+        ParallelFor(vMtx.size(), MAX_DENIAL_SIGNING_THREADS, [&](size_t i) {
+            vSigned[i] = SignDenialTransaction(vMtx[i], vSpent[i]);
+        });
+
+        // Denials that are still below the goal are denied by the next round
+        std::vector<COutput> vNextCoins;
+        for (size_t i = 0; i < vMtx.size(); i++) {
+            if (!vSigned[i]) {
+                LogPrintf("%s: Signing denial of %s:%u failed\n", __func__, vSpent[i].tx->GetHash().ToString(), vSpent[i].i);
+                continue;
+            }
+
+            dequeWtx.emplace_back();
+            CWalletTx& wtx = dequeWtx.back();
+            wtx.fTimeReceivedIsTxTime = true;
+            wtx.fFromMe = true;
+            wtx.BindWallet(this);
+            wtx.nDenial = vSpent[i].tx->nDenial + 1;
+            wtx.SetTx(MakeTransactionRef(std::move(vMtx[i])));
+            vTxRound.push_back(nRounds);
+
+            if (wtx.nDenial >= nGoal)
+                continue;
+            for (size_t n = 0; n < wtx.tx->vout.size(); n++)
+                vNextCoins.emplace_back(&wtx, n, 0, true, true, true);
+        }
+
+        nRounds++;
+        vRoundCoins.swap(vNextCoins);
+    }
+
+    if (dequeWtx.empty()) {
+        strFail = "No coins to deny!\n";
+        return false;
+    }
+
+    // Write every transaction in one database transaction. AddToWallet also
+    // adds them to memory, which is undone if they aren't committed.
+    CWalletDB walletdb(*dbw);
+    if (!walletdb.TxnBegin()) {
+        strFail = "Failed to begin wallet database transaction!\n";
+        return false;
+    }
+    std::vector<uint256> vAdded;
+    for (const CWalletTx& wtx : dequeWtx) {
+        if (!mapWallet.count(wtx.GetHash()))
+            vAdded.push_back(wtx.GetHash());
+        if (!AddToWallet(wtx, walletdb)) {
+            walletdb.TxnAbort();
+            RemoveUncommittedTxs(vAdded);
+            strFail = "Failed to write denial transaction to wallet!\n";
+            return false;
+        }
+    }
+    if (!walletdb.TxnCommit()) {
+        RemoveUncommittedTxs(vAdded);
+        strFail = "Failed to commit denial transactions to wallet database!\n";
+        return false;
+    }
+
+    // Notify that the coins were spent
+    for (const COutput& coin : vCoins) {
+        if (coin.tx->nDenial < nGoal && IsSpent(coin.tx->GetHash(), coin.i))
+            NotifyTransactionChanged(this, coin.tx->GetHash(), CT_UPDATED);
+    }
+
+    // Spread the rounds over the window, every transaction is broadcast
+    // after the transaction it spends from
+    const int64_t nNow = GetTime();
+    const int64_t nSlot = std::max<int64_t>(1, nWindow / nRounds);
+    for (size_t i = 0; i < dequeWtx.size(); i++)
+        vScheduled.emplace_back(dequeWtx[i].GetHash(), nNow + vTxRound[i] * nSlot + GetRand(nSlot));
+
+    if (!ScheduleTransactions(vScheduled)) {
+        strFail = "Failed to schedule denial transactions!\n";
+        vScheduled.clear();
+        return false;
+    }
+
+    LogPrintf("%s: Scheduled %u denial transactions in %u rounds over %d seconds\n", __func__, vScheduled.size(), nRounds, nWindow);
+
+    return true;
+}
+
+bool CWallet::SplitCoins(const std::vector<COutput>& vCoins, unsigned int nOutputs, const CAmount& nAmount, unsigned int nMaxTxOutputs, std::vector<PlannedSplitTx>& vPlan, std::vector<CTransactionRef>& vtx, CAmount& nFeeRet, std::string& strFail, bool fDryRun)
+{
+    vPlan.clear();
+    vtx.clear();
+    nFeeRet = 0;
+
+    if (!fDryRun && IsLocked()) {
+        strFail = "Wallet is locked!\n";
+        return false;
+    }
+    if (!fDryRun && !fBroadcastTransactions) {
+        strFail = "Transaction broadcast is disabled!\n";
+        return false;
+    }
+
+    // Split outputs pay to new P2PKH keys
+    if (IsDust(CTxOut(nAmount, GetScriptForDestination(CKeyID())), ::dustRelayFee)) {
+        strFail = "Split amount is too small!\n";
+        return false;
+    }
+
+    LOCK2(cs_main, cs_wallet);
+
+    // Only confirmed coins are split, the mempool limits of a split tree
+    // count from its root
+    std::vector<COutput> vRoot;
+    std::vector<CAmount> vValue;
+    for (const COutput& coin : vCoins) {
+        if (coin.nDepth < 1 || !coin.fSpendable)
+            continue;
+        vRoot.push_back(coin);
+        vValue.push_back(coin.tx->tx->vout[coin.i].nValue);
+    }
+
+    const CFeeRate feeRate = GetCoinSplitFeeRate();
+    if (!PlanCoinSplit(vValue, nOutputs, nAmount, feeRate, GetCoinSplitLimits(nMaxTxOutputs), vPlan, strFail))
+        return false;
+    if (fDryRun)
+        return true;
+
+    // Create the transactions with outputs to new keys. The split outputs
+    // come first, then the outputs funding the children and the change of
+    // a root last.
+    std::vector<CMutableTransaction> vMtx(vPlan.size());
+    std::vector<unsigned int> vParentOut(vPlan.size(), 0);
+    for (size_t i = 0; i < vPlan.size(); i++) {
+        const PlannedSplitTx& planned = vPlan[i];
+        CMutableTransaction& mtx = vMtx[i];
+        mtx.nVersion = TX_REPLAY_VERSION;
+
+        const size_t nOut = planned.nSplitOutputs + planned.vChildren.size() + (planned.nParent < 0 ? 1 : 0);
+        for (size_t n = 0; n < nOut; n++) {
+            CPubKey newKey;
+            if (!GetKeyFromPool(newKey)) {
+                strFail = "Keypool ran out, please call keypoolrefill first!\n";
+                return false;
+            }
+            LearnRelatedScripts(newKey, OUTPUT_TYPE_LEGACY);
+            mtx.vout.emplace_back(n < planned.nSplitOutputs ? nAmount : 0, GetScriptForDestination(GetDestinationForKey(newKey, OUTPUT_TYPE_LEGACY)));
+        }
+        for (size_t n = 0; n < planned.vChildren.size(); n++)
+            vParentOut[planned.vChildren[n]] = planned.nSplitOutputs + n;
+
+        if (planned.nParent < 0) {
+            const COutput& coin = vRoot[planned.nCoin];
+            mtx.vin.emplace_back(coin.tx->GetHash(), coin.i);
+        } else {
+            // The txid of the parent is set once it is signed
+            mtx.vin.emplace_back(uint256(), vParentOut[i]);
+        }
+    }
+
+    // Dummy sign the transactions to calculate their fees
+    std::vector<CAmount> vFee(vPlan.size());
+    for (size_t i = 0; i < vPlan.size(); i++) {
+        const PlannedSplitTx& planned = vPlan[i];
+        const CTxOut& txout = planned.nParent < 0 ? vRoot[planned.nCoin].tx->tx->vout[vRoot[planned.nCoin].i] : vMtx[planned.nParent].vout[vParentOut[i]];
+        CMutableTransaction mtxDummy = vMtx[i];
+        if (!DummySignTx(mtxDummy, std::vector<CInputCoin>{CInputCoin(mtxDummy.vin[0].prevout, txout)})) {
+            strFail = "Dummy signing transaction for required fee calculation failed!";
+            return false;
+        }
+        unsigned int nBytes = GetVirtualTransactionSize(mtxDummy);
+        vFee[i] = std::max(feeRate.GetFee(nBytes), ::minRelayTxFee.GetFee(nBytes));
+        nFeeRet += vFee[i];
+    }
+
+    // Fund every transaction with its outputs and fee, children first
+    std::vector<CAmount> vNeeded(vPlan.size());
+    for (size_t i = vPlan.size(); i-- > 0; ) {
+        const PlannedSplitTx& planned = vPlan[i];
+        CMutableTransaction& mtx = vMtx[i];
+        vNeeded[i] = planned.nSplitOutputs * nAmount + vFee[i];
+        for (size_t nChild : planned.vChildren) {
+            mtx.vout[vParentOut[nChild]].nValue = vNeeded[nChild];
+            vNeeded[i] += vNeeded[nChild];
+        }
+
+        if (planned.nParent < 0) {
+            const COutput& coin = vRoot[planned.nCoin];
+            const CAmount nChange = vValue[planned.nCoin] - vNeeded[i];
+            if (nChange < 0) {
+                strFail = strprintf("Coin %s:%u is too small to pay for its split!\n", coin.tx->GetHash().ToString(), coin.i);
+                return false;
+            }
+            mtx.vout.back().nValue = nChange;
+            if (IsDust(mtx.vout.back(), ::dustRelayFee)) {
+                nFeeRet += nChange;
+                mtx.vout.pop_back();
+            }
+        }
+    }
+
+    // Sign the transactions a level at a time, every level spends the
+    // outputs of the one before it. The transactions of a level are signed
+    // in parallel.
+    vtx.resize(vPlan.size());
+    unsigned int nMaxDepth = 0;
+    for (const PlannedSplitTx& planned : vPlan)
+        nMaxDepth = std::max(nMaxDepth, planned.nDepth);
+    for (unsigned int nDepth = 0; nDepth <= nMaxDepth; nDepth++) {
+        std::vector<size_t> vLevel;
+        for (size_t i = 0; i < vPlan.size(); i++) {
+            if (vPlan[i].nDepth != nDepth)
+                continue;
+            if (vPlan[i].nParent >= 0)
+                vMtx[i].vin[0].prevout.hash = vtx[vPlan[i].nParent]->GetHash();
+            vLevel.push_back(i);
+        }
+
+        std::vector<char> vSigned(vLevel.size(), false);
+        ParallelFor(vLevel.size(), MAX_SPLIT_SIGNING_THREADS, [&](size_t n) {
+            const size_t i = vLevel[n];
+            const PlannedSplitTx& planned = vPlan[i];
+            const CTxOut& txout = planned.nParent < 0 ? vRoot[planned.nCoin].tx->tx->vout[vRoot[planned.nCoin].i] : vtx[planned.nParent]->vout[vParentOut[i]];
+            vSigned[n] = SignTransactionInputs(*this, vMtx[i], {txout});
+        });
+
+        for (size_t n = 0; n < vLevel.size(); n++) {
+            if (!vSigned[n]) {
+                strFail = "Signing split transaction failed!\n";
+                vtx.clear();
+                return false;
+            }
+            vtx[vLevel[n]] = MakeTransactionRef(std::move(vMtx[vLevel[n]]));
+        }
+    }
+
+    // Write every transaction in one database transaction. AddToWallet also
+    // adds them to memory, which is undone if they aren't committed.
+    CWalletDB walletdb(*dbw);
+    if (!walletdb.TxnBegin()) {
+        strFail = "Failed to begin wallet database transaction!\n";
+        vtx.clear();
+        return false;
+    }
+    std::vector<uint256> vAdded;
+    for (const CTransactionRef& tx : vtx) {
+        CWalletTx wtx(this, tx);
+        wtx.fTimeReceivedIsTxTime = true;
+        wtx.fFromMe = true;
+        if (!mapWallet.count(wtx.GetHash()))
+            vAdded.push_back(wtx.GetHash());
+        if (!AddToWallet(wtx, walletdb)) {
+            walletdb.TxnAbort();
+            RemoveUncommittedTxs(vAdded);
+            strFail = "Failed to write split transaction to wallet!\n";
+            vtx.clear();
+            return false;
+        }
+    }
+    if (!walletdb.TxnCommit()) {
+        RemoveUncommittedTxs(vAdded);
+        strFail = "Failed to commit split transactions to wallet database!\n";
+        vtx.clear();
+        return false;
+    }
+
+    // Notify that the coins were spent
+    for (const PlannedSplitTx& planned : vPlan) {
+        if (planned.nParent < 0)
+            NotifyTransactionChanged(this, vRoot[planned.nCoin].tx->GetHash(), CT_UPDATED);
+    }
+
+    // Submit the transactions parents first. A rejected transaction is
+    // abandoned with its descendants, which aren't submitted.
+    std::vector<char> vRejected(vPlan.size(), false);
+    std::vector<CTransactionRef> vAccepted;
+    size_t nRejected = 0;
+    for (size_t i = 0; i < vPlan.size(); i++) {
+        const int nParent = vPlan[i].nParent;
+        if (nParent >= 0 && vRejected[nParent]) {
+            vRejected[i] = true;
+            continue;
+        }
+
+        CWalletTx& wtx = mapWallet[vtx[i]->GetHash()];
+        CValidationState state;
+        if (!wtx.AcceptToMemoryPool(maxTxFee, state)) {
+            if (nRejected++ == 0)
+                strFail = strprintf("Split transaction %s was rejected: %s\n", wtx.GetHash().ToString(), FormatStateMessage(state));
+            vRejected[i] = true;
+            AbandonTransaction(wtx.GetHash());
+            continue;
+        }
+        wtx.RelayWalletTransaction(g_connman.get());
+        vAccepted.push_back(vtx[i]);
+    }
+    vtx.swap(vAccepted);
+
+    LogPrintf("%s: Split %u coins into %u outputs with %u transactions, %u were rejected\n", __func__, vValue.size(), nOutputs, vPlan.size(), vPlan.size() - vtx.size());
+
+    return nRejected == 0;
+}
+
+bool CWallet::CreateBMMRequest(CWalletTx& wtx, CReserveKey& reservekey, CAmount& nFeeRet, std::string& strFail, const uint8_t nSidechain, const uint256& hashCritical, const CAmount& nAmount, int nHeight, const std::string& strPrevBlock, bool fReplaceable)
+{
+    std::vector<unsigned char> vPrevBytes = ParseHex(strPrevBlock);
+    if (vPrevBytes.size() != 4) {
+        strFail = "Invalid prevBlockHash bytes size";
+        return false;
+    }
+
+    // Create critical data bytes
+    CScript vBytes;
+    vBytes.resize(8);
+
+    // Add header to identify BMM data
+    vBytes[0] = 0x00;
+    vBytes[1] = 0xbf;
+    vBytes[2] = 0x00;
+
+    // Add sidechain number
+    vBytes[3] = nSidechain;
+
+    // Add prev block bytes
+    memcpy(&vBytes[4], vPrevBytes.data(), vPrevBytes.size());
+
+    CCriticalData criticalData;
+    criticalData.vBytes = std::vector<unsigned char>(vBytes.begin(), vBytes.end());
+    criticalData.hashCritical = hashCritical;
+
+    // Create transaction with critical data
+    std::vector<CRecipient> vecSend;
+    CRecipient recipient = {CScript() << OP_TRUE, nAmount, false};
+    vecSend.push_back(recipient);
+
+    wtx.fFromMe = true;
+    wtx.fTimeReceivedIsTxTime = true;
+    wtx.BindWallet(this);
+
+    int nChangePosRet = -1;
+    CCoinControl cc;
+    cc.signalRbf = fReplaceable;
+    return CreateTransaction(vecSend, wtx, reservekey, nFeeRet, nChangePosRet, strFail, cc, true, 3, nHeight, criticalData);
+}
+
+bool CWallet::SetBMMBidder(BMMBidder& bidder, std::string& strFail, const uint8_t nSidechain, const uint256& hashCritical, const CAmount& nAmount, const CAmount& nMaxBid)
+{
+    if (!scdb.IsSidechainActive(nSidechain)) {
+        strFail = "Invalid Sidechain number";
+        return false;
+    }
+    if (hashCritical.IsNull()) {
+        strFail = "Invalid h*";
+        return false;
+    }
+    if (nAmount <= 0 || nMaxBid <= nAmount) {
+        strFail = "Invalid amount or budget, the budget must be more than the amount to pay the fee";
+        return false;
+    }
+
+    LOCK2(cs_main, cs_wallet);
+
+    BMMBidder& bidderSet = mapBMMBidders[nSidechain];
+    if (bidderSet.hashCritical != hashCritical || bidderSet.nAmount != nAmount || bidderSet.nMaxBid != nMaxBid)
+        ExpireBMMBid(bidderSet);
+
+    bidderSet.nSidechain = nSidechain;
+    bidderSet.hashCritical = hashCritical;
+    bidderSet.nAmount = nAmount;
+    bidderSet.nMaxBid = nMaxBid;
+
+    if (!IsInitialBlockDownload())
+        PlaceBMMBid(bidderSet);
+
+    bidder = bidderSet;
+    return true;
+}
+
+bool CWallet::RemoveBMMBidder(const uint8_t nSidechain, std::string& strFail)
+{
+    LOCK2(cs_main, cs_wallet);
+
+    auto it = mapBMMBidders.find(nSidechain);
+    if (it == mapBMMBidders.end()) {
+        strFail = "No BMM bidder for sidechain!";
+        return false;
+    }
+
+    ExpireBMMBid(it->second);
+    mapBMMBidders.erase(it);
+    return true;
+}
+
+std::vector<BMMBidder> CWallet::GetBMMBidders() const
+{
+    LOCK(cs_wallet);
+
+    std::vector<BMMBidder> vBidder;
+    for (const std::pair<const uint8_t, BMMBidder>& bidder : mapBMMBidders)
+        vBidder.push_back(bidder.second);
+
+    return vBidder;
+}
+
+void CWallet::PlaceBMMBid(BMMBidder& bidder)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    const CBlockIndex* pindexTip = chainActive.Tip();
+    if (bidder.hashCritical.IsNull() || bidder.hashBidBlock == pindexTip->GetBlockHash())
+        return;
+
+    // A bid on another tip can't be mined anymore
+    ExpireBMMBid(bidder);
+
+    // Find the best BMM request for the sidechain that is already waiting
+    // in the mempool, there is no point in bidding if it is over the budget
+    const std::string strPrevBlock = GetBMMPrevBlock(pindexTip->GetBlockHash());
+    CAmount nCompetingBid = 0;
+    {
+        LOCK(mempool.cs);
+        for (const CTxMemPoolEntry& entry : mempool.mapTx) {
+            uint8_t nSidechain;
+            std::string strPrevBlockRequest = "";
+            if (entry.GetTx().criticalData.IsBMMRequest(nSidechain, strPrevBlockRequest) &&
+                    nSidechain == bidder.nSidechain && strPrevBlockRequest == strPrevBlock)
+                nCompetingBid = std::max(nCompetingBid, GetBMMRequestBid(entry));
+        }
+    }
+    if (nCompetingBid >= bidder.nMaxBid) {
+        bidder.strError = strprintf("Outbid by %s, over the budget", FormatMoney(nCompetingBid));
+        LogPrintf("%s: Not bidding for BMM of sidechain %u: %s\n", __func__, bidder.nSidechain, bidder.strError);
+        return;
+    }
+
+    CWalletTx wtx;
+    CReserveKey reservekey(this);
+    CAmount nFee = 0;
+    std::string strFail;
+    if (!CreateBMMRequest(wtx, reservekey, nFee, strFail, bidder.nSidechain, bidder.hashCritical, bidder.nAmount, pindexTip->nHeight, strPrevBlock, true)) {
+        bidder.strError = strFail;
+        LogPrintf("%s: Failed to create BMM request for sidechain %u: %s\n", __func__, bidder.nSidechain, strFail);
+        return;
+    }
+    if (bidder.nAmount + nFee > bidder.nMaxBid) {
+        bidder.strError = strprintf("The fee of %s is over the budget", FormatMoney(nFee));
+        LogPrintf("%s: Not bidding for BMM of sidechain %u: %s\n", __func__, bidder.nSidechain, bidder.strError);
+        return;
+    }
+
+    CValidationState state;
+    if (!CommitTransaction(wtx, reservekey, g_connman.get(), state, true /* fRemoveIfFail */)) {
+        bidder.strError = strprintf("The BMM request was rejected: %s", FormatStateMessage(state));
+        LogPrintf("%s: Failed to bid for BMM of sidechain %u: %s\n", __func__, bidder.nSidechain, bidder.strError);
+        return;
+    }
+
+    bidder.hashBidBlock = pindexTip->GetBlockHash();
+    bidder.vBidTxid.push_back(wtx.GetHash());
+    bidder.nBid = bidder.nAmount + nFee;
+    bidder.strError = "";
+    LogPrintf("%s: Bid %s for BMM of sidechain %u in block %u: %s\n", __func__, FormatMoney(bidder.nBid), bidder.nSidechain, pindexTip->nHeight + 1, wtx.GetHash().ToString());
+
+    if (nCompetingBid >= bidder.nBid)
+        RaiseBMMBid(bidder, nCompetingBid);
+}
+
+void CWallet::RaiseBMMBid(BMMBidder& bidder, const CAmount& nCompetingBid)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    if (bidder.vBidTxid.empty())
+        return;
+    const uint256 txid = bidder.vBidTxid.back();
+
+    // The fee that outbids the competing BMM request, or the smallest fee
+    // bump replacement allows if that is more
+    CAmount nFee = nCompetingBid - bidder.nAmount + 1;
+    if (bidder.nAmount + nFee > bidder.nMaxBid) {
+        bidder.strError = strprintf("Outbid by %s, over the budget", FormatMoney(nCompetingBid));
+        LogPrintf("%s: Not raising the BMM bid for sidechain %u: %s\n", __func__, bidder.nSidechain, bidder.strError);
+        return;
+    }
+
+    CCoinControl cc;
+    cc.signalRbf = true;
+    std::vector<std::string> vError;
+    CAmount nOldFee = 0;
+    CAmount nNewFee = 0;
+    CMutableTransaction mtx;
+    feebumper::Result result = feebumper::CreateTransaction(this, txid, cc, nFee, vError, nOldFee, nNewFee, mtx);
+    if (result == feebumper::Result::INVALID_PARAMETER) {
+        vError.clear();
+        result = feebumper::CreateTransaction(this, txid, cc, 0, vError, nOldFee, nNewFee, mtx);
+    }
+    if (result != feebumper::Result::OK) {
+        bidder.strError = vError.empty() ? "Failed to bump the fee" : vError.front();
+        LogPrintf("%s: Failed to raise the BMM bid for sidechain %u: %s\n", __func__, bidder.nSidechain, bidder.strError);
+        return;
+    }
+    if (bidder.nAmount + nNewFee > bidder.nMaxBid) {
+        bidder.strError = strprintf("Outbid by %s, the fee bump is over the budget", FormatMoney(nCompetingBid));
+        LogPrintf("%s: Not raising the BMM bid for sidechain %u: %s\n", __func__, bidder.nSidechain, bidder.strError);
+        return;
+    }
+    if (!feebumper::SignTransaction(this, mtx)) {
+        bidder.strError = "Can't sign the fee bump";
+        LogPrintf("%s: Failed to raise the BMM bid for sidechain %u: %s\n", __func__, bidder.nSidechain, bidder.strError);
+        return;
+    }
+
+    uint256 txidBumped;
+    result = feebumper::CommitTransaction(this, txid, std::move(mtx), vError, txidBumped);
+    if (!txidBumped.IsNull())
+        bidder.vBidTxid.push_back(txidBumped);
+    if (result != feebumper::Result::OK || !vError.empty()) {
+        bidder.strError = vError.empty() ? "Failed to commit the fee bump" : vError.front();
+        LogPrintf("%s: Failed to raise the BMM bid for sidechain %u: %s\n", __func__, bidder.nSidechain, bidder.strError);
+        return;
+    }
+
+    bidder.nBid = bidder.nAmount + nNewFee;
+    bidder.strError = "";
+    LogPrintf("%s: Raised the BMM bid for sidechain %u to %s: %s\n", __func__, bidder.nSidechain, FormatMoney(bidder.nBid), txidBumped.ToString());
+}
+
+void CWallet::ExpireBMMBid(BMMBidder& bidder)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    // The miner doesn't drop BMM requests for an old tip until it creates a
+    // block on the new one, remove them now to free the inputs of our bids
+    std::vector<uint256> vHashRemoved;
+    mempool.RemoveExpiredCriticalRequests(vHashRemoved);
+    for (const uint256& u : vHashRemoved)
+        scdb.AddRemovedBMM(u);
+
+    // Abandon our BMM requests that left the mempool. A bid on the current
+    // tip stays there until it expires or is outbid.
+    std::set<uint256> setAbandon(vHashRemoved.begin(), vHashRemoved.end());
+    setAbandon.insert(bidder.vBidTxid.begin(), bidder.vBidTxid.end());
+    for (const uint256& txid : setAbandon) {
+        auto it = mapWallet.find(txid);
+        if (it == mapWallet.end() || it->second.GetDepthInMainChain() != 0 || it->second.isAbandoned() || mempool.exists(txid))
+            continue;
+
+        // The wallet is notified of the removal later
+        it->second.fInMempool = false;
+
+        std::string strReason;
+        if (!AbandonTransaction(txid, &strReason))
+            LogPrintf("%s: Failed to abandon BMM request %s: %s\n", __func__, txid.ToString(), strReason);
+    }
+
+    bidder.hashBidBlock.SetNull();
+    bidder.vBidTxid.clear();
+    bidder.nBid = 0;
+}
+
 /**
  * Call after CreateTransaction unless you want to abort
  */
@@ -4551,7 +5815,7 @@ CWallet* CWallet::CreateWalletFromFile(const std::string walletFile)
     if (gArgs.GetBoolArg("-zapwallettxes", false)) {
         uiInterface.InitMessage(_("Zapping all transactions from wallet..."));
 
-        std::unique_ptr<CWalletDBWrapper> dbw(new CWalletDBWrapper(&bitdb, walletFile));
+        std::unique_ptr<CWalletDBWrapper> dbw(new CWalletDBWrapper(&bitdb, walletFile, GetWalletDBFormat(walletFile)));
         std::unique_ptr<CWallet> tempWallet = MakeUnique<CWallet>(std::move(dbw));
         DBErrors nZapWalletRet = tempWallet->ZapWalletTx(vWtx);
         if (nZapWalletRet != DB_LOAD_OK) {
@@ -4564,7 +5828,7 @@ CWallet* CWallet::CreateWalletFromFile(const std::string walletFile)
 
     int64_t nStart = GetTimeMillis();
     bool fFirstRun = true;
-    std::unique_ptr<CWalletDBWrapper> dbw(new CWalletDBWrapper(&bitdb, walletFile));
+    std::unique_ptr<CWalletDBWrapper> dbw(new CWalletDBWrapper(&bitdb, walletFile, GetWalletDBFormat(walletFile)));
     CWallet *walletInstance = new CWallet(std::move(dbw));
     DBErrors nLoadWalletRet = walletInstance->LoadWallet(fFirstRun);
     if (nLoadWalletRet != DB_LOAD_OK)
@@ -4751,10 +6015,19 @@ void CWallet::postInitProcess(CScheduler& scheduler)
     // Do this here as mempool requires genesis block to be loaded
     ReacceptWalletTransactions();
 
+    // Submit the queued deposits that aren't in the mempool
+    {
+        LOCK2(cs_main, cs_wallet);
+        ProcessDepositQueues();
+    }
+
     // Run a thread to flush wallet periodically
     if (!CWallet::fFlushScheduled.exchange(true)) {
         scheduler.scheduleEvery(MaybeCompactWalletDB, 500);
     }
+
+    // Broadcast scheduled transactions when they are due
+    scheduler.scheduleEvery(std::bind(&CWallet::BroadcastScheduledTransactions, this), SCHEDULED_TX_BROADCAST_INTERVAL);
 }
 
 bool CWallet::BackupWallet(const std::string& strDest)
@@ -4979,6 +6252,30 @@ void CWallet::UpdateReplayStatus(const uint256& txid, const int nReplayStatus)
     NotifyTransactionChanged(this, txid, CT_UPDATED);
 }
 
+void CWallet::UpdateReplayStatus(const std::map<uint256, int>& mapReplayStatus)
+{
+    AssertLockHeld(cs_wallet);
+
+    std::vector<uint256> vUpdated;
+    CWalletDB walletdb(*dbw, "r+");
+    bool fTxn = walletdb.TxnBegin();
+    for (const std::pair<const uint256, int>& status : mapReplayStatus) {
+        std::map<uint256, CWalletTx>::iterator it = mapWallet.find(status.first);
+        if (it == mapWallet.end() || it->second.GetReplayStatus() == status.second)
+            continue;
+
+        it->second.UpdateReplayStatus(status.second);
+        if (!walletdb.WriteTx(it->second))
+            LogPrintf("%s: Updating walletdb tx %s failed\n", __func__, it->second.GetHash().ToString());
+        vUpdated.push_back(status.first);
+    }
+    if (fTxn && !walletdb.TxnCommit())
+        LogPrintf("%s: Writing the replay status of %u transactions failed\n", __func__, vUpdated.size());
+
+    for (const uint256& txid : vUpdated)
+        NotifyTransactionChanged(this, txid, CT_UPDATED);
+}
+
 std::vector<unsigned char> CWallet::SignHeaderHash(const uint256& hash)
 {
     if (vpwallets.empty())
@@ -10,6 +10,7 @@
 #include <policy/feerate.h>
 #include <streams.h>
 #include <tinyformat.h>
+#include <txmempool.h>
 #include <ui_interface.h>
 #include <utilstrencodings.h>
 #include <validationinterface.h>
@@ -22,10 +23,12 @@
 #include <algorithm>
 #include <atomic>
 #include <map>
+#include <queue>
 #include <set>
 #include <stdexcept>
 #include <stdint.h>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -80,6 +83,7 @@ class CTxMemPool;
 class CBlockPolicyEstimator;
 class CWalletTx;
 class CriticalData;
+struct PlannedSplitTx;
 struct FeeCalculation;
 enum class FeeEstimateMode;
 
@@ -691,26 +695,118 @@ private:
     std::vector<char> _ssExtra;
 };
 
+//! Qt format of the time of scheduled transactions in the GUI, and in files written before version 1
 static const std::string SCHEDULED_TX_TIME_FORMAT = "ddd MMMM d yyyy h:mm a";
-static const uint64_t SCHEDULED_TX_DUMP_VERSION = 0;
+static const uint64_t SCHEDULED_TX_DUMP_VERSION = 1;
+//! How often the wallet checks for scheduled transactions to broadcast (ms)
+static const int64_t SCHEDULED_TX_BROADCAST_INTERVAL = 10 * 1000;
+//! Maximum number of threads reading blocks for a rescan
+static const int MAX_RESCAN_THREADS = 4;
+//! Default maximum number of transactions created by one call to DenyCoins
+static const unsigned int DEFAULT_MAX_DENIAL_TXS = 500;
+//! Maximum number of threads signing denial transactions
+static const int MAX_DENIAL_SIGNING_THREADS = 8;
+//! Maximum number of threads signing the inputs of one transaction
+static const int MAX_INPUT_SIGNING_THREADS = 8;
+//! Transactions with fewer inputs are signed on one thread
+static const unsigned int MIN_PARALLEL_SIGNING_INPUTS = 32;
+
 struct ScheduledTransaction
 {
-    // TODO I would prefer unix time, which requires updating Qt dep
-    // The date time in SCHEULED_TX_TIME_FORMAT to broadcast the TX
-    std::string strTime;
-
     // The scheduled transaction
     uint256 wtxid; // WTX hash in mapWallet
 
+    // Unix time to broadcast the transaction at
+    int64_t nTime;
+
+    ScheduledTransaction() : nTime(0) {}
+    ScheduledTransaction(const uint256& wtxidIn, int64_t nTimeIn) : wtxid(wtxidIn), nTime(nTimeIn) {}
+
     ADD_SERIALIZE_METHODS
 
     template<typename Stream, typename Operation>
     inline void SerializationOp(Stream& s, Operation ser_action) {
-        READWRITE(strTime);
         READWRITE(wtxid);
+        READWRITE(nTime);
+    }
+};
+
+/**
+ * A sidechain deposit waiting in the deposit queue of its sidechain. The
+ * deposits of a sidechain are chained in queue order, every deposit spends
+ * the deposit output of the one before it as its CTIP.
+ */
+struct QueuedDeposit
+{
+    uint256 id;
+    uint8_t nSidechain;
+    CScript sidechainScriptPubKey;
+    CAmount nAmount;
+    CAmount nFee;
+    std::string strDest;
+    // Position in the queue, taken from the transaction order of the wallet
+    int64_t nOrderPos;
+    int64_t nTimeQueued;
+    // The deposit transaction accepted to the mempool and added to the wallet, null until submitted
+    uint256 txid;
+
+    // Not serialized:
+
+    // The deposit transaction built on the projected CTIP, null until built
+    CTransactionRef tx;
+    // The CTIP tx spends, null if there was no CTIP or tx was loaded from the wallet
+    COutPoint outCTIP;
+    // Why the deposit couldn't be built or submitted the last time
+    std::string strError;
+
+    QueuedDeposit() : nSidechain(0), nAmount(0), nFee(0), nOrderPos(0), nTimeQueued(0) {}
+
+    ADD_SERIALIZE_METHODS
+
+    template<typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nSidechain);
+        READWRITE(sidechainScriptPubKey);
+        READWRITE(nAmount);
+        READWRITE(nFee);
+        READWRITE(strDest);
+        READWRITE(nOrderPos);
+        READWRITE(nTimeQueued);
+        READWRITE(txid);
     }
 };
 
+/**
+ * The BMM bidder of a sidechain. On every new tip it requests BMM for the
+ * sidechain block with h* hashCritical in the next block, and when another
+ * BMM request for the sidechain outbids it in the mempool it bumps the fee
+ * of its request, within the budget of nMaxBid per block.
+ */
+struct BMMBidder
+{
+    uint8_t nSidechain;
+    // h* of the sidechain block to BMM, null once it was BMMed
+    uint256 hashCritical;
+    // Amount the BMM requests pay to the miner with their OP_TRUE output
+    CAmount nAmount;
+    // The most the amount and the fee of a BMM request may add up to
+    CAmount nMaxBid;
+
+    // The tip the current bid was made on, null without a bid
+    uint256 hashBidBlock;
+    // BMM requests of the current bid, every one replaced the one before it
+    std::vector<uint256> vBidTxid;
+    // What the last BMM request of the current bid pays the miner
+    CAmount nBid;
+    // Number of h* that were BMMed and what their BMM requests paid
+    int nWon;
+    CAmount nSpent;
+    // Why the last bid or rebid failed
+    std::string strError;
+
+    BMMBidder() : nSidechain(0), nAmount(0), nMaxBid(0), nBid(0), nWon(0), nSpent(0) {}
+};
+
 class WalletRescanReserver; //forward declarations for ScanForWalletTransactions/RescanFromTime
 /**
  * A CWallet is an extension of a keystore, which also maintains a set of transactions and balances,
@@ -724,6 +820,7 @@ private:
     std::atomic<bool> fScanningWallet; //controlled by WalletRescanReserver
     std::mutex mutexScanning;
     friend class WalletRescanReserver;
+    friend class WalletDepositQueueHandler;
 
 
     /**
@@ -755,6 +852,12 @@ private:
     void AddToSpends(const COutPoint& outpoint, const uint256& wtxid);
     void AddToSpends(const uint256& wtxid);
 
+    /**
+     * Remove transactions that AddToWallet inserted in a wallet database
+     * transaction that was aborted or failed to commit.
+     */
+    void RemoveUncommittedTxs(const std::vector<uint256>& vHash);
+
     /* Mark a transaction (and its in-wallet descendants) as conflicting with a particular block. */
     void MarkConflicted(const uint256& hashBlock, const uint256& hashTx);
 
@@ -802,13 +905,89 @@ private:
      */
     const CBlockIndex* m_last_block_processed;
 
-    /* Load list of scheduled transactions */
+    /* Import the scheduled transactions of the wallet from the file they were kept in before */
     bool LoadScheduledTransactions();
 
-    /* Write list of scheduled transactions */
-    void WriteScheduledTransactions();
+    /** Broadcast time of the scheduled transactions by wtxid */
+    std::unordered_map<uint256, int64_t, SaltedTxidHasher> mapScheduled;
+
+    /**
+     * Scheduled transactions ordered by broadcast time, earliest first.
+     * Cancelled transactions are only removed from mapScheduled, their
+     * entries are dropped when they reach the top.
+     */
+    std::priority_queue<std::pair<int64_t, uint256>, std::vector<std::pair<int64_t, uint256>>, std::greater<std::pair<int64_t, uint256>>> queueScheduled;
+
+    /** Create an unsigned transaction sending a coin to new keys, paying the fee from the outputs */
+    bool CreateDenialTransaction(CMutableTransaction& mtx, std::string& strFail, const COutput& coin, const CAmount& amountRequired, const CTxDestination& destRequired);
+
+    /** Sign the input of a denial transaction, may be called from several threads at once */
+    bool SignDenialTransaction(CMutableTransaction& mtx, const COutput& coin) const;
+
+    /**
+     * Outputs of wallet transactions that are ours and weren't spent when
+     * last checked, with their ownership, by txid. AvailableCoins only visits
+     * these and drops the outputs it finds spent. Outputs are added back when
+     * the transaction spending them is abandoned or conflicted, and the index
+     * is rebuilt when the wallet is marked dirty (for example by an import).
+     */
+    mutable std::map<uint256, std::map<unsigned int, isminetype>> mapUnspentIndex;
+    mutable bool fUnspentIndexValid;
+
+    void BuildUnspentIndex() const;
+    /** Add the outputs of a new transaction that are ours to the index */
+    void AddToUnspentIndex(const uint256& hash, const CWalletTx& wtx) const;
+    /** Add an output that may have become unspent to the index */
+    void AddToUnspentIndex(const COutPoint& outpoint) const;
 
-    std::vector<ScheduledTransaction> vScheduled;
+    /** Deposits waiting to be confirmed by sidechain, in the order they are chained in */
+    std::map<uint8_t, std::vector<QueuedDeposit>> mapDepositQueue;
+
+    /** Sidechains whose deposit queue has to be processed, set when one of its deposits leaves the mempool */
+    std::set<uint8_t> setDepositQueueDirty;
+
+    /** Check the parameters of a sidechain deposit, before the wallet is locked */
+    bool CheckSidechainDeposit(std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const std::string& strDest, CScript& dataScript);
+
+    /**
+     * Build and sign a sidechain deposit spending setCoins and the CTIP, if
+     * there is one, with change to a key reserved from reserveKey.
+     */
+    bool SignSidechainDeposit(CMutableTransaction& mtx, std::string& strFail, const std::set<CInputCoin>& setCoins, CAmount nValueIn, const SidechainCTIP* pctip, const CScript& sidechainScriptPubKey, const CScript& dataScript, const CAmount& nAmount, const CAmount& nFee, CReserveKey& reserveKey);
+
+    /** Process the deposit queue of a sidechain on its mempool CTIP, see ::ProcessDepositQueue */
+    void ProcessDepositQueue(uint8_t nSidechain);
+
+    /** Drop the transaction of a queued deposit, adding the inputs of a submitted one to vReuse */
+    void DiscardQueuedDeposit(QueuedDeposit& deposit, CWalletDB& walletdb, std::vector<COutPoint>& vReuse);
+
+    /**
+     * Build the transaction of a queued deposit on the projected CTIP. It
+     * spends the coins in vReuse that are still unspent, the change of the
+     * deposit queued before it and confirmed coins, and its coins are locked
+     * until it is submitted.
+     */
+    bool BuildQueuedDeposit(QueuedDeposit& deposit, const SidechainCTIP* pctip, const QueuedDeposit* pprev, const std::vector<COutPoint>& vReuse);
+
+    bool SubmitQueuedDeposit(QueuedDeposit& deposit, CWalletDB& walletdb, CValidationState& state);
+
+    void ProcessDepositQueues();
+
+    /** BMM bidders by sidechain, they aren't saved to the wallet */
+    std::map<uint8_t, BMMBidder> mapBMMBidders;
+
+    /**
+     * Bid for BMM on the tip, unless the bidder already did or doesn't have
+     * an h*. The bid is raised right away if a BMM request in the mempool
+     * outbids it.
+     */
+    void PlaceBMMBid(BMMBidder& bidder);
+
+    /** Bump the fee of the current bid to outbid nCompetingBid, if the budget allows it */
+    void RaiseBMMBid(BMMBidder& bidder, const CAmount& nCompetingBid);
+
+    /** Remove the BMM requests of the current bid from the mempool and abandon them */
+    void ExpireBMMBid(BMMBidder& bidder);
 
 public:
     /*
@@ -882,6 +1061,7 @@ public:
         nRelockTime = 0;
         fAbortRescan = false;
         fScanningWallet = false;
+        fUnspentIndexValid = false;
     }
 
     std::map<uint256, CWalletTx> mapWallet;
@@ -1003,10 +1183,16 @@ public:
 
     void MarkDirty();
     bool AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose=true);
+    bool AddToWallet(const CWalletTx& wtxIn, CWalletDB& walletdb);
     bool LoadToWallet(const CWalletTx& wtxIn);
+    //! Adds a scheduled transaction read from the database, without saving it again
+    void LoadScheduledTransaction(const ScheduledTransaction& scheduled);
+    //! Adds a queued deposit read from the database, without saving it again
+    void LoadQueuedDeposit(const QueuedDeposit& deposit);
     void TransactionAddedToMempool(const CTransactionRef& tx) override;
     void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex *pindex, const std::vector<CTransactionRef>& vtxConflicted) override;
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) override;
+    void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
     bool AddToWalletIfInvolvingMe(const CTransactionRef& tx, const CBlockIndex* pIndex, int posInBlock, bool fUpdate);
     int64_t RescanFromTime(int64_t startTime, const WalletRescanReserver& reserver, bool update);
     CBlockIndex* ScanForWalletTransactions(CBlockIndex* pindexStart, CBlockIndex* pindexStop, const WalletRescanReserver& reserver, bool fUpdate = false);
@@ -1042,10 +1228,62 @@ public:
     /** Create a transaction with special format for sidechains */
     bool CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest);
 
+    /**
+     * Add a sidechain deposit to the deposit queue of its sidechain. It is
+     * built on the deposit queued before it, so that several deposits to the
+     * same sidechain can wait in the mempool at once, and is submitted as soon
+     * as the mempool accepts it.
+     */
+    bool QueueSidechainDeposit(QueuedDeposit& deposit, std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest);
+
+    /** Remove a queued deposit that wasn't submitted yet, the deposits after it are rebuilt */
+    bool RemoveQueuedDeposit(const uint256& id, std::string& strFail);
+
+    /** Queued deposits of every sidechain, in queue order */
+    std::vector<QueuedDeposit> GetQueuedDeposits() const;
+
+    /**
+     * Create a BMM request paying nAmount to the miner that commits h* for
+     * nSidechain in the block after the block at nHeight, whose hash ends
+     * with strPrevBlock. Call CommitTransaction to send it.
+     */
+    bool CreateBMMRequest(CWalletTx& wtx, CReserveKey& reservekey, CAmount& nFeeRet, std::string& strFail, const uint8_t nSidechain, const uint256& hashCritical, const CAmount& nAmount, int nHeight, const std::string& strPrevBlock, bool fReplaceable = false);
+
+    /**
+     * Start bidding for BMM of a sidechain or change the h*, amount or budget
+     * of its bidder. A changed bidder drops its current bid and bids again on
+     * the tip.
+     */
+    bool SetBMMBidder(BMMBidder& bidder, std::string& strFail, const uint8_t nSidechain, const uint256& hashCritical, const CAmount& nAmount, const CAmount& nMaxBid);
+
+    /** Stop bidding for BMM of a sidechain, its current bid is abandoned */
+    bool RemoveBMMBidder(const uint8_t nSidechain, std::string& strFail);
+
+    std::vector<BMMBidder> GetBMMBidders() const;
+
     bool CreateOPReturnTransaction(CTransactionRef& tx, std::string& strFail, const CAmount& nFee, const CScript& script);
 
     bool DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin, bool fBroadcast = true, const CAmount& amountRequired = CAmount(0), const CTxDestination& destRequired = CNoDestination());
 
+    /**
+     * Deny coins until they reach a denial score of nGoal. Each round denies
+     * the outputs of the round before it, up to nMaxTx transactions in total.
+     * The transactions of a round are signed in parallel, all of them are
+     * written in one wallet database transaction and scheduled over nWindow
+     * seconds, every round after the round it spends from.
+     */
+    bool DenyCoins(const std::vector<COutput>& vCoins, unsigned int nGoal, int64_t nWindow, std::vector<ScheduledTransaction>& vScheduled, std::string& strFail, size_t nMaxTx = DEFAULT_MAX_DENIAL_TXS);
+
+    /**
+     * Split confirmed coins into nOutputs outputs of nAmount to new keys,
+     * with the transactions planned by PlanCoinSplit. The transactions of a
+     * level of the split trees are signed in parallel, all of them are
+     * written in one wallet database transaction and submitted parents
+     * first. vtx gets the transactions that were accepted to the mempool.
+     * A dry run only plans the split.
+     */
+    bool SplitCoins(const std::vector<COutput>& vCoins, unsigned int nOutputs, const CAmount& nAmount, unsigned int nMaxTxOutputs, std::vector<PlannedSplitTx>& vPlan, std::vector<CTransactionRef>& vtx, CAmount& nFeeRet, std::string& strFail, bool fDryRun = false);
+
     bool CommitTransaction(CWalletTx& wtxNew, CReserveKey& reservekey, CConnman* connman, CValidationState& state, bool fRemoveIfFail = false, CAmount nAbsurdFee = CAmount(0));
 
     void ListAccountCreditDebit(const std::string& strAccount, std::list<CAccountingEntry>& entries);
@@ -1230,17 +1468,25 @@ public:
     /** Update the replay status of a wallet transaction */
     void UpdateReplayStatus(const uint256& txid, const int nReplayStatus);
 
-    /** Add to scheduled transaction cache */
-    bool ScheduleTransaction(const uint256& wtxid, const std::string& strTime);
+    /** Update the replay status of a set of wallet transactions, writing them in one batch */
+    void UpdateReplayStatus(const std::map<uint256, int>& mapReplayStatus);
+
+    /** Broadcast a wallet transaction that hasn't been broadcast at unix time nTime */
+    bool ScheduleTransaction(const uint256& wtxid, int64_t nTime);
+
+    /** Schedule a set of transactions, writing the schedule once. Nothing is scheduled if any of them can't be */
+    bool ScheduleTransactions(const std::vector<ScheduledTransaction>& vSchedule);
 
-    /** Remove / cancel scheduled transaction */
-    void RemoveScheduledTransaction(const ScheduledTransaction& scheduled);
+    /** Cancel a scheduled transaction and abandon it, so that its inputs can be respent */
+    bool CancelScheduledTransaction(const uint256& wtxid);
 
+    /** Scheduled transactions, earliest first */
     std::vector<ScheduledTransaction> GetScheduled() const;
 
     bool IsScheduled(const uint256& wtxid) const;
 
-    bool BroadcastScheduled(const uint256& wtxid);
+    /** Broadcast the scheduled transactions that are due, run by the scheduler */
+    void BroadcastScheduledTransactions();
 
     std::vector<unsigned char> SignHeaderHash(const uint256& hash);
 };
@@ -146,6 +146,26 @@ bool CWalletDB::ErasePool(int64_t nPool)
     return EraseIC(std::make_pair(std::string("pool"), nPool));
 }
 
+bool CWalletDB::WriteScheduledTransaction(const ScheduledTransaction& scheduled)
+{
+    return WriteIC(std::make_pair(std::string("scheduledtx"), scheduled.wtxid), scheduled.nTime);
+}
+
+bool CWalletDB::EraseScheduledTransaction(const uint256& wtxid)
+{
+    return EraseIC(std::make_pair(std::string("scheduledtx"), wtxid));
+}
+
+bool CWalletDB::WriteQueuedDeposit(const QueuedDeposit& deposit)
+{
+    return WriteIC(std::make_pair(std::string("depositqueue"), deposit.id), deposit);
+}
+
+bool CWalletDB::EraseQueuedDeposit(const uint256& id)
+{
+    return EraseIC(std::make_pair(std::string("depositqueue"), id));
+}
+
 bool CWalletDB::WriteMinVersion(int nVersion)
 {
     return WriteIC(std::string("minversion"), nVersion);
@@ -183,7 +203,7 @@ void CWalletDB::ListAccountCreditDebit(const std::string& strAccount, std::list<
 {
     bool fAllAccounts = (strAccount == "*");
 
-    Dbc* pcursor = batch.GetCursor();
+    std::unique_ptr<CDBCursor> pcursor = batch.GetCursor();
     if (!pcursor)
         throw std::runtime_error(std::string(__func__) + ": cannot create DB cursor");
     bool setRange = true;
@@ -194,13 +214,12 @@ void CWalletDB::ListAccountCreditDebit(const std::string& strAccount, std::list<
         if (setRange)
             ssKey << std::make_pair(std::string("acentry"), std::make_pair((fAllAccounts ? std::string("") : strAccount), uint64_t(0)));
         CDataStream ssValue(SER_DISK, CLIENT_VERSION);
-        int ret = batch.ReadAtCursor(pcursor, ssKey, ssValue, setRange);
+        int ret = batch.ReadAtCursor(pcursor.get(), ssKey, ssValue, setRange);
         setRange = false;
         if (ret == DB_NOTFOUND)
             break;
         else if (ret != 0)
         {
-            pcursor->close();
             throw std::runtime_error(std::string(__func__) + ": error scanning DB");
         }
 
@@ -218,8 +237,6 @@ void CWalletDB::ListAccountCreditDebit(const std::string& strAccount, std::list<
         ssKey >> acentry.nEntryNo;
         entries.push_back(acentry);
     }
-
-    pcursor->close();
 }
 
 class CWalletScanState {
@@ -506,6 +523,20 @@ ReadKeyValue(CWallet* pwallet, CDataStream& ssKey, CDataStream& ssValue,
                 return false;
             }
         }
+        else if (strType == "scheduledtx")
+        {
+            ScheduledTransaction scheduled;
+            ssKey >> scheduled.wtxid;
+            ssValue >> scheduled.nTime;
+            pwallet->LoadScheduledTransaction(scheduled);
+        }
+        else if (strType == "depositqueue")
+        {
+            QueuedDeposit deposit;
+            ssKey >> deposit.id;
+            ssValue >> deposit;
+            pwallet->LoadQueuedDeposit(deposit);
+        }
     } catch (...)
     {
         return false;
@@ -536,7 +567,7 @@ DBErrors CWalletDB::LoadWallet(CWallet* pwallet)
         }
 
         // Get cursor
-        Dbc* pcursor = batch.GetCursor();
+        std::unique_ptr<CDBCursor> pcursor = batch.GetCursor();
         if (!pcursor)
         {
             LogPrintf("Error getting wallet database cursor\n");
@@ -548,7 +579,7 @@ DBErrors CWalletDB::LoadWallet(CWallet* pwallet)
             // Read next record
             CDataStream ssKey(SER_DISK, CLIENT_VERSION);
             CDataStream ssValue(SER_DISK, CLIENT_VERSION);
-            int ret = batch.ReadAtCursor(pcursor, ssKey, ssValue);
+            int ret = batch.ReadAtCursor(pcursor.get(), ssKey, ssValue);
             if (ret == DB_NOTFOUND)
                 break;
             else if (ret != 0)
@@ -577,7 +608,6 @@ DBErrors CWalletDB::LoadWallet(CWallet* pwallet)
             if (!strErr.empty())
                 LogPrintf("%s\n", strErr);
         }
-        pcursor->close();
     }
     catch (const boost::thread_interrupted&) {
         throw;
@@ -638,7 +668,7 @@ DBErrors CWalletDB::FindWalletTx(std::vector<uint256>& vTxHash, std::vector<CWal
         }
 
         // Get cursor
-        Dbc* pcursor = batch.GetCursor();
+        std::unique_ptr<CDBCursor> pcursor = batch.GetCursor();
         if (!pcursor)
         {
             LogPrintf("Error getting wallet database cursor\n");
@@ -650,7 +680,7 @@ DBErrors CWalletDB::FindWalletTx(std::vector<uint256>& vTxHash, std::vector<CWal
             // Read next record
             CDataStream ssKey(SER_DISK, CLIENT_VERSION);
             CDataStream ssValue(SER_DISK, CLIENT_VERSION);
-            int ret = batch.ReadAtCursor(pcursor, ssKey, ssValue);
+            int ret = batch.ReadAtCursor(pcursor.get(), ssKey, ssValue);
             if (ret == DB_NOTFOUND)
                 break;
             else if (ret != 0)
@@ -672,7 +702,6 @@ DBErrors CWalletDB::FindWalletTx(std::vector<uint256>& vTxHash, std::vector<CWal
                 vWtx.push_back(wtx);
             }
         }
-        pcursor->close();
     }
     catch (const boost::thread_interrupted&) {
         throw;
@@ -817,6 +846,11 @@ bool CWalletDB::VerifyDatabaseFile(const std::string& walletFile, const fs::path
     return CDB::VerifyDatabaseFile(walletFile, walletDir, warningStr, errorStr, CWalletDB::Recover);
 }
 
+bool CWalletDB::MigrateDatabaseFile(const std::string& walletFile, WalletDBFormat format, std::string& errorStr)
+{
+    return CDB::Migrate(walletFile, format, errorStr);
+}
+
 bool CWalletDB::WriteDestData(const std::string &address, const std::string &key, const std::string &value)
 {
     return WriteIC(std::make_pair(std::string("destdata"), std::make_pair(address, key)), value);
@@ -23,6 +23,8 @@
  *
  * - CDBEnv is an environment in which the database exists (has no analog in dbwrapper.h)
  * - CWalletDBWrapper represents a wallet database (similar to CDBWrapper in dbwrapper.h)
+ * - CWalletLogDB is the append-only log a wallet database is stored in instead
+ *   of BerkeleyDB with -walletformat=log
  * - CDB is a low-level database transaction (similar to CDBBatch in dbwrapper.h)
  * - CWalletDB is a modifier object for the wallet, and encapsulates a database
  *   transaction as well as methods to act on the database (no analog in
@@ -43,6 +45,8 @@ class CMasterKey;
 class CScript;
 class CWallet;
 class CWalletTx;
+struct QueuedDeposit;
+struct ScheduledTransaction;
 class uint160;
 class uint256;
 
@@ -198,6 +202,12 @@ public:
     bool WritePool(int64_t nPool, const CKeyPool& keypool);
     bool ErasePool(int64_t nPool);
 
+    bool WriteScheduledTransaction(const ScheduledTransaction& scheduled);
+    bool EraseScheduledTransaction(const uint256& wtxid);
+
+    bool WriteQueuedDeposit(const QueuedDeposit& deposit);
+    bool EraseQueuedDeposit(const uint256& id);
+
     bool WriteMinVersion(int nVersion);
 
     /// This writes directly to the database, and will not update the CWallet's cached accounting entries!
@@ -230,6 +240,8 @@ public:
     static bool VerifyEnvironment(const std::string& walletFile, const fs::path& walletDir, std::string& errorStr);
     /* verifies the database file */
     static bool VerifyDatabaseFile(const std::string& walletFile, const fs::path& walletDir, std::string& warningStr, std::string& errorStr);
+    /* replaces the database file with a copy in another format */
+    static bool MigrateDatabaseFile(const std::string& walletFile, WalletDBFormat format, std::string& errorStr);
 
     //! write the hdchain model (external chain child index counter)
     bool WriteHDChain(const CHDChain& chain);